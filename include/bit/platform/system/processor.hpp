@@ -126,7 +126,11 @@ namespace bit {
       /// \return true if hyper threading is supported
       bool is_hyper_threading_supported() const noexcept;
 
-      /// \brief Returns the number of logical processors
+      /// \brief Returns the number of logical processors available to the
+      ///        process
+      ///
+      /// This honors the affinity mask and cgroup limits of the process; see
+      /// available_concurrency
       ///
       /// \return the number of logical processors
       std::size_t logical_processors() const noexcept;
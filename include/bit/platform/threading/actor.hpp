@@ -0,0 +1,352 @@
+/**
+ * \file actor.hpp
+ *
+ * \brief This header contains the definition of an actor; a stateful entity
+ *        that processes the messages of its mailbox one-at-a-time on the
+ *        workers of a dispatcher
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_ACTOR_HPP
+#define BIT_PLATFORM_THREADING_ACTOR_HPP
+
+#include "job.hpp"                // job
+#include "dispatcher.hpp"         // dispatcher
+#include "detail/mpsc_queue.hpp"  // detail::mpsc_queue, detail::mpsc_node
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <functional>  // std::function
+#include <new>         // placement new
+#include <type_traits> // std::is_nothrow_destructible
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      class actor_base;
+
+      /// \brief Allocates a block for a message of \p size bytes from the
+      ///        slabs of the calling thread
+      ///
+      /// \param size the size of the message node
+      /// \return pointer to the allocated block
+      void* allocate_actor_message( std::size_t size );
+
+      /// \brief Deallocates a block of \p size bytes previously allocated
+      ///        with allocate_actor_message
+      ///
+      /// \param p pointer to the block
+      /// \param size the size of the message node
+      void deallocate_actor_message( void* p, std::size_t size ) noexcept;
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The header of every entry in the mailbox of an actor
+      /////////////////////////////////////////////////////////////////////////
+      struct actor_message_base : mpsc_node
+      {
+        /// The function that handles, and then destroys, the message
+        using receive_function = void(*)( actor_base&, actor_message_base* );
+
+        explicit actor_message_base( receive_function receive ) noexcept;
+
+        receive_function receive;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A message of type \p Message, stored inline after its header
+      /////////////////////////////////////////////////////////////////////////
+      template<typename Message>
+      struct actor_message : actor_message_base
+      {
+        template<typename...Args>
+        explicit actor_message( receive_function receive, Args&&...args );
+
+        Message value;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The type-independent mailbox and scheduling of an actor
+      ///
+      /// This behaves like a serial_queue of messages, except that an actor
+      /// does not post a job of its own when its mailbox transitions from
+      /// idle to non-empty. Instead, the actor links itself into the run
+      /// queue of its dispatcher, which is serviced by at most one job per
+      /// worker. This keeps the number of outstanding jobs bounded, no matter
+      /// how many actors become ready at once.
+      /////////////////////////////////////////////////////////////////////////
+      class actor_base : private mpsc_node
+      {
+        //---------------------------------------------------------------------
+        // Public Static Members
+        //---------------------------------------------------------------------
+      public:
+
+        static constexpr std::size_t default_batch_size = 64u;
+
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      protected:
+
+        /// \brief Constructs this actor_base to execute on the workers of
+        ///        \p dispatcher
+        ///
+        /// \param dispatcher the dispatcher to execute on
+        /// \param batch_size the maximum number of messages to process
+        ///                   before yielding the worker
+        actor_base( dispatcher& dispatcher, std::size_t batch_size ) noexcept;
+
+        // Deleted move constructor
+        actor_base( actor_base&& other ) = delete;
+
+        // Deleted copy constructor
+        actor_base( const actor_base& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Destructs this actor_base
+        ///
+        /// \pre the mailbox has been flushed
+        ~actor_base();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        actor_base& operator=( actor_base&& other ) = delete;
+
+        // Deleted copy assignment
+        actor_base& operator=( const actor_base& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Gets the dispatcher that this actor executes on
+        ///
+        /// \return reference to the dispatcher
+        dispatcher& get_dispatcher() const noexcept;
+
+        /// \brief Gets the maximum number of messages processed before the
+        ///        worker is yielded
+        ///
+        /// \return the batch size
+        std::size_t batch_size() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Protected Modifiers
+        //---------------------------------------------------------------------
+      protected:
+
+        /// \brief Pushes \p message into the mailbox, scheduling a drain if
+        ///        the mailbox was idle
+        ///
+        /// \param message the message to push
+        void enqueue( actor_message_base* message );
+
+        /// \brief Waits for every message sent so far to be processed, and
+        ///        for the last drain to release this actor
+        void flush();
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        dispatcher&        m_dispatcher;
+        detail::mpsc_queue m_mailbox;
+        std::atomic<bool>  m_scheduled;  ///< Whether the actor is queued or draining
+        std::atomic<bool>  m_draining;   ///< Whether a drain is touching the mailbox
+        std::size_t        m_batch_size;
+
+        //---------------------------------------------------------------------
+        // Private Modifiers
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Links this actor into the run queue of its dispatcher
+        void schedule();
+
+        /// \brief Processes up to batch_size messages from the mailbox, and
+        ///        then either reschedules itself or marks the actor idle
+        void drain();
+
+        //---------------------------------------------------------------------
+        // Private Static Functions
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Posts a job to service the run queue of \p dispatcher,
+        ///        unless every worker is already servicing it
+        ///
+        /// \param dispatcher the dispatcher
+        static void add_runner( dispatcher& dispatcher );
+
+        /// \brief Drains the next actor in the run queue of \p dispatcher,
+        ///        and then either reschedules itself or retires
+        ///
+        /// \param dispatcher the dispatcher
+        static void run( dispatcher& dispatcher );
+      };
+
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A stateful entity that processes messages of type \p Message
+    ///        one-at-a-time, in the order they were sent, on the workers of
+    ///        an existing dispatcher
+    ///
+    /// An actor owns no thread, and takes no lock. Messages are linked into a
+    /// lock-free mailbox, and the actor is only scheduled on the dispatcher
+    /// while its mailbox has messages. Each activation processes at most
+    /// \c batch_size messages before yielding its worker, so that one busy
+    /// actor cannot starve the others.
+    ///
+    /// Messages are constructed directly inside of their mailbox entry, which
+    /// is allocated from slabs cached per-thread rather than from the heap;
+    /// only messages too large for the slabs fall back to operator new. An
+    /// idle actor costs only its own footprint, which makes it suitable for
+    /// running hundreds of thousands of actors on a handful of workers.
+    ///
+    /// Since the handler is never invoked concurrently with itself, state
+    /// that is only touched by the handler needs no further synchronization.
+    /// Sending a message is thread-safe, and may be done from any thread --
+    /// including from the handler of any actor.
+    ///
+    /// \note The dispatcher must remain running for as long as the actor
+    ///       has unprocessed messages
+    ///
+    /// \note The handler may not throw; an exception escaping the handler
+    ///       results in a call to std::terminate
+    ///
+    /// \tparam Message the type of message received by this actor
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename Message>
+    class actor : private detail::actor_base
+    {
+      static_assert( alignof(Message) <= alignof(std::max_align_t),
+                     "Over-aligned messages are not supported" );
+      static_assert( std::is_nothrow_destructible<Message>::value,
+                     "Messages must be nothrow destructible" );
+
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      using message_type = Message;
+      using handler_type = std::function<void(Message&)>;
+
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      using detail::actor_base::default_batch_size;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs this actor to process messages with \p handler
+      ///        on the workers of \p dispatcher
+      ///
+      /// \param dispatcher the dispatcher to execute on
+      /// \param handler the function invoked with each received message
+      /// \param batch_size the maximum number of messages to process before
+      ///                   yielding the worker
+      actor( dispatcher& dispatcher,
+             handler_type handler,
+             std::size_t batch_size = default_batch_size );
+
+      // Deleted move constructor
+      actor( actor&& other ) = delete;
+
+      // Deleted copy constructor
+      actor( const actor& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Destructs this actor, waiting for all messages sent so far to
+      ///        be processed
+      ///
+      /// When the handler refers to the state of an enclosing object, the
+      /// actor should be declared as the last member of that object so that
+      /// this state outlives any pending messages.
+      ///
+      /// \note An actor may not be destroyed from its own handler
+      ~actor();
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      actor& operator=( actor&& other ) = delete;
+
+      // Deleted copy assignment
+      actor& operator=( const actor& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      using detail::actor_base::get_dispatcher;
+      using detail::actor_base::batch_size;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \{
+      /// \brief Sends the message \p message to this actor
+      ///
+      /// \param message the message to send
+      void send( const Message& message );
+      void send( Message&& message );
+      /// \}
+
+      /// \brief Sends a message constructed in-place from \p args to this
+      ///        actor
+      ///
+      /// \param args the arguments to forward to the message's constructor
+      template<typename...Args>
+      void emplace( Args&&...args );
+
+      //-----------------------------------------------------------------------
+      // Private Types
+      //-----------------------------------------------------------------------
+    private:
+
+      using node_type = detail::actor_message<Message>;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      handler_type m_handler;
+
+      //-----------------------------------------------------------------------
+      // Private Static Functions
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Invokes the handler of \p self with the message \p message,
+      ///        and then destroys the message
+      ///
+      /// \param self the actor that received the message
+      /// \param message the message
+      static void receive( detail::actor_base& self,
+                           detail::actor_message_base* message ) noexcept;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/actor.inl"
+
+#endif /* BIT_PLATFORM_THREADING_ACTOR_HPP */
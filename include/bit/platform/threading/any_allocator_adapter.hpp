@@ -0,0 +1,128 @@
+/**
+ * \file any_allocator_adapter.hpp
+ *
+ * \brief This header contains an adapter that lets the threading containers
+ *        allocate from a bit::memory allocator
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_ANY_ALLOCATOR_ADAPTER_HPP
+#define BIT_PLATFORM_THREADING_ANY_ALLOCATOR_ADAPTER_HPP
+
+// bit::memory headers
+#include <bit/memory/allocators/any_allocator.hpp>
+
+// std headers
+#include <cstddef>     // std::size_t
+#include <new>         // std::bad_alloc
+#include <type_traits> // std::true_type
+#include <utility>     // std::move
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief An adapter that satisfies the standard Allocator concept by
+    ///        forwarding to a \c memory::any_allocator
+    ///
+    /// This allows the storage of \ref concurrent_queue, and of the other
+    /// allocator-aware containers in this library, to come from a
+    /// \c bit::memory allocator such as an arena or a pool.
+    ///
+    /// The adapter does not own the underlying allocator, which must outlive
+    /// every container that uses it.
+    ///
+    /// \tparam T the type of the entries to allocate
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class any_allocator_adapter
+    {
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type = T;
+      using size_type  = std::size_t;
+
+      using propagate_on_container_move_assignment = std::true_type;
+      using propagate_on_container_swap            = std::true_type;
+
+      template<typename U>
+      struct rebind
+      {
+        using other = any_allocator_adapter<U>;
+      };
+
+      //----------------------------------------------------------------------
+      // Constructors
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs an adapter that allocates from \p allocator
+      ///
+      /// \param allocator the allocator to forward to
+      explicit any_allocator_adapter( memory::any_allocator allocator ) noexcept;
+
+      /// \brief Converts an adapter of another type
+      ///
+      /// \param other the other adapter
+      template<typename U>
+      any_allocator_adapter( const any_allocator_adapter<U>& other ) noexcept;
+
+      //----------------------------------------------------------------------
+      // Allocation
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Allocates storage for \p n entries
+      ///
+      /// \throw std::bad_alloc if the underlying allocator fails
+      /// \param n the number of entries
+      /// \return pointer to the storage
+      T* allocate( size_type n );
+
+      /// \brief Deallocates storage from a previous call to allocate
+      ///
+      /// \param p pointer to the storage
+      /// \param n the number of entries it was allocated for
+      void deallocate( T* p, size_type n ) noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator
+      ///
+      /// \return the allocator
+      memory::any_allocator underlying() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      memory::any_allocator m_allocator;
+
+      template<typename> friend class any_allocator_adapter;
+    };
+
+    //------------------------------------------------------------------------
+    // Equality
+    //------------------------------------------------------------------------
+
+    template<typename T, typename U>
+    bool operator==( const any_allocator_adapter<T>& lhs,
+                     const any_allocator_adapter<U>& rhs ) noexcept;
+
+    template<typename T, typename U>
+    bool operator!=( const any_allocator_adapter<T>& lhs,
+                     const any_allocator_adapter<U>& rhs ) noexcept;
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/any_allocator_adapter.inl"
+
+#endif /* BIT_PLATFORM_THREADING_ANY_ALLOCATOR_ADAPTER_HPP */
@@ -0,0 +1,329 @@
+/**
+ * \file bounded_concurrent_queue.hpp
+ *
+ * \brief This header contains a bounded, lock-free, multi-producer/
+ *        multi-consumer queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_BOUNDED_CONCURRENT_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_BOUNDED_CONCURRENT_QUEUE_HPP
+
+#include "concurrency_arbiter.hpp" // blocking_region
+#include "futex.hpp"               // futex_wait, futex_wake_one
+#include "true_share.hpp"          // cache_line_size
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t, std::ptrdiff_t
+#include <cstdint>     // std::uint32_t
+#include <memory>      // std::allocator, std::allocator_traits
+#include <new>         // placement new
+#include <thread>      // std::this_thread::yield
+#include <type_traits> // std::aligned_storage_t, std::is_nothrow_constructible
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \class bit::platform::bounded_concurrent_queue
+    ///
+    /// \brief A bounded, lock-free variant of \ref concurrent_queue
+    ///
+    /// This is Dmitry Vyukov's bounded MPMC queue: a ring of cells with a
+    /// power-of-two capacity, where each cell carries a sequence number that
+    /// tells producers and consumers whether the cell is theirs to use. A
+    /// push or pop costs a single compare-and-swap on the tail or head index,
+    /// which live on separate cache lines, and never allocates.
+    ///
+    /// The blocking operations spin briefly before parking on a futex, and
+    /// only notify when a thread is parked, so that uncontended operations
+    /// make no system calls.
+    ///
+    /// \tparam T the type of the queue
+    /// \tparam Allocator the allocator used for the ring
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator = std::allocator<T>>
+    class bounded_concurrent_queue
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+      static_assert( std::is_nothrow_move_constructible<T>::value, "T must be nothrow move-constructible" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using pointer         = T*;
+      using const_pointer   = const T*;
+
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a queue that holds at least \p capacity entries
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      explicit bounded_concurrent_queue( size_type capacity );
+
+      /// \brief Constructs a queue that holds at least \p capacity entries,
+      ///        using the specified allocator
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      /// \param alloc the allocator to use
+      bounded_concurrent_queue( size_type capacity, const Allocator& alloc );
+
+      // Deleted move constructor
+      bounded_concurrent_queue( bounded_concurrent_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      bounded_concurrent_queue( const bounded_concurrent_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys any entries left in the queue
+      ~bounded_concurrent_queue();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      bounded_concurrent_queue& operator=( bounded_concurrent_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      bounded_concurrent_queue& operator=( const bounded_concurrent_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this queue is empty
+      ///
+      /// \note this function is not thread safe, since the value returned
+      ///       can easily be different between the time it's retrieved vs
+      ///       the time it's read
+      /// \return \c true if this queue is empty
+      bool empty() const noexcept;
+
+      /// \brief Returns the size of this queue
+      ///
+      /// \note this function is not thread safe, since the value returned
+      ///       can easily be different between the time it's retrieved vs
+      ///       the time it's read
+      /// \return the size of this queue
+      size_type size() const noexcept;
+
+      /// \brief Returns the maximum number of entries in this queue
+      ///
+      /// \return the capacity of this queue
+      size_type capacity() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator from this queue
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Element Access
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Pops the front element in the queue, blocking until one is
+      ///        available
+      ///
+      /// The result is stored in the entry pointed to by \p value
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      void pop( T* value );
+
+      /// \brief Attempts to pop the front element in the queue, returning
+      ///        immediately on failure
+      ///
+      /// The result is stored in the entry pointed to by \p value
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if a value was acquired
+      bool try_pop( T* value );
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Pushes an entry into the queue, blocking while the queue is
+      ///        full
+      ///
+      /// \param value the value to push
+      void push_back( const T& value );
+
+      /// \copydoc bounded_concurrent_queue::push_back
+      void push_back( T&& value );
+
+      /// \brief Emplaces an entry in the queue, blocking while the queue is
+      ///        full
+      ///
+      /// \note If constructing the entry may throw, the entry is constructed
+      ///       before waiting for room, and then moved into the queue
+      ///
+      /// \param args the arguments to construct the entry
+      template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+      void emplace_back( Args&&...args );
+
+      //----------------------------------------------------------------------
+
+      /// \brief Attempts to push an entry into the queue, returning
+      ///        immediately if the queue is full
+      ///
+      /// \param value the value to push back
+      /// \return \c true if the value was inserted
+      bool try_push_back( const T& value );
+
+      /// \copydoc bounded_concurrent_queue::try_push_back
+      bool try_push_back( T&& value );
+
+      /// \brief Attempts to emplace an entry into the queue, returning
+      ///        immediately if the queue is full
+      ///
+      /// \note If constructing the entry may throw, the entry is constructed
+      ///       before checking for room, and is discarded on failure
+      ///
+      /// \param args the arguments to construct the entry
+      /// \return \c true if the value was inserted
+      template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+      bool try_emplace_back( Args&&...args );
+
+      //----------------------------------------------------------------------
+
+      /// \brief Clears this queue of all entries
+      void clear();
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      struct cell
+      {
+        explicit cell( size_type sequence ) noexcept;
+
+        std::atomic<size_type> sequence; ///< The position this cell is ready for
+        std::aligned_storage_t<sizeof(T),alignof(T)> storage;
+      };
+
+      using alloc_traits   = std::allocator_traits<Allocator>;
+      using cell_allocator = typename alloc_traits::template rebind_alloc<cell>;
+      using cell_traits    = std::allocator_traits<cell_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Static Members
+      //----------------------------------------------------------------------
+    private:
+
+      /// The number of failed attempts a blocking operation makes before
+      /// it parks
+      static constexpr std::size_t spin_count = 64u;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      cell_allocator m_allocator;
+      cell*          m_cells;
+      size_type      m_mask;      ///< The capacity, minus one
+
+      char m_padding0[cache_line_size()];
+
+      std::atomic<size_type> m_tail; ///< The next position to push to
+
+      char m_padding1[cache_line_size()];
+
+      std::atomic<size_type> m_head; ///< The next position to pop from
+
+      char m_padding2[cache_line_size()];
+
+      std::atomic<std::uint32_t> m_push_epoch;   ///< Bumped when a cell is freed
+      std::atomic<std::uint32_t> m_pop_epoch;    ///< Bumped when a cell is filled
+      std::atomic<size_type>     m_push_waiters; ///< Producers parked while full
+      std::atomic<size_type>     m_pop_waiters;  ///< Consumers parked while empty
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Claims the cell at the tail of the queue for a push
+      ///
+      /// \param position set to the claimed position
+      /// \return the cell, or \c nullptr if the queue is full
+      cell* claim_push( size_type* position ) noexcept;
+
+      /// \brief Claims the cell at the head of the queue for a pop
+      ///
+      /// \param position set to the claimed position
+      /// \return the cell, or \c nullptr if the queue is empty
+      cell* claim_pop( size_type* position ) noexcept;
+
+      /// \brief Constructs an entry in a claimed cell, and publishes it to
+      ///        consumers
+      template<typename...Args>
+      void commit_push( cell* c, size_type position, Args&&...args ) noexcept;
+
+      /// \brief Moves the entry out of a claimed cell, and returns the cell
+      ///        to producers
+      void commit_pop( cell* c, size_type position, T* value );
+
+      template<typename...Args>
+      bool try_emplace_back( std::true_type, Args&&...args );
+      template<typename...Args>
+      bool try_emplace_back( std::false_type, Args&&...args );
+
+      template<typename...Args>
+      void emplace_back( std::true_type, Args&&...args );
+      template<typename...Args>
+      void emplace_back( std::false_type, Args&&...args );
+
+      /// \brief Calls \p claim until it returns a cell, spinning and then
+      ///        parking on \p epoch
+      ///
+      /// \param epoch the epoch bumped when a cell may be available
+      /// \param waiters the number of threads parked on \p epoch
+      /// \param claim the function that claims a cell
+      /// \return the claimed cell
+      template<typename Claim>
+      cell* wait_for_cell( std::atomic<std::uint32_t>& epoch,
+                           std::atomic<size_type>& waiters,
+                           Claim&& claim ) noexcept;
+
+      /// \brief Wakes a thread parked on \p epoch, if there is one
+      ///
+      /// \param epoch the epoch to bump
+      /// \param waiters the number of threads parked on \p epoch
+      static void notify( std::atomic<std::uint32_t>& epoch,
+                          std::atomic<size_type>& waiters ) noexcept;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/bounded_concurrent_queue.inl"
+
+#endif /* BIT_PLATFORM_THREADING_BOUNDED_CONCURRENT_QUEUE_HPP */
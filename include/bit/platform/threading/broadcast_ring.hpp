@@ -0,0 +1,442 @@
+/**
+ * \file broadcast_ring.hpp
+ *
+ * \brief This header contains a single-producer ring that broadcasts every
+ *        entry to any number of consumers
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_BROADCAST_RING_HPP
+#define BIT_PLATFORM_THREADING_BROADCAST_RING_HPP
+
+#include "concurrency_arbiter.hpp" // blocking_region
+#include "futex.hpp"               // futex_wait, futex_wake_one, futex_wake_all
+#include "true_share.hpp"          // cache_line_size
+
+#include <bit/stl/containers/span.hpp>  // stl::span
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <atomic>      // std::atomic, std::atomic_thread_fence
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <memory>      // std::allocator, std::allocator_traits
+#include <stdexcept>   // std::out_of_range
+#include <thread>      // std::this_thread::yield
+#include <type_traits> // std::is_default_constructible
+#include <utility>     // std::move
+
+namespace bit {
+  namespace platform {
+
+    /// \brief The way in which a side of a \ref broadcast_ring waits for
+    ///        the other side
+    enum class wait_strategy
+    {
+      busy_spin, ///< Re-checks continuously; lowest latency, burns a core
+      yield,     ///< Yields the processor between checks
+      park,      ///< Yields briefly, then blocks on a futex until notified
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \class bit::platform::broadcast_ring
+    ///
+    /// \brief A bounded ring in which a single producer publishes each entry
+    ///        once, and every consumer sees every entry
+    ///
+    /// This follows the design of the LMAX disruptor. The entries are
+    /// constructed up front in a ring with a power-of-two capacity, and
+    /// publishing assigns over the oldest one, so nothing is allocated
+    /// after construction. Each consumer reads the entries in place and
+    /// tracks its own sequence on its own cache line; the producer never
+    /// overwrites an entry until the slowest consumer has moved past it.
+    ///
+    /// Consumers handle every entry that is ready in a batch, and only
+    /// publish their sequence once per batch, so a consumer that falls
+    /// behind catches up without extra synchronization. Each consumer, and
+    /// the producer, picks its own \ref wait_strategy. The \c park strategy
+    /// only costs the other side a system call when a thread is parked.
+    ///
+    /// The producer functions may only be called from one thread at a time.
+    /// Each consumer may only be used from one thread at a time, but
+    /// consumers may subscribe and unsubscribe while entries are published.
+    ///
+    /// \tparam T the type of the entries, which must be default
+    ///         constructible and copy or move assignable
+    /// \tparam Allocator the allocator used for the ring
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator = std::allocator<T>>
+    class broadcast_ring
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+      static_assert( std::is_default_constructible<T>::value, "T must be default-constructible" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using pointer         = T*;
+      using const_pointer   = const T*;
+
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      class consumer;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a ring that holds at least \p capacity entries,
+      ///        for up to \p max_consumers consumers at once
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      /// \param max_consumers the maximum number of subscribed consumers
+      /// \param wait the way in which the producer waits for room
+      broadcast_ring( size_type capacity,
+                      size_type max_consumers,
+                      wait_strategy wait = wait_strategy::park );
+
+      /// \brief Constructs a ring that holds at least \p capacity entries,
+      ///        for up to \p max_consumers consumers at once, using the
+      ///        specified allocator
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      /// \param max_consumers the maximum number of subscribed consumers
+      /// \param wait the way in which the producer waits for room
+      /// \param alloc the allocator to use
+      broadcast_ring( size_type capacity,
+                      size_type max_consumers,
+                      wait_strategy wait,
+                      const Allocator& alloc );
+
+      // Deleted move constructor
+      broadcast_ring( broadcast_ring&& other ) = delete;
+
+      // Deleted copy constructor
+      broadcast_ring( const broadcast_ring& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys every entry of the ring
+      ///
+      /// \pre every consumer of this ring has been destroyed
+      ~broadcast_ring();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      broadcast_ring& operator=( broadcast_ring&& other ) = delete;
+
+      // Deleted copy assignment
+      broadcast_ring& operator=( const broadcast_ring& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns the number of entries in the ring
+      ///
+      /// \return the capacity of this ring
+      size_type capacity() const noexcept;
+
+      /// \brief Returns the maximum number of consumers that may be
+      ///        subscribed at once
+      ///
+      /// \return the maximum number of consumers
+      size_type max_consumers() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator from this ring
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      /// \brief Queries whether the producer has closed this ring
+      ///
+      /// \return \c true if close was called
+      bool closed() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Consumers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Subscribes a new consumer, which sees every entry published
+      ///        from this point on
+      ///
+      /// \throw std::out_of_range if \ref max_consumers consumers are
+      ///        already subscribed
+      /// \param wait the way in which the consumer waits for entries
+      /// \return the consumer
+      consumer subscribe( wait_strategy wait = wait_strategy::park );
+
+      //----------------------------------------------------------------------
+      // Producer
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Publishes \p value to every consumer, waiting for the
+      ///        slowest consumer to make room if the ring is full
+      ///
+      /// \param value the value to publish
+      void publish( const T& value );
+
+      /// \copydoc broadcast_ring::publish
+      void publish( T&& value );
+
+      /// \brief Attempts to publish \p value to every consumer, returning
+      ///        immediately if the slowest consumer has not made room
+      ///
+      /// \param value the value to publish
+      /// \return \c true if the value was published
+      bool try_publish( const T& value );
+
+      /// \brief Publishes copies of all of \p values to every consumer
+      ///
+      /// The entries are published in batches of as many as there is room
+      /// for, so consumers are notified once per batch rather than once per
+      /// entry
+      ///
+      /// \param values the values to publish
+      void publish_n( stl::span<const T> values );
+
+      /// \brief Closes this ring, waking every parked consumer
+      ///
+      /// Consumers still see every entry that was published before the
+      /// ring was closed. Nothing may be published afterwards.
+      void close() noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      using sequence_type = std::uint64_t;
+
+      /// The sequence of a consumer slot that is not in use
+      static constexpr sequence_type no_sequence = static_cast<sequence_type>(-1);
+
+      struct consumer_slot
+      {
+        consumer_slot() noexcept;
+
+        std::atomic<sequence_type> sequence; ///< The next entry to handle
+        std::atomic<bool>          in_use;
+
+        char padding[cache_line_size()];
+      };
+
+      using alloc_traits    = std::allocator_traits<Allocator>;
+      using entry_allocator = typename alloc_traits::template rebind_alloc<T>;
+      using entry_traits    = std::allocator_traits<entry_allocator>;
+      using slot_allocator  = typename alloc_traits::template rebind_alloc<consumer_slot>;
+      using slot_traits     = std::allocator_traits<slot_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Static Members
+      //----------------------------------------------------------------------
+    private:
+
+      /// The number of times a parking side yields before it parks
+      static constexpr std::size_t spin_count = 64u;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      entry_allocator m_allocator;
+      T*              m_entries;
+      size_type       m_mask;          ///< The capacity, minus one
+      consumer_slot*  m_slots;
+      size_type       m_slot_count;
+      wait_strategy   m_wait;          ///< How the producer waits for room
+
+      char m_padding0[cache_line_size()];
+
+      std::atomic<sequence_type> m_published; ///< The next entry to publish
+      sequence_type m_gate;            ///< The producer's bound on what it may write
+
+      char m_padding1[cache_line_size()];
+
+      std::atomic<std::uint32_t> m_publish_epoch;
+      std::atomic<size_type>     m_publish_waiters; ///< Consumers parked for entries
+      std::atomic<bool>          m_closed;
+
+      char m_padding2[cache_line_size()];
+
+      std::atomic<std::uint32_t> m_consume_epoch;
+      std::atomic<size_type>     m_consume_waiters; ///< Producers parked for room
+
+      char m_padding3[cache_line_size()];
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Gets the entry for \p sequence
+      T& entry( sequence_type sequence ) const noexcept;
+
+      /// \brief Gets the sequence of the slowest consumer, or the next
+      ///        entry to publish if there are no consumers
+      sequence_type slowest_sequence() const noexcept;
+
+      /// \brief Returns whether the entries before \p end may be written,
+      ///        refreshing the producer's gate only if it is behind
+      bool has_room( sequence_type end ) noexcept;
+
+      /// \brief Waits, as the producer's strategy dictates, until the
+      ///        entries before \p end may be written
+      void wait_for_room( sequence_type end ) noexcept;
+
+      /// \brief Waits, as \p wait dictates, until an entry after
+      ///        \p sequence is published or the ring is closed
+      ///
+      /// \return the next entry to publish
+      sequence_type wait_for_entries( sequence_type sequence,
+                                      wait_strategy wait ) noexcept;
+
+      /// \brief Makes the entries before \p end visible to the consumers
+      void publish_until( sequence_type end ) noexcept;
+
+      /// \brief Makes \p sequence the next entry of consumer \p slot, waking
+      ///        the producer if it is parked for room
+      void release( consumer_slot& slot, sequence_type sequence ) noexcept;
+
+      static void notify( std::atomic<std::uint32_t>& epoch,
+                          const std::atomic<size_type>& waiters,
+                          bool all ) noexcept;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A subscription to a \ref broadcast_ring
+    ///
+    /// The consumer reads every entry in place, and holds the producer back
+    /// from overwriting the entries it has not handled; a consumer that is
+    /// no longer polled should be destroyed, which unsubscribes it.
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator>
+    class broadcast_ring<T,Allocator>::consumer
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Move-constructs a consumer from \p other
+      ///
+      /// \param other the other consumer to move
+      consumer( consumer&& other ) noexcept;
+
+      // Deleted copy constructor
+      consumer( const consumer& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Unsubscribes this consumer
+      ~consumer();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      consumer& operator=( consumer&& other ) = delete;
+
+      // Deleted copy assignment
+      consumer& operator=( const consumer& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns the number of entries that are ready for this
+      ///        consumer
+      ///
+      /// \return the number of entries
+      size_type available() const noexcept;
+
+      /// \brief Gets the way in which this consumer waits for entries
+      ///
+      /// \return the wait strategy
+      wait_strategy strategy() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Consuming
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Invokes \p fn with every entry that is ready, returning
+      ///        immediately if there are none
+      ///
+      /// If \p fn throws, the entry it threw for is handled again by the
+      /// next call
+      ///
+      /// \param fn the function to invoke with a \c const \c T&
+      /// \return the number of entries handled
+      template<typename Fn>
+      size_type poll( Fn&& fn );
+
+      /// \brief Waits until at least one entry is ready, then invokes \p fn
+      ///        with every entry that is ready
+      ///
+      /// If \p fn throws, the entry it threw for is handled again by the
+      /// next call
+      ///
+      /// \param fn the function to invoke with a \c const \c T&
+      /// \return the number of entries handled, which is only \c 0 once the
+      ///         ring is closed and every entry has been handled
+      template<typename Fn>
+      size_type wait( Fn&& fn );
+
+      //----------------------------------------------------------------------
+      // Private Constructor
+      //----------------------------------------------------------------------
+    private:
+
+      consumer( broadcast_ring& ring,
+                consumer_slot& slot,
+                sequence_type sequence,
+                wait_strategy wait ) noexcept;
+
+      friend broadcast_ring;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      broadcast_ring* m_ring;
+      consumer_slot*  m_slot;
+      sequence_type   m_sequence;  ///< The next entry to handle
+      sequence_type   m_published; ///< The cached end of the ready entries
+      wait_strategy   m_wait;
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Invokes \p fn with the entries before \p end
+      template<typename Fn>
+      size_type consume( sequence_type end, Fn& fn );
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/broadcast_ring.inl"
+
+#endif /* BIT_PLATFORM_THREADING_BROADCAST_RING_HPP */
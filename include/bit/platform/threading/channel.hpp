@@ -0,0 +1,643 @@
+/**
+ * \file channel.hpp
+ *
+ * \brief This header contains a closeable, optionally bounded, channel for
+ *        passing values between threads, along with a select that waits on
+ *        several channels at once
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_CHANNEL_HPP
+#define BIT_PLATFORM_THREADING_CHANNEL_HPP
+
+#include "futex.hpp"     // futex_wait, futex_wake_one
+#include "spin_lock.hpp" // spin_lock
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
+#include <deque>       // std::deque
+#include <limits>      // std::numeric_limits
+#include <memory>      // std::allocator, std::addressof
+#include <mutex>       // std::unique_lock
+#include <new>         // placement new
+#include <type_traits> // std::decay_t, std::aligned_storage_t
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+
+    /// \brief The result of a non-blocking operation on a channel
+    enum class channel_status
+    {
+      ok,     ///< The value was sent or received
+      empty,  ///< There was no value to receive
+      full,   ///< There was no room to send the value
+      closed, ///< The channel is closed (and drained, when receiving)
+    };
+
+    /// The result of a select when every channel is closed and drained
+    constexpr std::size_t select_closed = static_cast<std::size_t>(-1);
+
+    /// The result of a try_select when no channel has a value ready
+    constexpr std::size_t select_empty  = static_cast<std::size_t>(-2);
+
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A thread blocked on one or more channels
+      ///
+      /// Each blocked thread parks on the futex word of its own waiter, which
+      /// lives on its stack. A channel wakes exactly the waiter it notifies,
+      /// rather than every thread blocked on the channel.
+      /////////////////////////////////////////////////////////////////////////
+      class channel_waiter
+      {
+        //---------------------------------------------------------------------
+        // Public Static Members
+        //---------------------------------------------------------------------
+      public:
+
+        /// The index returned by notifier() when this was never notified
+        static constexpr std::uint32_t no_notifier = static_cast<std::uint32_t>(-1);
+
+        //---------------------------------------------------------------------
+        // Constructors / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        channel_waiter() noexcept;
+
+        // Deleted move constructor
+        channel_waiter( channel_waiter&& other ) = delete;
+
+        // Deleted copy constructor
+        channel_waiter( const channel_waiter& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        channel_waiter& operator=( channel_waiter&& other ) = delete;
+
+        // Deleted copy assignment
+        channel_waiter& operator=( const channel_waiter& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Gets the index of the wait that notified this waiter
+        ///
+        /// \return the index, or \c no_notifier
+        std::uint32_t notifier() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Blocks the calling thread until this waiter is notified
+        void wait() const noexcept;
+
+        /// \brief Marks this waiter as notified by the wait \p index
+        ///
+        /// Only the first notification of a waiter succeeds; the thread must
+        /// then be woken with wake() once the channel has been unlocked
+        ///
+        /// \param index the index of the wait being notified
+        /// \return \c true if this was the first notification
+        bool notify( std::uint32_t index ) noexcept;
+
+        /// \brief Wakes the thread blocked on this waiter
+        ///
+        /// This only hashes the address of the waiter, so the waiter may
+        /// already have been destroyed
+        void wake() noexcept;
+
+        /// \brief Resets this waiter so that it may be notified again
+        void reset() noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        std::atomic<std::uint32_t> m_state; ///< 0, or 1 + the notifier index
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The entry of a waiter in the wait list of one channel
+      /////////////////////////////////////////////////////////////////////////
+      struct channel_wait_node
+      {
+        channel_waiter*    waiter;
+        std::uint32_t      index;  ///< The index passed to notify
+        channel_wait_node* prev;
+        channel_wait_node* next;
+        bool               linked;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief An intrusive, first-in first-out list of waiters
+      ///
+      /// \note The list is guarded by the lock of its channel
+      /////////////////////////////////////////////////////////////////////////
+      class channel_wait_list
+      {
+        //---------------------------------------------------------------------
+        // Constructor
+        //---------------------------------------------------------------------
+      public:
+
+        channel_wait_list() noexcept;
+
+        //---------------------------------------------------------------------
+        // Capacity
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Returns whether any waiter is linked into this list
+        ///
+        /// \return \c true if no waiter is linked
+        bool empty() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Links \p node to the back of this list
+        ///
+        /// \param node the node to link
+        void push_back( channel_wait_node* node ) noexcept;
+
+        /// \brief Unlinks \p node from this list, if it is still linked
+        ///
+        /// \param node the node to unlink
+        void remove( channel_wait_node* node ) noexcept;
+
+        /// \brief Unlinks waiters from the front of this list until one of
+        ///        them accepts the notification
+        ///
+        /// Waiters that were already notified by another channel are skipped
+        ///
+        /// \return the waiter to wake once the channel is unlocked, or
+        ///         \c nullptr if there was none
+        channel_waiter* notify_one() noexcept;
+
+        /// \brief Notifies, and wakes, up to \p count waiters
+        ///
+        /// \param count the number of waiters to notify
+        void notify( std::size_t count ) noexcept;
+
+        /// \brief Notifies, and wakes, every waiter in this list
+        void notify_all() noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        channel_wait_node* m_head;
+        channel_wait_node* m_tail;
+      };
+
+      class channel_base;
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A type-erased receive operation of a select
+      /////////////////////////////////////////////////////////////////////////
+      struct select_case
+      {
+        /// Attempts to receive a value into the case without blocking
+        using receive_function = channel_status(*)( select_case& );
+
+        /// Invokes the handler of the case with the received value
+        using deliver_function = void(*)( select_case& );
+
+        channel_base*    source;  ///< The channel received from
+        receive_function receive;
+        deliver_function deliver;
+      };
+
+      /// \brief Receives from the first of \p count cases to have a value,
+      ///        starting from a random case
+      ///
+      /// \param cases the cases to select between
+      /// \param nodes storage for one wait node per case
+      /// \param count the number of cases
+      /// \param block whether to block until a case is ready
+      /// \return the index of the case that received a value, otherwise
+      ///         \c select_closed or \c select_empty
+      std::size_t select( select_case* const* cases,
+                          channel_wait_node* nodes,
+                          std::size_t count,
+                          bool block );
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The type-independent locking, closing and waiting of a
+      ///        channel
+      /////////////////////////////////////////////////////////////////////////
+      class channel_base
+      {
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      protected:
+
+        channel_base() noexcept;
+
+        // Deleted move constructor
+        channel_base( channel_base&& other ) = delete;
+
+        // Deleted copy constructor
+        channel_base( const channel_base& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Destructs this channel_base
+        ///
+        /// \pre no thread is blocked on the channel
+        ~channel_base();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        channel_base& operator=( channel_base&& other ) = delete;
+
+        // Deleted copy assignment
+        channel_base& operator=( const channel_base& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Queries whether this channel has been closed
+        ///
+        /// \return \c true if the channel is closed
+        bool closed() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Closes this channel, waking every blocked sender and
+        ///        receiver
+        ///
+        /// Values already in the channel may still be received; any further
+        /// send fails. Closing a closed channel has no effect.
+        void close() noexcept;
+
+        //---------------------------------------------------------------------
+        // Protected Members
+        //---------------------------------------------------------------------
+      protected:
+
+        mutable spin_lock m_lock;
+        channel_wait_list m_receivers;
+        channel_wait_list m_senders;
+        bool              m_closed;
+
+        //---------------------------------------------------------------------
+        // Protected Modifiers
+        //---------------------------------------------------------------------
+      protected:
+
+        /// \brief Blocks the calling thread in \p list until it is notified,
+        ///        releasing \p lock while it is blocked
+        ///
+        /// \param list the list to wait in
+        /// \param lock the held lock of this channel
+        void park( channel_wait_list& list, std::unique_lock<spin_lock>& lock ) noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Modifiers
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Links \p node into the receivers of this channel
+        void add_receiver( channel_wait_node* node ) noexcept;
+
+        /// \brief Unlinks \p node from the receivers of this channel
+        void remove_receiver( channel_wait_node* node ) noexcept;
+
+        /// \brief Passes a notification on to the next receiver
+        void notify_receiver() noexcept;
+
+        friend std::size_t select( select_case* const*,
+                                   channel_wait_node*,
+                                   std::size_t,
+                                   bool );
+      };
+
+      template<typename T, typename Allocator, typename Fn>
+      class select_case_impl;
+
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A channel of values of type \p T, which may be bounded and may
+    ///        be closed
+    ///
+    /// Senders block while a bounded channel is full, and receivers block
+    /// while the channel is empty. Blocked threads are parked on a futex of
+    /// their own and woken one at a time, so that a value wakes exactly one
+    /// receiver, and no thread polls.
+    ///
+    /// Closing a channel fails every further send, and wakes all blocked
+    /// threads. Values sent before the close are still received; once they
+    /// are drained, receives fail too. This lets a producer signal the end
+    /// of its stream without a sentinel value.
+    ///
+    /// A receiver may wait on several channels at once with \ref select.
+    ///
+    /// \tparam T the type of value passed through the channel
+    /// \tparam Allocator the allocator used for the buffered values
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator = std::allocator<T>>
+    class channel : public detail::channel_base
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      using value_type     = T;
+      using allocator_type = Allocator;
+      using size_type      = std::size_t;
+
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      /// The capacity of a channel that never blocks its senders
+      static constexpr size_type unbounded = std::numeric_limits<size_type>::max();
+
+      //-----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a channel that buffers up to \p capacity values
+      ///
+      /// \param capacity the maximum number of buffered values
+      /// \param alloc the allocator to use
+      explicit channel( size_type capacity = unbounded,
+                        const Allocator& alloc = Allocator() );
+
+      // Deleted move constructor
+      channel( channel&& other ) = delete;
+
+      // Deleted copy constructor
+      channel( const channel& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      channel& operator=( channel&& other ) = delete;
+
+      // Deleted copy assignment
+      channel& operator=( const channel& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Capacity
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this channel has no buffered values
+      ///
+      /// \note The result may be stale by the time it is read
+      /// \return \c true if the channel is empty
+      bool empty() const noexcept;
+
+      /// \brief Returns the number of buffered values
+      ///
+      /// \note The result may be stale by the time it is read
+      /// \return the number of values
+      size_type size() const noexcept;
+
+      /// \brief Returns the maximum number of buffered values
+      ///
+      /// \return the capacity, or \c unbounded
+      size_type capacity() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator of this channel
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //-----------------------------------------------------------------------
+      // Sending
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \{
+      /// \brief Sends \p value, blocking while the channel is full
+      ///
+      /// \param value the value to send
+      /// \return \c false if the channel was closed
+      bool send( const T& value );
+      bool send( T&& value );
+      /// \}
+
+      /// \brief Sends a value constructed from \p args, blocking while the
+      ///        channel is full
+      ///
+      /// \param args the arguments to forward to the value's constructor
+      /// \return \c false if the channel was closed
+      template<typename...Args>
+      bool emplace( Args&&...args );
+
+      /// \{
+      /// \brief Attempts to send \p value without blocking
+      ///
+      /// \p value is left untouched unless it was sent
+      ///
+      /// \param value the value to send
+      /// \return \c channel_status::ok, \c channel_status::full, or
+      ///         \c channel_status::closed
+      channel_status try_send( const T& value );
+      channel_status try_send( T&& value );
+      /// \}
+
+      //-----------------------------------------------------------------------
+      // Receiving
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Receives the next value into \p value, blocking while the
+      ///        channel is empty
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c false if the channel was closed and drained
+      bool recv( T* value );
+
+      /// \brief Attempts to receive the next value into \p value without
+      ///        blocking
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c channel_status::ok, \c channel_status::empty, or
+      ///         \c channel_status::closed
+      channel_status try_recv( T* value );
+
+      /// \brief Receives up to \p max values into \p out, blocking only
+      ///        while the channel is empty
+      ///
+      /// All values are taken under a single acquisition of the lock
+      ///
+      /// \param out the output iterator to write the values to
+      /// \param max the maximum number of values to receive
+      /// \return the number of values received; \c 0 only if the channel
+      ///         was closed and drained
+      template<typename OutputIt>
+      size_type recv_batch( OutputIt out, size_type max );
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      std::deque<T,Allocator> m_queue;
+      size_type               m_capacity;
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Pushes a value constructed from \p args, if there is room
+      ///
+      /// \param lock the held lock of this channel
+      /// \param args the arguments to forward to the value's constructor
+      template<typename...Args>
+      channel_status try_push( std::unique_lock<spin_lock>& lock, Args&&...args );
+
+      /// \brief Pops the front value into \p value, if there is one
+      ///
+      /// \param lock the held lock of this channel
+      /// \param value the entry to move-assign the value to
+      /// \param construct whether \p value is uninitialized storage
+      channel_status try_pop( std::unique_lock<spin_lock>& lock, T* value, bool construct );
+
+      template<typename,typename,typename> friend class detail::select_case_impl;
+    };
+
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A receive from a channel<T>, whose value is handed to \p Fn
+      /////////////////////////////////////////////////////////////////////////
+      template<typename T, typename Allocator, typename Fn>
+      class select_case_impl : public select_case
+      {
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        template<typename Fn2>
+        select_case_impl( channel<T,Allocator>& channel, Fn2&& fn );
+
+        select_case_impl( select_case_impl&& other );
+
+        // Deleted copy constructor
+        select_case_impl( const select_case_impl& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        ~select_case_impl();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        select_case_impl& operator=( select_case_impl&& other ) = delete;
+
+        // Deleted copy assignment
+        select_case_impl& operator=( const select_case_impl& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        using storage_type = std::aligned_storage_t<sizeof(T),alignof(T)>;
+
+        channel<T,Allocator>* m_channel;
+        Fn                    m_function;
+        storage_type          m_storage;
+        bool                  m_has_value;
+
+        //---------------------------------------------------------------------
+        // Private Static Functions
+        //---------------------------------------------------------------------
+      private:
+
+        static channel_status receive( select_case& self );
+
+        static void deliver( select_case& self );
+      };
+
+    } // namespace detail
+
+    //-------------------------------------------------------------------------
+    // Select
+    //-------------------------------------------------------------------------
+
+    /// \brief Creates a case for \ref select that receives from \p channel,
+    ///        and invokes \p fn with the received value
+    ///
+    /// \param channel the channel to receive from
+    /// \param fn the function to invoke with the value
+    /// \return the case
+    template<typename T, typename Allocator, typename Fn>
+    detail::select_case_impl<T,Allocator,std::decay_t<Fn>>
+      on_recv( channel<T,Allocator>& channel, Fn&& fn );
+
+    /// \brief Blocks until one of \p cases receives a value, and invokes the
+    ///        handler of that case
+    ///
+    /// When several channels have values ready, one is chosen at random so
+    /// that no channel is starved. Closed channels are skipped, until every
+    /// channel is closed and drained.
+    ///
+    /// \code
+    /// auto index = select( on_recv( requests, [&](request r){ ... } ),
+    ///                      on_recv( control,  [&](command c){ ... } ) );
+    /// \endcode
+    ///
+    /// \param cases the cases created with on_recv
+    /// \return the index of the case that received, or \c select_closed
+    template<typename...Cases>
+    std::size_t select( Cases&&...cases );
+
+    /// \brief Invokes the handler of one of \p cases that has a value ready,
+    ///        without blocking
+    ///
+    /// \param cases the cases created with on_recv
+    /// \return the index of the case that received, \c select_empty, or
+    ///         \c select_closed
+    template<typename...Cases>
+    std::size_t try_select( Cases&&...cases );
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/channel.inl"
+
+#endif /* BIT_PLATFORM_THREADING_CHANNEL_HPP */
@@ -0,0 +1,125 @@
+/**
+ * \file completion_flag.hpp
+ *
+ * \brief This header contains a lightweight one-shot synchronization
+ *        primitive for waiting on the completion of a single operation
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_COMPLETION_FLAG_HPP
+#define BIT_PLATFORM_THREADING_COMPLETION_FLAG_HPP
+
+#include "concurrency_arbiter.hpp" // blocking_region
+#include "futex.hpp"               // futex_wait, futex_wake_all
+
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::duration, std::chrono::time_point
+#include <cstdint> // std::uint32_t
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A one-shot flag that threads may block on until it is
+    ///        signaled
+    ///
+    /// Unlike \ref waitable_event, this is never reset, and consists of a
+    /// single futex word: signaling it costs one atomic exchange, and only
+    /// issues a wake if a thread is actually blocked on it.
+    ///
+    /// Signaling never reads from the flag after the exchange, so a waiter
+    /// may destroy the flag as soon as it observes the signal; this allows
+    /// the flag to live on the waiting thread's stack.
+    //////////////////////////////////////////////////////////////////////////
+    class completion_flag
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs a completion_flag that is not yet
+      ///        signaled
+      completion_flag() noexcept;
+
+      // Deleted move constructor
+      completion_flag( completion_flag&& other ) = delete;
+
+      // Deleted copy constructor
+      completion_flag( const completion_flag& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      completion_flag& operator=( completion_flag&& other ) = delete;
+
+      // Deleted copy assignment
+      completion_flag& operator=( const completion_flag& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Queries whether this flag has been signaled
+      ///
+      /// \return \c true if this flag has been signaled
+      bool signaled() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Waiting
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Blocks the current thread until this flag is signaled
+      void wait() const noexcept;
+
+      /// \brief Blocks the current thread until this flag is signaled, or
+      ///        until the specified duration has been waited for
+      ///
+      /// \param duration the amount of time to wait for
+      /// \return \c true if the flag was signaled
+      template<typename Rep, typename Period>
+      bool wait_for( const std::chrono::duration<Rep,Period>& duration ) const;
+
+      /// \brief Blocks the current thread until this flag is signaled, or
+      ///        until the specified \p time_point has been reached
+      ///
+      /// \param time_point the time to wait until
+      /// \return \c true if the flag was signaled
+      template<typename Clock, typename Duration>
+      bool wait_until( const std::chrono::time_point<Clock,Duration>& time_point ) const;
+
+      //----------------------------------------------------------------------
+      // Signaling
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Signals this flag, waking all threads blocked on it
+      ///
+      /// This must be called at most once
+      void signal() noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      static constexpr std::uint32_t state_unsignaled = 0u;
+      static constexpr std::uint32_t state_waiting    = 1u;
+      static constexpr std::uint32_t state_signaled   = 2u;
+
+      mutable std::atomic<std::uint32_t> m_state;
+
+      /// \brief Announces that a thread is about to block on this flag
+      ///
+      /// \return \c false if the flag was signaled in the meantime
+      bool prepare_wait() const noexcept;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/completion_flag.inl"
+
+#endif /* BIT_PLATFORM_THREADING_COMPLETION_FLAG_HPP */
@@ -0,0 +1,231 @@
+/**
+ * \file concurrency_arbiter.hpp
+ *
+ * \brief This header contains a process-wide arbiter that bounds the number
+ *        of actively running worker threads across all executors
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_CONCURRENCY_ARBITER_HPP
+#define BIT_PLATFORM_THREADING_CONCURRENCY_ARBITER_HPP
+
+#include "spin_lock.hpp" // spin_lock
+
+#include <atomic>  // std::atomic
+#include <cstddef> // std::size_t
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+      struct arbiter_waiter;
+    } // namespace detail
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief An arbiter that leases active-worker slots out of a fixed
+    ///        budget
+    ///
+    /// Every executor in this library registers its workers with the
+    /// \c global arbiter, and each worker holds a lease while it is running
+    /// tasks. Workers give up their lease before parking, so idle executors
+    /// yield their slots to busy ones, and the number of active workers in
+    /// the process never exceeds the budget; the remaining workers wait for
+    /// a lease instead of competing for the cores.
+    ///
+    /// Leases are granted in the order they were requested in, so that an
+    /// executor with many workers cannot starve the others.
+    ///
+    /// A thread holds at most one lease at a time. Blocking waits in this
+    /// library release the lease of the calling thread for the duration of
+    /// the wait, since a thread that blocks while holding a lease would
+    /// otherwise starve the workers it is waiting on.
+    //////////////////////////////////////////////////////////////////////////
+    class concurrency_arbiter
+    {
+      //----------------------------------------------------------------------
+      // Public Static Functions
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the process-wide arbiter that the executors in this
+      ///        library lease from
+      ///
+      /// \return reference to the global arbiter
+      static concurrency_arbiter& global() noexcept;
+
+      /// \brief Gets the budget that the global arbiter starts with, which
+      ///        is the number of cores available to the process
+      ///
+      /// \return the default budget
+      static std::size_t default_budget() noexcept;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs an arbiter that leases at most \p budget slots
+      ///        at a time
+      ///
+      /// \param budget the number of slots
+      explicit concurrency_arbiter( std::size_t budget ) noexcept;
+
+      // Deleted move constructor
+      concurrency_arbiter( concurrency_arbiter&& other ) = delete;
+
+      // Deleted copy constructor
+      concurrency_arbiter( const concurrency_arbiter& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      concurrency_arbiter& operator=( concurrency_arbiter&& other ) = delete;
+
+      // Deleted copy assignment
+      concurrency_arbiter& operator=( const concurrency_arbiter& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the maximum number of leases held at a time
+      ///
+      /// \return the budget
+      std::size_t budget() const noexcept;
+
+      /// \brief Gets the number of leases currently held
+      ///
+      /// \return the number of active workers
+      std::size_t active() const noexcept;
+
+      /// \brief Gets the number of threads waiting for a lease
+      ///
+      /// \return the number of waiting workers
+      std::size_t waiting() const noexcept;
+
+      /// \brief Gets the number of workers registered with this arbiter
+      ///
+      /// \return the number of registered workers
+      std::size_t registered() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Sets the maximum number of leases held at a time
+      ///
+      /// Lowering the budget does not revoke leases that are already held;
+      /// workers only stop running once they give their leases up.
+      ///
+      /// \param budget the new budget
+      void set_budget( std::size_t budget ) noexcept;
+
+      /// \brief Registers \p workers workers of an executor
+      ///
+      /// \param workers the number of workers
+      void attach( std::size_t workers ) noexcept;
+
+      /// \brief Unregisters \p workers workers of an executor
+      ///
+      /// \param workers the number of workers
+      void detach( std::size_t workers ) noexcept;
+
+      //----------------------------------------------------------------------
+      // Leasing
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Blocks the calling thread until it is granted a lease
+      ///
+      /// \pre the calling thread does not hold a lease
+      void acquire() noexcept;
+
+      /// \brief Attempts to acquire a lease without blocking
+      ///
+      /// \pre the calling thread does not hold a lease
+      ///
+      /// \return \c true if a lease was acquired
+      bool try_acquire() noexcept;
+
+      /// \brief Gives up the lease held by the calling thread, handing it
+      ///        to the longest waiting thread if there is one
+      ///
+      /// \pre the calling thread holds a lease from this arbiter
+      void release() noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      mutable spin_lock        m_lock;
+      std::size_t              m_budget;
+      std::size_t              m_active;
+      detail::arbiter_waiter*  m_head;       ///< The longest waiting thread
+      detail::arbiter_waiter*  m_tail;
+      std::atomic<std::size_t> m_waiting;    ///< The number of waiting threads
+      std::atomic<std::size_t> m_registered; ///< The number of registered workers
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A scope in which the calling thread gives up its lease, if it
+    ///        holds one
+    ///
+    /// This is used around blocking waits, so that a thread that is blocked
+    /// does not occupy a slot that the thread it waits on may need. The
+    /// lease is reacquired when the scope ends, which may block.
+    //////////////////////////////////////////////////////////////////////////
+    class blocking_region
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Releases the lease held by the calling thread
+      blocking_region() noexcept;
+
+      // Deleted move constructor
+      blocking_region( blocking_region&& other ) = delete;
+
+      // Deleted copy constructor
+      blocking_region( const blocking_region& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Reacquires the lease released on construction
+      ~blocking_region();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      blocking_region& operator=( blocking_region&& other ) = delete;
+
+      // Deleted copy assignment
+      blocking_region& operator=( const blocking_region& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      concurrency_arbiter* m_arbiter; ///< The arbiter to reacquire from
+    };
+
+    //------------------------------------------------------------------------
+    // Free Functions
+    //------------------------------------------------------------------------
+
+    /// \brief Hands the lease of the calling thread to a waiting thread, and
+    ///        waits to be granted a lease again
+    ///
+    /// This is a no-op if the calling thread does not hold a lease, or if no
+    /// thread is waiting for one. Threads that spin while helping with work
+    /// call this so that the work they wait on is not starved of a slot.
+    void yield_lease() noexcept;
+
+  } // namespace platform
+} // namespace bit
+
+#endif /* BIT_PLATFORM_THREADING_CONCURRENCY_ARBITER_HPP */
@@ -0,0 +1,388 @@
+/**
+ * \file concurrent_hash_map.hpp
+ *
+ * \brief This header contains a concurrent open-addressing hash map with
+ *        lock-free lookups
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_CONCURRENT_HASH_MAP_HPP
+#define BIT_PLATFORM_THREADING_CONCURRENT_HASH_MAP_HPP
+
+#include "spin_lock.hpp"           // spin_lock
+#include "true_share.hpp"          // cache_line_size
+#include "detail/epoch_domain.hpp" // detail::epoch_domain
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <algorithm>  // std::min
+#include <atomic>     // std::atomic
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint64_t, std::uintptr_t
+#include <functional> // std::hash, std::equal_to
+#include <memory>     // std::allocator, std::allocator_traits
+#include <mutex>      // std::lock_guard
+#include <utility>    // std::pair, std::forward, std::move
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A thread-safe hash map for caches that are shared between
+    ///        threads, in which lookups never block
+    ///
+    /// The map is an open-addressing table of pointers to immutable
+    /// entries. Lookups only load those pointers and take no lock; the only
+    /// shared memory they write is a striped counter that keeps the entries
+    /// they read alive. Writers serialize per key on one of a set of striped
+    /// locks; an assignment publishes a new entry in place of the old one,
+    /// rather than modifying it, so readers never see a partial write.
+    ///
+    /// When the table fills, a larger one is linked behind it, and every
+    /// operation moves a small chunk of entries across before its own, so a
+    /// resize never stops the world, and finishes even if the map is only
+    /// read. Lookups search both tables until the move is complete.
+    ///
+    /// Replaced entries, erased entries, and old tables are reclaimed once
+    /// no lookup can still be reading them, through an epoch domain that is
+    /// local to the map.
+    ///
+    /// \tparam Key the type of the keys
+    /// \tparam T the type of the mapped values
+    /// \tparam Hash the hash function of the keys
+    /// \tparam KeyEqual the equality of the keys
+    /// \tparam Allocator the underlying allocator used for the entries and
+    ///         tables
+    //////////////////////////////////////////////////////////////////////////
+    template<typename Key,
+             typename T,
+             typename Hash = std::hash<Key>,
+             typename KeyEqual = std::equal_to<Key>,
+             typename Allocator = std::allocator<std::pair<const Key,T>>>
+    class concurrent_hash_map
+    {
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using key_type       = Key;
+      using mapped_type    = T;
+      using value_type     = std::pair<const Key,T>;
+      using hasher         = Hash;
+      using key_equal      = KeyEqual;
+      using allocator_type = Allocator;
+      using size_type      = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs an empty concurrent_hash_map
+      concurrent_hash_map();
+
+      /// \brief Constructs an empty concurrent_hash_map with room for
+      ///        \p capacity entries before it first resizes
+      ///
+      /// \param capacity the number of entries to make room for
+      /// \param hash the hash function to use
+      /// \param equal the key equality to use
+      /// \param alloc the allocator to use
+      explicit concurrent_hash_map( size_type capacity,
+                                    const Hash& hash = Hash(),
+                                    const KeyEqual& equal = KeyEqual(),
+                                    const Allocator& alloc = Allocator() );
+
+      // Deleted move constructor
+      concurrent_hash_map( concurrent_hash_map&& other ) = delete;
+
+      // Deleted copy constructor
+      concurrent_hash_map( const concurrent_hash_map& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys every entry, and frees every table
+      ~concurrent_hash_map();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      concurrent_hash_map& operator=( concurrent_hash_map&& other ) = delete;
+
+      // Deleted copy assignment
+      concurrent_hash_map& operator=( const concurrent_hash_map& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this map is empty
+      ///
+      /// \note The result may already be stale when it is read
+      /// \return \c true if this map is empty
+      bool empty() const noexcept;
+
+      /// \brief Returns the number of entries in this map
+      ///
+      /// \note The result may already be stale when it is read
+      /// \return the number of entries
+      size_type size() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the hash function of this map
+      ///
+      /// \return the hash function
+      Hash hash_function() const;
+
+      /// \brief Gets the key equality of this map
+      ///
+      /// \return the key equality
+      KeyEqual key_eq() const;
+
+      /// \brief Gets the underlying allocator
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Lookup
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Copies the value mapped to \p key, if there is one
+      ///
+      /// This does not block, other than to help a resize that is in
+      /// progress
+      ///
+      /// \param key the key to look up
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if \p key was found
+      bool find( const Key& key, T* value ) const;
+
+      /// \brief Returns whether \p key is in this map
+      ///
+      /// This does not block, other than to help a resize that is in
+      /// progress
+      ///
+      /// \param key the key to look up
+      /// \return \c true if \p key was found
+      bool contains( const Key& key ) const;
+
+      /// \brief Invokes \p fn with the entry for \p key, if there is one,
+      ///        without copying it
+      ///
+      /// The entry stays valid for the duration of the call, even if it is
+      /// concurrently replaced or erased. This does not block, other than to
+      /// help a resize that is in progress.
+      ///
+      /// \param key the key to look up
+      /// \param fn the function to invoke with a \c const \c value_type&
+      /// \return \c true if \p key was found
+      template<typename Fn>
+      bool visit( const Key& key, Fn&& fn ) const;
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Maps \p key to \p value, replacing any value that \p key
+      ///        was mapped to
+      ///
+      /// \param key the key to map
+      /// \param value the value to map it to
+      /// \return \c true if \p key was inserted, \c false if it was assigned
+      template<typename M>
+      bool insert_or_assign( const Key& key, M&& value );
+
+      /// \copydoc concurrent_hash_map::insert_or_assign
+      template<typename M>
+      bool insert_or_assign( Key&& key, M&& value );
+
+      /// \brief Erases the entry for \p key, if there is one
+      ///
+      /// \param key the key to erase
+      /// \return \c true if an entry was erased
+      bool erase( const Key& key );
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      struct node
+      {
+        template<typename K, typename M>
+        node( size_type hash, K&& key, M&& value );
+
+        size_type  hash;  ///< The mixed hash of the key
+        value_type value;
+      };
+
+      struct table
+      {
+        explicit table( size_type capacity ) noexcept;
+
+        size_type              capacity; ///< Always a power of two
+        std::atomic<node*>*    slots;
+        std::atomic<size_type> used;     ///< Slots that have held an entry
+        std::atomic<table*>    next;     ///< The table being resized into
+        std::atomic<size_type> cursor;   ///< The next slot to move
+        std::atomic<size_type> moved;    ///< The number of slots moved
+        std::atomic<size_type> departed; ///< Entries moved to the next table
+      };
+
+      struct stripe
+      {
+        spin_lock lock;
+
+        char padding[cache_line_size()];
+      };
+
+      using alloc_traits    = std::allocator_traits<Allocator>;
+      using node_allocator  = typename alloc_traits::template rebind_alloc<node>;
+      using node_traits     = std::allocator_traits<node_allocator>;
+      using table_allocator = typename alloc_traits::template rebind_alloc<table>;
+      using table_traits    = std::allocator_traits<table_allocator>;
+      using slot_allocator  = typename alloc_traits::template rebind_alloc<std::atomic<node*>>;
+      using slot_traits     = std::allocator_traits<slot_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Static Members
+      //----------------------------------------------------------------------
+    private:
+
+      /// The number of writer locks that keys are spread over
+      static constexpr size_type stripe_count = 64u;
+
+      /// The smallest capacity of a table
+      static constexpr size_type min_capacity = 16u;
+
+      /// The number of slots that a writer moves during a resize
+      static constexpr size_type migrate_chunk = 32u;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      node_allocator m_allocator;
+      Hash           m_hash;
+      KeyEqual       m_equal;
+
+      char m_padding0[cache_line_size()];
+
+      /// The oldest table that is in use; lookups may help to retire it
+      mutable std::atomic<table*> m_table;
+      std::atomic<size_type>      m_size;
+
+      char m_padding1[cache_line_size()];
+
+      mutable stripe m_stripes[stripe_count];
+
+      mutable detail::epoch_domain m_epochs;
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Scrambles a hash, so that its low bits pick slots and its
+      ///        high bits pick stripes
+      static size_type mix( size_type hash ) noexcept;
+
+      /// \brief The slot value of a slot whose entry was erased
+      static node* tombstone() noexcept;
+
+      /// \brief The slot value of a slot whose entry was moved to the next
+      ///        table
+      static node* moved() noexcept;
+
+      /// \brief The slot value of an empty slot that was closed when its
+      ///        table started resizing, which ends a probe like an empty slot
+      static node* closed() noexcept;
+
+      /// \brief Returns whether slot value \p p is an entry, rather than
+      ///        one of the markers
+      static bool is_entry( const node* p ) noexcept;
+
+      /// \brief Gets the lock that serializes writers of \p hash
+      spin_lock& stripe_for( size_type hash ) const noexcept;
+
+      /// \brief Finds the entry for \p key
+      ///
+      /// \pre an epoch guard is held
+      const node* find_node( const Key& key, size_type hash ) const;
+
+      /// \brief Publishes \p n, replacing any entry with the same key
+      ///
+      /// \return \c true if no entry was replaced
+      bool assign( node* n );
+
+      /// \brief Gets the newest table, having moved the entry for \p key
+      ///        into it from any older table
+      ///
+      /// \pre the stripe of \p hash is locked
+      table* writable_table( const Key& key, size_type hash );
+
+      /// \brief Moves the entry for \p key from \p from to \p to, if it is
+      ///        in \p from
+      ///
+      /// \pre the stripe of \p hash is locked
+      void move_key( table& from, const Key& key, size_type hash, table& to );
+
+      /// \brief Moves a chunk of slots from the oldest table into the next,
+      ///        retiring the oldest table once all of its slots are moved
+      ///
+      /// \pre an epoch guard is held, and no stripe is locked
+      void help_migrate() const;
+
+      /// \brief Moves every slot of the oldest table that is left into the
+      ///        next, and retires the oldest table
+      ///
+      /// This is used once the next table fills up before the chunks of the
+      /// oldest table are all moved, which happens when a thread that
+      /// claimed a chunk stalls
+      ///
+      /// \pre an epoch guard is held, and no stripe is locked
+      void complete_migrate() const;
+
+      /// \brief Makes \p to the oldest table, and retires \p from, once
+      ///        every slot of \p from has been moved
+      void finish_migrate( table& from, table& to ) const;
+
+      /// \brief Moves slot \p index of \p from into \p to
+      void migrate_slot( table& from, size_type index, table& to ) const;
+
+      /// \brief Links a new table behind \p t, if \p t is the newest table
+      ///        and is not already being resized
+      void start_resize( table& t );
+
+      template<typename...Args>
+      node* create_node( Args&&...args );
+
+      void destroy_node( node* n ) noexcept;
+
+      table* create_table( size_type capacity );
+
+      void destroy_table( table* t ) const noexcept;
+
+      static void insert_moved( table& to, node* n ) noexcept;
+
+      static void reclaim_node( void* map, void* p ) noexcept;
+
+      static void reclaim_table( void* map, void* p ) noexcept;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/concurrent_hash_map.inl"
+
+#endif /* BIT_PLATFORM_THREADING_CONCURRENT_HASH_MAP_HPP */
@@ -0,0 +1,486 @@
+/**
+ * \file concurrent_priority_queue.hpp
+ *
+ * \brief This header contains thread-safe priority queues: a strict,
+ *        flat-combining heap, and a relaxed MultiQueue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_CONCURRENT_PRIORITY_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_CONCURRENT_PRIORITY_QUEUE_HPP
+
+#include "concurrency_arbiter.hpp" // yield_lease
+#include "spin_lock.hpp"           // spin_lock
+#include "thread.hpp"              // available_concurrency
+#include "true_share.hpp"          // cache_line_size
+#include "detail/this_thread.hpp"  // detail::this_thread_random
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <algorithm>   // std::push_heap, std::pop_heap
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
+#include <exception>   // std::exception_ptr
+#include <functional>  // std::less
+#include <memory>      // std::allocator, std::allocator_traits
+#include <mutex>       // std::unique_lock
+#include <thread>      // std::this_thread
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief Orders a binary heap so that its front is the least entry
+      ///        under \p Compare
+      /////////////////////////////////////////////////////////////////////////
+      template<typename Compare>
+      struct min_heap_compare
+      {
+        Compare compare;
+
+        template<typename T>
+        bool operator()( const T& lhs, const T& rhs ) const
+        {
+          return compare( rhs, lhs );
+        }
+      };
+
+    } // namespace detail
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A thread-safe priority queue that pops entries in strict
+    ///        priority order
+    ///
+    /// The heap is only ever touched by one thread at a time, but rather than
+    /// every thread taking turns on a lock, each thread publishes its
+    /// operation in a slot, and whichever thread acquires the lock applies
+    /// every published operation in one pass (flat combining). The heap
+    /// stays hot in the cache of the combining thread, and the lock changes
+    /// hands once per batch rather than once per operation.
+    ///
+    /// This is the queue to use where the order of release must be exact,
+    /// such as replaying events; \ref relaxed_priority_queue scales better
+    /// where an approximate order is enough.
+    ///
+    /// \tparam T the type of the entries
+    /// \tparam Compare the ordering of the entries; the least entry is
+    ///         popped first
+    /// \tparam Allocator the underlying allocator used for the heap
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T,
+             typename Compare = std::less<T>,
+             typename Allocator = std::allocator<T>>
+    class concurrent_priority_queue
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using value_compare   = Compare;
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Constructors / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs a concurrent_priority_queue
+      concurrent_priority_queue();
+
+      /// \brief Constructs a concurrent_priority_queue with the specified
+      ///        ordering and allocator
+      ///
+      /// \param compare the ordering of the entries
+      /// \param alloc the allocator to use
+      explicit concurrent_priority_queue( const Compare& compare,
+                                          const Allocator& alloc = Allocator() );
+
+      // Deleted move constructor
+      concurrent_priority_queue( concurrent_priority_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      concurrent_priority_queue( const concurrent_priority_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      concurrent_priority_queue& operator=( concurrent_priority_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      concurrent_priority_queue& operator=( const concurrent_priority_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this queue is empty
+      ///
+      /// \note The result may already be stale when it is read
+      /// \return \c true if this queue is empty
+      bool empty() const noexcept;
+
+      /// \brief Returns the number of entries in this queue
+      ///
+      /// \note The result may already be stale when it is read
+      /// \return the number of entries
+      size_type size() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Element Access
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Attempts to pop the least entry in the queue, returning
+      ///        immediately if the queue is empty
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if a value was acquired
+      bool try_pop_min( T* value );
+
+      /// \brief Pops up to \p max of the least entries in the queue in a
+      ///        single operation, in priority order
+      ///
+      /// \param out the output iterator to store the results in
+      /// \param max the maximum number of entries to pop
+      /// \return the number of entries popped
+      template<typename OutputIterator>
+      size_type try_pop_n( OutputIterator out, size_type max );
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Pushes an entry into the queue
+      ///
+      /// \param value the value to push
+      void push( const T& value );
+
+      /// \copydoc concurrent_priority_queue::push
+      void push( T&& value );
+
+      /// \brief Clears this queue of all entries
+      void clear();
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      using heap_compare = detail::min_heap_compare<Compare>;
+      using heap_type    = std::vector<T,Allocator>;
+
+      // States of a request slot
+      static constexpr std::uint32_t slot_free    = 0u;
+      static constexpr std::uint32_t slot_claimed = 1u;
+      static constexpr std::uint32_t slot_pending = 2u; ///< Awaiting the combiner
+      static constexpr std::uint32_t slot_done    = 3u;
+
+      /// An operation published for the combining thread to apply
+      struct request
+      {
+        request() noexcept;
+
+        std::atomic<std::uint32_t> state;
+        void (*apply)( void*, concurrent_priority_queue& );
+        void*                      operation;
+        std::exception_ptr         error;
+
+        char padding[cache_line_size()];
+      };
+
+      //----------------------------------------------------------------------
+      // Private Static Members
+      //----------------------------------------------------------------------
+    private:
+
+      /// The number of request slots that threads publish to
+      static constexpr size_type slot_count = 64u;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      heap_type              m_heap;
+      heap_compare           m_compare;
+      std::atomic<size_type> m_size; ///< Mirrors the heap, for the observers
+
+      char m_padding0[cache_line_size()];
+
+      spin_lock m_combiner;
+
+      char m_padding1[cache_line_size()];
+
+      request m_requests[slot_count];
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Has \p operation applied to the heap by a combining thread,
+      ///        which may be this one
+      ///
+      /// \param operation the callable to invoke with this queue
+      template<typename Operation>
+      void execute( Operation& operation );
+
+      /// \brief Applies every pending request
+      ///
+      /// \pre m_combiner is held
+      void combine() noexcept;
+
+      /// \brief Claims a free request slot
+      request& claim_request() noexcept;
+
+      template<typename Operation>
+      static void apply_operation( void* operation, concurrent_priority_queue& queue );
+
+      /// \brief Pops the least entry from the heap
+      ///
+      /// \pre m_combiner is held, and the heap is not empty
+      T pop_heap();
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A scalable thread-safe priority queue that pops entries in
+    ///        approximate priority order
+    ///
+    /// This is a MultiQueue: entries are spread over several independently
+    /// locked heaps. A push goes to a random heap, and a pop takes the
+    /// better front of two random heaps. Contention is spread over every
+    /// heap, at the cost of popping an entry that may not be the least one.
+    ///
+    /// The rank error of a pop, which is the number of entries in the queue
+    /// that were less than the entry that was popped, is expected to be
+    /// linear in the number of heaps; \ref rank_error_bound gives that
+    /// expected bound. An entry is never starved: it only grows closer to
+    /// the front of its heap.
+    ///
+    /// \tparam T the type of the entries
+    /// \tparam Compare the ordering of the entries; lesser entries are
+    ///         popped first
+    /// \tparam Allocator the underlying allocator used for the heaps
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T,
+             typename Compare = std::less<T>,
+             typename Allocator = std::allocator<T>>
+    class relaxed_priority_queue
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using value_compare   = Compare;
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs a relaxed_priority_queue with two heaps
+      ///        for every thread that the process can run concurrently
+      relaxed_priority_queue();
+
+      /// \brief Constructs a relaxed_priority_queue with \p heaps heaps
+      ///
+      /// More heaps lowers contention, but raises the rank error
+      ///
+      /// \param heaps the number of heaps, which is at least 1
+      /// \param compare the ordering of the entries
+      /// \param alloc the allocator to use
+      explicit relaxed_priority_queue( size_type heaps,
+                                       const Compare& compare = Compare(),
+                                       const Allocator& alloc = Allocator() );
+
+      // Deleted move constructor
+      relaxed_priority_queue( relaxed_priority_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      relaxed_priority_queue( const relaxed_priority_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys every heap
+      ~relaxed_priority_queue();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      relaxed_priority_queue& operator=( relaxed_priority_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      relaxed_priority_queue& operator=( const relaxed_priority_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \copydoc concurrent_priority_queue::empty
+      bool empty() const noexcept;
+
+      /// \copydoc concurrent_priority_queue::size
+      size_type size() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the number of heaps that entries are spread over
+      ///
+      /// \return the number of heaps
+      size_type heap_count() const noexcept;
+
+      /// \brief Gets the expected rank error of a pop
+      ///
+      /// With two-choice pops over \c n heaps, the expected number of
+      /// entries that are less than a popped entry is bounded by \c n, and
+      /// the deviation past that falls off exponentially
+      ///
+      /// \return the expected rank error
+      size_type rank_error_bound() const noexcept;
+
+      /// \copydoc concurrent_priority_queue::get_allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Element Access
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Attempts to pop one of the least entries in the queue,
+      ///        returning immediately if the queue is empty
+      ///
+      /// The entry is within \ref rank_error_bound of the least entry in
+      /// expectation
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if a value was acquired
+      bool try_pop_min( T* value );
+
+      /// \brief Pops up to \p max entries, each with the guarantee of
+      ///        \ref try_pop_min
+      ///
+      /// \param out the output iterator to store the results in
+      /// \param max the maximum number of entries to pop
+      /// \return the number of entries popped
+      template<typename OutputIterator>
+      size_type try_pop_n( OutputIterator out, size_type max );
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Pushes an entry into a random heap of the queue
+      ///
+      /// \param value the value to push
+      void push( const T& value );
+
+      /// \copydoc relaxed_priority_queue::push
+      void push( T&& value );
+
+      /// \brief Clears this queue of all entries
+      void clear();
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      using heap_compare = detail::min_heap_compare<Compare>;
+      using heap_type    = std::vector<T,Allocator>;
+
+      struct sub_heap
+      {
+        explicit sub_heap( const Allocator& alloc );
+
+        spin_lock lock;
+        heap_type entries;
+
+        char padding[cache_line_size()];
+      };
+
+      using alloc_traits       = std::allocator_traits<Allocator>;
+      using sub_heap_allocator = typename alloc_traits::template rebind_alloc<sub_heap>;
+      using sub_heap_traits    = std::allocator_traits<sub_heap_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      sub_heap_allocator     m_allocator;
+      sub_heap*              m_heaps;
+      size_type              m_count;
+      heap_compare           m_compare;
+      std::atomic<size_type> m_size;
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Picks a random heap
+      sub_heap& random_heap() noexcept;
+
+      /// \brief Pushes an entry into a random heap that is not locked
+      template<typename U>
+      void push_entry( U&& value );
+
+      /// \brief Pops the better front of two random heaps, and passes it to
+      ///        \p consume
+      ///
+      /// \return \c false if every heap was empty
+      template<typename Consume>
+      bool pop_entry( Consume&& consume );
+
+      /// \brief Pops the least entry of \p heap, and passes it to
+      ///        \p consume
+      ///
+      /// \pre \p heap is locked, and not empty
+      template<typename Consume>
+      void pop_from( sub_heap& heap, Consume& consume );
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/concurrent_priority_queue.inl"
+
+#endif /* BIT_PLATFORM_THREADING_CONCURRENT_PRIORITY_QUEUE_HPP */
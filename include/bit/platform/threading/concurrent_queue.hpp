@@ -8,17 +8,25 @@
 #ifndef BIT_PLATFORM_THREADING_CONCURRENT_QUEUE_HPP
 #define BIT_PLATFORM_THREADING_CONCURRENT_QUEUE_HPP
 
+#include "condition.hpp"
 #include "spin_lock.hpp"
+#include "detail/ring_storage.hpp"
+#include "detail/segmented_queue.hpp"
 
 #include <bit/stl/utilities/assert.hpp>
 
+#include <memory>
 #include <mutex>
-#include <condition_variable>
-#include <queue>
 
 namespace bit {
   namespace platform {
 
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A tag used in place of a lock type to select the lock-free
+    ///        implementation of \ref concurrent_queue
+    //////////////////////////////////////////////////////////////////////////
+    struct lock_free{};
+
     //////////////////////////////////////////////////////////////////////////
     /// \class bit::platform::concurrent_queue
     ///
@@ -26,7 +34,20 @@ namespace bit {
     ///        queue that supports thread-safe operations.
     ///
     /// The default locking mechanism uses a spin-lock, but can be replaced
-    /// with heavier locking-mechanisms such as mutexes.
+    /// with heavier locking-mechanisms such as mutexes. Blocking operations
+    /// wait on a \ref condition, which works with any lock type, and pushes
+    /// only notify when a consumer is actually waiting.
+    ///
+    /// Entries are stored in a ring that grows geometrically and keeps its
+    /// storage when drained, so a queue that oscillates between empty and
+    /// some working size stops allocating once it has reached that size.
+    /// The storage comes from \p Allocator, which may be an
+    /// \ref any_allocator_adapter to allocate from a \c bit::memory
+    /// allocator.
+    ///
+    /// Passing \ref lock_free as the lock selects an unbounded lock-free
+    /// queue of linked segments instead, with the same interface apart from
+    /// moving and swapping.
     ///
     /// \tparam T the type of the queue
     /// \tparam Lock the type of lock for this current queue
@@ -67,7 +88,7 @@ namespace bit {
       /// \param alloc the allocator to use
       explicit concurrent_queue( const Allocator& alloc );
 
-      /// \brief Move-constructs a concurrent queue
+      /// \brief Move-constructs a concurrent queue, taking its allocator
       ///
       /// \param other the other concurrent_queue to move
       concurrent_queue( concurrent_queue&& other );
@@ -117,6 +138,13 @@ namespace bit {
       /// \return the size of this queue
       size_type size() const noexcept;
 
+      /// \brief Grows the storage of this queue to hold at least \p n
+      ///        entries, so that it does not allocate again until it holds
+      ///        more than that
+      ///
+      /// \param n the number of entries to reserve storage for
+      void reserve( size_type n );
+
       //----------------------------------------------------------------------
       // Observers
       //----------------------------------------------------------------------
@@ -153,6 +181,32 @@ namespace bit {
       /// \return \c true if a value was acquired
       bool try_pop( T* value );
 
+      //----------------------------------------------------------------------
+
+      /// \brief Pops up to \p max elements from the front of the queue under
+      ///        a single lock, returning immediately if the queue is empty
+      ///
+      /// The results are move-assigned through \p out in queue order
+      ///
+      /// \param out the output iterator to store the results in
+      /// \param max the maximum number of elements to pop
+      /// \return the number of elements popped
+      template<typename OutputIterator>
+      size_type try_pop_n( OutputIterator out, size_type max );
+
+      /// \brief Pops every element in the queue, returning immediately if the
+      ///        queue is empty
+      ///
+      /// The underlying storage is swapped out under a single lock, and the
+      /// elements are only moved through \p out after the lock has been
+      /// released. The queue carries on with spare storage kept from an
+      /// earlier call, so neither side allocates once warmed up.
+      ///
+      /// \param out the output iterator to store the results in
+      /// \return the number of elements popped
+      template<typename OutputIterator>
+      size_type pop_all( OutputIterator out );
+
       //----------------------------------------------------------------------
       // Modifiers
       //----------------------------------------------------------------------
@@ -174,6 +228,26 @@ namespace bit {
       template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
       void emplace_back( Args&&...args );
 
+      /// \brief Pushes every entry in the range [\p first, \p last) into the
+      ///        queue under a single lock
+      ///
+      /// Waiting consumers are notified once for the whole batch
+      ///
+      /// \param first the iterator to the first entry
+      /// \param last the iterator past the last entry
+      template<typename InputIterator>
+      void push_range( InputIterator first, InputIterator last );
+
+      /// \brief Emplaces \p n entries constructed from \p args into the
+      ///        queue under a single lock
+      ///
+      /// Waiting consumers are notified once for the whole batch
+      ///
+      /// \param n the number of entries to emplace
+      /// \param args the arguments to construct each entry
+      template<typename...Args, std::enable_if_t<std::is_constructible<T,const Args&...>::value>* = nullptr>
+      void emplace_n( size_type n, const Args&...args );
+
       //----------------------------------------------------------------------
 
       /// \brief Attempts to push an entry into the queue, returning
@@ -196,7 +270,8 @@ namespace bit {
 
       //----------------------------------------------------------------------
 
-      /// \brief Clears this concurrent queue of all entries
+      /// \brief Clears this concurrent queue of all entries, keeping its
+      ///        storage
       void clear();
 
       /// \brief Swaps this concurrent_queue with another queue
@@ -209,27 +284,58 @@ namespace bit {
       //----------------------------------------------------------------------
     private:
 
-      using base_type = std::queue<T,std::deque<T,Allocator>>;
+      using container = detail::ring_storage<T,Allocator>;
 
-      class container : public base_type
-      {
-      public:
-        using base_type::base_type;
+      container m_queue; ///< The underlying queue
+      container m_spare; ///< Empty storage kept for pop_all to swap in
+      lock_type m_lock;  ///< The type of lock to wait on
+      condition m_cv;    ///< A condition to wait on
 
-        container( const container& other ) = default;
-        container( container&& other ) = default;
-        container& operator=( const container& other ) = default;
-        container& operator=( container&& other ) = default;
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Notifies consumers after \p count entries were pushed
+      ///
+      /// \param count the number of entries pushed
+      void notify( size_type count );
+    };
 
-        Allocator get_allocator() const
-        {
-          return base_type::c.get_allocator();
-        }
-      };
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief The lock-free implementation of concurrent_queue
+    ///
+    /// Producers and consumers claim cells within a segment with a single
+    /// fetch-and-add, and only compare-and-swap to link a new segment once
+    /// the current one is full. Drained segments are recycled rather than
+    /// freed, so a queue that has reached its working size stops
+    /// allocating.
+    ///
+    /// The queue can be neither moved nor swapped, since other threads may
+    /// still be operating on its segments.
+    ///
+    /// \tparam T the type of the queue
+    /// \tparam Allocator the underlying allocator used for creating segments
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator>
+    class concurrent_queue<T,lock_free,Allocator>
+      : public detail::segmented_queue<T,Allocator>
+    {
+      using base_type = detail::segmented_queue<T,Allocator>;
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using lock_type = lock_free;
+
+      //----------------------------------------------------------------------
+      // Constructors
+      //----------------------------------------------------------------------
+    public:
 
-      container               m_queue; ///< The underlying queue
-      lock_type               m_lock;  ///< The type of lock to wait on
-      std::condition_variable m_cv;    ///< A condition to wait on
+      using base_type::base_type;
     };
 
     //------------------------------------------------------------------------
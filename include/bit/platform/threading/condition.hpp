@@ -0,0 +1,147 @@
+/**
+ * \file condition.hpp
+ *
+ * \brief This header contains a futex-based condition variable that works
+ *        with any lockable type
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_CONDITION_HPP
+#define BIT_PLATFORM_THREADING_CONDITION_HPP
+
+#include "concurrency_arbiter.hpp" // blocking_region
+#include "futex.hpp"               // futex_wait, futex_wake_one, futex_wake_all
+
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::duration, std::chrono::time_point
+#include <cstdint> // std::uint32_t
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A condition variable for any BasicLockable type, such as
+    ///        \ref spin_lock, \ref null_mutex, or \c std::unique_lock
+    ///
+    /// Waiters block on a futex word that is bumped by every notification,
+    /// and register themselves while still holding the lock. Since a
+    /// notifier must change the awaited state under the same lock before
+    /// notifying, it always sees a registered waiter; so notifying with no
+    /// waiters costs a single load, and makes no system call.
+    ///
+    /// As with \c std::condition_variable, waits may wake spuriously, and
+    /// should be done in a loop or with a predicate.
+    //////////////////////////////////////////////////////////////////////////
+    class condition
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs a condition with no waiters
+      condition() noexcept;
+
+      // Deleted move constructor
+      condition( condition&& other ) = delete;
+
+      // Deleted copy constructor
+      condition( const condition& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      condition& operator=( condition&& other ) = delete;
+
+      // Deleted copy assignment
+      condition& operator=( const condition& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether any thread is waiting on this condition
+      ///
+      /// \return \c true if there are waiters
+      bool has_waiters() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Waiting
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Atomically unlocks \p lock and blocks until notified, or
+      ///        until woken spuriously, then locks \p lock again
+      ///
+      /// \pre \p lock is locked by the calling thread
+      ///
+      /// \param lock the lock to release while waiting
+      template<typename Lock>
+      void wait( Lock& lock );
+
+      /// \brief Waits on this condition until \p predicate returns \c true
+      ///
+      /// \pre \p lock is locked by the calling thread
+      ///
+      /// \param lock the lock to release while waiting
+      /// \param predicate the predicate to check while holding \p lock
+      template<typename Lock, typename Predicate>
+      void wait( Lock& lock, Predicate predicate );
+
+      /// \brief Waits on this condition until \p predicate returns \c true,
+      ///        or until \p duration has elapsed
+      ///
+      /// \pre \p lock is locked by the calling thread
+      ///
+      /// \param lock the lock to release while waiting
+      /// \param duration the maximum duration to wait for
+      /// \param predicate the predicate to check while holding \p lock
+      /// \return the result of the last call to \p predicate
+      template<typename Lock, typename Rep, typename Period, typename Predicate>
+      bool wait_for( Lock& lock,
+                     const std::chrono::duration<Rep,Period>& duration,
+                     Predicate predicate );
+
+      /// \brief Waits on this condition until \p predicate returns \c true,
+      ///        or until \p time_point has been reached
+      ///
+      /// \pre \p lock is locked by the calling thread
+      ///
+      /// \param lock the lock to release while waiting
+      /// \param time_point the time to wait until
+      /// \param predicate the predicate to check while holding \p lock
+      /// \return the result of the last call to \p predicate
+      template<typename Lock, typename Clock, typename Duration, typename Predicate>
+      bool wait_until( Lock& lock,
+                       const std::chrono::time_point<Clock,Duration>& time_point,
+                       Predicate predicate );
+
+      //----------------------------------------------------------------------
+      // Notification
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Wakes at least one thread waiting on this condition, if
+      ///        there are any
+      void notify_one() noexcept;
+
+      /// \brief Wakes every thread waiting on this condition, if there are
+      ///        any
+      void notify_all() noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      std::atomic<std::uint32_t> m_sequence; ///< Bumped by every notification
+      std::atomic<std::uint32_t> m_waiters;  ///< The number of waiting threads
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/condition.inl"
+
+#endif /* BIT_PLATFORM_THREADING_CONDITION_HPP */
@@ -0,0 +1,127 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_ACTOR_INL
+#define BIT_PLATFORM_THREADING_DETAIL_ACTOR_INL
+
+//=============================================================================
+// detail::actor_message_base
+//=============================================================================
+
+inline bit::platform::detail::actor_message_base
+  ::actor_message_base( receive_function receive )
+  noexcept
+  : receive(receive)
+{
+
+}
+
+//=============================================================================
+// detail::actor_message
+//=============================================================================
+
+template<typename Message>
+template<typename...Args>
+inline bit::platform::detail::actor_message<Message>
+  ::actor_message( receive_function receive, Args&&...args )
+  : actor_message_base(receive),
+    value( std::forward<Args>(args)... )
+{
+
+}
+
+//=============================================================================
+// detail::actor_base
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline bit::platform::dispatcher&
+  bit::platform::detail::actor_base::get_dispatcher()
+  const noexcept
+{
+  return m_dispatcher;
+}
+
+inline std::size_t bit::platform::detail::actor_base::batch_size()
+  const noexcept
+{
+  return m_batch_size;
+}
+
+//=============================================================================
+// actor<Message>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename Message>
+inline bit::platform::actor<Message>::actor( dispatcher& dispatcher,
+                                             handler_type handler,
+                                             std::size_t batch_size )
+  : detail::actor_base(dispatcher,batch_size),
+    m_handler(std::move(handler))
+{
+
+}
+
+template<typename Message>
+inline bit::platform::actor<Message>::~actor()
+{
+  // The handler must outlive every pending message, so this cannot be left
+  // to the base destructor
+  flush();
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename Message>
+inline void bit::platform::actor<Message>::send( const Message& message )
+{
+  emplace( message );
+}
+
+template<typename Message>
+inline void bit::platform::actor<Message>::send( Message&& message )
+{
+  emplace( std::move(message) );
+}
+
+template<typename Message>
+template<typename...Args>
+inline void bit::platform::actor<Message>::emplace( Args&&...args )
+{
+  auto* p = detail::allocate_actor_message( sizeof(node_type) );
+
+  node_type* node;
+  try {
+    node = ::new (p) node_type( &receive, std::forward<Args>(args)... );
+  } catch( ... ) {
+    detail::deallocate_actor_message( p, sizeof(node_type) );
+    throw;
+  }
+
+  enqueue( node );
+}
+
+//-----------------------------------------------------------------------------
+// Private Static Functions
+//-----------------------------------------------------------------------------
+
+template<typename Message>
+inline void bit::platform::actor<Message>
+  ::receive( detail::actor_base& self, detail::actor_message_base* message )
+  noexcept
+{
+  auto* node = static_cast<node_type*>(message);
+
+  static_cast<actor&>(self).m_handler( node->value );
+
+  node->~node_type();
+  detail::deallocate_actor_message( node, sizeof(node_type) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_ACTOR_INL */
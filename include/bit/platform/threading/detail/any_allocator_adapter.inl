@@ -0,0 +1,79 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_ANY_ALLOCATOR_ADAPTER_INL
+#define BIT_PLATFORM_THREADING_DETAIL_ANY_ALLOCATOR_ADAPTER_INL
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::any_allocator_adapter<T>
+  ::any_allocator_adapter( memory::any_allocator allocator )
+  noexcept
+  : m_allocator(std::move(allocator))
+{
+
+}
+
+template<typename T>
+template<typename U>
+inline bit::platform::any_allocator_adapter<T>
+  ::any_allocator_adapter( const any_allocator_adapter<U>& other )
+  noexcept
+  : m_allocator(other.m_allocator)
+{
+
+}
+
+//----------------------------------------------------------------------------
+// Allocation
+//----------------------------------------------------------------------------
+
+template<typename T>
+inline T* bit::platform::any_allocator_adapter<T>::allocate( size_type n )
+{
+  auto p = m_allocator.allocate( sizeof(T) * n, alignof(T) );
+  if( p == nullptr ) throw std::bad_alloc{};
+
+  return static_cast<T*>(p);
+}
+
+template<typename T>
+inline void bit::platform::any_allocator_adapter<T>::deallocate( T* p, size_type n )
+  noexcept
+{
+  m_allocator.deallocate( p, sizeof(T) * n );
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::memory::any_allocator
+  bit::platform::any_allocator_adapter<T>::underlying()
+  const noexcept
+{
+  return m_allocator;
+}
+
+//----------------------------------------------------------------------------
+// Equality
+//----------------------------------------------------------------------------
+
+template<typename T, typename U>
+inline bool bit::platform::operator==( const any_allocator_adapter<T>& lhs,
+                                       const any_allocator_adapter<U>& rhs )
+  noexcept
+{
+  return lhs.underlying() == rhs.underlying();
+}
+
+template<typename T, typename U>
+inline bool bit::platform::operator!=( const any_allocator_adapter<T>& lhs,
+                                       const any_allocator_adapter<U>& rhs )
+  noexcept
+{
+  return !(lhs == rhs);
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_ANY_ALLOCATOR_ADAPTER_INL */
@@ -0,0 +1,418 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_BOUNDED_CONCURRENT_QUEUE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_BOUNDED_CONCURRENT_QUEUE_INL
+
+//============================================================================
+// bounded_concurrent_queue::cell
+//============================================================================
+
+template<typename T, typename Allocator>
+inline bit::platform::bounded_concurrent_queue<T,Allocator>::cell
+  ::cell( size_type sequence )
+  noexcept
+  : sequence(sequence)
+{
+
+}
+
+//============================================================================
+// bounded_concurrent_queue
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Static Members
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr std::size_t bit::platform::bounded_concurrent_queue<T,Allocator>::spin_count;
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::bounded_concurrent_queue( size_type capacity )
+  : bounded_concurrent_queue( capacity, Allocator() )
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::bounded_concurrent_queue( size_type capacity, const Allocator& alloc )
+  : m_allocator(alloc),
+    m_cells(nullptr),
+    m_mask(0u),
+    m_tail(0u),
+    m_head(0u),
+    m_push_epoch(0u),
+    m_pop_epoch(0u),
+    m_push_waiters(0u),
+    m_pop_waiters(0u)
+{
+  BIT_ASSERT( capacity > 0, "bounded_concurrent_queue: capacity must be greater than zero" );
+
+  // A ring of one cell cannot tell a full cell from an empty one
+  auto size = size_type(2);
+  while( size < capacity ) size <<= 1;
+
+  m_cells = cell_traits::allocate( m_allocator, size );
+  m_mask  = size - 1;
+
+  for( auto i = size_type(0); i < size; ++i ) {
+    cell_traits::construct( m_allocator, m_cells + i, i );
+  }
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::~bounded_concurrent_queue()
+{
+  clear();
+
+  for( auto i = size_type(0); i <= m_mask; ++i ) {
+    cell_traits::destroy( m_allocator, m_cells + i );
+  }
+  cell_traits::deallocate( m_allocator, m_cells, m_mask + 1 );
+}
+
+//----------------------------------------------------------------------------
+// Capacity
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::bounded_concurrent_queue<T,Allocator>::size_type
+  bit::platform::bounded_concurrent_queue<T,Allocator>::size()
+  const noexcept
+{
+  const auto head = m_head.load( std::memory_order_acquire );
+  const auto tail = m_tail.load( std::memory_order_acquire );
+
+  // Consumers may claim positions that the loaded tail does not cover yet
+  return static_cast<std::ptrdiff_t>(tail - head) > 0 ? (tail - head) : 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::bounded_concurrent_queue<T,Allocator>::size_type
+  bit::platform::bounded_concurrent_queue<T,Allocator>::capacity()
+  const noexcept
+{
+  return m_mask + 1;
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::bounded_concurrent_queue<T,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//----------------------------------------------------------------------------
+// Element Access
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>::pop( T* value )
+{
+  BIT_ASSERT( value, "bounded_concurrent_queue::pop: value cannot be null");
+
+  auto position = size_type();
+  auto c = wait_for_cell( m_pop_epoch, m_pop_waiters, [&]
+  {
+    return claim_pop( &position );
+  });
+
+  commit_pop( c, position, value );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>::try_pop( T* value )
+{
+  BIT_ASSERT( value, "bounded_concurrent_queue::try_pop: value cannot be null");
+
+  auto position = size_type();
+  auto c = claim_pop( &position );
+
+  if( !c ) return false;
+
+  commit_pop( c, position, value );
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::push_back( const T& value )
+{
+  emplace_back( value );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::push_back( T&& value )
+{
+  emplace_back( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::emplace_back( Args&&...args )
+{
+  emplace_back( std::is_nothrow_constructible<T,Args...>{},
+                std::forward<Args>(args)... );
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::try_push_back( const T& value )
+{
+  return try_emplace_back( value );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::try_push_back( T&& value )
+{
+  return try_emplace_back( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::try_emplace_back( Args&&...args )
+{
+  return try_emplace_back( std::is_nothrow_constructible<T,Args...>{},
+                           std::forward<Args>(args)... );
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>::clear()
+{
+  auto position = size_type();
+
+  while( auto c = claim_pop( &position ) ) {
+    auto p = static_cast<T*>(static_cast<void*>(&c->storage));
+
+    p->~T();
+    c->sequence.store( position + m_mask + 1, std::memory_order_release );
+    notify( m_push_epoch, m_push_waiters );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline typename bit::platform::bounded_concurrent_queue<T,Allocator>::cell*
+  bit::platform::bounded_concurrent_queue<T,Allocator>::claim_push( size_type* position )
+  noexcept
+{
+  auto tail = m_tail.load( std::memory_order_relaxed );
+
+  while( true ) {
+    auto c = &m_cells[tail & m_mask];
+    const auto sequence = c->sequence.load( std::memory_order_acquire );
+    const auto distance = static_cast<std::ptrdiff_t>(sequence - tail);
+
+    if( distance == 0 ) {
+      if( m_tail.compare_exchange_weak( tail, tail + 1, std::memory_order_relaxed ) ) {
+        (*position) = tail;
+        return c;
+      }
+    } else if( distance < 0 ) {
+      // The cell still holds the entry from the previous lap
+      return nullptr;
+    } else {
+      tail = m_tail.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::bounded_concurrent_queue<T,Allocator>::cell*
+  bit::platform::bounded_concurrent_queue<T,Allocator>::claim_pop( size_type* position )
+  noexcept
+{
+  auto head = m_head.load( std::memory_order_relaxed );
+
+  while( true ) {
+    auto c = &m_cells[head & m_mask];
+    const auto sequence = c->sequence.load( std::memory_order_acquire );
+    const auto distance = static_cast<std::ptrdiff_t>(sequence - (head + 1));
+
+    if( distance == 0 ) {
+      if( m_head.compare_exchange_weak( head, head + 1, std::memory_order_relaxed ) ) {
+        (*position) = head;
+        return c;
+      }
+    } else if( distance < 0 ) {
+      // The cell has not been filled for this lap yet
+      return nullptr;
+    } else {
+      head = m_head.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::commit_push( cell* c, size_type position, Args&&...args )
+  noexcept
+{
+  ::new(static_cast<void*>(&c->storage)) T( std::forward<Args>(args)... );
+
+  c->sequence.store( position + 1, std::memory_order_release );
+  notify( m_pop_epoch, m_pop_waiters );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::commit_pop( cell* c, size_type position, T* value )
+{
+  auto p = static_cast<T*>(static_cast<void*>(&c->storage));
+
+  // The cell is handed back to producers even if the assignment throws, so
+  // that the queue is never left with a cell that no one will release
+  struct release_guard
+  {
+    bounded_concurrent_queue* self;
+    cell*                     c;
+    size_type                 position;
+    T*                        p;
+
+    ~release_guard()
+    {
+      p->~T();
+      c->sequence.store( position + self->m_mask + 1, std::memory_order_release );
+      self->notify( self->m_push_epoch, self->m_push_waiters );
+    }
+  } guard{ this, c, position, p };
+
+  (*value) = std::move(*p);
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::try_emplace_back( std::true_type, Args&&...args )
+{
+  auto position = size_type();
+  auto c = claim_push( &position );
+
+  if( !c ) return false;
+
+  commit_push( c, position, std::forward<Args>(args)... );
+  return true;
+}
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline bool bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::try_emplace_back( std::false_type, Args&&...args )
+{
+  // A claimed cell cannot be given back, so anything that may throw happens
+  // before claiming one
+  auto value = T( std::forward<Args>(args)... );
+
+  return try_emplace_back( std::true_type{}, std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::emplace_back( std::true_type, Args&&...args )
+{
+  auto position = size_type();
+  auto c = wait_for_cell( m_push_epoch, m_push_waiters, [&]
+  {
+    return claim_push( &position );
+  });
+
+  commit_push( c, position, std::forward<Args>(args)... );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::emplace_back( std::false_type, Args&&...args )
+{
+  auto value = T( std::forward<Args>(args)... );
+
+  emplace_back( std::true_type{}, std::move(value) );
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename Claim>
+inline typename bit::platform::bounded_concurrent_queue<T,Allocator>::cell*
+  bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::wait_for_cell( std::atomic<std::uint32_t>& epoch,
+                   std::atomic<size_type>& waiters,
+                   Claim&& claim )
+  noexcept
+{
+  for( auto i = size_type(0); i < spin_count; ++i ) {
+    if( auto c = claim() ) return c;
+
+    std::this_thread::yield();
+  }
+
+  // Pairs with the fence in notify(): either the other side sees this thread
+  // waiting, or this thread sees the cell it released
+  waiters.fetch_add( 1u );
+
+  auto c = static_cast<cell*>(nullptr);
+  while( true ) {
+    const auto current = epoch.load();
+
+    if( (c = claim()) ) break;
+
+    // Parked threads do not occupy a slot of the arbiter
+    blocking_region region;
+    futex_wait( epoch, current );
+  }
+
+  waiters.fetch_sub( 1u, std::memory_order_relaxed );
+  return c;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::bounded_concurrent_queue<T,Allocator>
+  ::notify( std::atomic<std::uint32_t>& epoch, std::atomic<size_type>& waiters )
+  noexcept
+{
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  if( waiters.load( std::memory_order_relaxed ) == 0u ) return;
+
+  epoch.fetch_add( 1u );
+  futex_wake_one( epoch );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_BOUNDED_CONCURRENT_QUEUE_INL */
@@ -0,0 +1,574 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_BROADCAST_RING_INL
+#define BIT_PLATFORM_THREADING_DETAIL_BROADCAST_RING_INL
+
+//============================================================================
+// broadcast_ring::consumer_slot
+//============================================================================
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>::consumer_slot
+  ::consumer_slot()
+  noexcept
+  : sequence(no_sequence),
+    in_use(false)
+{
+
+}
+
+//============================================================================
+// broadcast_ring
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Static Members
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr typename bit::platform::broadcast_ring<T,Allocator>::sequence_type
+  bit::platform::broadcast_ring<T,Allocator>::no_sequence;
+
+template<typename T, typename Allocator>
+constexpr std::size_t bit::platform::broadcast_ring<T,Allocator>::spin_count;
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>
+  ::broadcast_ring( size_type capacity,
+                    size_type max_consumers,
+                    wait_strategy wait )
+  : broadcast_ring( capacity, max_consumers, wait, Allocator() )
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>
+  ::broadcast_ring( size_type capacity,
+                    size_type max_consumers,
+                    wait_strategy wait,
+                    const Allocator& alloc )
+  : m_allocator(alloc),
+    m_entries(nullptr),
+    m_mask(0u),
+    m_slots(nullptr),
+    m_slot_count(max_consumers),
+    m_wait(wait),
+    m_published(0u),
+    m_gate(0u),
+    m_publish_epoch(0u),
+    m_publish_waiters(0u),
+    m_closed(false),
+    m_consume_epoch(0u),
+    m_consume_waiters(0u)
+{
+  BIT_ASSERT( capacity > 0, "broadcast_ring: capacity must be greater than zero" );
+  BIT_ASSERT( max_consumers > 0, "broadcast_ring: max_consumers must be greater than zero" );
+
+  auto size = size_type(1);
+  while( size < capacity ) size <<= 1;
+
+  auto slots = slot_allocator(m_allocator);
+  m_slots = slot_traits::allocate( slots, max_consumers );
+  for( auto i = size_type(0); i < max_consumers; ++i ) {
+    ::new(static_cast<void*>(m_slots + i)) consumer_slot();
+  }
+
+  auto i = size_type(0);
+  try {
+    m_entries = entry_traits::allocate( m_allocator, size );
+    for( ; i < size; ++i ) {
+      entry_traits::construct( m_allocator, m_entries + i );
+    }
+  } catch( ... ) {
+    while( i > 0u ) {
+      entry_traits::destroy( m_allocator, m_entries + --i );
+    }
+    if( m_entries ) entry_traits::deallocate( m_allocator, m_entries, size );
+    slot_traits::deallocate( slots, m_slots, max_consumers );
+    throw;
+  }
+
+  m_mask = size - 1;
+  m_gate = size;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>::~broadcast_ring()
+{
+  for( auto i = size_type(0); i < m_slot_count; ++i ) {
+    BIT_ASSERT( !m_slots[i].in_use.load( std::memory_order_relaxed ),
+                "broadcast_ring: destroyed while a consumer is subscribed" );
+  }
+
+  for( auto i = size_type(0); i <= m_mask; ++i ) {
+    entry_traits::destroy( m_allocator, m_entries + i );
+  }
+  entry_traits::deallocate( m_allocator, m_entries, m_mask + 1 );
+
+  auto slots = slot_allocator(m_allocator);
+  slot_traits::deallocate( slots, m_slots, m_slot_count );
+}
+
+//----------------------------------------------------------------------------
+// Capacity
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::capacity()
+  const noexcept
+{
+  return m_mask + 1;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::max_consumers()
+  const noexcept
+{
+  return m_slot_count;
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::broadcast_ring<T,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::broadcast_ring<T,Allocator>::closed()
+  const noexcept
+{
+  return m_closed.load( std::memory_order_acquire );
+}
+
+//----------------------------------------------------------------------------
+// Consumers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::consumer
+  bit::platform::broadcast_ring<T,Allocator>::subscribe( wait_strategy wait )
+{
+  for( auto i = size_type(0); i < m_slot_count; ++i ) {
+    auto& slot = m_slots[i];
+
+    if( slot.in_use.exchange( true, std::memory_order_acquire ) ) continue;
+
+    // The producer may be looking for the slowest consumer right now. The
+    // fence pairs with the one in slowest_sequence(): either the producer
+    // sees this slot, or this consumer starts after every entry that the
+    // producer was allowed to overwrite
+    slot.sequence.store( m_published.load( std::memory_order_acquire ), std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+
+    const auto sequence = m_published.load( std::memory_order_acquire );
+    slot.sequence.store( sequence, std::memory_order_release );
+
+    return consumer( *this, slot, sequence, wait );
+  }
+
+  throw std::out_of_range("broadcast_ring::subscribe: too many consumers subscribed");
+}
+
+//----------------------------------------------------------------------------
+// Producer
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>::publish( const T& value )
+{
+  BIT_ASSERT( !closed(), "broadcast_ring::publish: ring is closed" );
+
+  const auto sequence = m_published.load( std::memory_order_relaxed );
+
+  wait_for_room( sequence + 1 );
+  entry(sequence) = value;
+  publish_until( sequence + 1 );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>::publish( T&& value )
+{
+  BIT_ASSERT( !closed(), "broadcast_ring::publish: ring is closed" );
+
+  const auto sequence = m_published.load( std::memory_order_relaxed );
+
+  wait_for_room( sequence + 1 );
+  entry(sequence) = std::move(value);
+  publish_until( sequence + 1 );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::broadcast_ring<T,Allocator>
+  ::try_publish( const T& value )
+{
+  BIT_ASSERT( !closed(), "broadcast_ring::try_publish: ring is closed" );
+
+  const auto sequence = m_published.load( std::memory_order_relaxed );
+
+  if( !has_room( sequence + 1 ) ) return false;
+
+  entry(sequence) = value;
+  publish_until( sequence + 1 );
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>
+  ::publish_n( stl::span<const T> values )
+{
+  BIT_ASSERT( !closed(), "broadcast_ring::publish_n: ring is closed" );
+
+  const auto count = static_cast<size_type>(values.size());
+
+  for( auto i = size_type(0); i < count; ) {
+    const auto sequence = m_published.load( std::memory_order_relaxed );
+
+    wait_for_room( sequence + 1 );
+
+    const auto room  = static_cast<size_type>(m_gate - sequence);
+    const auto batch = room < (count - i) ? room : (count - i);
+
+    auto j = size_type(0);
+    try {
+      for( ; j < batch; ++j ) {
+        entry(sequence + j) = values[i + j];
+      }
+    } catch( ... ) {
+      // Publish the entries that were assigned before the throw
+      publish_until( sequence + j );
+      throw;
+    }
+
+    publish_until( sequence + batch );
+    i += batch;
+  }
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>::close()
+  noexcept
+{
+  m_closed.store( true );
+
+  notify( m_publish_epoch, m_publish_waiters, true );
+}
+
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline T& bit::platform::broadcast_ring<T,Allocator>
+  ::entry( sequence_type sequence )
+  const noexcept
+{
+  return m_entries[static_cast<size_type>(sequence) & m_mask];
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::sequence_type
+  bit::platform::broadcast_ring<T,Allocator>::slowest_sequence()
+  const noexcept
+{
+  // Pairs with the fences in subscribe() and notify()
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  auto slowest = m_published.load( std::memory_order_relaxed );
+
+  for( auto i = size_type(0); i < m_slot_count; ++i ) {
+    const auto sequence = m_slots[i].sequence.load( std::memory_order_acquire );
+
+    if( sequence < slowest ) slowest = sequence;
+  }
+  return slowest;
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::broadcast_ring<T,Allocator>
+  ::has_room( sequence_type end )
+  noexcept
+{
+  if( end <= m_gate ) return true;
+
+  // Only scan the consumers once the last scan's room is used up
+  m_gate = slowest_sequence() + capacity();
+
+  return end <= m_gate;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>
+  ::wait_for_room( sequence_type end )
+  noexcept
+{
+  if( has_room( end ) ) return;
+
+  if( m_wait != wait_strategy::park ) {
+    while( !has_room( end ) ) {
+      if( m_wait == wait_strategy::yield ) std::this_thread::yield();
+    }
+    return;
+  }
+
+  for( auto i = size_type(0); i < spin_count; ++i ) {
+    std::this_thread::yield();
+
+    if( has_room( end ) ) return;
+  }
+
+  // Pairs with the fence in notify(): either the consumer sees the producer
+  // waiting, or the producer sees the sequence it released
+  m_consume_waiters.fetch_add( 1u );
+
+  while( true ) {
+    const auto current = m_consume_epoch.load();
+
+    if( has_room( end ) ) break;
+
+    // A parked producer does not occupy a slot of the arbiter
+    blocking_region region;
+    futex_wait( m_consume_epoch, current );
+  }
+
+  m_consume_waiters.fetch_sub( 1u, std::memory_order_relaxed );
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::sequence_type
+  bit::platform::broadcast_ring<T,Allocator>
+  ::wait_for_entries( sequence_type sequence, wait_strategy wait )
+  noexcept
+{
+  auto published = sequence;
+  const auto ready = [&]() {
+    // The ring is checked for closing first, so that a closed ring is seen
+    // with every entry that was published before it closed
+    const auto closed = m_closed.load( std::memory_order_acquire );
+    published = m_published.load( std::memory_order_acquire );
+
+    return closed || published != sequence;
+  };
+
+  if( ready() ) return published;
+
+  if( wait != wait_strategy::park ) {
+    while( !ready() ) {
+      if( wait == wait_strategy::yield ) std::this_thread::yield();
+    }
+    return published;
+  }
+
+  for( auto i = size_type(0); i < spin_count; ++i ) {
+    std::this_thread::yield();
+
+    if( ready() ) return published;
+  }
+
+  // Pairs with the fence in notify(): either the producer sees this
+  // consumer waiting, or this consumer sees the entry it published
+  m_publish_waiters.fetch_add( 1u );
+
+  while( true ) {
+    const auto current = m_publish_epoch.load();
+
+    if( ready() ) break;
+
+    // Parked consumers do not occupy a slot of the arbiter
+    blocking_region region;
+    futex_wait( m_publish_epoch, current );
+  }
+
+  m_publish_waiters.fetch_sub( 1u, std::memory_order_relaxed );
+  return published;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>
+  ::publish_until( sequence_type end )
+  noexcept
+{
+  m_published.store( end, std::memory_order_release );
+
+  notify( m_publish_epoch, m_publish_waiters, true );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>
+  ::release( consumer_slot& slot, sequence_type sequence )
+  noexcept
+{
+  slot.sequence.store( sequence, std::memory_order_release );
+
+  // A producer that does not park re-scans the consumers on its own
+  if( m_wait == wait_strategy::park ) {
+    notify( m_consume_epoch, m_consume_waiters, false );
+  }
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::broadcast_ring<T,Allocator>
+  ::notify( std::atomic<std::uint32_t>& epoch,
+            const std::atomic<size_type>& waiters,
+            bool all )
+  noexcept
+{
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  if( waiters.load( std::memory_order_relaxed ) == 0u ) return;
+
+  epoch.fetch_add( 1u );
+
+  if( all ) {
+    futex_wake_all( epoch );
+  } else {
+    futex_wake_one( epoch );
+  }
+}
+
+//============================================================================
+// broadcast_ring::consumer
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>::consumer
+  ::consumer( broadcast_ring& ring,
+              consumer_slot& slot,
+              sequence_type sequence,
+              wait_strategy wait )
+  noexcept
+  : m_ring(&ring),
+    m_slot(&slot),
+    m_sequence(sequence),
+    m_published(sequence),
+    m_wait(wait)
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>::consumer
+  ::consumer( consumer&& other )
+  noexcept
+  : m_ring(other.m_ring),
+    m_slot(other.m_slot),
+    m_sequence(other.m_sequence),
+    m_published(other.m_published),
+    m_wait(other.m_wait)
+{
+  other.m_slot = nullptr;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::broadcast_ring<T,Allocator>::consumer::~consumer()
+{
+  if( m_slot == nullptr ) return;
+
+  // The producer may have been waiting on this consumer
+  m_ring->release( *m_slot, no_sequence );
+  m_slot->in_use.store( false, std::memory_order_release );
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::consumer::available()
+  const noexcept
+{
+  const auto published = m_ring->m_published.load( std::memory_order_acquire );
+
+  return static_cast<size_type>(published - m_sequence);
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::wait_strategy
+  bit::platform::broadcast_ring<T,Allocator>::consumer::strategy()
+  const noexcept
+{
+  return m_wait;
+}
+
+//----------------------------------------------------------------------------
+// Consuming
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename Fn>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::consumer::poll( Fn&& fn )
+{
+  // The published sequence is only reloaded once the cached one is used
+  // up, so that a consumer that is behind does not contend with the producer
+  if( m_published == m_sequence ) {
+    m_published = m_ring->m_published.load( std::memory_order_acquire );
+  }
+  return consume( m_published, fn );
+}
+
+template<typename T, typename Allocator>
+template<typename Fn>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::consumer::wait( Fn&& fn )
+{
+  if( m_published == m_sequence ) {
+    m_published = m_ring->wait_for_entries( m_sequence, m_wait );
+  }
+  return consume( m_published, fn );
+}
+
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename Fn>
+inline typename bit::platform::broadcast_ring<T,Allocator>::size_type
+  bit::platform::broadcast_ring<T,Allocator>::consumer
+  ::consume( sequence_type end, Fn& fn )
+{
+  const auto first = m_sequence;
+
+  if( first == end ) return 0u;
+
+  auto sequence = first;
+  try {
+    for( ; sequence != end; ++sequence ) {
+      const auto& value = m_ring->entry(sequence);
+      fn( value );
+    }
+  } catch( ... ) {
+    // The entry whose handler threw is handled again by the next call
+    m_sequence = sequence;
+    m_ring->release( *m_slot, sequence );
+    throw;
+  }
+
+  // The whole batch is released at once, so that the producer is only
+  // woken once per batch
+  m_sequence = end;
+  m_ring->release( *m_slot, end );
+
+  return static_cast<size_type>(end - first);
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_BROADCAST_RING_INL */
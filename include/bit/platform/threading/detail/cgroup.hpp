@@ -0,0 +1,63 @@
+/**
+ * \file cgroup.hpp
+ *
+ * \brief This header contains the parsing of the cgroup files that limit
+ *        the number of CPUs available to a process on Linux
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_CGROUP_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_CGROUP_HPP
+
+#include <cstddef>    // std::size_t
+#include <functional> // std::function
+#include <istream>    // std::istream
+#include <string>     // std::string
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /// \brief Reads the first line of the file at \p path into \p line
+      ///
+      /// Returns \c true if a non-empty line was read
+      using cgroup_file_reader = std::function<bool( const std::string& path, std::string& line )>;
+
+      /// \brief Counts the CPUs in a cpuset list, such as "0-3,8"
+      ///
+      /// \param list the cpu list
+      /// \return the number of CPUs in the list
+      std::size_t count_cpu_list( const std::string& list ) noexcept;
+
+      /// \brief Converts a CPU quota into a number of CPUs, rounding up
+      ///
+      /// \param quota the time the cgroup may run in each period
+      /// \param period the length of each period
+      /// \return the number of CPUs, or 0 if the quota is unlimited
+      std::size_t quota_to_cpus( long long quota, long long period ) noexcept;
+
+      /// \brief Converts the contents of a cgroup v2 'cpu.max' file, of the
+      ///        form 'quota period', into a number of CPUs
+      ///
+      /// \param value the contents of the file
+      /// \return the number of CPUs, or 0 if the quota is 'max'
+      std::size_t parse_cpu_max( const std::string& value ) noexcept;
+
+      /// \brief Determines the number of CPUs that a process is limited to
+      ///        by the cpusets and CPU quotas of its cgroups (v1 and v2)
+      ///
+      /// \param cgroups the contents of '/proc/self/cgroup'
+      /// \param read_line the function used to read the cgroup files under
+      ///                  '/sys/fs/cgroup'
+      /// \return the number of CPUs, or 0 if there is no limit
+      std::size_t cgroup_concurrency( std::istream& cgroups,
+                                      const cgroup_file_reader& read_line );
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_CGROUP_HPP */
@@ -0,0 +1,403 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_CHANNEL_INL
+#define BIT_PLATFORM_THREADING_DETAIL_CHANNEL_INL
+
+//=============================================================================
+// detail::channel_waiter
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+inline bit::platform::detail::channel_waiter::channel_waiter()
+  noexcept
+  : m_state(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline std::uint32_t bit::platform::detail::channel_waiter::notifier()
+  const noexcept
+{
+  const auto state = m_state.load( std::memory_order_acquire );
+
+  return state ? (state - 1u) : no_notifier;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::detail::channel_waiter::wait()
+  const noexcept
+{
+  while( m_state.load( std::memory_order_acquire ) == 0u ) {
+    futex_wait( m_state, 0u );
+  }
+}
+
+inline bool bit::platform::detail::channel_waiter::notify( std::uint32_t index )
+  noexcept
+{
+  auto expected = std::uint32_t{0u};
+
+  return m_state.compare_exchange_strong( expected, index + 1u,
+                                          std::memory_order_acq_rel );
+}
+
+inline void bit::platform::detail::channel_waiter::wake()
+  noexcept
+{
+  futex_wake_one( m_state );
+}
+
+inline void bit::platform::detail::channel_waiter::reset()
+  noexcept
+{
+  m_state.store( 0u, std::memory_order_relaxed );
+}
+
+//=============================================================================
+// channel<T,Allocator>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Public Static Members
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr typename bit::platform::channel<T,Allocator>::size_type
+  bit::platform::channel<T,Allocator>::unbounded;
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::channel<T,Allocator>
+  ::channel( size_type capacity, const Allocator& alloc )
+  : m_queue( alloc ),
+    m_capacity( capacity )
+{
+  BIT_ASSERT( capacity > 0, "channel::channel: capacity must be non-zero" );
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::channel<T,Allocator>::empty()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_queue.empty();
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::channel<T,Allocator>::size_type
+  bit::platform::channel<T,Allocator>::size()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_queue.size();
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::channel<T,Allocator>::size_type
+  bit::platform::channel<T,Allocator>::capacity()
+  const noexcept
+{
+  return m_capacity;
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::channel<T,Allocator>::get_allocator()
+  const
+{
+  return m_queue.get_allocator();
+}
+
+//-----------------------------------------------------------------------------
+// Sending
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::channel<T,Allocator>::send( const T& value )
+{
+  return emplace( value );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::channel<T,Allocator>::send( T&& value )
+{
+  return emplace( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline bool bit::platform::channel<T,Allocator>::emplace( Args&&...args )
+{
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  while( true ) {
+    // The arguments are only consumed once the value is pushed
+    const auto status = try_push( lock, std::forward<Args>(args)... );
+
+    if( status != channel_status::full ) return status == channel_status::ok;
+
+    park( m_senders, lock );
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::channel_status
+  bit::platform::channel<T,Allocator>::try_send( const T& value )
+{
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  return try_push( lock, value );
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::channel_status
+  bit::platform::channel<T,Allocator>::try_send( T&& value )
+{
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  return try_push( lock, std::move(value) );
+}
+
+//-----------------------------------------------------------------------------
+// Receiving
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::channel<T,Allocator>::recv( T* value )
+{
+  BIT_ASSERT( value, "channel::recv: value cannot be null" );
+
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  while( true ) {
+    const auto status = try_pop( lock, value, false );
+
+    if( status != channel_status::empty ) return status == channel_status::ok;
+
+    park( m_receivers, lock );
+  }
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::channel_status
+  bit::platform::channel<T,Allocator>::try_recv( T* value )
+{
+  BIT_ASSERT( value, "channel::try_recv: value cannot be null" );
+
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  return try_pop( lock, value, false );
+}
+
+template<typename T, typename Allocator>
+template<typename OutputIt>
+inline typename bit::platform::channel<T,Allocator>::size_type
+  bit::platform::channel<T,Allocator>::recv_batch( OutputIt out, size_type max )
+{
+  BIT_ASSERT( max > 0, "channel::recv_batch: max must be non-zero" );
+
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  while( m_queue.empty() ) {
+    if( m_closed ) return 0u;
+
+    park( m_receivers, lock );
+  }
+
+  const auto count = std::min( max, m_queue.size() );
+  for( auto i = size_type{0}; i < count; ++i ) {
+    *out = std::move( m_queue.front() );
+    ++out;
+    m_queue.pop_front();
+  }
+
+  // Every slot freed may unblock a sender
+  m_senders.notify( count );
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline bit::platform::channel_status
+  bit::platform::channel<T,Allocator>
+  ::try_push( std::unique_lock<spin_lock>& lock, Args&&...args )
+{
+  if( m_closed ) return channel_status::closed;
+  if( m_queue.size() >= m_capacity ) return channel_status::full;
+
+  m_queue.emplace_back( std::forward<Args>(args)... );
+
+  auto* waiter = m_receivers.notify_one();
+  lock.unlock();
+
+  if( waiter ) waiter->wake();
+  return channel_status::ok;
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::channel_status
+  bit::platform::channel<T,Allocator>
+  ::try_pop( std::unique_lock<spin_lock>& lock, T* value, bool construct )
+{
+  if( m_queue.empty() ) {
+    return m_closed ? channel_status::closed : channel_status::empty;
+  }
+
+  if( construct ) {
+    ::new (static_cast<void*>(value)) T( std::move(m_queue.front()) );
+  } else {
+    (*value) = std::move(m_queue.front());
+  }
+  m_queue.pop_front();
+
+  auto* waiter = m_senders.notify_one();
+  lock.unlock();
+
+  if( waiter ) waiter->wake();
+  return channel_status::ok;
+}
+
+//=============================================================================
+// detail::select_case_impl<T,Allocator,Fn>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator, typename Fn>
+template<typename Fn2>
+inline bit::platform::detail::select_case_impl<T,Allocator,Fn>
+  ::select_case_impl( channel<T,Allocator>& channel, Fn2&& fn )
+  : select_case{ std::addressof(channel), &receive, &deliver },
+    m_channel( std::addressof(channel) ),
+    m_function( std::forward<Fn2>(fn) ),
+    m_has_value( false )
+{
+
+}
+
+template<typename T, typename Allocator, typename Fn>
+inline bit::platform::detail::select_case_impl<T,Allocator,Fn>
+  ::select_case_impl( select_case_impl&& other )
+  : select_case{ other.m_channel, &receive, &deliver },
+    m_channel( other.m_channel ),
+    m_function( std::move(other.m_function) ),
+    m_has_value( false )
+{
+  BIT_ASSERT( !other.m_has_value, "select_case_impl: cannot move a case that holds a value" );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator, typename Fn>
+inline bit::platform::detail::select_case_impl<T,Allocator,Fn>::~select_case_impl()
+{
+  if( m_has_value ) {
+    reinterpret_cast<T*>(&m_storage)->~T();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Static Functions
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator, typename Fn>
+inline bit::platform::channel_status
+  bit::platform::detail::select_case_impl<T,Allocator,Fn>
+  ::receive( select_case& base )
+{
+  auto& self    = static_cast<select_case_impl&>(base);
+  auto& channel = *self.m_channel;
+
+  std::unique_lock<spin_lock> lock(channel.m_lock);
+
+  const auto status = channel.try_pop( lock, reinterpret_cast<T*>(&self.m_storage), true );
+  self.m_has_value  = (status == channel_status::ok);
+
+  return status;
+}
+
+template<typename T, typename Allocator, typename Fn>
+inline void bit::platform::detail::select_case_impl<T,Allocator,Fn>
+  ::deliver( select_case& base )
+{
+  auto& self = static_cast<select_case_impl&>(base);
+  auto* p    = reinterpret_cast<T*>(&self.m_storage);
+
+  auto value = T( std::move(*p) );
+  p->~T();
+  self.m_has_value = false;
+
+  stl::invoke( self.m_function, std::move(value) );
+}
+
+//=============================================================================
+// Select
+//=============================================================================
+
+template<typename T, typename Allocator, typename Fn>
+inline bit::platform::detail::select_case_impl<T,Allocator,std::decay_t<Fn>>
+  bit::platform::on_recv( channel<T,Allocator>& channel, Fn&& fn )
+{
+  return detail::select_case_impl<T,Allocator,std::decay_t<Fn>>( channel, std::forward<Fn>(fn) );
+}
+
+template<typename...Cases>
+inline std::size_t bit::platform::select( Cases&&...cases )
+{
+  static_assert( sizeof...(Cases) > 0, "select requires at least one case" );
+
+  detail::select_case* list[] = { static_cast<detail::select_case*>(std::addressof(cases))... };
+  detail::channel_wait_node nodes[sizeof...(Cases)];
+
+  const auto index = detail::select( list, nodes, sizeof...(Cases), true );
+
+  if( index < sizeof...(Cases) ) {
+    list[index]->deliver( *list[index] );
+  }
+  return index;
+}
+
+template<typename...Cases>
+inline std::size_t bit::platform::try_select( Cases&&...cases )
+{
+  static_assert( sizeof...(Cases) > 0, "try_select requires at least one case" );
+
+  detail::select_case* list[] = { static_cast<detail::select_case*>(std::addressof(cases))... };
+
+  const auto index = detail::select( list, nullptr, sizeof...(Cases), false );
+
+  if( index < sizeof...(Cases) ) {
+    list[index]->deliver( *list[index] );
+  }
+  return index;
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_CHANNEL_INL */
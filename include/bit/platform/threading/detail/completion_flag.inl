@@ -0,0 +1,94 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_COMPLETION_FLAG_INL
+#define BIT_PLATFORM_THREADING_DETAIL_COMPLETION_FLAG_INL
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+inline bit::platform::completion_flag::completion_flag()
+  noexcept
+  : m_state(state_unsignaled)
+{
+
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+inline bool bit::platform::completion_flag::signaled()
+  const noexcept
+{
+  return m_state.load( std::memory_order_acquire ) == state_signaled;
+}
+
+//----------------------------------------------------------------------------
+// Waiting
+//----------------------------------------------------------------------------
+
+inline void bit::platform::completion_flag::wait()
+  const noexcept
+{
+  if( !prepare_wait() ) return;
+
+  blocking_region region;
+  do {
+    futex_wait( m_state, state_waiting );
+  } while( prepare_wait() );
+}
+
+template<typename Rep, typename Period>
+inline bool bit::platform::completion_flag
+  ::wait_for( const std::chrono::duration<Rep,Period>& duration )
+  const
+{
+  return wait_until( std::chrono::steady_clock::now() + duration );
+}
+
+template<typename Clock, typename Duration>
+inline bool bit::platform::completion_flag
+  ::wait_until( const std::chrono::time_point<Clock,Duration>& time_point )
+  const
+{
+  if( !prepare_wait() ) return true;
+
+  blocking_region region;
+  do {
+    const auto now = Clock::now();
+    if( now >= time_point ) return false;
+
+    futex_wait_for( m_state, state_waiting, time_point - now );
+  } while( prepare_wait() );
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Signaling
+//----------------------------------------------------------------------------
+
+inline void bit::platform::completion_flag::signal()
+  noexcept
+{
+  // The flag may be destroyed by a waiter as soon as the exchange is
+  // visible; waking only hashes the address, and never touches the flag
+  if( m_state.exchange( state_signaled ) == state_waiting ) {
+    futex_wake_all( m_state );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Private Observers
+//----------------------------------------------------------------------------
+
+inline bool bit::platform::completion_flag::prepare_wait()
+  const noexcept
+{
+  auto state = m_state.load( std::memory_order_acquire );
+
+  while( state == state_unsignaled ) {
+    if( m_state.compare_exchange_weak( state, state_waiting ) ) return true;
+  }
+  return state == state_waiting;
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_COMPLETION_FLAG_INL */
@@ -0,0 +1,725 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_HASH_MAP_INL
+#define BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_HASH_MAP_INL
+
+//=============================================================================
+// concurrent_hash_map::node
+//=============================================================================
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+template<typename K, typename M>
+inline bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node
+  ::node( size_type hash, K&& key, M&& value )
+  : hash(hash),
+    value(std::forward<K>(key), std::forward<M>(value))
+{
+
+}
+
+//=============================================================================
+// concurrent_hash_map::table
+//=============================================================================
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::table
+  ::table( size_type capacity )
+  noexcept
+  : capacity(capacity),
+    slots(nullptr),
+    used(0u),
+    next(nullptr),
+    cursor(0u),
+    moved(0u),
+    departed(0u)
+{
+
+}
+
+//=============================================================================
+// concurrent_hash_map
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+constexpr typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size_type
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::stripe_count;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+constexpr typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size_type
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::min_capacity;
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+constexpr typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size_type
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::migrate_chunk;
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::concurrent_hash_map()
+  : concurrent_hash_map( 0u )
+{
+
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::concurrent_hash_map( size_type capacity,
+                         const Hash& hash,
+                         const KeyEqual& equal,
+                         const Allocator& alloc )
+  : m_allocator(alloc),
+    m_hash(hash),
+    m_equal(equal),
+    m_table(nullptr),
+    m_size(0u),
+    m_stripes(),
+    m_epochs()
+{
+  // Tables resize once they are three quarters full
+  const auto wanted = capacity + capacity / 3u + 1u;
+
+  auto slots = min_capacity;
+  while( slots < wanted ) {
+    slots <<= 1u;
+  }
+  m_table.store( create_table( slots ), std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::~concurrent_hash_map()
+{
+  m_epochs.reclaim_all();
+
+  // Every entry is in exactly one slot of the tables that are still linked
+  for( auto t = m_table.load( std::memory_order_relaxed ); t != nullptr; ) {
+    for( auto i = size_type(0); i < t->capacity; ++i ) {
+      const auto current = t->slots[i].load( std::memory_order_relaxed );
+
+      if( is_entry( current ) ) {
+        destroy_node( current );
+      }
+    }
+
+    const auto next = t->next.load( std::memory_order_relaxed );
+    destroy_table( t );
+    t = next;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size_type
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size()
+  const noexcept
+{
+  return m_size.load( std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline Hash bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::hash_function()
+  const
+{
+  return m_hash;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline KeyEqual bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::key_eq()
+  const
+{
+  return m_equal;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline Allocator bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//-----------------------------------------------------------------------------
+// Lookup
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::find( const Key& key, T* value )
+  const
+{
+  BIT_ASSERT( value, "concurrent_hash_map::find: value cannot be null");
+
+  return visit( key, [value]( const value_type& entry )
+  {
+    (*value) = entry.second;
+  });
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::contains( const Key& key )
+  const
+{
+  return visit( key, []( const value_type& ){} );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+template<typename Fn>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::visit( const Key& key, Fn&& fn )
+  const
+{
+  const auto hash = mix( m_hash( key ) );
+  const detail::epoch_domain::guard guard( m_epochs );
+
+  // Lookups move a chunk too, so that a resize finishes without writes
+  help_migrate();
+
+  const auto n = find_node( key, hash );
+  if( n == nullptr ) return false;
+
+  fn( static_cast<const value_type&>(n->value) );
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+template<typename M>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::insert_or_assign( const Key& key, M&& value )
+{
+  const auto hash = mix( m_hash( key ) );
+
+  return assign( create_node( hash, key, std::forward<M>(value) ) );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+template<typename M>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::insert_or_assign( Key&& key, M&& value )
+{
+  const auto hash = mix( m_hash( key ) );
+
+  return assign( create_node( hash, std::move(key), std::forward<M>(value) ) );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::erase( const Key& key )
+{
+  const auto hash = mix( m_hash( key ) );
+  const detail::epoch_domain::guard guard( m_epochs );
+
+  help_migrate();
+
+  auto erased = static_cast<node*>(nullptr);
+  {
+    std::lock_guard<spin_lock> lock( stripe_for( hash ) );
+
+    // The key is in the newest table, if anywhere, and cannot be moved out
+    // of it while the stripe is locked
+    const auto t    = writable_table( key, hash );
+    const auto mask = t->capacity - 1u;
+
+    for( auto i = size_type(0); i < t->capacity; ++i ) {
+      auto& slot = t->slots[(hash + i) & mask];
+      const auto current = slot.load( std::memory_order_acquire );
+
+      if( current == nullptr || current == closed() ) break;
+      if( !is_entry( current ) ) continue;
+
+      if( current->hash == hash && m_equal( current->value.first, key ) ) {
+        slot.store( tombstone(), std::memory_order_release );
+        erased = current;
+        break;
+      }
+    }
+  }
+
+  if( erased == nullptr ) return false;
+
+  m_size.fetch_sub( 1u, std::memory_order_relaxed );
+  m_epochs.retire( erased, &reclaim_node, this );
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::size_type
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::mix( size_type hash )
+  noexcept
+{
+  // The finalizer of MurmurHash3
+  auto h = static_cast<std::uint64_t>(hash);
+  h ^= h >> 33u;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33u;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33u;
+  return static_cast<size_type>(h);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::tombstone()
+  noexcept
+{
+  return reinterpret_cast<node*>(std::uintptr_t(1u));
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::moved()
+  noexcept
+{
+  return reinterpret_cast<node*>(std::uintptr_t(2u));
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::closed()
+  noexcept
+{
+  return reinterpret_cast<node*>(std::uintptr_t(3u));
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::is_entry( const node* p )
+  noexcept
+{
+  return reinterpret_cast<std::uintptr_t>(p) > 3u;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bit::platform::spin_lock&
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::stripe_for( size_type hash )
+  const noexcept
+{
+  return m_stripes[(hash >> 16u) % stripe_count].lock;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline const typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::find_node( const Key& key, size_type hash )
+  const
+{
+  // An entry is moved into the next table before its slot is marked as
+  // moved, so searching the tables in order never misses it. An entry is
+  // never stored past an empty slot of its probe, and closing that slot
+  // does not change this
+  for( auto t = m_table.load( std::memory_order_acquire ); t != nullptr;
+       t = t->next.load( std::memory_order_acquire ) ) {
+    const auto mask = t->capacity - 1u;
+
+    for( auto i = size_type(0); i < t->capacity; ++i ) {
+      const auto current = t->slots[(hash + i) & mask].load( std::memory_order_acquire );
+
+      if( current == nullptr || current == closed() ) break;
+      if( !is_entry( current ) ) continue;
+
+      if( current->hash == hash && m_equal( current->value.first, key ) ) {
+        return current;
+      }
+    }
+  }
+  return nullptr;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline bool bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::assign( node* n )
+{
+  const detail::epoch_domain::guard guard( m_epochs );
+
+  auto replaced  = static_cast<node*>(nullptr);
+  auto full      = static_cast<table*>(nullptr);
+  auto published = false;
+
+  try {
+    while( !published ) {
+      help_migrate();
+
+      // A table that cannot take the entry. Growing it may need to move
+      // entries of this stripe, so it is done with the stripe unlocked
+      auto blocked = static_cast<table*>(nullptr);
+      {
+        std::lock_guard<spin_lock> lock( stripe_for( n->hash ) );
+
+        // The key is in the newest table, if anywhere, and cannot be moved
+        // out of it while the stripe is locked
+        const auto t    = writable_table( n->value.first, n->hash );
+        const auto mask = t->capacity - 1u;
+
+        blocked = t;
+        for( auto i = size_type(0); i < t->capacity; ++i ) {
+          auto& slot = t->slots[(n->hash + i) & mask];
+          auto current = slot.load( std::memory_order_acquire );
+
+          // The table started resizing; the entry belongs in the next one
+          if( current == closed() ) {
+            blocked = nullptr;
+            break;
+          }
+
+          // Erased slots are not reused, so that resizing never has to
+          // close them against writers
+          if( current == tombstone() || current == moved() ) continue;
+
+          if( current == nullptr ) {
+            // A table that is being resized into stops taking entries once
+            // the ones still left in the oldest table would push it past
+            // its load limit, so that the rest of the move always fits
+            const auto oldest = m_table.load( std::memory_order_acquire );
+            if( t != oldest ) {
+              const auto departed = oldest->departed.load( std::memory_order_relaxed );
+              const auto used     = oldest->used.load( std::memory_order_relaxed );
+              const auto left     = used > departed ? used - departed : 0u;
+
+              if( (t->used.load( std::memory_order_relaxed ) + left) * 4u > t->capacity * 3u ) {
+                break;
+              }
+            }
+
+            blocked = nullptr;
+
+            // Writers of other stripes, or the resize, may claim the slot
+            if( slot.compare_exchange_strong( current, n, std::memory_order_acq_rel,
+                                                          std::memory_order_acquire ) ) {
+              const auto used = t->used.fetch_add( 1u, std::memory_order_relaxed ) + 1u;
+
+              if( used * 4u > t->capacity * 3u ) full = t;
+              published = true;
+            }
+            break;
+          }
+
+          // No other writer can touch the slot of a key in this stripe
+          if( current->hash == n->hash && m_equal( current->value.first, n->value.first ) ) {
+            slot.store( n, std::memory_order_release );
+            replaced  = current;
+            published = true;
+            blocked   = nullptr;
+            break;
+          }
+        }
+      }
+
+      if( blocked == nullptr ) continue;
+
+      if( blocked == m_table.load( std::memory_order_acquire ) ) {
+        start_resize( *blocked );
+      } else {
+        complete_migrate();
+      }
+    }
+  } catch( ... ) {
+    if( !published ) destroy_node( n );
+    throw;
+  }
+
+  if( replaced != nullptr ) {
+    m_epochs.retire( replaced, &reclaim_node, this );
+    return false;
+  }
+
+  m_size.fetch_add( 1u, std::memory_order_relaxed );
+  if( full != nullptr ) {
+    // The table grew past its load limit while it was still being resized
+    // into; it can only be resized once it is the oldest
+    if( full != m_table.load( std::memory_order_acquire ) ) {
+      complete_migrate();
+    }
+    start_resize( *full );
+    help_migrate();
+  }
+  return true;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::table*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::writable_table( const Key& key, size_type hash )
+{
+  auto t = m_table.load( std::memory_order_acquire );
+
+  for( auto next = t->next.load( std::memory_order_acquire ); next != nullptr;
+       next = t->next.load( std::memory_order_acquire ) ) {
+    move_key( *t, key, hash, *next );
+    t = next;
+  }
+  return t;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::move_key( table& from, const Key& key, size_type hash, table& to )
+{
+  const auto mask = from.capacity - 1u;
+
+  for( auto i = size_type(0); i < from.capacity; ++i ) {
+    auto& slot = from.slots[(hash + i) & mask];
+    const auto current = slot.load( std::memory_order_acquire );
+
+    if( current == nullptr || current == closed() ) return;
+    if( !is_entry( current ) ) continue;
+
+    if( current->hash == hash && m_equal( current->value.first, key ) ) {
+      insert_moved( to, current );
+      slot.store( moved(), std::memory_order_release );
+      from.departed.fetch_add( 1u, std::memory_order_relaxed );
+      return;
+    }
+  }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::help_migrate()
+  const
+{
+  const auto t    = m_table.load( std::memory_order_acquire );
+  const auto next = t->next.load( std::memory_order_acquire );
+
+  if( next == nullptr ) return;
+
+  // Once every chunk is claimed, lookups stop touching the cursor
+  if( t->cursor.load( std::memory_order_relaxed ) >= t->capacity ) return;
+
+  const auto first = t->cursor.fetch_add( migrate_chunk, std::memory_order_relaxed );
+  if( first >= t->capacity ) return;
+
+  const auto last = std::min( first + migrate_chunk, t->capacity );
+  for( auto i = first; i < last; ++i ) {
+    migrate_slot( *t, i, *next );
+  }
+
+  // Whoever moves the last chunk retires the table
+  const auto count = last - first;
+  if( t->moved.fetch_add( count, std::memory_order_acq_rel ) + count == t->capacity ) {
+    finish_migrate( *t, *next );
+  }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::complete_migrate()
+  const
+{
+  const auto t    = m_table.load( std::memory_order_acquire );
+  const auto next = t->next.load( std::memory_order_acquire );
+
+  if( next == nullptr ) return;
+
+  // Moving a slot twice is harmless, so this does not wait for the chunks
+  // that other threads have claimed
+  for( auto i = size_type(0); i < t->capacity; ++i ) {
+    migrate_slot( *t, i, *next );
+  }
+  finish_migrate( *t, *next );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::finish_migrate( table& from, table& to )
+  const
+{
+  auto expected = &from;
+
+  if( m_table.compare_exchange_strong( expected, &to, std::memory_order_acq_rel ) ) {
+    // Lookups may finish a resize too; reclaiming only touches the allocator
+    m_epochs.retire( &from, &reclaim_table, const_cast<concurrent_hash_map*>(this) );
+  }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::migrate_slot( table& from, size_type index, table& to )
+  const
+{
+  auto& slot   = from.slots[index];
+  auto current = slot.load( std::memory_order_acquire );
+
+  // Empty slots are closed, so that writers of the old table move on.
+  // Erased slots stay as they are, since writers never reuse them
+  while( current == nullptr ) {
+    slot.compare_exchange_weak( current, closed(), std::memory_order_acq_rel,
+                                                   std::memory_order_acquire );
+  }
+
+  while( is_entry( current ) ) {
+    std::lock_guard<spin_lock> lock( stripe_for( current->hash ) );
+
+    // A writer may have replaced, erased, or moved the entry meanwhile
+    if( slot.load( std::memory_order_acquire ) == current ) {
+      insert_moved( to, current );
+      slot.store( moved(), std::memory_order_release );
+      from.departed.fetch_add( 1u, std::memory_order_relaxed );
+      return;
+    }
+    current = slot.load( std::memory_order_acquire );
+  }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::start_resize( table& t )
+{
+  if( &t != m_table.load( std::memory_order_acquire ) ||
+      t.next.load( std::memory_order_acquire ) != nullptr ) {
+    return;
+  }
+
+  // Room for every entry, and for the entries that can be inserted while
+  // the move is in progress, at under half load
+  const auto wanted = 2u * (m_size.load( std::memory_order_relaxed ) + t.capacity / migrate_chunk);
+
+  auto capacity = min_capacity;
+  while( capacity < wanted ) {
+    capacity <<= 1u;
+  }
+
+  auto fresh    = create_table( capacity );
+  auto expected = static_cast<table*>(nullptr);
+  if( !t.next.compare_exchange_strong( expected, fresh, std::memory_order_acq_rel ) ) {
+    destroy_table( fresh );
+  }
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+template<typename...Args>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::node*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::create_node( Args&&...args )
+{
+  auto n = node_traits::allocate( m_allocator, 1u );
+
+  try {
+    node_traits::construct( m_allocator, n, std::forward<Args>(args)... );
+  } catch( ... ) {
+    node_traits::deallocate( m_allocator, n, 1u );
+    throw;
+  }
+  return n;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::destroy_node( node* n )
+  noexcept
+{
+  node_traits::destroy( m_allocator, n );
+  node_traits::deallocate( m_allocator, n, 1u );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline typename bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>::table*
+  bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::create_table( size_type capacity )
+{
+  auto table_alloc = table_allocator( m_allocator );
+  auto slot_alloc  = slot_allocator( m_allocator );
+
+  auto t = table_traits::allocate( table_alloc, 1u );
+  table_traits::construct( table_alloc, t, capacity );
+
+  try {
+    t->slots = slot_traits::allocate( slot_alloc, capacity );
+  } catch( ... ) {
+    table_traits::destroy( table_alloc, t );
+    table_traits::deallocate( table_alloc, t, 1u );
+    throw;
+  }
+
+  for( auto i = size_type(0); i < capacity; ++i ) {
+    slot_traits::construct( slot_alloc, t->slots + i, nullptr );
+  }
+  return t;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::destroy_table( table* t )
+  const noexcept
+{
+  auto table_alloc = table_allocator( m_allocator );
+  auto slot_alloc  = slot_allocator( m_allocator );
+
+  for( auto i = size_type(0); i < t->capacity; ++i ) {
+    slot_traits::destroy( slot_alloc, t->slots + i );
+  }
+  slot_traits::deallocate( slot_alloc, t->slots, t->capacity );
+
+  table_traits::destroy( table_alloc, t );
+  table_traits::deallocate( table_alloc, t, 1u );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::insert_moved( table& to, node* n )
+  noexcept
+{
+  const auto mask = to.capacity - 1u;
+
+  for( auto i = size_type(0); i < to.capacity; ++i ) {
+    auto& slot   = to.slots[(n->hash + i) & mask];
+    auto current = slot.load( std::memory_order_acquire );
+
+    while( current == nullptr || current == tombstone() ) {
+      if( slot.compare_exchange_weak( current, n, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire ) ) {
+        if( current == nullptr ) to.used.fetch_add( 1u, std::memory_order_relaxed );
+        return;
+      }
+    }
+  }
+
+  BIT_ASSERT( false, "concurrent_hash_map: resized table is full" );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::reclaim_node( void* map, void* p )
+  noexcept
+{
+  static_cast<concurrent_hash_map*>(map)->destroy_node( static_cast<node*>(p) );
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+inline void bit::platform::concurrent_hash_map<Key,T,Hash,KeyEqual,Allocator>
+  ::reclaim_table( void* map, void* p )
+  noexcept
+{
+  static_cast<concurrent_hash_map*>(map)->destroy_table( static_cast<table*>(p) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_HASH_MAP_INL */
@@ -0,0 +1,552 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_PRIORITY_QUEUE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_PRIORITY_QUEUE_INL
+
+//=============================================================================
+// concurrent_priority_queue::request
+//=============================================================================
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::concurrent_priority_queue<T,Compare,Allocator>::request
+  ::request()
+  noexcept
+  : state(slot_free),
+    apply(nullptr),
+    operation(nullptr),
+    error()
+{
+
+}
+
+//=============================================================================
+// concurrent_priority_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+constexpr std::uint32_t bit::platform::concurrent_priority_queue<T,Compare,Allocator>::slot_free;
+template<typename T, typename Compare, typename Allocator>
+constexpr std::uint32_t bit::platform::concurrent_priority_queue<T,Compare,Allocator>::slot_claimed;
+template<typename T, typename Compare, typename Allocator>
+constexpr std::uint32_t bit::platform::concurrent_priority_queue<T,Compare,Allocator>::slot_pending;
+template<typename T, typename Compare, typename Allocator>
+constexpr std::uint32_t bit::platform::concurrent_priority_queue<T,Compare,Allocator>::slot_done;
+template<typename T, typename Compare, typename Allocator>
+constexpr typename bit::platform::concurrent_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::concurrent_priority_queue<T,Compare,Allocator>::slot_count;
+
+//-----------------------------------------------------------------------------
+// Constructors
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::concurrent_priority_queue()
+  : concurrent_priority_queue( Compare() )
+{
+
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::concurrent_priority_queue( const Compare& compare, const Allocator& alloc )
+  : m_heap(alloc),
+    m_compare{compare},
+    m_size(0u),
+    m_combiner(),
+    m_requests()
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bool bit::platform::concurrent_priority_queue<T,Compare,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::concurrent_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::concurrent_priority_queue<T,Compare,Allocator>::size()
+  const noexcept
+{
+  return m_size.load( std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline Allocator
+  bit::platform::concurrent_priority_queue<T,Compare,Allocator>::get_allocator()
+  const
+{
+  return m_heap.get_allocator();
+}
+
+//-----------------------------------------------------------------------------
+// Element Access
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bool bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::try_pop_min( T* value )
+{
+  BIT_ASSERT( value, "concurrent_priority_queue::try_pop_min: value cannot be null");
+
+  if( empty() ) return false;
+
+  auto result = false;
+  auto operation = [value,&result]( concurrent_priority_queue& queue )
+  {
+    if( queue.m_heap.empty() ) return;
+
+    (*value) = queue.pop_heap();
+    result   = true;
+  };
+  execute( operation );
+
+  return result;
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename OutputIterator>
+inline typename bit::platform::concurrent_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::try_pop_n( OutputIterator out, size_type max )
+{
+  if( max == 0u || empty() ) return 0u;
+
+  auto count = size_type(0);
+  auto operation = [&out,&count,max]( concurrent_priority_queue& queue )
+  {
+    for( ; count < max && !queue.m_heap.empty(); ++count ) {
+      (*out) = queue.pop_heap();
+      ++out;
+    }
+  };
+  execute( operation );
+
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::push( const T& value )
+{
+  auto operation = [&value]( concurrent_priority_queue& queue )
+  {
+    queue.m_heap.push_back( value );
+    std::push_heap( queue.m_heap.begin(), queue.m_heap.end(), queue.m_compare );
+  };
+  execute( operation );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::push( T&& value )
+{
+  auto operation = [&value]( concurrent_priority_queue& queue )
+  {
+    queue.m_heap.push_back( std::move(value) );
+    std::push_heap( queue.m_heap.begin(), queue.m_heap.end(), queue.m_compare );
+  };
+  execute( operation );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>::clear()
+{
+  auto operation = []( concurrent_priority_queue& queue )
+  {
+    queue.m_heap.clear();
+  };
+  execute( operation );
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+template<typename Operation>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::execute( Operation& operation )
+{
+  auto& slot = claim_request();
+
+  slot.apply     = &apply_operation<Operation>;
+  slot.operation = &operation;
+  slot.state.store( slot_pending, std::memory_order_release );
+
+  // Either some other thread combines this request, or this thread becomes
+  // the combiner and applies it along with everyone else's
+  while( slot.state.load( std::memory_order_acquire ) != slot_done ) {
+    if( m_combiner.try_lock() ) {
+      combine();
+      m_combiner.unlock();
+      continue;
+    }
+
+    yield_lease();
+    std::this_thread::yield();
+  }
+
+  auto error = std::move(slot.error);
+  slot.error = nullptr;
+  slot.state.store( slot_free, std::memory_order_release );
+
+  if( error ) std::rethrow_exception( error );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>::combine()
+  noexcept
+{
+  for( auto& slot : m_requests ) {
+    if( slot.state.load( std::memory_order_acquire ) != slot_pending ) continue;
+
+    try {
+      slot.apply( slot.operation, *this );
+    } catch( ... ) {
+      slot.error = std::current_exception();
+    }
+
+    // Published before the request completes, so that a thread that saw
+    // the request complete never reads an older size
+    m_size.store( m_heap.size(), std::memory_order_relaxed );
+    slot.state.store( slot_done, std::memory_order_release );
+  }
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::concurrent_priority_queue<T,Compare,Allocator>::request&
+  bit::platform::concurrent_priority_queue<T,Compare,Allocator>::claim_request()
+  noexcept
+{
+  while( true ) {
+    const auto start = detail::this_thread_random();
+
+    for( auto i = size_type(0); i < slot_count; ++i ) {
+      auto& slot  = m_requests[(start + i) % slot_count];
+      auto  state = slot_free;
+
+      if( slot.state.compare_exchange_strong( state, slot_claimed,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed ) ) {
+        return slot;
+      }
+    }
+
+    // Every slot is in use; wait for one to be released
+    yield_lease();
+    std::this_thread::yield();
+  }
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename Operation>
+inline void bit::platform::concurrent_priority_queue<T,Compare,Allocator>
+  ::apply_operation( void* operation, concurrent_priority_queue& queue )
+{
+  (*static_cast<Operation*>(operation))( queue );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline T bit::platform::concurrent_priority_queue<T,Compare,Allocator>::pop_heap()
+{
+  std::pop_heap( m_heap.begin(), m_heap.end(), m_compare );
+
+  auto result = std::move(m_heap.back());
+  m_heap.pop_back();
+  return result;
+}
+
+//=============================================================================
+// relaxed_priority_queue::sub_heap
+//=============================================================================
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::relaxed_priority_queue<T,Compare,Allocator>::sub_heap
+  ::sub_heap( const Allocator& alloc )
+  : lock(),
+    entries(alloc)
+{
+
+}
+
+//=============================================================================
+// relaxed_priority_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::relaxed_priority_queue()
+  : relaxed_priority_queue( available_concurrency() * 2u )
+{
+
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::relaxed_priority_queue( size_type heaps,
+                            const Compare& compare,
+                            const Allocator& alloc )
+  : m_allocator(alloc),
+    m_heaps(nullptr),
+    m_count(heaps == 0u ? 1u : heaps),
+    m_compare{compare},
+    m_size(0u)
+{
+  m_heaps = sub_heap_traits::allocate( m_allocator, m_count );
+
+  auto constructed = size_type(0);
+  try {
+    for( ; constructed < m_count; ++constructed ) {
+      sub_heap_traits::construct( m_allocator, m_heaps + constructed, alloc );
+    }
+  } catch( ... ) {
+    for( auto i = size_type(0); i < constructed; ++i ) {
+      sub_heap_traits::destroy( m_allocator, m_heaps + i );
+    }
+    sub_heap_traits::deallocate( m_allocator, m_heaps, m_count );
+    throw;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::~relaxed_priority_queue()
+{
+  for( auto i = size_type(0); i < m_count; ++i ) {
+    sub_heap_traits::destroy( m_allocator, m_heaps + i );
+  }
+  sub_heap_traits::deallocate( m_allocator, m_heaps, m_count );
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bool bit::platform::relaxed_priority_queue<T,Compare,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::relaxed_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>::size()
+  const noexcept
+{
+  return m_size.load( std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::relaxed_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>::heap_count()
+  const noexcept
+{
+  return m_count;
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::relaxed_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>::rank_error_bound()
+  const noexcept
+{
+  return m_count;
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline Allocator
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//-----------------------------------------------------------------------------
+// Element Access
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline bool bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::try_pop_min( T* value )
+{
+  BIT_ASSERT( value, "relaxed_priority_queue::try_pop_min: value cannot be null");
+
+  return pop_entry( [value]( T& entry )
+  {
+    (*value) = std::move(entry);
+  });
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename OutputIterator>
+inline typename bit::platform::relaxed_priority_queue<T,Compare,Allocator>::size_type
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::try_pop_n( OutputIterator out, size_type max )
+{
+  auto consume = [&out]( T& entry )
+  {
+    (*out) = std::move(entry);
+    ++out;
+  };
+
+  auto count = size_type(0);
+  while( count < max && pop_entry( consume ) ) {
+    ++count;
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::push( const T& value )
+{
+  push_entry( value );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::push( T&& value )
+{
+  push_entry( std::move(value) );
+}
+
+template<typename T, typename Compare, typename Allocator>
+inline void bit::platform::relaxed_priority_queue<T,Compare,Allocator>::clear()
+{
+  for( auto i = size_type(0); i < m_count; ++i ) {
+    auto& heap = m_heaps[i];
+    std::lock_guard<spin_lock> lock(heap.lock);
+
+    m_size.fetch_sub( heap.entries.size(), std::memory_order_relaxed );
+    heap.entries.clear();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Compare, typename Allocator>
+inline typename bit::platform::relaxed_priority_queue<T,Compare,Allocator>::sub_heap&
+  bit::platform::relaxed_priority_queue<T,Compare,Allocator>::random_heap()
+  noexcept
+{
+  return m_heaps[detail::this_thread_random() % m_count];
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename U>
+inline void bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::push_entry( U&& value )
+{
+  while( true ) {
+    auto& heap = random_heap();
+
+    // A locked heap is busy; any other heap will do just as well
+    std::unique_lock<spin_lock> lock(heap.lock, std::try_to_lock);
+    if( !lock.owns_lock() ) continue;
+
+    heap.entries.push_back( std::forward<U>(value) );
+    std::push_heap( heap.entries.begin(), heap.entries.end(), m_compare );
+    m_size.fetch_add( 1u, std::memory_order_relaxed );
+    return;
+  }
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename Consume>
+inline bool bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::pop_entry( Consume&& consume )
+{
+  if( empty() ) return false;
+
+  for( auto attempt = size_type(0); attempt < m_count; ++attempt ) {
+    auto& first  = random_heap();
+    auto& second = random_heap();
+
+    std::unique_lock<spin_lock> lock1(first.lock, std::try_to_lock);
+    if( !lock1.owns_lock() ) continue;
+
+    auto best = first.entries.empty() ? nullptr : &first;
+
+    std::unique_lock<spin_lock> lock2;
+    if( &second != &first ) {
+      lock2 = std::unique_lock<spin_lock>(second.lock, std::try_to_lock);
+
+      if( lock2.owns_lock() && !second.entries.empty() &&
+          (best == nullptr || m_compare.compare( second.entries.front(), best->entries.front() )) ) {
+        best = &second;
+      }
+    }
+
+    if( best != nullptr ) {
+      pop_from( *best, consume );
+      return true;
+    }
+  }
+
+  // The sampled heaps kept coming up empty or busy; check every heap before
+  // reporting that the queue is empty
+  for( auto i = size_type(0); i < m_count; ++i ) {
+    auto& heap = m_heaps[i];
+    std::lock_guard<spin_lock> lock(heap.lock);
+
+    if( !heap.entries.empty() ) {
+      pop_from( heap, consume );
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T, typename Compare, typename Allocator>
+template<typename Consume>
+inline void bit::platform::relaxed_priority_queue<T,Compare,Allocator>
+  ::pop_from( sub_heap& heap, Consume& consume )
+{
+  std::pop_heap( heap.entries.begin(), heap.entries.end(), m_compare );
+
+  try {
+    consume( heap.entries.back() );
+  } catch( ... ) {
+    // Keep the entry, and the heap intact
+    std::push_heap( heap.entries.begin(), heap.entries.end(), m_compare );
+    throw;
+  }
+  heap.entries.pop_back();
+  m_size.fetch_sub( 1u, std::memory_order_relaxed );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_CONCURRENT_PRIORITY_QUEUE_INL */
@@ -15,7 +15,8 @@ bit::platform::concurrent_queue<T,Lock,Allocator>::concurrent_queue()
 template<typename T, typename Lock, typename Allocator>
 bit::platform::concurrent_queue<T,Lock,Allocator>
   ::concurrent_queue( const Allocator& alloc )
-  : m_queue( alloc )
+  : m_queue( alloc ),
+    m_spare( alloc )
 {
 
 }
@@ -23,7 +24,8 @@ bit::platform::concurrent_queue<T,Lock,Allocator>
 template<typename T, typename Lock, typename Allocator>
 bit::platform::concurrent_queue<T,Lock,Allocator>
   ::concurrent_queue( concurrent_queue&& other )
-  : concurrent_queue( std::move(other), Allocator() )
+  : m_queue( std::move(other.m_queue) ),
+    m_spare( m_queue.get_allocator() )
 {
 
 }
@@ -31,7 +33,8 @@ bit::platform::concurrent_queue<T,Lock,Allocator>
 template<typename T, typename Lock, typename Allocator>
 bit::platform::concurrent_queue<T,Lock,Allocator>
   ::concurrent_queue( concurrent_queue&& other, const Allocator& alloc )
-  : m_queue( std::move(other.m_queue), alloc )
+  : m_queue( std::move(other.m_queue), alloc ),
+    m_spare( alloc )
 {
 
 }
@@ -66,6 +69,14 @@ typename bit::platform::concurrent_queue<T,Lock,Allocator>::size_type
   return m_queue.size();
 }
 
+template<typename T, typename Lock, typename Allocator>
+void bit::platform::concurrent_queue<T,Lock,Allocator>::reserve( size_type n )
+{
+  std::lock_guard<lock_type> lock(m_lock);
+
+  m_queue.reserve( n );
+}
+
 //----------------------------------------------------------------------------
 // Size
 //----------------------------------------------------------------------------
@@ -126,6 +137,37 @@ void bit::platform::concurrent_queue<T,Lock,Allocator>
   m_cv.notify_one();
 }
 
+template<typename T, typename Lock, typename Allocator>
+template<typename InputIterator>
+void bit::platform::concurrent_queue<T,Lock,Allocator>
+  ::push_range( InputIterator first, InputIterator last )
+{
+  auto count = size_type(0);
+  {
+    std::lock_guard<lock_type> lock(m_lock);
+
+    for( ; first != last; ++first, ++count ) {
+      m_queue.push( *first );
+    }
+  }
+  notify( count );
+}
+
+template<typename T, typename Lock, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,const Args&...>::value>*>
+void bit::platform::concurrent_queue<T,Lock,Allocator>
+  ::emplace_n( size_type n, const Args&...args )
+{
+  {
+    std::lock_guard<lock_type> lock(m_lock);
+
+    for( auto i = size_type(0); i < n; ++i ) {
+      m_queue.emplace( args... );
+    }
+  }
+  notify( n );
+}
+
 //----------------------------------------------------------------------------
 
 
@@ -134,16 +176,61 @@ bool bit::platform::concurrent_queue<T,Lock,Allocator>::try_pop( T* value )
 {
   BIT_ASSERT( value, "concurrent_queue::pop: value cannot be null");
 
-  std::unique_lock<std::mutex> lock(m_lock);
+  std::lock_guard<lock_type> lock(m_lock);
 
   if( m_queue.empty() ) return false;
 
-  m_cv.wait(lock, [&]{ return !m_queue.empty(); });
   (*value) = std::move(m_queue.front());
   m_queue.pop();
   return true;
 }
 
+template<typename T, typename Lock, typename Allocator>
+template<typename OutputIterator>
+typename bit::platform::concurrent_queue<T,Lock,Allocator>::size_type
+  bit::platform::concurrent_queue<T,Lock,Allocator>
+  ::try_pop_n( OutputIterator out, size_type max )
+{
+  std::lock_guard<lock_type> lock(m_lock);
+
+  auto count = size_type(0);
+  for( ; count < max && !m_queue.empty(); ++count ) {
+    (*out) = std::move(m_queue.front());
+    ++out;
+    m_queue.pop();
+  }
+  return count;
+}
+
+template<typename T, typename Lock, typename Allocator>
+template<typename OutputIterator>
+typename bit::platform::concurrent_queue<T,Lock,Allocator>::size_type
+  bit::platform::concurrent_queue<T,Lock,Allocator>
+  ::pop_all( OutputIterator out )
+{
+  auto entries = container( m_queue.get_allocator() );
+  {
+    std::lock_guard<lock_type> lock(m_lock);
+
+    if( m_queue.empty() ) return 0u;
+    m_queue.swap( entries );
+    m_queue.swap( m_spare );
+  }
+
+  const auto count = entries.size();
+  for( ; !entries.empty(); entries.pop() ) {
+    (*out) = std::move(entries.front());
+    ++out;
+  }
+
+  // Keep the larger of the two storages for the next call
+  std::lock_guard<lock_type> lock(m_lock);
+  if( entries.capacity() > m_spare.capacity() ) {
+    m_spare.swap( entries );
+  }
+  return count;
+}
+
 template<typename T, typename Lock, typename Allocator>
 bool bit::platform::concurrent_queue<T,Lock,Allocator>
   ::try_push_back( const T& value )
@@ -151,7 +238,7 @@ bool bit::platform::concurrent_queue<T,Lock,Allocator>
   std::unique_lock<lock_type> lock(m_lock, std::try_to_lock);
   if( !lock.owns_lock() ) return false;
 
-  m_queue.push_back( value );
+  m_queue.push( value );
   lock.unlock();
   m_cv.notify_one();
   return true;
@@ -164,7 +251,7 @@ bool bit::platform::concurrent_queue<T,Lock,Allocator>
   std::unique_lock<lock_type> lock(m_lock, std::try_to_lock);
   if( !lock.owns_lock() ) return false;
 
-  m_queue.push_back( std::move(value) );
+  m_queue.push( std::move(value) );
   lock.unlock();
   m_cv.notify_one();
   return true;
@@ -191,7 +278,7 @@ void bit::platform::concurrent_queue<T,Lock,Allocator>::clear()
 {
   std::lock_guard<lock_type> lock(m_lock);
 
-  m_queue = {};
+  m_queue.clear();
 }
 
 
@@ -207,6 +294,20 @@ void bit::platform::concurrent_queue<T,Lock,Allocator>
   m_queue.swap(other.m_queue);
 }
 
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Lock, typename Allocator>
+void bit::platform::concurrent_queue<T,Lock,Allocator>::notify( size_type count )
+{
+  if( count == 1u ) {
+    m_cv.notify_one();
+  } else if( count > 1u ) {
+    m_cv.notify_all();
+  }
+}
+
 //----------------------------------------------------------------------------
 // Free Functions
 //----------------------------------------------------------------------------
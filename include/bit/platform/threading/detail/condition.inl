@@ -0,0 +1,110 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_CONDITION_INL
+#define BIT_PLATFORM_THREADING_DETAIL_CONDITION_INL
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+inline bit::platform::condition::condition()
+  noexcept
+  : m_sequence(0u),
+    m_waiters(0u)
+{
+
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+inline bool bit::platform::condition::has_waiters()
+  const noexcept
+{
+  return m_waiters.load( std::memory_order_relaxed ) != 0u;
+}
+
+//----------------------------------------------------------------------------
+// Waiting
+//----------------------------------------------------------------------------
+
+template<typename Lock>
+inline void bit::platform::condition::wait( Lock& lock )
+{
+  // Both are done under the lock, which orders them before any state change
+  // that a notifier makes under the same lock
+  const auto sequence = m_sequence.load( std::memory_order_relaxed );
+  m_waiters.fetch_add( 1u, std::memory_order_relaxed );
+
+  lock.unlock();
+  {
+    blocking_region region;
+    futex_wait( m_sequence, sequence );
+  }
+  m_waiters.fetch_sub( 1u, std::memory_order_relaxed );
+  lock.lock();
+}
+
+template<typename Lock, typename Predicate>
+inline void bit::platform::condition::wait( Lock& lock, Predicate predicate )
+{
+  while( !predicate() ) {
+    wait( lock );
+  }
+}
+
+template<typename Lock, typename Rep, typename Period, typename Predicate>
+inline bool bit::platform::condition
+  ::wait_for( Lock& lock,
+              const std::chrono::duration<Rep,Period>& duration,
+              Predicate predicate )
+{
+  return wait_until( lock, std::chrono::steady_clock::now() + duration, predicate );
+}
+
+template<typename Lock, typename Clock, typename Duration, typename Predicate>
+inline bool bit::platform::condition
+  ::wait_until( Lock& lock,
+                const std::chrono::time_point<Clock,Duration>& time_point,
+                Predicate predicate )
+{
+  while( !predicate() ) {
+    const auto now = Clock::now();
+    if( now >= time_point ) return predicate();
+
+    const auto sequence = m_sequence.load( std::memory_order_relaxed );
+    m_waiters.fetch_add( 1u, std::memory_order_relaxed );
+
+    lock.unlock();
+    {
+      blocking_region region;
+      futex_wait_for( m_sequence, sequence, time_point - now );
+    }
+    m_waiters.fetch_sub( 1u, std::memory_order_relaxed );
+    lock.lock();
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Notification
+//----------------------------------------------------------------------------
+
+inline void bit::platform::condition::notify_one()
+  noexcept
+{
+  if( m_waiters.load( std::memory_order_relaxed ) == 0u ) return;
+
+  m_sequence.fetch_add( 1u, std::memory_order_relaxed );
+  futex_wake_one( m_sequence );
+}
+
+inline void bit::platform::condition::notify_all()
+  noexcept
+{
+  if( m_waiters.load( std::memory_order_relaxed ) == 0u ) return;
+
+  m_sequence.fetch_add( 1u, std::memory_order_relaxed );
+  futex_wake_all( m_sequence );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_CONDITION_INL */
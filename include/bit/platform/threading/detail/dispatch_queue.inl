@@ -44,7 +44,7 @@ namespace bit { namespace platform { namespace detail {
       dispatch_queue.post_job( std::move(job) );
       dispatch_queue.wait( handle );
 
-      return std::move( *static_cast<T*>(&storage) );
+      return std::move( *reinterpret_cast<T*>(&storage) );
     }
   };
 
@@ -103,7 +103,7 @@ namespace bit { namespace platform { namespace detail {
       });
 
       auto handle = job_handle(job);
-      dispatch_queue.post_job( job );
+      dispatch_queue.post_job( std::move(job) );
       dispatch_queue.wait( handle );
     }
 
@@ -138,7 +138,6 @@ void bit::platform::dispatch_queue::post( Fn&& fn, Args&&...args )
   auto job = make_job( std::forward<Fn>(fn), std::forward<Args>(args)... );
 
   post_job( std::move(job) );
-  m_cv.notify_all();
 }
 
 template<typename Fn, typename...Args>
@@ -147,7 +146,6 @@ void bit::platform::dispatch_queue::post( const job& parent, Fn&& fn, Args&&...a
   auto job = make_job( parent, std::forward<Fn>(fn), std::forward<Args>(args)... );
 
   post_job( std::move(job) );
-  m_cv.notify_all();
 }
 
 //-----------------------------------------------------------------------------
@@ -238,6 +238,30 @@ namespace bit { namespace platform { namespace detail {
 
 } } } // namespace bit::platform::detail
 
+//=============================================================================
+// detail::make_timer_callback
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief Makes a timer callback that invokes a decayed copy of \p fn with
+  ///        decayed copies of \p args
+  ///
+  /// \param fn the function to invoke
+  /// \param args the arguments to invoke \p fn with
+  /// \return the timer callback
+  template<typename Fn, typename...Args>
+  timer_wheel::callback_type make_timer_callback( Fn&& fn, Args&&...args )
+  {
+    return [fn = decay_copy(std::forward<Fn>(fn)),
+            tuple = std::make_tuple(decay_copy(std::forward<Args>(args))...)]() mutable
+    {
+      stl::apply( fn, tuple );
+    };
+  }
+
+} } } // namespace bit::platform::detail
+
 //=============================================================================
 // dispatcher
 //=============================================================================
@@ -307,6 +331,73 @@ bit::stl::invoke_result_t<Fn,Args...>
     ::invoke( *this, parent, std::forward<Fn>(fn), std::forward<Args>(args)... );
 }
 
+//-----------------------------------------------------------------------------
+// Worker Groups
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+void bit::platform::dispatcher::post_to( group_id group, Fn&& fn, Args&&...args )
+{
+  auto job = make_job( std::forward<Fn>(fn), std::forward<Args>(args)... );
+
+  post_job_to( group, std::move(job) );
+}
+
+template<typename Fn, typename...Args>
+void bit::platform::dispatcher::post_to( group_id group,
+                                         const job& parent, Fn&& fn, Args&&...args )
+{
+  auto job = make_job( parent, std::forward<Fn>(fn), std::forward<Args>(args)... );
+
+  post_job_to( group, std::move(job) );
+}
+
+//-----------------------------------------------------------------------------
+// Timers
+//-----------------------------------------------------------------------------
+
+template<typename Rep, typename Period, typename Fn, typename...Args>
+bit::platform::timer_handle
+  bit::platform::dispatcher::post_after( const std::chrono::duration<Rep,Period>& delay,
+                                         Fn&& fn, Args&&...args )
+{
+  using duration_type = timer_wheel::duration;
+
+  const auto deadline = timer_wheel::clock_type::now()
+                      + std::chrono::duration_cast<duration_type>(delay);
+
+  return schedule_timer( deadline,
+                         duration_type::zero(),
+                         detail::make_timer_callback( std::forward<Fn>(fn),
+                                                      std::forward<Args>(args)... ) );
+}
+
+template<typename Clock, typename Duration, typename Fn, typename...Args>
+bit::platform::timer_handle
+  bit::platform::dispatcher::post_at( const std::chrono::time_point<Clock,Duration>& time,
+                                      Fn&& fn, Args&&...args )
+{
+  return post_after( time - Clock::now(),
+                     std::forward<Fn>(fn),
+                     std::forward<Args>(args)... );
+}
+
+template<typename Rep, typename Period, typename Fn, typename...Args>
+bit::platform::timer_handle
+  bit::platform::dispatcher::post_every( const std::chrono::duration<Rep,Period>& period,
+                                         Fn&& fn, Args&&...args )
+{
+  using duration_type = timer_wheel::duration;
+
+  const auto interval = std::chrono::duration_cast<duration_type>(period);
+  const auto deadline = timer_wheel::clock_type::now() + interval;
+
+  return schedule_timer( deadline,
+                         interval,
+                         detail::make_timer_callback( std::forward<Fn>(fn),
+                                                      std::forward<Args>(args)... ) );
+}
+
 //-----------------------------------------------------------------------------
 // Free Functions
 //-----------------------------------------------------------------------------
@@ -0,0 +1,335 @@
+/**
+ * \file epoch_domain.hpp
+ *
+ * \brief This header contains an epoch-based reclamation domain for
+ *        lock-free data structures
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_EPOCH_DOMAIN_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_EPOCH_DOMAIN_HPP
+
+#include "../spin_lock.hpp"  // spin_lock
+#include "../true_share.hpp" // cache_line_size
+#include "this_thread.hpp"   // this_thread_stripe
+
+#include <atomic>  // std::atomic
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
+#include <mutex>   // std::lock_guard
+#include <vector>  // std::vector
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A domain in which memory that has been unlinked from a
+      ///        lock-free structure is reclaimed once no reader can still
+      ///        hold it
+      ///
+      /// Every access to the structure is made under a \ref guard, which
+      /// registers the access in the current epoch on a striped counter, so
+      /// even read-only accesses write to shared memory, but rarely to the
+      /// same cache line as another thread.
+      /// Retired memory waits out two epochs: it is only reclaimed once
+      /// every access that was in flight when it was retired has finished.
+      ///
+      /// The domain is local to the structure that owns it, so a stalled
+      /// reader only holds back that structure's memory.
+      /////////////////////////////////////////////////////////////////////////
+      class epoch_domain
+      {
+        //---------------------------------------------------------------------
+        // Public Member Types
+        //---------------------------------------------------------------------
+      public:
+
+        using size_type = std::size_t;
+
+        /// The function that reclaims retired memory \p p, given the
+        /// \p context it was retired with
+        using reclaim_function = void(*)( void* context, void* p );
+
+        ///////////////////////////////////////////////////////////////////////
+        /// \brief Registers an access to the structure for its lifetime
+        ///////////////////////////////////////////////////////////////////////
+        class guard
+        {
+        public:
+
+          /// \brief Registers an access in the current epoch of \p domain
+          ///
+          /// \param domain the domain to register in
+          explicit guard( epoch_domain& domain ) noexcept;
+
+          // Deleted copy constructor
+          guard( const guard& other ) = delete;
+
+          /// \brief Ends the access
+          ~guard();
+
+          // Deleted copy assignment
+          guard& operator=( const guard& other ) = delete;
+
+        private:
+
+          std::atomic<size_type>* m_count;
+        };
+
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Constructs a domain with nothing retired
+        epoch_domain() noexcept;
+
+        // Deleted move constructor
+        epoch_domain( epoch_domain&& other ) = delete;
+
+        // Deleted copy constructor
+        epoch_domain( const epoch_domain& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Reclaims everything that is still retired
+        ///
+        /// \pre no guard is active
+        ~epoch_domain();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        epoch_domain& operator=( epoch_domain&& other ) = delete;
+
+        // Deleted copy assignment
+        epoch_domain& operator=( const epoch_domain& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Reclamation
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Retires \p p, which has been unlinked from the structure,
+        ///        to be reclaimed with \p reclaim once it is safe
+        ///
+        /// This also reclaims whatever earlier retirements have become safe
+        ///
+        /// \param p the memory to retire
+        /// \param reclaim the function that reclaims \p p
+        /// \param context the context to pass to \p reclaim
+        void retire( void* p, reclaim_function reclaim, void* context );
+
+        /// \brief Reclaims whatever retirements have become safe, without
+        ///        retiring anything
+        void reclaim_safe();
+
+        /// \brief Reclaims everything that is retired, regardless of the
+        ///        accesses in flight
+        ///
+        /// \pre no guard is active
+        void reclaim_all() noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Member Types
+        //---------------------------------------------------------------------
+      private:
+
+        struct retired
+        {
+          void*            p;
+          reclaim_function reclaim;
+          void*            context;
+        };
+
+        /// The accesses in flight in each epoch, for one stripe of threads
+        struct alignas(cache_line_size()) active_counter
+        {
+          std::atomic<size_type> count[2];
+        };
+
+        /// The number of stripes of the epoch counters
+        static constexpr size_type stripe_count = 8u;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        active_counter             m_active[stripe_count];
+        std::atomic<std::uint32_t> m_epoch;
+
+        spin_lock            m_lock;
+        std::vector<retired> m_limbo;    ///< Retired in the current epoch
+        std::vector<retired> m_draining; ///< Retired in the previous epoch
+        std::vector<retired> m_spare;    ///< Storage for the next collection
+
+        //---------------------------------------------------------------------
+        // Private Member Functions
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Retires \p entry, if it is not null, and reclaims
+        ///        whatever retirements have become safe
+        void advance( const retired* entry );
+
+        /// \brief Moves retirements along the grace period, taking those
+        ///        that have become safe into \p safe
+        ///
+        /// \pre m_lock is held
+        void collect( std::vector<retired>& safe ) noexcept;
+
+        /// \brief Reclaims every entry of \p entries
+        static void reclaim( std::vector<retired>& entries ) noexcept;
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::epoch_domain::guard
+//=============================================================================
+
+inline bit::platform::detail::epoch_domain::guard::guard( epoch_domain& domain )
+  noexcept
+{
+  auto& stripe = domain.m_active[this_thread_stripe() % stripe_count];
+
+  while( true ) {
+    const auto epoch = domain.m_epoch.load();
+
+    m_count = &stripe.count[epoch & 1u];
+    m_count->fetch_add( 1u );
+
+    // If the epoch moved on, the collector may have already checked this
+    // counter; register again in the new epoch
+    if( domain.m_epoch.load() == epoch ) return;
+
+    m_count->fetch_sub( 1u, std::memory_order_release );
+  }
+}
+
+inline bit::platform::detail::epoch_domain::guard::~guard()
+{
+  m_count->fetch_sub( 1u, std::memory_order_release );
+}
+
+//=============================================================================
+// detail::epoch_domain
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+inline bit::platform::detail::epoch_domain::epoch_domain()
+  noexcept
+  : m_active(),
+    m_epoch(0u),
+    m_lock(),
+    m_limbo(),
+    m_draining(),
+    m_spare()
+{
+  for( auto& stripe : m_active ) {
+    stripe.count[0].store( 0u, std::memory_order_relaxed );
+    stripe.count[1].store( 0u, std::memory_order_relaxed );
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+inline bit::platform::detail::epoch_domain::~epoch_domain()
+{
+  reclaim_all();
+}
+
+//-----------------------------------------------------------------------------
+// Reclamation
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::detail::epoch_domain
+  ::retire( void* p, reclaim_function reclaim, void* context )
+{
+  const auto entry = retired{ p, reclaim, context };
+
+  advance( &entry );
+}
+
+inline void bit::platform::detail::epoch_domain::reclaim_safe()
+{
+  advance( nullptr );
+}
+
+inline void bit::platform::detail::epoch_domain::reclaim_all()
+  noexcept
+{
+  reclaim( m_draining );
+  reclaim( m_limbo );
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::detail::epoch_domain
+  ::advance( const retired* entry )
+{
+  auto safe = std::vector<retired>{};
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    if( entry != nullptr ) m_limbo.push_back( *entry );
+    safe.swap( m_spare );
+    collect( safe );
+  }
+
+  // Reclaimed outside of the lock, since reclaiming may be expensive
+  epoch_domain::reclaim( safe );
+
+  // The storage is handed back, so that retiring stops allocating once the
+  // three lists are large enough
+  if( safe.capacity() != 0u ) {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    if( m_spare.capacity() < safe.capacity() ) m_spare.swap( safe );
+  }
+}
+
+inline void bit::platform::detail::epoch_domain
+  ::collect( std::vector<retired>& safe )
+  noexcept
+{
+  if( !m_draining.empty() ) {
+    const auto previous = (m_epoch.load() & 1u) ^ 1u;
+
+    for( auto& stripe : m_active ) {
+      if( stripe.count[previous].load( std::memory_order_acquire ) != 0u ) return;
+    }
+
+    // Every access from before these were retired has finished
+    safe.swap( m_draining );
+  }
+
+  if( !m_limbo.empty() ) {
+    m_draining.swap( m_limbo );
+    m_epoch.fetch_add( 1u );
+  }
+}
+
+inline void bit::platform::detail::epoch_domain
+  ::reclaim( std::vector<retired>& entries )
+  noexcept
+{
+  for( auto& entry : entries ) {
+    entry.reclaim( entry.context, entry.p );
+  }
+  entries.clear();
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_EPOCH_DOMAIN_HPP */
@@ -0,0 +1,133 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_EXECUTOR_INL
+#define BIT_PLATFORM_THREADING_DETAIL_EXECUTOR_INL
+
+//=============================================================================
+// detail::executor_ops
+//=============================================================================
+
+template<typename Executor>
+constexpr bit::platform::detail::executor_vtable
+  bit::platform::detail::executor_ops<Executor>::vtable;
+
+template<typename Executor>
+inline void bit::platform::detail::executor_ops<Executor>
+  ::post( void* executor, unique_task task )
+{
+  static_cast<Executor*>(executor)->post( std::move(task) );
+}
+
+template<typename Executor>
+inline void bit::platform::detail::executor_ops<Executor>
+  ::post_job( void* executor, job j )
+{
+  do_post_job( *static_cast<Executor*>(executor), std::move(j), is_job_executor<Executor>{} );
+}
+
+template<typename Executor>
+inline void bit::platform::detail::executor_ops<Executor>
+  ::do_post_job( Executor& executor, job j, std::true_type )
+{
+  executor.post_job( std::move(j) );
+}
+
+template<typename Executor>
+inline void bit::platform::detail::executor_ops<Executor>
+  ::do_post_job( Executor& executor, job j, std::false_type )
+{
+  // Never in the vtable of an executor that does not execute jobs
+  executor.post( unique_task( [j = std::move(j)]{ j.execute(); } ) );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename Executor>
+inline void bit::platform::detail::executor_ops<Executor>
+  ::post_and_wait( void* executor, void (*fn)( void* ), void* data )
+{
+  static_cast<Executor*>(executor)->post_and_wait( [fn,data]()
+  {
+    (*fn)( data );
+  });
+}
+
+//=============================================================================
+// any_executor
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors
+//-----------------------------------------------------------------------------
+
+template<typename Executor, typename>
+inline bit::platform::any_executor::any_executor( Executor& executor )
+  noexcept
+  : m_executor( static_cast<void*>( std::addressof(executor) ) ),
+    m_vtable( &detail::executor_ops<Executor>::vtable )
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename Executor>
+inline Executor* bit::platform::any_executor::target()
+  const noexcept
+{
+  if( m_vtable != &detail::executor_ops<Executor>::vtable ) return nullptr;
+
+  return static_cast<Executor*>(m_executor);
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+inline void bit::platform::any_executor::post( Fn&& fn, Args&&...args )
+{
+  // tuple is to account for performing a decay copy to simulate
+  // behaviour of std::thread
+  auto call = [fn = std::decay_t<Fn>( std::forward<Fn>(fn) ),
+               tuple = std::make_tuple( std::forward<Args>(args)... )]() mutable
+  {
+    stl::apply( std::move(fn), std::move(tuple) );
+  };
+
+  // Executors of jobs would otherwise wrap the unique_task in a job, which
+  // it is too large to fit inside of without allocating
+  if( m_vtable->post_job ) {
+    m_vtable->post_job( m_executor, make_job( std::move(call) ) );
+  } else {
+    m_vtable->post( m_executor, unique_task( std::move(call) ) );
+  }
+}
+
+template<typename Fn, typename...Args>
+inline bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::any_executor::post_and_wait( Fn&& fn, Args&&...args )
+{
+  using result_type = stl::invoke_result_t<Fn,Args...>;
+
+  detail::task_result<result_type> result;
+
+  // The call never throws, so the executor only ever needs to run it
+  auto call = [&]()
+  {
+    result.store( [&]() -> result_type
+    {
+      return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+    });
+  };
+  using call_type = decltype(call);
+
+  m_vtable->post_and_wait( m_executor, []( void* p )
+  {
+    (*static_cast<call_type*>(p))();
+  }, static_cast<void*>(&call) );
+
+  return result.get();
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_EXECUTOR_INL */
@@ -0,0 +1,32 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_FUTEX_INL
+#define BIT_PLATFORM_THREADING_DETAIL_FUTEX_INL
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+template<typename Rep, typename Period>
+inline bool bit::platform::futex_wait_for( const std::atomic<std::uint32_t>& address,
+                                           std::uint32_t expected,
+                                           const std::chrono::duration<Rep,Period>& timeout )
+{
+  using nanoseconds = std::chrono::nanoseconds;
+
+  if( timeout <= timeout.zero() ) {
+    return address.load( std::memory_order_acquire ) != expected;
+  }
+
+  // Clamp durations that cannot be represented in nanoseconds
+  const auto limit = std::chrono::hours(24 * 365);
+  if( std::chrono::duration<double>(timeout) >= limit ) {
+    return detail::futex_wait_for( address, expected, limit );
+  }
+
+  // Round up, so that the wait never finishes before the timeout
+  auto ns = std::chrono::duration_cast<nanoseconds>(timeout);
+  if( ns < timeout ) ++ns;
+
+  return detail::futex_wait_for( address, expected, ns );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_FUTEX_INL */
@@ -0,0 +1,677 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_FUTURE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_FUTURE_INL
+
+//=============================================================================
+// detail::future_state_base
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+template<typename Clock, typename Duration>
+inline bool bit::platform::detail::future_state_base
+  ::wait_until( const std::chrono::time_point<Clock,Duration>& time_point )
+  const
+{
+  auto expected = prepare_wait();
+  if( expected == 0u ) return true;
+
+  blocking_region region;
+  do {
+    const auto now = Clock::now();
+    if( now >= time_point ) return false;
+
+    futex_wait_for( m_state, expected, time_point - now );
+    expected = prepare_wait();
+  } while( expected != 0u );
+  return true;
+}
+
+//=============================================================================
+// detail::future_state
+//=============================================================================
+
+template<typename T>
+inline bit::platform::detail::future_state<T>*
+  bit::platform::detail::future_state<T>::make()
+{
+  static_assert( alignof(future_state) <= alignof(std::max_align_t),
+                 "future_state must not be over-aligned" );
+
+  auto* p = allocate_future_state( sizeof(future_state) );
+
+  return ::new (p) future_state();
+}
+
+template<typename T>
+template<typename Fn>
+inline void bit::platform::detail::future_state<T>::set_result( Fn&& fn )
+{
+  m_result.store( std::forward<Fn>(fn) );
+  mark_ready();
+}
+
+template<typename T>
+inline void bit::platform::detail::future_state<T>
+  ::set_exception( std::exception_ptr error )
+{
+  m_result.set_exception( std::move(error) );
+  mark_ready();
+}
+
+template<typename T>
+inline T bit::platform::detail::future_state<T>::get()
+{
+  return m_result.get();
+}
+
+template<typename T>
+inline void bit::platform::detail::future_state<T>::destroy()
+  noexcept
+{
+  this->~future_state();
+  deallocate_future_state( this, sizeof(future_state) );
+}
+
+//=============================================================================
+// detail::future_state_ref
+//=============================================================================
+
+inline bit::platform::detail::future_state_ref
+  ::future_state_ref( future_state_base* state )
+  noexcept
+  : m_state(state)
+{
+
+}
+
+inline bit::platform::detail::future_state_ref
+  ::future_state_ref( const future_state_ref& other )
+  noexcept
+  : m_state(other.m_state)
+{
+  if( m_state ) m_state->retain();
+}
+
+inline bit::platform::detail::future_state_ref
+  ::future_state_ref( future_state_ref&& other )
+  noexcept
+  : m_state(other.m_state)
+{
+  other.m_state = nullptr;
+}
+
+inline bit::platform::detail::future_state_ref::~future_state_ref()
+{
+  if( m_state ) m_state->release();
+}
+
+inline void bit::platform::detail::future_state_ref::operator()()
+{
+  auto* state = m_state;
+  m_state = nullptr;
+
+  state->run_continuation();
+}
+
+//=============================================================================
+// detail functions
+//=============================================================================
+
+template<typename Executor>
+inline void bit::platform::detail::schedule_continuation( void* executor,
+                                                          future_state_base* state )
+{
+  static_cast<Executor*>(executor)->post( future_state_ref(state) );
+}
+
+template<typename T, typename Fn>
+inline void bit::platform::detail::attach( future<T>&& f, Fn&& fn )
+{
+  assert( f.valid() && "Cannot attach to a future without a shared state" );
+
+  auto* state = f.m_state;
+  f.m_state = nullptr;
+
+  state->set_continuation( unique_task( [state, fn = std::decay_t<Fn>( std::forward<Fn>(fn) )]() mutable
+  {
+    fn( future<T>( state ) );
+  }), nullptr, nullptr );
+}
+
+template<typename T, typename Fn>
+inline void bit::platform::detail::fulfil( promise<T>& p, Fn&& fn )
+{
+  assert( !p.m_satisfied && "The promise has already been satisfied" );
+
+  p.m_satisfied = true;
+  p.m_state->set_result( std::forward<Fn>(fn) );
+}
+
+//=============================================================================
+// promise<T>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Assignment / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::promise<T>::promise()
+  : m_state( detail::future_state<T>::make() ),
+    m_retrieved( false ),
+    m_satisfied( false )
+{
+
+}
+
+template<typename T>
+inline bit::platform::promise<T>::promise( promise&& other )
+  noexcept
+  : m_state( other.m_state ),
+    m_retrieved( other.m_retrieved ),
+    m_satisfied( other.m_satisfied )
+{
+  other.m_state = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::promise<T>::~promise()
+{
+  abandon();
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::promise<T>&
+  bit::platform::promise<T>::operator=( promise&& other )
+  noexcept
+{
+  if( this == &other ) return (*this);
+
+  abandon();
+
+  m_state     = other.m_state;
+  m_retrieved = other.m_retrieved;
+  m_satisfied = other.m_satisfied;
+
+  other.m_state = nullptr;
+
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::future<T> bit::platform::promise<T>::get_future()
+{
+  assert( m_state != nullptr && "The promise has no shared state" );
+  assert( !m_retrieved && "The future has already been retrieved" );
+
+  m_retrieved = true;
+  m_state->retain();
+
+  return future<T>( m_state );
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+template<typename...Args>
+inline void bit::platform::promise<T>::set_value( Args&&...args )
+{
+  detail::fulfil( *this, [&]() -> T
+  {
+    return T( std::forward<Args>(args)... );
+  });
+}
+
+template<typename T>
+inline void bit::platform::promise<T>::set_exception( std::exception_ptr error )
+{
+  assert( !m_satisfied && "The promise has already been satisfied" );
+
+  m_satisfied = true;
+  m_state->set_exception( std::move(error) );
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline void bit::platform::promise<T>::abandon()
+  noexcept
+{
+  if( !m_state ) return;
+
+  if( !m_satisfied ) {
+    m_satisfied = true;
+
+    const auto error = std::future_error( std::future_errc::broken_promise );
+    m_state->set_exception( std::make_exception_ptr( error ) );
+  }
+
+  m_state->release();
+  m_state = nullptr;
+}
+
+//=============================================================================
+// future<T>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Assignment / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::future<T>::future()
+  noexcept
+  : m_state(nullptr)
+{
+
+}
+
+template<typename T>
+inline bit::platform::future<T>::future( future&& other )
+  noexcept
+  : m_state(other.m_state)
+{
+  other.m_state = nullptr;
+}
+
+template<typename T>
+inline bit::platform::future<T>::future( detail::future_state<T>* state )
+  noexcept
+  : m_state(state)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::future<T>::~future()
+{
+  if( m_state ) m_state->release();
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::future<T>&
+  bit::platform::future<T>::operator=( future&& other )
+  noexcept
+{
+  if( this == &other ) return (*this);
+
+  if( m_state ) m_state->release();
+
+  m_state       = other.m_state;
+  other.m_state = nullptr;
+
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bool bit::platform::future<T>::valid()
+  const noexcept
+{
+  return m_state != nullptr;
+}
+
+template<typename T>
+inline bool bit::platform::future<T>::ready()
+  const noexcept
+{
+  assert( valid() && "The future has no shared state" );
+
+  return m_state->ready();
+}
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline void bit::platform::future<T>::wait()
+  const
+{
+  assert( valid() && "The future has no shared state" );
+
+  m_state->wait();
+}
+
+template<typename T>
+template<typename Rep, typename Period>
+inline bool bit::platform::future<T>
+  ::wait_for( const std::chrono::duration<Rep,Period>& duration )
+  const
+{
+  return wait_until( std::chrono::steady_clock::now() + duration );
+}
+
+template<typename T>
+template<typename Clock, typename Duration>
+inline bool bit::platform::future<T>
+  ::wait_until( const std::chrono::time_point<Clock,Duration>& time_point )
+  const
+{
+  assert( valid() && "The future has no shared state" );
+
+  return m_state->wait_until( time_point );
+}
+
+//-----------------------------------------------------------------------------
+// Consumers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline T bit::platform::future<T>::get()
+{
+  wait();
+
+  // Releases the state once the result has been retrieved
+  const auto f = std::move(*this);
+
+  return f.m_state->get();
+}
+
+template<typename T>
+template<typename Fn>
+inline bit::platform::future<bit::stl::invoke_result_t<std::decay_t<Fn>&,bit::platform::future<T>>>
+  bit::platform::future<T>::then( Fn&& fn )
+{
+  return then( nullptr, nullptr, std::forward<Fn>(fn) );
+}
+
+template<typename T>
+template<typename Executor, typename Fn>
+inline bit::platform::future<bit::stl::invoke_result_t<std::decay_t<Fn>&,bit::platform::future<T>>>
+  bit::platform::future<T>::then( Executor& executor, Fn&& fn )
+{
+  return then( &detail::schedule_continuation<Executor>,
+               static_cast<void*>( std::addressof(executor) ),
+               std::forward<Fn>(fn) );
+}
+
+//-----------------------------------------------------------------------------
+// Private Consumers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+template<typename Fn>
+inline bit::platform::future<bit::stl::invoke_result_t<std::decay_t<Fn>&,bit::platform::future<T>>>
+  bit::platform::future<T>::then( detail::schedule_function schedule,
+                                  void* executor,
+                                  Fn&& fn )
+{
+  using result_type = stl::invoke_result_t<std::decay_t<Fn>&,future>;
+
+  assert( valid() && "Cannot attach a continuation to a future without a shared state" );
+
+  auto p      = promise<result_type>();
+  auto result = p.get_future();
+
+  // The continuation takes over this future's reference, and hands it back
+  // to the future it invokes 'fn' with
+  auto* state = m_state;
+  m_state = nullptr;
+
+  state->set_continuation( unique_task( [state,
+                                         p = std::move(p),
+                                         fn = std::decay_t<Fn>( std::forward<Fn>(fn) )]() mutable
+  {
+    detail::fulfil( p, [&]() -> result_type
+    {
+      return stl::invoke( fn, future( state ) );
+    });
+  }), schedule, executor );
+
+  return result;
+}
+
+//=============================================================================
+// Factories
+//=============================================================================
+
+template<typename T>
+inline bit::platform::future<std::decay_t<T>>
+  bit::platform::make_ready_future( T&& value )
+{
+  auto p = promise<std::decay_t<T>>();
+  p.set_value( std::forward<T>(value) );
+
+  return p.get_future();
+}
+
+inline bit::platform::future<void> bit::platform::make_ready_future()
+{
+  auto p = promise<void>();
+  p.set_value();
+
+  return p.get_future();
+}
+
+template<typename T>
+inline bit::platform::future<T>
+  bit::platform::make_exceptional_future( std::exception_ptr error )
+{
+  auto p = promise<T>();
+  p.set_exception( std::move(error) );
+
+  return p.get_future();
+}
+
+//=============================================================================
+// Combinators
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief The state shared by the continuations of a \ref when_all
+  template<typename Sequence>
+  struct when_all_context
+  {
+    when_all_context( Sequence futures, std::size_t count )
+      : futures(std::move(futures)),
+        remaining(count + 1),
+        promise()
+    {
+
+    }
+
+    /// \brief Counts down a ready future, or the setup of the context,
+    ///        completing the promise once all have been counted
+    void count_down()
+    {
+      if( --remaining != 0 ) return;
+
+      promise.set_value( std::move(futures) );
+      delete this;
+    }
+
+    Sequence                            futures;
+    std::atomic<std::size_t>            remaining;
+    bit::platform::promise<Sequence>    promise;
+  };
+
+  /// \brief The state shared by the continuations of a \ref when_any
+  template<typename T>
+  struct when_any_context
+  {
+    explicit when_any_context( std::size_t count )
+      : remaining(count + 1),
+        completed(false),
+        promise()
+    {
+
+    }
+
+    /// \brief Offers the ready future \p f at \p index as the result
+    void complete( std::size_t index, future<T> f )
+    {
+      if( !completed.exchange( true ) ) {
+        promise.set_value( when_any_result<T>{ index, std::move(f) } );
+      }
+      release();
+    }
+
+    /// \brief Counts down a ready future, or the setup of the context,
+    ///        deleting the context once all have been counted
+    void release()
+    {
+      if( --remaining == 0 ) delete this;
+    }
+
+    std::atomic<std::size_t>                      remaining;
+    std::atomic<bool>                             completed;
+    bit::platform::promise<when_any_result<T>>    promise;
+  };
+
+  template<typename Tuple, std::size_t...Idxs>
+  inline void attach_all( when_all_context<Tuple>* context,
+                          std::index_sequence<Idxs...> )
+  {
+    // The futures are moved out of the tuple, and back in once ready
+    using expander = int[];
+    (void) expander{ 0, (
+      detail::attach( std::move(std::get<Idxs>(context->futures)),
+                      [context]( std::tuple_element_t<Idxs,Tuple> f )
+      {
+        std::get<Idxs>(context->futures) = std::move(f);
+        context->count_down();
+      }), 0 )...
+    };
+  }
+
+} } } // namespace bit::platform::detail
+
+//-----------------------------------------------------------------------------
+
+template<typename...Futures>
+inline bit::platform::future<std::tuple<std::decay_t<Futures>...>>
+  bit::platform::when_all( Futures&&...futures )
+{
+  using sequence_type = std::tuple<std::decay_t<Futures>...>;
+  using context_type  = detail::when_all_context<sequence_type>;
+
+  auto* context = new context_type( sequence_type( std::move(futures)... ),
+                                     sizeof...(Futures) );
+  auto result = context->promise.get_future();
+
+  detail::attach_all( context, std::index_sequence_for<Futures...>{} );
+  context->count_down();
+
+  return result;
+}
+
+template<typename InputIt>
+inline bit::platform::future<std::vector<typename std::iterator_traits<InputIt>::value_type>>
+  bit::platform::when_all( InputIt first, InputIt last )
+{
+  using future_type   = typename std::iterator_traits<InputIt>::value_type;
+  using sequence_type = std::vector<future_type>;
+  using context_type  = detail::when_all_context<sequence_type>;
+
+  auto futures = sequence_type();
+  for( ; first != last; ++first ) {
+    futures.push_back( std::move(*first) );
+  }
+
+  const auto size = futures.size();
+  auto* context = new context_type( std::move(futures), size );
+  auto result = context->promise.get_future();
+
+  for( auto i = std::size_t{0}; i < size; ++i ) {
+    detail::attach( std::move(context->futures[i]), [context,i]( future_type f )
+    {
+      context->futures[i] = std::move(f);
+      context->count_down();
+    });
+  }
+  context->count_down();
+
+  return result;
+}
+
+template<typename InputIt>
+inline bit::platform::future<bit::platform::when_any_result<typename std::iterator_traits<InputIt>::value_type::value_type>>
+  bit::platform::when_any( InputIt first, InputIt last )
+{
+  using value_type   = typename std::iterator_traits<InputIt>::value_type::value_type;
+  using context_type = detail::when_any_context<value_type>;
+
+  auto futures = std::vector<future<value_type>>();
+  for( ; first != last; ++first ) {
+    futures.push_back( std::move(*first) );
+  }
+
+  if( futures.empty() ) {
+    return make_ready_future( when_any_result<value_type>{ std::size_t(-1), {} } );
+  }
+
+  auto* context = new context_type( futures.size() );
+  auto result = context->promise.get_future();
+
+  for( auto i = std::size_t{0}; i < futures.size(); ++i ) {
+    detail::attach( std::move(futures[i]), [context,i]( future<value_type> f )
+    {
+      context->complete( i, std::move(f) );
+    });
+  }
+  context->release();
+
+  return result;
+}
+
+template<typename T, typename...Futures>
+inline bit::platform::future<bit::platform::when_any_result<T>>
+  bit::platform::when_any( future<T>&& first, Futures&&...rest )
+{
+  future<T> futures[] = { std::move(first), std::move(rest)... };
+
+  return when_any( std::begin(futures), std::end(futures) );
+}
+
+//=============================================================================
+// Execution
+//=============================================================================
+
+template<typename Executor, typename Fn, typename...Args>
+inline bit::platform::future<bit::stl::invoke_result_t<std::decay_t<Fn>,std::decay_t<Args>...>>
+  bit::platform::post_async( Executor& executor, Fn&& fn, Args&&...args )
+{
+  using result_type = stl::invoke_result_t<std::decay_t<Fn>,std::decay_t<Args>...>;
+
+  auto p      = promise<result_type>();
+  auto result = p.get_future();
+
+  // tuple is to account for performing a decay copy to simulate
+  // behaviour of std::thread
+  executor.post( [p = std::move(p),
+                  fn = std::decay_t<Fn>( std::forward<Fn>(fn) ),
+                  tuple = std::make_tuple( std::forward<Args>(args)... )]() mutable
+  {
+    detail::fulfil( p, [&]() -> result_type
+    {
+      return stl::apply( std::move(fn), std::move(tuple) );
+    });
+  });
+
+  return result;
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_FUTURE_INL */
@@ -9,8 +9,12 @@ namespace bit { namespace platform { namespace detail {
 /// \note A job may only ever be executed exactly once; executing a job
 ///       more than once is undefined behaviour. This is best left up to
 ///       the dispatcher system for the job.
+///
+/// \note The storage doubles as an intrusive node for an mpsc_queue, so that
+///       queueing a job never requires an allocation
 ///////////////////////////////////////////////////////////////////////////////
 class alignas(cache_line_size()) job_storage
+  : public mpsc_node
 {
   //---------------------------------------------------------------------------
   // Observers
@@ -42,6 +46,18 @@ public:
   /// \return the parent of the job
   job_storage* parent() const noexcept;
 
+  //---------------------------------------------------------------------------
+  // Waiting
+  //---------------------------------------------------------------------------
+public:
+
+  /// \brief Blocks the calling thread until this job, and all of its
+  ///        children, have completed
+  ///
+  /// The thread that finishes the job wakes the waiters, so waiting costs
+  /// nothing while the job is running
+  void wait() noexcept;
+
   //---------------------------------------------------------------------------
   // Execution
   //---------------------------------------------------------------------------
@@ -162,39 +178,75 @@ private:
     void* m_ptr;
   };
 
-  using atomic_type   = std::atomic<std::uint16_t>;
+  using atomic_type   = std::atomic<std::uint32_t>;
   using function_type = void(*)( void* );
   using move_function_type = void(*)(void*,void*);
 
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief The functions that operate on the stored arguments
+  ///
+  /// Both functions are shared behind a single pointer, so that the
+  /// intrusive queue hook does not cost any argument storage
+  /////////////////////////////////////////////////////////////////////////////
+  struct operations
+  {
+    function_type execute;
+    function_type destroy;
+  };
+
   //---------------------------------------------------------------------------
   // Static Private Members
   //---------------------------------------------------------------------------
 private:
 
   static constexpr std::size_t padding_size = cache_line_size()
+                                            - sizeof(mpsc_node)
                                             - sizeof(job_storage*)
-                                            - 2*sizeof(function_type)
+                                            - sizeof(const operations*)
                                             - sizeof(atomic_type);
 
   template<typename T>
   static constexpr std::size_t max_storage_size = padding_size - alignof(T);
 
+  /// The bit of the unfinished count that is set once a thread waits on
+  /// the job, so that finishing a job nobody waits on makes no system call
+  static constexpr std::uint32_t waiter_flag = 0x80000000u;
+
+  /// The bits of the unfinished count that hold the count
+  static constexpr std::uint32_t count_mask = ~waiter_flag;
+
+  /// The number of bytes of arguments that are always stored inline, which
+  /// is enough for a std::function
+  static constexpr std::size_t inline_capacity = 4 * sizeof(void*);
+
   //---------------------------------------------------------------------------
   // Private Members
   //---------------------------------------------------------------------------
 private:
 
-  job_storage*  m_parent;
-  function_type m_function;
-  function_type m_destructor;
-  atomic_type   m_unfinished;
-  mutable char  m_padding[padding_size];
+  // The padding directly follows the pointers so that it starts suitably
+  // aligned for any argument with pointer alignment
+  job_storage*      m_parent;
+  const operations* m_operations;
+  mutable char      m_padding[padding_size];
+  atomic_type       m_unfinished;
+
+  static_assert( padding_size >= inline_capacity,
+                 "job_storage must store at least 4 pointers of arguments inline" );
 
   //---------------------------------------------------------------------------
   // Static Functions
   //---------------------------------------------------------------------------
 private:
 
+  /// \brief Gets the operations for a job that stores \p Types
+  ///
+  /// \return a pointer to the static operations
+  template<typename...Types>
+  static const operations* operations_for() noexcept;
+
+  //---------------------------------------------------------------------------
+
   /// \brief The function being wrapped in the job object
   ///
   /// \param padding pointer to the padding to convert to arguments
@@ -244,6 +296,8 @@ private:
   template<typename Fn, typename...Args>
   friend job bit::platform::make_job( const job&, Fn&&, Args&&... );
 
+  friend class bit::platform::job;
+
   friend void* allocate_job();
 };
 
@@ -263,9 +317,9 @@ static_assert( std::is_trivially_destructible<bit::platform::detail::job_storage
 //-----------------------------------------------------------------------------
 
 inline bit::platform::detail::job_storage::job_storage()
-  : m_parent(nullptr),
-    m_function(nullptr),
-    m_destructor(nullptr),
+  : mpsc_node(),
+    m_parent(nullptr),
+    m_operations(nullptr),
     m_unfinished(0)
 {
 
@@ -273,9 +327,9 @@ inline bit::platform::detail::job_storage::job_storage()
 
 template<typename Fn, typename...Args>
 bit::platform::detail::job_storage::job_storage( Fn&& fn, Args&&...args )
-: m_parent(nullptr),
-  m_function(&function<std::decay_t<Fn>,std::decay_t<Args>...>),
-  m_destructor(&destruct_function<std::decay_t<Fn>,std::decay_t<Args>...>),
+: mpsc_node(),
+  m_parent(nullptr),
+  m_operations(operations_for<std::decay_t<Fn>,std::decay_t<Args>...>()),
   m_unfinished(1)
 {
   store_arguments( std::forward<Fn>(fn), std::forward<Args>(args)... );
@@ -285,9 +339,9 @@ bit::platform::detail::job_storage::job_storage( Fn&& fn, Args&&...args )
 
 template<typename Fn, typename...Args>
 bit::platform::detail::job_storage::job_storage( job_storage* parent, Fn&& fn, Args&&...args )
-  : m_parent(parent),
-    m_function(&function<std::decay_t<Fn>,std::decay_t<Args>...>),
-    m_destructor(&destruct_function<std::decay_t<Fn>,std::decay_t<Args>...>),
+  : mpsc_node(),
+    m_parent(parent),
+    m_operations(operations_for<std::decay_t<Fn>,std::decay_t<Args>...>()),
     m_unfinished(1)
 {
   ++m_parent->m_unfinished;
@@ -302,13 +356,13 @@ bit::platform::detail::job_storage::job_storage( job_storage* parent, Fn&& fn, A
 inline bool bit::platform::detail::job_storage::completed()
   const noexcept
 {
-  return m_unfinished == 0;
+  return (m_unfinished.load() & count_mask) == 0;
 }
 
 inline bool bit::platform::detail::job_storage::available()
   const noexcept
 {
-  return m_unfinished == 1;
+  return (m_unfinished.load() & count_mask) == 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -321,13 +375,28 @@ inline bit::platform::detail::job_storage* bit::platform::detail::job_storage::p
   return m_parent;
 }
 
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::detail::job_storage::wait()
+  noexcept
+{
+  auto unfinished = m_unfinished.fetch_or( waiter_flag ) | waiter_flag;
+
+  while( (unfinished & count_mask) != 0 ) {
+    futex_wait( m_unfinished, unfinished );
+    unfinished = m_unfinished.load();
+  }
+}
+
 //-----------------------------------------------------------------------------
 // Execution
 //-----------------------------------------------------------------------------
 
 inline void bit::platform::detail::job_storage::execute() const
 {
-  (*m_function)( static_cast<void*>(&m_padding[0]) );
+  (*m_operations->execute)( static_cast<void*>(&m_padding[0]) );
 }
 
 //-----------------------------------------------------------------------------
@@ -336,10 +405,18 @@ inline void bit::platform::detail::job_storage::execute() const
 
 inline void bit::platform::detail::job_storage::finalize()
 {
-  (*m_destructor)( static_cast<void*>(&m_padding[0]) );
-  auto unfinished = --m_unfinished;
-  if( unfinished == 0 && m_parent ) {
-    m_parent->finalize();
+  (*m_operations->destroy)( static_cast<void*>(&m_padding[0]) );
+
+  // The storage may be reused as soon as the count reaches zero
+  auto* const parent = m_parent;
+  const auto unfinished = m_unfinished.fetch_sub( 1 );
+  if( (unfinished & count_mask) != 1 ) return;
+
+  if( unfinished & waiter_flag ) {
+    futex_wake_all( m_unfinished );
+  }
+  if( parent ) {
+    parent->finalize();
   }
 }
 
@@ -372,6 +449,19 @@ void bit::platform::detail::job_storage::store_arguments( Args&&...args )
   }
 }
 
+template<typename...Types>
+inline const bit::platform::detail::job_storage::operations*
+  bit::platform::detail::job_storage::operations_for()
+  noexcept
+{
+  static constexpr auto s_operations = operations{
+    &function<Types...>,
+    &destruct_function<Types...>
+  };
+
+  return &s_operations;
+}
+
 template<typename...Types>
 void bit::platform::detail::job_storage::function( void* padding )
 {
@@ -656,6 +746,30 @@ inline bit::platform::job
   return job{ parent, std::forward<Fn>(fn), std::forward<Args>(args)... };
 }
 
+//-----------------------------------------------------------------------------
+// Intrusive Queueing
+//-----------------------------------------------------------------------------
+
+inline bit::platform::detail::mpsc_node*
+  bit::platform::detail::release_job( job&& j )
+  noexcept
+{
+  auto* storage = j.m_job;
+  j.m_job = nullptr;
+
+  return storage;
+}
+
+inline bit::platform::job
+  bit::platform::detail::acquire_job( mpsc_node* node )
+  noexcept
+{
+  auto j = job{};
+  j.m_job = static_cast<job_storage*>(node);
+
+  return j;
+}
+
 //=============================================================================
 // job_handle
 //=============================================================================
@@ -694,4 +808,14 @@ inline bool bit::platform::job_handle::available()
   return m_job ? m_job->available() : true;
 }
 
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::job_handle::wait()
+  const noexcept
+{
+  if( m_job ) m_job->wait();
+}
+
 #endif /* BIT_PLATFORM_THREADING_DETAIL_JOB_INL */
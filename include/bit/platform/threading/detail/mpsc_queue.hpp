@@ -0,0 +1,218 @@
+/**
+ * \file mpsc_queue.hpp
+ *
+ * \brief This header contains an intrusive, lock-free,
+ *        multi-producer/single-consumer queue
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_MPSC_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_MPSC_QUEUE_HPP
+
+#include <atomic> // std::atomic
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The intrusive hook used by entries of an \ref mpsc_queue
+      /////////////////////////////////////////////////////////////////////////
+      class mpsc_node
+      {
+        //---------------------------------------------------------------------
+        // Constructor
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Default-constructs an unlinked node
+        mpsc_node() noexcept;
+
+        // Deleted copy constructor
+        mpsc_node( const mpsc_node& other ) = delete;
+
+        // Deleted copy assignment
+        mpsc_node& operator=( const mpsc_node& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        std::atomic<mpsc_node*> m_next;
+
+        friend class mpsc_queue;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief An intrusive multi-producer/single-consumer queue, based on
+      ///        Dmitry Vyukov's non-blocking MPSC queue
+      ///
+      /// Pushing is wait-free and costs a single atomic exchange; popping is
+      /// lock-free and may only ever be done by one thread at a time.
+      ///
+      /// A push that is still in progress may cause \ref pop to return
+      /// \c nullptr while \ref empty returns \c false; consumers must treat
+      /// this as a transient state and try again later.
+      /////////////////////////////////////////////////////////////////////////
+      class mpsc_queue
+      {
+        //---------------------------------------------------------------------
+        // Constructor
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Default-constructs an empty queue
+        mpsc_queue() noexcept;
+
+        // Deleted move constructor
+        mpsc_queue( mpsc_queue&& other ) = delete;
+
+        // Deleted copy constructor
+        mpsc_queue( const mpsc_queue& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        mpsc_queue& operator=( mpsc_queue&& other ) = delete;
+
+        // Deleted copy assignment
+        mpsc_queue& operator=( const mpsc_queue& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Capacity
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Queries whether this queue is empty
+        ///
+        /// \note This may only be called by the consumer
+        ///
+        /// \return \c true if there are no entries, including any whose
+        ///         push is still in progress
+        bool empty() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Pushes \p node to the back of this queue
+        ///
+        /// This may be called by any number of threads concurrently
+        ///
+        /// \param node the node to push
+        void push( mpsc_node* node ) noexcept;
+
+        /// \brief Pops the node at the front of this queue
+        ///
+        /// \note This may only be called by the consumer
+        ///
+        /// \return the popped node, or \c nullptr if none is available
+        mpsc_node* pop() noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        std::atomic<mpsc_node*> m_head; ///< The most recently pushed node
+        mpsc_node*              m_tail; ///< The next node to pop
+        mpsc_node               m_stub; ///< Placeholder for an empty queue
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::mpsc_node
+//=============================================================================
+
+inline bit::platform::detail::mpsc_node::mpsc_node()
+  noexcept
+  : m_next(nullptr)
+{
+
+}
+
+//=============================================================================
+// detail::mpsc_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+inline bit::platform::detail::mpsc_queue::mpsc_queue()
+  noexcept
+  : m_head(&m_stub),
+    m_tail(&m_stub),
+    m_stub()
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+inline bool bit::platform::detail::mpsc_queue::empty()
+  const noexcept
+{
+  return m_tail == &m_stub && m_head.load() == &m_stub;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::detail::mpsc_queue::push( mpsc_node* node )
+  noexcept
+{
+  node->m_next.store( nullptr, std::memory_order_relaxed );
+
+  auto* prev = m_head.exchange( node );
+  prev->m_next.store( node, std::memory_order_release );
+}
+
+inline bit::platform::detail::mpsc_node*
+  bit::platform::detail::mpsc_queue::pop()
+  noexcept
+{
+  auto* tail = m_tail;
+  auto* next = tail->m_next.load( std::memory_order_acquire );
+
+  // Skip over the stub node
+  if( tail == &m_stub ) {
+    if( !next ) return nullptr;
+
+    m_tail = next;
+    tail   = next;
+    next   = next->m_next.load( std::memory_order_acquire );
+  }
+
+  if( next ) {
+    m_tail = next;
+    return tail;
+  }
+
+  // A producer has exchanged the head, but not yet linked its node
+  if( tail != m_head.load( std::memory_order_acquire ) ) return nullptr;
+
+  // Re-insert the stub so that the last real node can be detached
+  push( &m_stub );
+
+  next = tail->m_next.load( std::memory_order_acquire );
+  if( next ) {
+    m_tail = next;
+    return tail;
+  }
+
+  return nullptr;
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_MPSC_QUEUE_HPP */
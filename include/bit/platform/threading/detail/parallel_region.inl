@@ -0,0 +1,135 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_PARALLEL_REGION_INL
+#define BIT_PLATFORM_THREADING_DETAIL_PARALLEL_REGION_INL
+
+//=============================================================================
+// team
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Private Constructor
+//-----------------------------------------------------------------------------
+
+inline bit::platform::team::team( detail::team_state& state, std::size_t index )
+  noexcept
+  : m_state(state),
+    m_index(index),
+    m_sense(0u),
+    m_singles(0u)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline std::size_t bit::platform::team::index()
+  const noexcept
+{
+  return m_index;
+}
+
+inline std::size_t bit::platform::team::size()
+  const noexcept
+{
+  return m_state.m_size;
+}
+
+//-----------------------------------------------------------------------------
+// Synchronization
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::team::barrier()
+  noexcept
+{
+  m_sense ^= 1u;
+  m_state.arrive( m_sense );
+}
+
+template<typename Fn>
+inline void bit::platform::team::single( Fn&& fn )
+{
+  if( m_state.claim_single( m_singles++ ) ) {
+    stl::invoke( std::forward<Fn>(fn) );
+  }
+  barrier();
+}
+
+//-----------------------------------------------------------------------------
+// Work Sharing
+//-----------------------------------------------------------------------------
+
+template<typename Integer, typename Fn>
+inline void bit::platform::team::for_static( Integer first,
+                                             Integer last,
+                                             Fn&& fn )
+{
+  static_assert( std::is_integral<Integer>::value, "for_static requires an integral index" );
+
+  if( first < last ) {
+    const auto count = static_cast<std::size_t>(last - first);
+    const auto chunk = (count + size() - 1) / size();
+    const auto begin = std::min( count, chunk * m_index );
+    const auto end   = std::min( count, begin + chunk );
+
+    for( auto i = begin; i < end; ++i ) {
+      stl::invoke( fn, static_cast<Integer>(first + static_cast<Integer>(i)) );
+    }
+  }
+  barrier();
+}
+
+template<typename Integer, typename Fn>
+inline void bit::platform::team::for_static( Integer first,
+                                             Integer last,
+                                             Integer chunk,
+                                             Fn&& fn )
+{
+  static_assert( std::is_integral<Integer>::value, "for_static requires an integral index" );
+
+  BIT_ASSERT( chunk > 0, "team::for_static: chunk must be greater than zero" );
+
+  if( first < last ) {
+    const auto count  = static_cast<std::size_t>(last - first);
+    const auto length = static_cast<std::size_t>(chunk);
+    const auto stride = length * size();
+
+    for( auto begin = length * m_index; begin < count; begin += stride ) {
+      const auto end = std::min( count, begin + length );
+
+      for( auto i = begin; i < end; ++i ) {
+        stl::invoke( fn, static_cast<Integer>(first + static_cast<Integer>(i)) );
+      }
+    }
+  }
+  barrier();
+}
+
+//=============================================================================
+// Free Functions
+//=============================================================================
+
+template<typename Fn>
+inline void bit::platform::parallel_region( dispatcher& dispatcher,
+                                            std::size_t team_size,
+                                            Fn&& fn )
+{
+  BIT_ASSERT( team_size > 0, "parallel_region: team_size must be greater than zero" );
+
+  using function_type = std::remove_reference_t<Fn>;
+
+  auto invoke = []( void* p, team& member )
+  {
+    stl::invoke( *static_cast<function_type*>(p), member );
+  };
+
+  // The function is only ever referenced by the members, which all finish
+  // before this returns
+  detail::team_state state( dispatcher,
+                            team_size,
+                            invoke,
+                            const_cast<void*>(static_cast<const void*>(std::addressof(fn))) );
+  state.run();
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_PARALLEL_REGION_INL */
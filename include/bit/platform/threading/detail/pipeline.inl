@@ -0,0 +1,302 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_PIPELINE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_PIPELINE_INL
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief The size, and the destruction, of a value of type \p T held by
+  ///        a pipeline token
+  template<typename T>
+  struct pipeline_value
+  {
+    static_assert( alignof(T) <= alignof(std::max_align_t),
+                   "Over-aligned values are not supported" );
+
+    static constexpr std::size_t size = sizeof(T);
+
+    static void destroy( void* p ) noexcept
+    {
+      static_cast<T*>(p)->~T();
+    }
+  };
+
+  template<>
+  struct pipeline_value<void>
+  {
+    static constexpr std::size_t size = 0u;
+
+    static void destroy( void* ) noexcept
+    {
+
+    }
+  };
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// flow_control
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+inline bit::platform::flow_control::flow_control( stl::span<char> buffer )
+  noexcept
+  : m_buffer(buffer),
+    m_stopped(false)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline bit::stl::span<char> bit::platform::flow_control::buffer()
+  const noexcept
+{
+  return m_buffer;
+}
+
+inline bool bit::platform::flow_control::stopped()
+  const noexcept
+{
+  return m_stopped;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::flow_control::stop()
+  noexcept
+{
+  m_stopped = true;
+}
+
+//=============================================================================
+// detail::pipeline_stage
+//=============================================================================
+
+inline bit::platform::detail::pipeline_stage::pipeline_stage( stage_mode mode )
+  noexcept
+  : mode(mode),
+    lock(),
+    busy(false),
+    next_sequence(0),
+    parked(nullptr)
+{
+
+}
+
+//=============================================================================
+// detail::pipeline_source_impl
+//=============================================================================
+
+template<typename Fn, typename T>
+template<typename Fn2>
+inline bit::platform::detail::pipeline_source_impl<Fn,T>
+  ::pipeline_source_impl( Fn2&& fn )
+  : m_function( std::forward<Fn2>(fn) )
+{
+
+}
+
+template<typename Fn, typename T>
+inline bool bit::platform::detail::pipeline_source_impl<Fn,T>
+  ::produce( flow_control& control, void* value )
+{
+  auto result = T( stl::invoke( m_function, control ) );
+
+  if( control.stopped() ) return false;
+
+  ::new (value) T( std::move(result) );
+  return true;
+}
+
+//=============================================================================
+// detail::pipeline_stage_impl
+//=============================================================================
+
+template<typename Fn, typename In, typename Out>
+template<typename Fn2>
+inline bit::platform::detail::pipeline_stage_impl<Fn,In,Out>
+  ::pipeline_stage_impl( stage_mode mode, Fn2&& fn )
+  : pipeline_stage(mode),
+    m_function( std::forward<Fn2>(fn) )
+{
+
+}
+
+template<typename Fn, typename In, typename Out>
+inline void bit::platform::detail::pipeline_stage_impl<Fn,In,Out>
+  ::process( void* value )
+{
+  process( static_cast<In*>(value), std::is_void<Out>{} );
+}
+
+template<typename Fn, typename In, typename Out>
+inline void bit::platform::detail::pipeline_stage_impl<Fn,In,Out>
+  ::discard( void* value )
+  noexcept
+{
+  static_cast<In*>(value)->~In();
+}
+
+template<typename Fn, typename In, typename Out>
+inline void bit::platform::detail::pipeline_stage_impl<Fn,In,Out>
+  ::process( In* in, std::true_type )
+{
+  stl::invoke( m_function, std::move(*in) );
+  in->~In();
+}
+
+template<typename Fn, typename In, typename Out>
+inline void bit::platform::detail::pipeline_stage_impl<Fn,In,Out>
+  ::process( In* in, std::false_type )
+{
+  auto out = Out( stl::invoke( m_function, std::move(*in) ) );
+  in->~In();
+
+  // The output reuses the storage of the input
+  ::new (static_cast<void*>(in)) Out( std::move(out) );
+}
+
+//=============================================================================
+// detail::pipeline_access
+//=============================================================================
+
+template<typename T>
+inline bit::platform::pipeline<T> bit::platform::detail::pipeline_access
+  ::make( std::unique_ptr<pipeline_state> state )
+  noexcept
+{
+  return pipeline<T>( std::move(state) );
+}
+
+//=============================================================================
+// pipeline<T>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Private Constructor
+//-----------------------------------------------------------------------------
+
+template<typename T>
+inline bit::platform::pipeline<T>
+  ::pipeline( std::unique_ptr<detail::pipeline_state> state )
+  noexcept
+  : m_state( std::move(state) )
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T>
+template<typename Fn>
+inline bit::platform::pipeline<bit::platform::detail::pipeline_stage_result_t<Fn,T>>
+  bit::platform::pipeline<T>::then( stage_mode mode, Fn&& fn ) &&
+{
+  static_assert( !std::is_void<T>::value, "A stage cannot follow a stage that returns void" );
+
+  using result_type = detail::pipeline_stage_result_t<Fn,T>;
+  using stage_type  = detail::pipeline_stage_impl<std::decay_t<Fn>,T,result_type>;
+
+  static_assert( std::is_void<result_type>::value ||
+                 std::is_nothrow_move_constructible<result_type>::value,
+                 "The result of a stage must be nothrow move-constructible" );
+
+  auto stage = std::unique_ptr<detail::pipeline_stage>(
+    new stage_type( mode, std::forward<Fn>(fn) )
+  );
+
+  m_state->add_stage( std::move(stage),
+                      detail::pipeline_value<result_type>::size,
+                      &detail::pipeline_value<result_type>::destroy );
+
+  return pipeline<result_type>( std::move(m_state) );
+}
+
+template<typename T>
+inline void bit::platform::pipeline<T>::run()
+{
+  m_state->run();
+}
+
+//=============================================================================
+// file_source<File>
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+template<typename File>
+inline bit::platform::file_source<File>::file_source( File& file )
+  noexcept
+  : m_file( std::addressof(file) )
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Call
+//-----------------------------------------------------------------------------
+
+template<typename File>
+inline bit::stl::span<char>
+  bit::platform::file_source<File>::operator()( flow_control& control )
+{
+  auto result = m_file->read( control.buffer() );
+
+  if( result.size() == 0 ) {
+    control.stop();
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename File>
+inline bit::platform::file_source<File> bit::platform::read_from( File& file )
+  noexcept
+{
+  return file_source<File>( file );
+}
+
+//=============================================================================
+// Free Functions
+//=============================================================================
+
+template<typename Source>
+inline bit::platform::pipeline<bit::platform::detail::pipeline_source_result_t<Source>>
+  bit::platform::make_pipeline( dispatcher& dispatcher,
+                                std::size_t max_tokens,
+                                Source&& source,
+                                std::size_t buffer_size )
+{
+  using result_type = detail::pipeline_source_result_t<Source>;
+  using source_type = detail::pipeline_source_impl<std::decay_t<Source>,result_type>;
+
+  static_assert( !std::is_void<result_type>::value, "The source must return a value" );
+  static_assert( std::is_nothrow_move_constructible<result_type>::value,
+                 "The result of the source must be nothrow move-constructible" );
+
+  auto state = std::unique_ptr<detail::pipeline_state>(
+    new detail::pipeline_state(
+      dispatcher,
+      max_tokens,
+      buffer_size,
+      std::unique_ptr<detail::pipeline_source>( new source_type( std::forward<Source>(source) ) ),
+      detail::pipeline_value<result_type>::size,
+      &detail::pipeline_value<result_type>::destroy
+    )
+  );
+
+  return detail::pipeline_access::make<result_type>( std::move(state) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_PIPELINE_INL */
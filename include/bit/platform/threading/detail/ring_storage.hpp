@@ -0,0 +1,432 @@
+/**
+ * \file ring_storage.hpp
+ *
+ * \brief This header contains a growable ring buffer used as the storage of
+ *        \ref concurrent_queue
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_RING_STORAGE_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_RING_STORAGE_HPP
+
+#include <cstddef>     // std::size_t
+#include <memory>      // std::allocator_traits
+#include <type_traits> // std::is_nothrow_move_constructible
+#include <utility>     // std::move, std::forward, std::swap
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A FIFO ring buffer that grows geometrically, and never gives
+      ///        its storage back until it is destroyed
+      ///
+      /// Unlike a \c std::deque, which allocates and frees blocks as it
+      /// oscillates between empty and full, a ring only allocates when it
+      /// grows past its largest size so far.
+      /////////////////////////////////////////////////////////////////////////
+      template<typename T, typename Allocator>
+      class ring_storage
+      {
+        //---------------------------------------------------------------------
+        // Public Member Types
+        //---------------------------------------------------------------------
+      public:
+
+        using size_type = std::size_t;
+
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Constructs an empty ring that has not allocated
+        ///
+        /// \param alloc the allocator to use
+        explicit ring_storage( const Allocator& alloc ) noexcept;
+
+        /// \brief Move-constructs a ring, taking the storage of \p other
+        ///
+        /// \param other the other ring to move
+        ring_storage( ring_storage&& other ) noexcept;
+
+        /// \brief Move-constructs a ring with a new allocator
+        ///
+        /// The storage of \p other is only taken if the allocators compare
+        /// equal; otherwise the entries are moved one at a time
+        ///
+        /// \param other the other ring to move
+        /// \param alloc the allocator to use
+        ring_storage( ring_storage&& other, const Allocator& alloc );
+
+        // Deleted copy constructor
+        ring_storage( const ring_storage& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Destroys every entry, and frees the storage
+        ~ring_storage();
+
+        //---------------------------------------------------------------------
+
+        /// \brief Move-assigns \p other to this ring by swapping with it,
+        ///        then clearing it
+        ///
+        /// \param other the other ring to move
+        /// \return reference to \c (*this)
+        ring_storage& operator=( ring_storage&& other ) noexcept;
+
+        // Deleted copy assignment
+        ring_storage& operator=( const ring_storage& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Capacity
+        //---------------------------------------------------------------------
+      public:
+
+        bool empty() const noexcept;
+
+        size_type size() const noexcept;
+
+        size_type capacity() const noexcept;
+
+        /// \brief Grows the storage to hold at least \p n entries
+        ///
+        /// \param n the number of entries to hold
+        void reserve( size_type n );
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        Allocator get_allocator() const;
+
+        //---------------------------------------------------------------------
+        // Element Access
+        //---------------------------------------------------------------------
+      public:
+
+        /// \pre !empty()
+        T& front() noexcept;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        template<typename...Args>
+        void emplace( Args&&...args );
+
+        void push( const T& value );
+
+        void push( T&& value );
+
+        /// \brief Destroys the front entry
+        ///
+        /// \pre !empty()
+        void pop() noexcept;
+
+        /// \brief Destroys every entry, keeping the storage
+        void clear() noexcept;
+
+        /// \brief Swaps the entries, storage, and allocator of this ring
+        ///        with \p other
+        ///
+        /// \param other the other ring
+        void swap( ring_storage& other ) noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Member Types
+        //---------------------------------------------------------------------
+      private:
+
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        /// The capacity of a ring on its first allocation
+        static constexpr size_type initial_capacity = 16u;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        Allocator m_allocator;
+        T*        m_data;
+        size_type m_capacity; ///< Always zero, or a power of two
+        size_type m_head;     ///< The index of the front entry
+        size_type m_size;
+
+        //---------------------------------------------------------------------
+        // Private Member Functions
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Moves every entry into new storage of \p capacity entries
+        void reallocate( size_type capacity );
+
+        /// \brief Grows the storage if it is full
+        void grow_if_full();
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::ring_storage
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr typename bit::platform::detail::ring_storage<T,Allocator>::size_type
+  bit::platform::detail::ring_storage<T,Allocator>::initial_capacity;
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor / Assignment
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::ring_storage<T,Allocator>
+  ::ring_storage( const Allocator& alloc )
+  noexcept
+  : m_allocator(alloc),
+    m_data(nullptr),
+    m_capacity(0u),
+    m_head(0u),
+    m_size(0u)
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::ring_storage<T,Allocator>
+  ::ring_storage( ring_storage&& other )
+  noexcept
+  : m_allocator(std::move(other.m_allocator)),
+    m_data(other.m_data),
+    m_capacity(other.m_capacity),
+    m_head(other.m_head),
+    m_size(other.m_size)
+{
+  other.m_data     = nullptr;
+  other.m_capacity = 0u;
+  other.m_head     = 0u;
+  other.m_size     = 0u;
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::ring_storage<T,Allocator>
+  ::ring_storage( ring_storage&& other, const Allocator& alloc )
+  : ring_storage( alloc )
+{
+  if( m_allocator == other.m_allocator ) {
+    swap( other );
+    return;
+  }
+
+  reserve( other.m_size );
+  while( !other.empty() ) {
+    push( std::move(other.front()) );
+    other.pop();
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::ring_storage<T,Allocator>::~ring_storage()
+{
+  clear();
+
+  if( m_data != nullptr ) {
+    alloc_traits::deallocate( m_allocator, m_data, m_capacity );
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::ring_storage<T,Allocator>&
+  bit::platform::detail::ring_storage<T,Allocator>::operator=( ring_storage&& other )
+  noexcept
+{
+  swap( other );
+  other.clear();
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::detail::ring_storage<T,Allocator>::empty()
+  const noexcept
+{
+  return m_size == 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::detail::ring_storage<T,Allocator>::size_type
+  bit::platform::detail::ring_storage<T,Allocator>::size()
+  const noexcept
+{
+  return m_size;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::detail::ring_storage<T,Allocator>::size_type
+  bit::platform::detail::ring_storage<T,Allocator>::capacity()
+  const noexcept
+{
+  return m_capacity;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::reserve( size_type n )
+{
+  if( n <= m_capacity ) return;
+
+  auto capacity = (m_capacity == 0u) ? initial_capacity : m_capacity;
+  while( capacity < n ) {
+    capacity <<= 1u;
+  }
+  reallocate( capacity );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::detail::ring_storage<T,Allocator>::get_allocator()
+  const
+{
+  return m_allocator;
+}
+
+//-----------------------------------------------------------------------------
+// Element Access
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline T& bit::platform::detail::ring_storage<T,Allocator>::front()
+  noexcept
+{
+  return m_data[m_head];
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline void bit::platform::detail::ring_storage<T,Allocator>
+  ::emplace( Args&&...args )
+{
+  grow_if_full();
+
+  const auto index = (m_head + m_size) & (m_capacity - 1u);
+  alloc_traits::construct( m_allocator, m_data + index, std::forward<Args>(args)... );
+  ++m_size;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::push( const T& value )
+{
+  emplace( value );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::push( T&& value )
+{
+  emplace( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::pop()
+  noexcept
+{
+  alloc_traits::destroy( m_allocator, m_data + m_head );
+  m_head = (m_head + 1u) & (m_capacity - 1u);
+  --m_size;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::clear()
+  noexcept
+{
+  while( m_size != 0u ) {
+    pop();
+  }
+  m_head = 0u;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>
+  ::swap( ring_storage& other )
+  noexcept
+{
+  using std::swap;
+
+  swap( m_allocator, other.m_allocator );
+  swap( m_data, other.m_data );
+  swap( m_capacity, other.m_capacity );
+  swap( m_head, other.m_head );
+  swap( m_size, other.m_size );
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>
+  ::reallocate( size_type capacity )
+{
+  auto data  = alloc_traits::allocate( m_allocator, capacity );
+  auto count = size_type(0);
+
+  try {
+    for( ; count < m_size; ++count ) {
+      const auto index = (m_head + count) & (m_capacity - 1u);
+      alloc_traits::construct( m_allocator, data + count, std::move_if_noexcept(m_data[index]) );
+    }
+  } catch( ... ) {
+    for( auto i = size_type(0); i < count; ++i ) {
+      alloc_traits::destroy( m_allocator, data + i );
+    }
+    alloc_traits::deallocate( m_allocator, data, capacity );
+    throw;
+  }
+
+  const auto size = m_size;
+  clear();
+  if( m_data != nullptr ) {
+    alloc_traits::deallocate( m_allocator, m_data, m_capacity );
+  }
+
+  m_data     = data;
+  m_capacity = capacity;
+  m_head     = 0u;
+  m_size     = size;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::ring_storage<T,Allocator>::grow_if_full()
+{
+  if( m_size != m_capacity ) return;
+
+  reallocate( (m_capacity == 0u) ? initial_capacity : (m_capacity << 1u) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_RING_STORAGE_HPP */
@@ -0,0 +1,856 @@
+/**
+ * \file segmented_queue.hpp
+ *
+ * \brief This header contains an unbounded, lock-free, multi-producer/
+ *        multi-consumer queue built from linked array segments
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_SEGMENTED_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_SEGMENTED_QUEUE_HPP
+
+#include "../concurrency_arbiter.hpp" // blocking_region
+#include "../futex.hpp"               // futex_wait, futex_wake_one
+#include "../spin_lock.hpp"           // spin_lock
+#include "../true_share.hpp"          // cache_line_size
+#include "epoch_domain.hpp"           // epoch_domain
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
+#include <memory>      // std::allocator_traits
+#include <mutex>       // std::lock_guard
+#include <new>         // placement new
+#include <thread>      // std::this_thread
+#include <type_traits> // std::aligned_storage_t
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief An unbounded, lock-free MPMC queue of linked array segments
+      ///
+      /// Producers and consumers claim cells of the segment at the tail or
+      /// head with a fetch-and-add on the segment's index, so the only
+      /// compare-and-swaps are those that link a new segment or move the
+      /// head and tail between segments. A consumer that claims a cell
+      /// before its producer has arrived poisons it, and the producer moves
+      /// on to the next cell.
+      ///
+      /// Drained segments are retired to an \ref epoch_domain that is local
+      /// to the queue, and only reused once every operation that could have
+      /// seen them has finished. Reclaimed segments are kept in a pool
+      /// rather than freed, so the queue stops allocating once it reaches
+      /// its high-water mark.
+      /////////////////////////////////////////////////////////////////////////
+      template<typename T, typename Allocator>
+      class segmented_queue
+      {
+        static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+        //---------------------------------------------------------------------
+        // Public Member Types
+        //---------------------------------------------------------------------
+      public:
+
+        using value_type      = T;
+        using reference       = T&;
+        using const_reference = const T&;
+        using pointer         = T*;
+        using const_pointer   = const T*;
+
+        using allocator_type  = Allocator;
+        using size_type       = std::size_t;
+
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Default constructs a segmented_queue
+        segmented_queue();
+
+        /// \brief Constructs a segmented_queue that uses the specified
+        ///        allocator
+        ///
+        /// \param alloc the allocator to use
+        explicit segmented_queue( const Allocator& alloc );
+
+        // Deleted move constructor
+        segmented_queue( segmented_queue&& other ) = delete;
+
+        // Deleted copy constructor
+        segmented_queue( const segmented_queue& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Destroys the entries left in the queue, and frees every
+        ///        segment
+        ~segmented_queue();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        segmented_queue& operator=( segmented_queue&& other ) = delete;
+
+        // Deleted copy assignment
+        segmented_queue& operator=( const segmented_queue& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Capacity
+        //---------------------------------------------------------------------
+      public:
+
+        /// \copydoc concurrent_queue::empty
+        bool empty() const noexcept;
+
+        /// \copydoc concurrent_queue::size
+        size_type size() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \copydoc concurrent_queue::get_allocator
+        Allocator get_allocator() const;
+
+        //---------------------------------------------------------------------
+        // Element Access
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Pops the front element in the queue, spinning and then
+        ///        parking until one is available
+        ///
+        /// \note This uses move-assignment to store the result
+        /// \param value pointer to the entry to store the result
+        void pop( T* value );
+
+        /// \copydoc concurrent_queue::try_pop
+        bool try_pop( T* value );
+
+        /// \copydoc concurrent_queue::try_pop_n
+        template<typename OutputIterator>
+        size_type try_pop_n( OutputIterator out, size_type max );
+
+        /// \brief Pops every element in the queue, returning immediately if
+        ///        the queue is empty
+        ///
+        /// \param out the output iterator to store the results in
+        /// \return the number of elements popped
+        template<typename OutputIterator>
+        size_type pop_all( OutputIterator out );
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Pushes an entry into the queue
+        ///
+        /// \param value the value to push
+        void push_back( const T& value );
+
+        /// \copydoc segmented_queue::push_back
+        void push_back( T&& value );
+
+        /// \brief Emplaces an entry in the queue
+        ///
+        /// \param args the arguments to construct the entry
+        template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+        void emplace_back( Args&&...args );
+
+        /// \copydoc concurrent_queue::push_range
+        template<typename InputIterator>
+        void push_range( InputIterator first, InputIterator last );
+
+        /// \copydoc concurrent_queue::emplace_n
+        template<typename...Args, std::enable_if_t<std::is_constructible<T,const Args&...>::value>* = nullptr>
+        void emplace_n( size_type n, const Args&...args );
+
+        //---------------------------------------------------------------------
+
+        /// \brief Pushes an entry into the queue
+        ///
+        /// This never fails, since the queue is unbounded
+        ///
+        /// \param value the value to push back
+        /// \return \c true
+        bool try_push_back( const T& value );
+
+        /// \copydoc segmented_queue::try_push_back
+        bool try_push_back( T&& value );
+
+        /// \brief Emplaces an entry into the queue
+        ///
+        /// This never fails, since the queue is unbounded
+        ///
+        /// \param args the arguments to construct the entry
+        /// \return \c true
+        template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+        bool try_emplace_back( Args&&...args );
+
+        //---------------------------------------------------------------------
+
+        /// \brief Clears this queue of all entries
+        void clear();
+
+        //---------------------------------------------------------------------
+        // Private Member Types
+        //---------------------------------------------------------------------
+      private:
+
+        // States of a cell
+        static constexpr std::uint32_t cell_empty    = 0u;
+        static constexpr std::uint32_t cell_writing  = 1u; ///< Claimed by a producer
+        static constexpr std::uint32_t cell_full     = 2u;
+        static constexpr std::uint32_t cell_poisoned = 3u; ///< Skipped by its producer
+        static constexpr std::uint32_t cell_consumed = 4u;
+
+        struct cell
+        {
+          cell() noexcept;
+
+          std::atomic<std::uint32_t> state;
+          std::aligned_storage_t<sizeof(T),alignof(T)> storage;
+        };
+
+        //---------------------------------------------------------------------
+        // Public Static Members
+        //---------------------------------------------------------------------
+      public:
+
+        /// The number of cells in each segment, which is chosen so that a
+        /// segment spans roughly a page
+        static constexpr size_type segment_size = (sizeof(cell) * 32u < 4096u) ? (4096u / sizeof(cell)) : 32u;
+
+        //---------------------------------------------------------------------
+        // Private Member Types
+        //---------------------------------------------------------------------
+      private:
+
+        struct segment
+        {
+          segment() noexcept;
+
+          std::atomic<size_type> enqueue; ///< The next cell producers claim
+          std::atomic<size_type> dequeue; ///< The next cell consumers claim
+          std::atomic<segment*>  next;
+          segment*               free;    ///< The next segment in a free list
+          cell                   cells[segment_size];
+        };
+
+        using alloc_traits      = std::allocator_traits<Allocator>;
+        using segment_allocator = typename alloc_traits::template rebind_alloc<segment>;
+        using segment_traits    = std::allocator_traits<segment_allocator>;
+
+        //---------------------------------------------------------------------
+        // Private Static Members
+        //---------------------------------------------------------------------
+      private:
+
+        /// The number of failed attempts a blocking pop makes before it parks
+        static constexpr size_type spin_count = 64u;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        segment_allocator m_allocator;
+
+        char m_padding0[cache_line_size()];
+
+        std::atomic<segment*> m_head; ///< The segment consumers claim from
+
+        char m_padding1[cache_line_size()];
+
+        std::atomic<segment*> m_tail; ///< The segment producers claim from
+
+        char m_padding2[cache_line_size()];
+
+        mutable epoch_domain m_epochs;
+
+        spin_lock m_pool_lock;
+        segment*  m_pool; ///< Segments ready to be reused
+
+        std::atomic<std::uint32_t> m_pop_epoch;   ///< Bumped when a cell is filled
+        std::atomic<size_type>     m_pop_waiters; ///< Consumers parked while empty
+
+        //---------------------------------------------------------------------
+        // Private Member Functions
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Constructs an entry from \p args at the back of the queue
+        template<typename...Args>
+        void enqueue( Args&&...args );
+
+        /// \brief Invokes \p consume with the entry at the front of the
+        ///        queue, then destroys the entry
+        ///
+        /// \return \c false if the queue was empty
+        template<typename Consume>
+        bool dequeue( Consume&& consume );
+
+        /// \brief Takes a segment from the pool, allocating one if the pool
+        ///        is empty and no retired segment can be reused yet
+        segment* acquire_segment();
+
+        /// \brief Returns segment \p s to the pool
+        void recycle_segment( segment* s ) noexcept;
+
+        /// \brief Returns retired segment \p p of queue \p queue to its
+        ///        pool, once no operation can still see it
+        static void reclaim_segment( void* queue, void* p ) noexcept;
+
+        /// \brief Wakes a consumer parked in pop, if there is one
+        void notify() noexcept;
+
+        /// \brief Frees every segment in a free list
+        void deallocate_list( segment* s ) noexcept;
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::segmented_queue::cell
+//=============================================================================
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::segmented_queue<T,Allocator>::cell::cell()
+  noexcept
+  : state(cell_empty)
+{
+
+}
+
+//=============================================================================
+// detail::segmented_queue::segment
+//=============================================================================
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::segmented_queue<T,Allocator>::segment::segment()
+  noexcept
+  : enqueue(0u),
+    dequeue(0u),
+    next(nullptr),
+    free(nullptr),
+    cells()
+{
+
+}
+
+//=============================================================================
+// detail::segmented_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr std::uint32_t bit::platform::detail::segmented_queue<T,Allocator>::cell_empty;
+template<typename T, typename Allocator>
+constexpr std::uint32_t bit::platform::detail::segmented_queue<T,Allocator>::cell_writing;
+template<typename T, typename Allocator>
+constexpr std::uint32_t bit::platform::detail::segmented_queue<T,Allocator>::cell_full;
+template<typename T, typename Allocator>
+constexpr std::uint32_t bit::platform::detail::segmented_queue<T,Allocator>::cell_poisoned;
+template<typename T, typename Allocator>
+constexpr std::uint32_t bit::platform::detail::segmented_queue<T,Allocator>::cell_consumed;
+template<typename T, typename Allocator>
+constexpr typename bit::platform::detail::segmented_queue<T,Allocator>::size_type
+  bit::platform::detail::segmented_queue<T,Allocator>::segment_size;
+template<typename T, typename Allocator>
+constexpr typename bit::platform::detail::segmented_queue<T,Allocator>::size_type
+  bit::platform::detail::segmented_queue<T,Allocator>::spin_count;
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::segmented_queue<T,Allocator>::segmented_queue()
+  : segmented_queue( Allocator() )
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::segmented_queue<T,Allocator>
+  ::segmented_queue( const Allocator& alloc )
+  : m_allocator(alloc),
+    m_head(nullptr),
+    m_tail(nullptr),
+    m_epochs(),
+    m_pool_lock(),
+    m_pool(nullptr),
+    m_pop_epoch(0u),
+    m_pop_waiters(0u)
+{
+  auto s = acquire_segment();
+  m_head.store( s, std::memory_order_relaxed );
+  m_tail.store( s, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::detail::segmented_queue<T,Allocator>::~segmented_queue()
+{
+  m_epochs.reclaim_all();
+
+  for( auto s = m_head.load( std::memory_order_relaxed ); s != nullptr; ) {
+    for( auto& c : s->cells ) {
+      if( c.state.load( std::memory_order_relaxed ) == cell_full ) {
+        static_cast<T*>(static_cast<void*>(&c.storage))->~T();
+      }
+    }
+
+    auto next = s->next.load( std::memory_order_relaxed );
+    segment_traits::destroy( m_allocator, s );
+    segment_traits::deallocate( m_allocator, s, 1u );
+    s = next;
+  }
+
+  deallocate_list( m_pool );
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::detail::segmented_queue<T,Allocator>::size_type
+  bit::platform::detail::segmented_queue<T,Allocator>::size()
+  const noexcept
+{
+  const epoch_domain::guard guard( m_epochs );
+
+  auto result = size_type(0);
+  for( auto s = m_head.load( std::memory_order_acquire ); s != nullptr;
+       s = s->next.load( std::memory_order_acquire ) ) {
+    auto enqueued = s->enqueue.load( std::memory_order_acquire );
+    auto dequeued = s->dequeue.load( std::memory_order_acquire );
+
+    if( enqueued > segment_size ) enqueued = segment_size;
+    if( dequeued > segment_size ) dequeued = segment_size;
+    if( enqueued > dequeued ) result += (enqueued - dequeued);
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::detail::segmented_queue<T,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//-----------------------------------------------------------------------------
+// Element Access
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>::pop( T* value )
+{
+  BIT_ASSERT( value, "concurrent_queue::pop: value cannot be null");
+
+  for( auto i = size_type(0); i < spin_count; ++i ) {
+    if( try_pop( value ) ) return;
+
+    std::this_thread::yield();
+  }
+
+  // Pairs with the fence in notify(): either the producer sees this thread
+  // waiting, or this thread sees the entry it pushed
+  m_pop_waiters.fetch_add( 1u );
+
+  struct waiting
+  {
+    std::atomic<size_type>& waiters;
+
+    ~waiting()
+    {
+      waiters.fetch_sub( 1u, std::memory_order_relaxed );
+    }
+  } registration{ m_pop_waiters };
+
+  while( true ) {
+    const auto current = m_pop_epoch.load();
+
+    if( try_pop( value ) ) return;
+
+    // Parked threads do not occupy a slot of the arbiter
+    blocking_region region;
+    futex_wait( m_pop_epoch, current );
+  }
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>::try_pop( T* value )
+{
+  BIT_ASSERT( value, "concurrent_queue::try_pop: value cannot be null");
+
+  return dequeue( [value]( T& entry )
+  {
+    (*value) = std::move(entry);
+  });
+}
+
+template<typename T, typename Allocator>
+template<typename OutputIterator>
+inline typename bit::platform::detail::segmented_queue<T,Allocator>::size_type
+  bit::platform::detail::segmented_queue<T,Allocator>
+  ::try_pop_n( OutputIterator out, size_type max )
+{
+  auto count = size_type(0);
+  auto consume = [&out]( T& entry )
+  {
+    (*out) = std::move(entry);
+    ++out;
+  };
+
+  while( count < max && dequeue( consume ) ) {
+    ++count;
+  }
+  return count;
+}
+
+template<typename T, typename Allocator>
+template<typename OutputIterator>
+inline typename bit::platform::detail::segmented_queue<T,Allocator>::size_type
+  bit::platform::detail::segmented_queue<T,Allocator>::pop_all( OutputIterator out )
+{
+  auto count = size_type(0);
+  auto consume = [&out]( T& entry )
+  {
+    (*out) = std::move(entry);
+    ++out;
+  };
+
+  while( dequeue( consume ) ) {
+    ++count;
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::push_back( const T& value )
+{
+  enqueue( value );
+  notify();
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::push_back( T&& value )
+{
+  enqueue( std::move(value) );
+  notify();
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::emplace_back( Args&&...args )
+{
+  enqueue( std::forward<Args>(args)... );
+  notify();
+}
+
+template<typename T, typename Allocator>
+template<typename InputIterator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::push_range( InputIterator first, InputIterator last )
+{
+  for( ; first != last; ++first ) {
+    enqueue( *first );
+  }
+  notify();
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,const Args&...>::value>*>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::emplace_n( size_type n, const Args&...args )
+{
+  for( auto i = size_type(0); i < n; ++i ) {
+    enqueue( args... );
+  }
+  notify();
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>
+  ::try_push_back( const T& value )
+{
+  push_back( value );
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>
+  ::try_push_back( T&& value )
+{
+  push_back( std::move(value) );
+  return true;
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>
+  ::try_emplace_back( Args&&...args )
+{
+  emplace_back( std::forward<Args>(args)... );
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>::clear()
+{
+  while( dequeue( []( T& ){} ) ) {
+    // discard the entry
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+template<typename...Args>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::enqueue( Args&&...args )
+{
+  const epoch_domain::guard guard( m_epochs );
+
+  while( true ) {
+    auto s = m_tail.load( std::memory_order_acquire );
+    const auto index = s->enqueue.fetch_add( 1u, std::memory_order_acq_rel );
+
+    if( index >= segment_size ) {
+      // The segment is full; link a new one, or help whoever already did
+      auto next = s->next.load( std::memory_order_acquire );
+
+      if( next == nullptr ) {
+        auto fresh = acquire_segment();
+
+        if( s->next.compare_exchange_strong( next, fresh,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire ) ) {
+          next = fresh;
+        } else {
+          // Never seen by anyone else, so it can go straight back
+          recycle_segment( fresh );
+        }
+      }
+      m_tail.compare_exchange_strong( s, next, std::memory_order_acq_rel );
+      continue;
+    }
+
+    auto& c = s->cells[index];
+    auto state = cell_empty;
+
+    // A consumer got here first and gave up on this cell
+    if( !c.state.compare_exchange_strong( state, cell_writing,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed ) ) {
+      continue;
+    }
+
+    try {
+      ::new(static_cast<void*>(&c.storage)) T( std::forward<Args>(args)... );
+    } catch( ... ) {
+      c.state.store( cell_poisoned, std::memory_order_release );
+      throw;
+    }
+    c.state.store( cell_full, std::memory_order_release );
+    return;
+  }
+}
+
+template<typename T, typename Allocator>
+template<typename Consume>
+inline bool bit::platform::detail::segmented_queue<T,Allocator>
+  ::dequeue( Consume&& consume )
+{
+  const epoch_domain::guard guard( m_epochs );
+
+  while( true ) {
+    auto s = m_head.load( std::memory_order_acquire );
+
+    if( s->dequeue.load( std::memory_order_acquire ) >= s->enqueue.load( std::memory_order_acquire ) &&
+        s->next.load( std::memory_order_acquire ) == nullptr ) {
+      return false;
+    }
+
+    const auto index = s->dequeue.fetch_add( 1u, std::memory_order_acq_rel );
+
+    if( index >= segment_size ) {
+      auto next = s->next.load( std::memory_order_acquire );
+      if( next == nullptr ) return false;
+
+      if( m_head.compare_exchange_strong( s, next, std::memory_order_acq_rel ) ) {
+        // Producers must not find the retired segment through the tail
+        auto tail = s;
+        m_tail.compare_exchange_strong( tail, next, std::memory_order_acq_rel );
+        m_epochs.retire( s, &reclaim_segment, this );
+      }
+      continue;
+    }
+
+    auto& c = s->cells[index];
+    auto state = c.state.load( std::memory_order_acquire );
+
+    while( state != cell_full ) {
+      if( state == cell_poisoned ) break;
+
+      if( state == cell_empty ) {
+        // The producer has not claimed this cell yet; poison it so that it
+        // moves on, rather than waiting for it
+        if( c.state.compare_exchange_strong( state, cell_poisoned,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire ) ) {
+          state = cell_poisoned;
+        }
+        continue;
+      }
+
+      // The producer is constructing the entry
+      std::this_thread::yield();
+      state = c.state.load( std::memory_order_acquire );
+    }
+    if( state == cell_poisoned ) continue;
+
+    auto p = static_cast<T*>(static_cast<void*>(&c.storage));
+
+    struct destroy_guard
+    {
+      cell& c;
+      T*    p;
+
+      ~destroy_guard()
+      {
+        p->~T();
+        c.state.store( cell_consumed, std::memory_order_relaxed );
+      }
+    } destroy{ c, p };
+
+    consume( *p );
+    return true;
+  }
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::detail::segmented_queue<T,Allocator>::segment*
+  bit::platform::detail::segmented_queue<T,Allocator>::acquire_segment()
+{
+  auto s = static_cast<segment*>(nullptr);
+
+  // Before allocating, the grace period is moved along, which may return
+  // retired segments to the pool
+  for( auto attempt = 0; attempt < 2 && s == nullptr; ++attempt ) {
+    if( attempt != 0 ) m_epochs.reclaim_safe();
+
+    std::lock_guard<spin_lock> lock(m_pool_lock);
+
+    if( m_pool != nullptr ) {
+      s      = m_pool;
+      m_pool = s->free;
+    }
+  }
+
+  if( s == nullptr ) {
+    s = segment_traits::allocate( m_allocator, 1u );
+    segment_traits::construct( m_allocator, s );
+    return s;
+  }
+
+  // No operation can see a pooled segment, so it is reset without races
+  s->enqueue.store( 0u, std::memory_order_relaxed );
+  s->dequeue.store( 0u, std::memory_order_relaxed );
+  s->next.store( nullptr, std::memory_order_relaxed );
+  s->free = nullptr;
+  for( auto& c : s->cells ) {
+    c.state.store( cell_empty, std::memory_order_relaxed );
+  }
+  return s;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::recycle_segment( segment* s )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_pool_lock);
+
+  s->free = m_pool;
+  m_pool  = s;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::reclaim_segment( void* queue, void* p )
+  noexcept
+{
+  static_cast<segmented_queue*>(queue)->recycle_segment( static_cast<segment*>(p) );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>::notify()
+  noexcept
+{
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  if( m_pop_waiters.load( std::memory_order_relaxed ) == 0u ) return;
+
+  m_pop_epoch.fetch_add( 1u );
+  futex_wake_one( m_pop_epoch );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::detail::segmented_queue<T,Allocator>
+  ::deallocate_list( segment* s )
+  noexcept
+{
+  while( s != nullptr ) {
+    auto next = s->free;
+    segment_traits::destroy( m_allocator, s );
+    segment_traits::deallocate( m_allocator, s, 1u );
+    s = next;
+  }
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_SEGMENTED_QUEUE_HPP */
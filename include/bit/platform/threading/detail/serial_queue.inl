@@ -0,0 +1,237 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_SERIAL_QUEUE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_SERIAL_QUEUE_INL
+
+//=============================================================================
+// detail::serial_queue_post_job_and_wait_impl
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  template<typename T>
+  struct serial_queue_post_job_and_wait_impl
+  {
+    template<typename...Args>
+    static T invoke( serial_queue& queue, Args&&...args )
+    {
+      using storage_type = std::aligned_storage_t<sizeof(T),alignof(T)>;
+      auto storage = storage_type{};
+
+      auto job = make_job_for( std::forward<Args>(args)..., &storage );
+
+      auto handle = job_handle(job);
+      queue.post_job( std::move(job) );
+      queue.wait( handle );
+
+      auto& result = *static_cast<T*>(static_cast<void*>(&storage));
+      auto value   = std::move(result);
+      result.~T();
+
+      return value;
+    }
+
+    template<typename Fn, typename Storage>
+    static job make_job_for( Fn&& fn, Storage* storage )
+    {
+      return make_job( [&fn,storage]()
+      {
+        new (storage) T( std::forward<Fn>(fn)() );
+      });
+    }
+
+    template<typename Fn, typename Storage>
+    static job make_job_for( const job& parent, Fn&& fn, Storage* storage )
+    {
+      return make_job( parent, [&fn,storage]()
+      {
+        new (storage) T( std::forward<Fn>(fn)() );
+      });
+    }
+  };
+
+  //---------------------------------------------------------------------------
+
+  template<typename T>
+  struct serial_queue_post_job_and_wait_impl<T&>
+  {
+    template<typename...Args>
+    static T& invoke( serial_queue& queue, Args&&...args )
+    {
+      T* ptr = nullptr;
+
+      auto job = make_job_for( std::forward<Args>(args)..., &ptr );
+
+      auto handle = job_handle(job);
+      queue.post_job( std::move(job) );
+      queue.wait( handle );
+
+      return *ptr;
+    }
+
+    template<typename Fn>
+    static job make_job_for( Fn&& fn, T** ptr )
+    {
+      return make_job( [&fn,ptr]()
+      {
+        *ptr = &std::forward<Fn>(fn)();
+      });
+    }
+
+    template<typename Fn>
+    static job make_job_for( const job& parent, Fn&& fn, T** ptr )
+    {
+      return make_job( parent, [&fn,ptr]()
+      {
+        *ptr = &std::forward<Fn>(fn)();
+      });
+    }
+  };
+
+  //---------------------------------------------------------------------------
+
+  template<>
+  struct serial_queue_post_job_and_wait_impl<void>
+  {
+    template<typename...Args>
+    static void invoke( serial_queue& queue, Args&&...args )
+    {
+      auto job = make_job_for( std::forward<Args>(args)... );
+
+      auto handle = job_handle(job);
+      queue.post_job( std::move(job) );
+      queue.wait( handle );
+    }
+
+    template<typename Fn>
+    static job make_job_for( Fn&& fn )
+    {
+      return make_job( [&fn]()
+      {
+        std::forward<Fn>(fn)();
+      });
+    }
+
+    template<typename Fn>
+    static job make_job_for( const job& parent, Fn&& fn )
+    {
+      return make_job( parent, [&fn]()
+      {
+        std::forward<Fn>(fn)();
+      });
+    }
+  };
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// serial_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline bit::platform::dispatcher& bit::platform::serial_queue::get_dispatcher()
+  const noexcept
+{
+  return m_dispatcher;
+}
+
+inline std::size_t bit::platform::serial_queue::batch_size()
+  const noexcept
+{
+  return m_batch_size;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+void bit::platform::serial_queue::post( Fn&& fn, Args&&...args )
+{
+  post_job( make_job( std::forward<Fn>(fn), std::forward<Args>(args)... ) );
+}
+
+template<typename Fn, typename...Args>
+void bit::platform::serial_queue::post( const job& parent,
+                                        Fn&& fn, Args&&...args )
+{
+  post_job( make_job( parent,
+                      std::forward<Fn>(fn),
+                      std::forward<Args>(args)... ) );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::serial_queue::post_and_wait( Fn&& fn, Args&&...args )
+{
+  using result_type = stl::invoke_result_t<Fn,Args...>;
+
+  // Arguments are bound by reference, since they outlive the wait
+  auto bound = [&]() -> result_type
+  {
+    return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+  };
+
+  return detail::serial_queue_post_job_and_wait_impl<result_type>
+    ::invoke( *this, bound );
+}
+
+template<typename Fn, typename...Args>
+bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::serial_queue::post_and_wait( const job& parent,
+                                              Fn&& fn, Args&&...args )
+{
+  using result_type = stl::invoke_result_t<Fn,Args...>;
+
+  // Arguments are bound by reference, since they outlive the wait
+  auto bound = [&]() -> result_type
+  {
+    return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+  };
+
+  return detail::serial_queue_post_job_and_wait_impl<result_type>
+    ::invoke( *this, parent, bound );
+}
+
+//-----------------------------------------------------------------------------
+// Free Functions
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args, typename>
+inline void bit::platform::post( serial_queue& queue,
+                                 Fn&& fn, Args&&...args )
+{
+  queue.post( std::forward<Fn>(fn), std::forward<Args>(args)... );
+}
+
+template<typename Fn, typename...Args, typename>
+inline void bit::platform::post( serial_queue& queue,
+                                 const job& parent, Fn&& fn, Args&&...args )
+{
+  queue.post( parent, std::forward<Fn>(fn), std::forward<Args>(args)... );
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args, typename>
+bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::post_and_wait( serial_queue& queue, Fn&& fn, Args&&...args )
+{
+  return queue.post_and_wait( std::forward<Fn>(fn),
+                              std::forward<Args>(args)... );
+}
+
+template<typename Fn, typename...Args, typename>
+bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::post_and_wait( serial_queue& queue,
+                                const job& parent, Fn&& fn, Args&&...args )
+{
+  return queue.post_and_wait( parent,
+                              std::forward<Fn>(fn),
+                              std::forward<Args>(args)... );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_SERIAL_QUEUE_INL */
@@ -0,0 +1,148 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_SHARDED_EXECUTOR_INL
+#define BIT_PLATFORM_THREADING_DETAIL_SHARDED_EXECUTOR_INL
+
+//=============================================================================
+// shard_arena
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Allocation
+//-----------------------------------------------------------------------------
+
+inline void bit::platform::shard_arena::deallocate( void* p, std::size_t size )
+  noexcept
+{
+  (void) p;
+  (void) size;
+}
+
+//=============================================================================
+// executor_shard
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline std::size_t bit::platform::executor_shard::index()
+  const noexcept
+{
+  return m_index;
+}
+
+inline bit::platform::sharded_executor&
+  bit::platform::executor_shard::get_executor()
+  const noexcept
+{
+  return m_executor;
+}
+
+inline bit::platform::shard_arena& bit::platform::executor_shard::arena()
+  noexcept
+{
+  BIT_ASSERT( sharded_executor::this_shard() == this,
+              "executor_shard::arena: must be called from the shard's own thread" );
+
+  return m_arena;
+}
+
+//-----------------------------------------------------------------------------
+// Execution
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+inline void bit::platform::executor_shard::post( Fn&& fn, Args&&...args )
+{
+  // tuple is to account for performing a decay copy to simulate
+  // behaviour of std::thread
+  post( unique_task( [fn = std::decay_t<Fn>( std::forward<Fn>(fn) ),
+                      tuple = std::make_tuple( std::forward<Args>(args)... )]() mutable
+  {
+    stl::apply( std::move(fn), std::move(tuple) );
+  }));
+}
+
+template<typename Fn, typename...Args>
+inline bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::executor_shard::post_and_wait( Fn&& fn, Args&&...args )
+{
+  using result_type = bit::stl::invoke_result_t<Fn,Args...>;
+
+  auto* const current = sharded_executor::this_shard();
+
+  // Waiting on this shard for a task queued behind the wait would deadlock
+  if( current == this ) {
+    return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+  }
+
+  detail::task_result<result_type> result;
+  completion_flag                  done;
+
+  post( unique_task( [&]()
+  {
+    result.store( [&]() -> result_type
+    {
+      return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+    });
+    done.signal();
+  }));
+
+  // A shard that blocks could deadlock with a shard that is waiting on it,
+  // so shards keep serving their own tasks instead
+  if( current ) {
+    while( !done.signaled() ) {
+      if( current->poll() ) continue;
+
+      yield_lease();
+      std::this_thread::yield();
+    }
+  } else {
+    done.wait();
+  }
+
+  return result.get();
+}
+
+//=============================================================================
+// sharded_executor
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline std::size_t bit::platform::sharded_executor::size()
+  const noexcept
+{
+  return m_shards.size();
+}
+
+inline bit::platform::executor_shard&
+  bit::platform::sharded_executor::operator[]( std::size_t index )
+  noexcept
+{
+  BIT_ASSERT( index < m_shards.size(), "sharded_executor::operator[]: index out of range" );
+
+  return *m_shards[index];
+}
+
+//-----------------------------------------------------------------------------
+// Execution
+//-----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+inline bit::platform::future<bit::stl::invoke_result_t<std::decay_t<Fn>,std::decay_t<Args>...>>
+  bit::platform::sharded_executor::submit_to( std::size_t index,
+                                              Fn&& fn,
+                                              Args&&...args )
+{
+  return post_async( (*this)[index], std::forward<Fn>(fn), std::forward<Args>(args)... );
+}
+
+inline void bit::platform::sharded_executor::post_to( std::size_t index,
+                                                      unique_task task )
+{
+  (*this)[index].post( std::move(task) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_SHARDED_EXECUTOR_INL */
@@ -0,0 +1,574 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_SPSC_QUEUE_INL
+#define BIT_PLATFORM_THREADING_DETAIL_SPSC_QUEUE_INL
+
+//============================================================================
+// spsc_queue
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::spsc_queue<T,Allocator>::spsc_queue( size_type capacity )
+  : spsc_queue( capacity, Allocator() )
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::spsc_queue<T,Allocator>
+  ::spsc_queue( size_type capacity, const Allocator& alloc )
+  : m_allocator(alloc),
+    m_buffer(nullptr),
+    m_mask(0u),
+    m_tail(0u),
+    m_cached_head(0u),
+    m_head(0u),
+    m_cached_tail(0u)
+{
+  BIT_ASSERT( capacity > 0, "spsc_queue: capacity must be greater than zero" );
+
+  auto size = size_type(1);
+  while( size < capacity ) size <<= 1;
+
+  m_buffer = storage_traits::allocate( m_allocator, size );
+  m_mask   = size - 1;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::spsc_queue<T,Allocator>::~spsc_queue()
+{
+  const auto tail = m_tail.load( std::memory_order_relaxed );
+
+  for( auto i = m_head.load( std::memory_order_relaxed ); i != tail; ++i ) {
+    entry(i)->~T();
+  }
+  storage_traits::deallocate( m_allocator, m_buffer, m_mask + 1 );
+}
+
+//----------------------------------------------------------------------------
+// Capacity
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::spsc_queue<T,Allocator>::empty()
+  const noexcept
+{
+  return size() == 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::size()
+  const noexcept
+{
+  const auto head = m_head.load( std::memory_order_acquire );
+  const auto tail = m_tail.load( std::memory_order_acquire );
+
+  return tail - head;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::capacity()
+  const noexcept
+{
+  return m_mask + 1;
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::spsc_queue<T,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//----------------------------------------------------------------------------
+// Consumer
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::spsc_queue<T,Allocator>::try_pop( T* value )
+{
+  BIT_ASSERT( value, "spsc_queue::try_pop: value cannot be null");
+
+  const auto head = m_head.load( std::memory_order_relaxed );
+
+  if( used_slots( head, 1u ) == 0u ) return false;
+
+  auto p = entry(head);
+  (*value) = std::move(*p);
+  p->~T();
+
+  m_head.store( head + 1, std::memory_order_release );
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::pop_n( stl::span<T> values )
+{
+  const auto wanted = static_cast<size_type>(values.size());
+  const auto head   = m_head.load( std::memory_order_relaxed );
+  const auto used   = used_slots( head, wanted );
+  const auto count  = used < wanted ? used : wanted;
+
+  auto i = size_type(0);
+  try {
+    for( ; i < count; ++i ) {
+      auto p = entry(head + i);
+      values[i] = std::move(*p);
+      p->~T();
+    }
+  } catch( ... ) {
+    // The entry whose assignment threw stays in the queue
+    m_head.store( head + i, std::memory_order_release );
+    throw;
+  }
+
+  m_head.store( head + count, std::memory_order_release );
+  return count;
+}
+
+//----------------------------------------------------------------------------
+// Producer
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::spsc_queue<T,Allocator>
+  ::try_push_back( const T& value )
+{
+  return try_emplace_back( value );
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::spsc_queue<T,Allocator>
+  ::try_push_back( T&& value )
+{
+  return try_emplace_back( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline bool bit::platform::spsc_queue<T,Allocator>
+  ::try_emplace_back( Args&&...args )
+{
+  const auto tail = m_tail.load( std::memory_order_relaxed );
+
+  if( free_slots( tail, 1u ) == 0u ) return false;
+
+  ::new(static_cast<void*>(entry(tail))) T( std::forward<Args>(args)... );
+
+  m_tail.store( tail + 1, std::memory_order_release );
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::push_n( stl::span<const T> values )
+{
+  const auto wanted = static_cast<size_type>(values.size());
+  const auto tail   = m_tail.load( std::memory_order_relaxed );
+  const auto room   = free_slots( tail, wanted );
+  const auto count  = room < wanted ? room : wanted;
+
+  auto i = size_type(0);
+  try {
+    for( ; i < count; ++i ) {
+      ::new(static_cast<void*>(entry(tail + i))) T( values[i] );
+    }
+  } catch( ... ) {
+    // Publish the entries that were constructed before the throw
+    m_tail.store( tail + i, std::memory_order_release );
+    throw;
+  }
+
+  m_tail.store( tail + count, std::memory_order_release );
+  return count;
+}
+
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline T* bit::platform::spsc_queue<T,Allocator>::entry( size_type position )
+  const noexcept
+{
+  return static_cast<T*>(static_cast<void*>(m_buffer + (position & m_mask)));
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::free_slots( size_type tail,
+                                                      size_type wanted )
+  noexcept
+{
+  auto room = capacity() - (tail - m_cached_head);
+
+  if( room < wanted ) {
+    m_cached_head = m_head.load( std::memory_order_acquire );
+    room = capacity() - (tail - m_cached_head);
+  }
+  return room;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::spsc_queue<T,Allocator>::size_type
+  bit::platform::spsc_queue<T,Allocator>::used_slots( size_type head,
+                                                      size_type wanted )
+  noexcept
+{
+  auto used = m_cached_tail - head;
+
+  if( used < wanted ) {
+    m_cached_tail = m_tail.load( std::memory_order_acquire );
+    used = m_cached_tail - head;
+  }
+  return used;
+}
+
+//============================================================================
+// unbounded_spsc_queue::segment
+//============================================================================
+
+template<typename T, typename Allocator>
+inline bit::platform::unbounded_spsc_queue<T,Allocator>::segment::segment()
+  noexcept
+  : next(nullptr),
+    count(0u),
+    free(nullptr)
+{
+
+}
+
+//============================================================================
+// unbounded_spsc_queue
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Static Members
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+constexpr typename bit::platform::unbounded_spsc_queue<T,Allocator>::size_type
+  bit::platform::unbounded_spsc_queue<T,Allocator>::segment_size;
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::unbounded_spsc_queue<T,Allocator>::unbounded_spsc_queue()
+  : unbounded_spsc_queue( Allocator() )
+{
+
+}
+
+template<typename T, typename Allocator>
+inline bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::unbounded_spsc_queue( const Allocator& alloc )
+  : m_allocator(alloc),
+    m_tail(nullptr),
+    m_tail_index(0u),
+    m_spare(nullptr),
+    m_head(nullptr),
+    m_head_index(0u),
+    m_cached_count(0u),
+    m_recycled(nullptr)
+{
+  m_tail = acquire_segment();
+  m_head = m_tail;
+}
+
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bit::platform::unbounded_spsc_queue<T,Allocator>::~unbounded_spsc_queue()
+{
+  auto destroy = [this]( segment* s )
+  {
+    segment_traits::destroy( m_allocator, s );
+    segment_traits::deallocate( m_allocator, s, 1u );
+  };
+
+  // Destroy the entries that were never popped, along with their segments
+  auto index = m_head_index;
+  for( auto s = m_head; s != nullptr; index = 0u ) {
+    const auto count = s->count.load( std::memory_order_relaxed );
+
+    for( auto i = index; i < count; ++i ) {
+      entry( s, i )->~T();
+    }
+
+    auto next = s->next.load( std::memory_order_relaxed );
+    destroy( s );
+    s = next;
+  }
+
+  for( auto s = m_recycled.load( std::memory_order_relaxed ); s != nullptr; ) {
+    auto next = s->free;
+    destroy( s );
+    s = next;
+  }
+
+  for( auto s = m_spare; s != nullptr; ) {
+    auto next = s->free;
+    destroy( s );
+    s = next;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline Allocator bit::platform::unbounded_spsc_queue<T,Allocator>::get_allocator()
+  const
+{
+  return Allocator( m_allocator );
+}
+
+//----------------------------------------------------------------------------
+// Consumer
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline bool bit::platform::unbounded_spsc_queue<T,Allocator>::empty()
+  const noexcept
+{
+  if( m_head_index < m_head->count.load( std::memory_order_acquire ) ) {
+    return false;
+  }
+  if( m_head_index == segment_size ) {
+    const auto next = m_head->next.load( std::memory_order_acquire );
+
+    return next == nullptr || next->count.load( std::memory_order_acquire ) == 0u;
+  }
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline bool bit::platform::unbounded_spsc_queue<T,Allocator>::try_pop( T* value )
+{
+  BIT_ASSERT( value, "unbounded_spsc_queue::try_pop: value cannot be null");
+
+  if( readable() == 0u ) return false;
+
+  auto p = entry( m_head, m_head_index );
+  (*value) = std::move(*p);
+  p->~T();
+
+  ++m_head_index;
+  return true;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::unbounded_spsc_queue<T,Allocator>::size_type
+  bit::platform::unbounded_spsc_queue<T,Allocator>::pop_n( stl::span<T> values )
+{
+  const auto wanted = static_cast<size_type>(values.size());
+
+  auto popped = size_type(0);
+  while( popped < wanted ) {
+    const auto available = readable();
+    if( available == 0u ) break;
+
+    const auto count = (wanted - popped) < available ? (wanted - popped) : available;
+    for( auto i = size_type(0); i < count; ++i ) {
+      auto p = entry( m_head, m_head_index );
+      values[popped] = std::move(*p);
+      p->~T();
+
+      // Advanced per entry, so that a throwing assignment leaves the queue
+      // consistent
+      ++m_head_index;
+      ++popped;
+    }
+  }
+  return popped;
+}
+
+//----------------------------------------------------------------------------
+// Producer
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::push_back( const T& value )
+{
+  emplace_back( value );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::push_back( T&& value )
+{
+  emplace_back( std::move(value) );
+}
+
+template<typename T, typename Allocator>
+template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>*>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::emplace_back( Args&&...args )
+{
+  if( m_tail_index == segment_size ) {
+    advance_tail();
+  }
+
+  ::new(static_cast<void*>(entry( m_tail, m_tail_index ))) T( std::forward<Args>(args)... );
+
+  m_tail->count.store( ++m_tail_index, std::memory_order_release );
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::push_n( stl::span<const T> values )
+{
+  const auto wanted = static_cast<size_type>(values.size());
+
+  auto pushed = size_type(0);
+  while( pushed < wanted ) {
+    if( m_tail_index == segment_size ) {
+      advance_tail();
+    }
+
+    const auto room  = segment_size - m_tail_index;
+    const auto count = (wanted - pushed) < room ? (wanted - pushed) : room;
+    const auto first = m_tail_index;
+
+    try {
+      for( ; m_tail_index < first + count; ++m_tail_index, ++pushed ) {
+        ::new(static_cast<void*>(entry( m_tail, m_tail_index ))) T( values[pushed] );
+      }
+    } catch( ... ) {
+      // Publish the entries that were constructed before the throw
+      m_tail->count.store( m_tail_index, std::memory_order_release );
+      throw;
+    }
+
+    m_tail->count.store( m_tail_index, std::memory_order_release );
+  }
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::reserve( size_type count )
+{
+  if( m_spare == nullptr ) {
+    m_spare = m_recycled.exchange( nullptr, std::memory_order_acquire );
+  }
+
+  auto available = segment_size - m_tail_index;
+  for( auto s = m_spare; s != nullptr && available < count; s = s->free ) {
+    available += segment_size;
+  }
+
+  while( available < count ) {
+    auto s = segment_traits::allocate( m_allocator, 1u );
+    segment_traits::construct( m_allocator, s );
+
+    s->free = m_spare;
+    m_spare = s;
+    available += segment_size;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Private Member Functions
+//----------------------------------------------------------------------------
+
+template<typename T, typename Allocator>
+inline T* bit::platform::unbounded_spsc_queue<T,Allocator>
+  ::entry( segment* s, size_type index )
+  noexcept
+{
+  return static_cast<T*>(static_cast<void*>(&s->entries[index]));
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>::advance_tail()
+{
+  auto s = acquire_segment();
+
+  // Publishes the reset of a recycled segment along with the link
+  m_tail->next.store( s, std::memory_order_release );
+  m_tail       = s;
+  m_tail_index = 0u;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::unbounded_spsc_queue<T,Allocator>::segment*
+  bit::platform::unbounded_spsc_queue<T,Allocator>::acquire_segment()
+{
+  if( m_spare == nullptr ) {
+    m_spare = m_recycled.exchange( nullptr, std::memory_order_acquire );
+  }
+
+  if( m_spare != nullptr ) {
+    auto s = m_spare;
+    m_spare = s->free;
+
+    s->next.store( nullptr, std::memory_order_relaxed );
+    s->count.store( 0u, std::memory_order_relaxed );
+    s->free = nullptr;
+    return s;
+  }
+
+  auto s = segment_traits::allocate( m_allocator, 1u );
+  segment_traits::construct( m_allocator, s );
+  return s;
+}
+
+template<typename T, typename Allocator>
+inline typename bit::platform::unbounded_spsc_queue<T,Allocator>::size_type
+  bit::platform::unbounded_spsc_queue<T,Allocator>::readable()
+  noexcept
+{
+  if( m_head_index < m_cached_count ) {
+    return m_cached_count - m_head_index;
+  }
+
+  m_cached_count = m_head->count.load( std::memory_order_acquire );
+  if( m_head_index < m_cached_count ) {
+    return m_cached_count - m_head_index;
+  }
+
+  if( m_head_index != segment_size ) return 0u;
+
+  // The head is drained; the producer never touches it again once it has
+  // linked the next segment
+  auto next = m_head->next.load( std::memory_order_acquire );
+  if( next == nullptr ) return 0u;
+
+  auto drained = m_head;
+  m_head         = next;
+  m_head_index   = 0u;
+  m_cached_count = next->count.load( std::memory_order_acquire );
+  recycle( drained );
+
+  return m_cached_count;
+}
+
+template<typename T, typename Allocator>
+inline void bit::platform::unbounded_spsc_queue<T,Allocator>::recycle( segment* s )
+  noexcept
+{
+  s->free = m_recycled.load( std::memory_order_relaxed );
+
+  while( !m_recycled.compare_exchange_weak( s->free, s,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed ) ) {
+    // retry with the new list head
+  }
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_SPSC_QUEUE_INL */
@@ -0,0 +1,230 @@
+/**
+ * \file task_result.hpp
+ *
+ * \brief This header contains the storage for the outcome of a task that is
+ *        executed on another thread
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_TASK_RESULT_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_TASK_RESULT_HPP
+
+#include <exception>   // std::exception_ptr, std::current_exception
+#include <memory>      // std::addressof
+#include <new>         // placement-new
+#include <type_traits> // std::aligned_storage_t
+#include <utility>     // std::move, std::forward
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief Holds either the value returned by a task, or the exception
+      ///        it exited with
+      ///
+      /// The result is stored by the executing thread, and retrieved by the
+      /// waiting thread once the two have synchronized.
+      ///
+      /// \tparam T the type of the result
+      /////////////////////////////////////////////////////////////////////////
+      template<typename T>
+      class task_result
+      {
+      public:
+
+        task_result() noexcept;
+        ~task_result();
+
+        task_result( const task_result& other ) = delete;
+        task_result& operator=( const task_result& other ) = delete;
+
+        /// \brief Invokes \p fn, storing its result or exception
+        template<typename Fn>
+        void store( Fn&& fn ) noexcept;
+
+        /// \brief Stores the exception \p error as the result
+        void set_exception( std::exception_ptr error ) noexcept;
+
+        /// \brief Retrieves the stored result, rethrowing the stored
+        ///        exception if there is one
+        T get();
+
+      private:
+
+        std::aligned_storage_t<sizeof(T),alignof(T)> m_storage;
+        std::exception_ptr                           m_error;
+        bool                                         m_has_value;
+      };
+
+      template<typename T>
+      class task_result<T&>
+      {
+      public:
+
+        task_result() noexcept;
+
+        task_result( const task_result& other ) = delete;
+        task_result& operator=( const task_result& other ) = delete;
+
+        template<typename Fn>
+        void store( Fn&& fn ) noexcept;
+
+        void set_exception( std::exception_ptr error ) noexcept;
+
+        T& get();
+
+      private:
+
+        T*                 m_value;
+        std::exception_ptr m_error;
+      };
+
+      template<>
+      class task_result<void>
+      {
+      public:
+
+        task_result() noexcept = default;
+
+        task_result( const task_result& other ) = delete;
+        task_result& operator=( const task_result& other ) = delete;
+
+        template<typename Fn>
+        void store( Fn&& fn ) noexcept;
+
+        void set_exception( std::exception_ptr error ) noexcept;
+
+        void get();
+
+      private:
+
+        std::exception_ptr m_error;
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::task_result<T>
+//=============================================================================
+
+template<typename T>
+inline bit::platform::detail::task_result<T>::task_result()
+  noexcept
+  : m_error(),
+    m_has_value(false)
+{
+
+}
+
+template<typename T>
+inline bit::platform::detail::task_result<T>::~task_result()
+{
+  if( m_has_value ) {
+    reinterpret_cast<T*>(&m_storage)->~T();
+  }
+}
+
+template<typename T>
+template<typename Fn>
+inline void bit::platform::detail::task_result<T>::store( Fn&& fn )
+  noexcept
+{
+  try {
+    ::new (&m_storage) T( std::forward<Fn>(fn)() );
+    m_has_value = true;
+  } catch( ... ) {
+    m_error = std::current_exception();
+  }
+}
+
+template<typename T>
+inline void bit::platform::detail::task_result<T>
+  ::set_exception( std::exception_ptr error )
+  noexcept
+{
+  m_error = std::move(error);
+}
+
+template<typename T>
+inline T bit::platform::detail::task_result<T>::get()
+{
+  if( m_error ) std::rethrow_exception( m_error );
+
+  return std::move( *reinterpret_cast<T*>(&m_storage) );
+}
+
+//=============================================================================
+// detail::task_result<T&>
+//=============================================================================
+
+template<typename T>
+inline bit::platform::detail::task_result<T&>::task_result()
+  noexcept
+  : m_value(nullptr),
+    m_error()
+{
+
+}
+
+template<typename T>
+template<typename Fn>
+inline void bit::platform::detail::task_result<T&>::store( Fn&& fn )
+  noexcept
+{
+  try {
+    m_value = std::addressof( std::forward<Fn>(fn)() );
+  } catch( ... ) {
+    m_error = std::current_exception();
+  }
+}
+
+template<typename T>
+inline void bit::platform::detail::task_result<T&>
+  ::set_exception( std::exception_ptr error )
+  noexcept
+{
+  m_error = std::move(error);
+}
+
+template<typename T>
+inline T& bit::platform::detail::task_result<T&>::get()
+{
+  if( m_error ) std::rethrow_exception( m_error );
+
+  return *m_value;
+}
+
+//=============================================================================
+// detail::task_result<void>
+//=============================================================================
+
+template<typename Fn>
+inline void bit::platform::detail::task_result<void>::store( Fn&& fn )
+  noexcept
+{
+  try {
+    std::forward<Fn>(fn)();
+  } catch( ... ) {
+    m_error = std::current_exception();
+  }
+}
+
+inline void bit::platform::detail::task_result<void>
+  ::set_exception( std::exception_ptr error )
+  noexcept
+{
+  m_error = std::move(error);
+}
+
+inline void bit::platform::detail::task_result<void>::get()
+{
+  if( m_error ) std::rethrow_exception( m_error );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_TASK_RESULT_HPP */
@@ -0,0 +1,68 @@
+/**
+ * \file this_thread.hpp
+ *
+ * \brief This header contains values local to the calling thread that are
+ *        used to spread threads over shared structures
+ *
+ * \note This is an internal header file, included by other library headers.
+ *       Do not attempt to use it directly.
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_DETAIL_THIS_THREAD_HPP
+#define BIT_PLATFORM_THREADING_DETAIL_THIS_THREAD_HPP
+
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint32_t
+#include <functional> // std::hash
+#include <thread>     // std::this_thread
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /// \brief Gets a number that identifies the calling thread, used to
+      ///        spread threads over striped counters
+      ///
+      /// \return the stripe of the calling thread
+      std::size_t this_thread_stripe() noexcept;
+
+      /// \brief Gets the next number of a random sequence that is local to
+      ///        the calling thread
+      ///
+      /// \return a pseudo-random number
+      std::uint32_t this_thread_random() noexcept;
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// detail::this_thread_stripe
+//=============================================================================
+
+inline std::size_t bit::platform::detail::this_thread_stripe()
+  noexcept
+{
+  static thread_local const auto stripe = std::hash<std::thread::id>{}( std::this_thread::get_id() );
+
+  return stripe;
+}
+
+//=============================================================================
+// detail::this_thread_random
+//=============================================================================
+
+inline std::uint32_t bit::platform::detail::this_thread_random()
+  noexcept
+{
+  // xorshift32, seeded differently on every thread; the seed must not be 0
+  static thread_local auto state = static_cast<std::uint32_t>(this_thread_stripe()) | 1u;
+
+  state ^= state << 13u;
+  state ^= state >> 17u;
+  state ^= state << 5u;
+  return state;
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_THIS_THREAD_HPP */
@@ -1,17 +1,163 @@
 #ifndef BIT_PLATFORM_THREADING_DETAIL_THREAD_POOL_INL
 #define BIT_PLATFORM_THREADING_DETAIL_THREAD_POOL_INL
 
+//============================================================================
+// detail::thread_pool_context
+//============================================================================
+
+inline bit::platform::detail::thread_pool_context&
+  bit::platform::detail::this_thread_pool_context()
+  noexcept
+{
+  thread_local thread_pool_context s_context = { nullptr, 0u };
+
+  return s_context;
+}
+
+//============================================================================
+// basic_thread_pool::task_queue
+//============================================================================
+
+template<typename Allocator>
+constexpr std::size_t
+  bit::platform::basic_thread_pool<Allocator>::task_queue::initial_capacity;
+
+template<typename Allocator>
+inline bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::task_queue( const task_allocator& allocator )
+  : m_lock(),
+    m_allocator( allocator ),
+    m_buffer( nullptr ),
+    m_capacity( 0 ),
+    m_head( 0 ),
+    m_size( 0 )
+{
+
+}
+
+template<typename Allocator>
+inline bit::platform::basic_thread_pool<Allocator>::task_queue::~task_queue()
+{
+  if( !m_buffer ) return;
+
+  const auto mask = m_capacity - 1;
+  for( auto i = std::size_t{0}; i < m_size; ++i ) {
+    task_traits::destroy( m_allocator, m_buffer + ((m_head + i) & mask) );
+  }
+  task_traits::deallocate( m_allocator, m_buffer, m_capacity );
+}
+
+template<typename Allocator>
+inline bool bit::platform::basic_thread_pool<Allocator>::task_queue::empty()
+  const
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_size == 0;
+}
+
+template<typename Allocator>
+inline void bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::push( value_type task )
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( m_size == m_capacity ) grow();
+
+  const auto index = (m_head + m_size) & (m_capacity - 1);
+  task_traits::construct( m_allocator, m_buffer + index, std::move(task) );
+  ++m_size;
+}
+
+template<typename Allocator>
+inline bool bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::try_pop_back( value_type* task )
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( m_size == 0 ) return false;
+
+  --m_size;
+  auto* back = m_buffer + ((m_head + m_size) & (m_capacity - 1));
+
+  (*task) = std::move(*back);
+  task_traits::destroy( m_allocator, back );
+  return true;
+}
+
+template<typename Allocator>
+inline bool bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::try_pop_front( value_type* task )
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( m_size == 0 ) return false;
+
+  pop_front( task );
+  return true;
+}
+
+template<typename Allocator>
+inline bool bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::try_steal( value_type* task )
+{
+  // Thieves never wait on a contended queue; they move on to the next one
+  std::unique_lock<spin_lock> lock(m_lock, std::try_to_lock);
+
+  if( !lock.owns_lock() || m_size == 0 ) return false;
+
+  pop_front( task );
+  return true;
+}
+
+template<typename Allocator>
+inline void bit::platform::basic_thread_pool<Allocator>::task_queue::grow()
+{
+  const auto capacity = m_capacity ? (m_capacity * 2) : initial_capacity;
+  auto* buffer = task_traits::allocate( m_allocator, capacity );
+
+  // Tasks are nothrow-movable, so relocating them cannot fail part-way
+  const auto mask = m_capacity - 1;
+  for( auto i = std::size_t{0}; i < m_size; ++i ) {
+    auto* task = m_buffer + ((m_head + i) & mask);
+
+    task_traits::construct( m_allocator, buffer + i, std::move(*task) );
+    task_traits::destroy( m_allocator, task );
+  }
+
+  if( m_buffer ) {
+    task_traits::deallocate( m_allocator, m_buffer, m_capacity );
+  }
+
+  m_buffer   = buffer;
+  m_capacity = capacity;
+  m_head     = 0;
+}
+
+template<typename Allocator>
+inline void bit::platform::basic_thread_pool<Allocator>::task_queue
+  ::pop_front( value_type* task )
+{
+  auto* front = m_buffer + m_head;
+
+  (*task) = std::move(*front);
+  task_traits::destroy( m_allocator, front );
+
+  m_head = (m_head + 1) & (m_capacity - 1);
+  --m_size;
+}
+
 //============================================================================
 // basic_thread_pool
 //============================================================================
 
 //----------------------------------------------------------------------------
-// Constructors
+// Constructors / Destructor
 //----------------------------------------------------------------------------
 
 template<typename Allocator>
 bit::platform::basic_thread_pool<Allocator>::basic_thread_pool()
-  : basic_thread_pool( std::thread::hardware_concurrency(), Allocator() )
+  : basic_thread_pool( available_concurrency(), Allocator() )
 {
 
 }
@@ -27,7 +173,25 @@ bit::platform::basic_thread_pool<Allocator>
 template<typename Allocator>
 bit::platform::basic_thread_pool<Allocator>
   ::basic_thread_pool( const Allocator& allocator )
-  : basic_thread_pool( std::thread::hardware_concurrency(), allocator )
+  : basic_thread_pool( available_concurrency(), allocator )
+{
+
+}
+
+template<typename Allocator>
+bit::platform::basic_thread_pool<Allocator>
+  ::basic_thread_pool( std::allocator_arg_t, const Allocator& allocator )
+  : basic_thread_pool( available_concurrency(), allocator )
+{
+
+}
+
+template<typename Allocator>
+bit::platform::basic_thread_pool<Allocator>
+  ::basic_thread_pool( std::allocator_arg_t,
+                       const Allocator& allocator,
+                       std::size_t capacity )
+  : basic_thread_pool( capacity, allocator )
 {
 
 }
@@ -35,20 +199,29 @@ bit::platform::basic_thread_pool<Allocator>
 template<typename Allocator>
 bit::platform::basic_thread_pool<Allocator>
   ::basic_thread_pool( std::size_t capacity, const Allocator& allocator )
-  : m_threads( allocator ),
-    m_queue( allocator ),
-    m_is_running(true)
+  : m_threads( thread_allocator(allocator) ),
+    m_allocator( allocator ),
+    m_injection( task_allocator(allocator) ),
+    m_workers( nullptr ),
+    m_capacity( capacity ? capacity : 1u ),
+    m_epoch( 0 ),
+    m_sleepers( 0 ),
+    m_is_running( true )
 {
-  m_threads.resize( capacity );
+  m_workers = queue_traits::allocate( m_allocator, m_capacity );
+  for( auto i = std::size_t{0}; i < m_capacity; ++i ) {
+    queue_traits::construct( m_allocator,
+                             m_workers + i,
+                             task_allocator(allocator) );
+  }
 
-  for( auto i = 0; i < m_threads.size(); ++i ) {
-    m_threads[i] = std::thread([this]()
+  concurrency_arbiter::global().attach( m_capacity );
+
+  m_threads.reserve( m_capacity );
+  for( auto i = std::size_t{0}; i < m_capacity; ++i ) {
+    m_threads.emplace_back( [this,i]()
     {
-      while( m_is_running ) {
-        std::packaged_task<void()> task;
-        m_queue.pop( &task );
-        task();
-      }
+      work( i );
     });
   }
 }
@@ -57,56 +230,265 @@ template<typename Allocator>
 bit::platform::basic_thread_pool<Allocator>::~basic_thread_pool()
 {
   m_is_running = false;
+
+  m_epoch.fetch_add( 1 );
+  futex_wake_all( m_epoch );
+
   for( auto& thread : m_threads ) {
     thread.join();
   }
+  concurrency_arbiter::global().detach( m_capacity );
+
+  for( auto i = std::size_t{0}; i < m_capacity; ++i ) {
+    queue_traits::destroy( m_allocator, m_workers + i );
+  }
+  queue_traits::deallocate( m_allocator, m_workers, m_capacity );
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+template<typename Allocator>
+typename bit::platform::basic_thread_pool<Allocator>::allocator_type
+  bit::platform::basic_thread_pool<Allocator>::get_allocator()
+  const
+{
+  return allocator_type( m_allocator );
+}
+
+template<typename Allocator>
+std::size_t bit::platform::basic_thread_pool<Allocator>::capacity()
+  const noexcept
+{
+  return m_capacity;
 }
 
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
 template<typename Allocator>
 template<typename Fn, typename...Args>
 void bit::platform::basic_thread_pool<Allocator>::post( Fn&& fn, Args&&...args )
 {
   // tuple is to account for performing a decay copy to simulate
   // behaviour of std::thread
-  m_queue.emplace_back( std::allocator_arg,
-                        m_queue.get_allocator(),
-                        [fn,tuple=std::make_tuple(args...)]()
+  enqueue( value_type( std::allocator_arg,
+                       m_allocator,
+                       [fn = std::decay_t<Fn>( std::forward<Fn>(fn) ),
+                        tuple = std::make_tuple( std::forward<Args>(args)... )]() mutable
   {
-    stl::apply( fn, tuple );
-  });
+    stl::apply( std::move(fn), std::move(tuple) );
+  }));
+}
+
+template<typename Allocator>
+void bit::platform::basic_thread_pool<Allocator>::post( unique_task task )
+{
+  enqueue( std::move(task) );
 }
 
 template<typename Allocator>
 template<typename Fn, typename...Args>
-bit::stl::invoke_result_t<std::decay_t<Fn>>
+bit::stl::invoke_result_t<Fn,Args...>
   bit::platform::basic_thread_pool<Allocator>::post_and_wait( Fn&& fn,
                                                               Args&&...args )
 {
-  using result_type = bit::stl::invoke_result_t<std::decay_t<Fn>>;
+  using result_type = bit::stl::invoke_result_t<Fn,Args...>;
 
-  auto decay_copy = []( auto&& x ){ return x; };
+  // The function, its arguments, and the result all stay on this thread's
+  // stack until the task signals completion, so the task is only a few
+  // references in size and never allocates
+  detail::task_result<result_type> result;
+  completion_flag                  done;
 
-  union output
+  enqueue( value_type( [&]()
   {
-    result_type    type;
-    struct empty{} empty;
+    result.store( [&]() -> result_type
+    {
+      return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+    });
+    done.signal();
+  }));
+
+  // A worker that blocks could starve the pool of the very worker needed to
+  // run the task, so workers help instead
+  const auto& context = detail::this_thread_pool_context();
+  if( context.pool == this ) {
+    while( !done.signaled() ) {
+      if( run_one( context.index ) ) continue;
+
+      yield_lease();
+      std::this_thread::yield();
+    }
+  } else {
+    done.wait();
+  }
+
+  return result.get();
+}
+
+//----------------------------------------------------------------------------
+// Private Modifiers
+//----------------------------------------------------------------------------
+
+template<typename Allocator>
+void bit::platform::basic_thread_pool<Allocator>::enqueue( value_type task )
+{
+  const auto& context = detail::this_thread_pool_context();
+
+  if( context.pool == this ) {
+    m_workers[context.index].push( std::move(task) );
+  } else {
+    m_injection.push( std::move(task) );
+  }
 
-    output() : empty{}{}
-  };
+  // Parking workers register before re-checking the queues, so either they
+  // observe this task or this observes them
+  if( m_sleepers.load() != 0 ) {
+    m_epoch.fetch_add( 1 );
+    futex_wake_one( m_epoch );
+  }
+}
+
+template<typename Allocator>
+bool bit::platform::basic_thread_pool<Allocator>
+  ::try_acquire( std::size_t index, value_type* task )
+{
+  if( m_workers[index].try_pop_back( task ) ) return true;
+  if( m_injection.try_pop_front( task ) ) return true;
 
-  output out;
+  for( auto i = std::size_t{1}; i < m_capacity; ++i ) {
+    if( m_workers[(index + i) % m_capacity].try_steal( task ) ) return true;
+  }
+  return false;
+}
+
+template<typename Allocator>
+bool bit::platform::basic_thread_pool<Allocator>::run_one( std::size_t index )
+{
+  auto task = value_type{};
+
+  if( !try_acquire( index, &task ) ) return false;
+
+  // A posted task has nowhere to report an exception to, so one that
+  // escapes is discarded rather than terminating the worker; post_and_wait
+  // forwards its exceptions to the waiting thread
+  try {
+    task();
+  } catch( ... ) {
+    // discarded
+  }
+  return true;
+}
+
+template<typename Allocator>
+bool bit::platform::basic_thread_pool<Allocator>::has_pending_tasks()
+  const
+{
+  if( !m_injection.empty() ) return true;
 
-  waitable_event event;
-  m_queue.emplace_back( std::allocator_arg,
-                        m_queue.get_allocator(),
-                        [&]()
+  for( auto i = std::size_t{0}; i < m_capacity; ++i ) {
+    if( !m_workers[i].empty() ) return true;
+  }
+  return false;
+}
+
+template<typename Allocator>
+void bit::platform::basic_thread_pool<Allocator>::work( std::size_t index )
+{
+  auto& context = detail::this_thread_pool_context();
+  context.pool  = this;
+  context.index = index;
+
+  auto& arbiter = concurrency_arbiter::global();
+  arbiter.acquire();
+
+  while( true ) {
+    if( run_one( index ) ) continue;
+
+    const auto epoch = m_epoch.load();
+    ++m_sleepers;
+
+    if( has_pending_tasks() ) {
+      --m_sleepers;
+      continue;
+    }
+
+    // Remaining tasks are always drained before stopping
+    if( !m_is_running ) {
+      --m_sleepers;
+      break;
+    }
+
+    { // Parked workers do not occupy a slot of the arbiter
+      blocking_region region;
+      futex_wait( m_epoch, epoch );
+    }
+    --m_sleepers;
+  }
+
+  arbiter.release();
+  context.pool = nullptr;
+}
+
+//============================================================================
+// cached_thread_pool
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Static Members
+//----------------------------------------------------------------------------
+
+inline constexpr bit::platform::cached_thread_pool::duration
+  bit::platform::cached_thread_pool::default_idle_timeout()
+  noexcept
+{
+  return std::chrono::seconds(60);
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+template<typename Fn, typename...Args>
+void bit::platform::cached_thread_pool::post( Fn&& fn, Args&&...args )
+{
+  dispatch( unique_task( [fn = std::decay_t<Fn>( std::forward<Fn>(fn) ),
+                          tuple = std::make_tuple( std::forward<Args>(args)... )]() mutable
   {
-    out.type = decay_copy(fn)( decay_copy(args)... );
-    event.signal();
-  });
-  event.wait();
+    stl::apply( std::move(fn), std::move(tuple) );
+  }));
+}
+
+inline void bit::platform::cached_thread_pool::post( unique_task task )
+{
+  dispatch( std::move(task) );
+}
+
+template<typename Fn, typename...Args>
+bit::stl::invoke_result_t<Fn,Args...>
+  bit::platform::cached_thread_pool::post_and_wait( Fn&& fn, Args&&...args )
+{
+  using result_type = bit::stl::invoke_result_t<Fn,Args...>;
+
+  detail::task_result<result_type> result;
+  completion_flag                  done;
+
+  dispatch( unique_task( [&]()
+  {
+    result.store( [&]() -> result_type
+    {
+      return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+    });
+    done.signal();
+  }));
+
+  // Concurrency is unbounded, so blocking can never starve the task
+  done.wait();
 
-  return out.type;
+  return result.get();
 }
 
 //============================================================================
@@ -125,32 +507,24 @@ void bit::platform::unlimited_thread_pool::post( Fn&& fn, Args&&...args )
 }
 
 template<typename Fn, typename...Args>
-bit::stl::invoke_result_t<std::decay_t<Fn>>
+bit::stl::invoke_result_t<Fn,Args...>
   bit::platform::unlimited_thread_pool::post_and_wait( Fn&& fn,
                                                        Args&&...args )
 {
-  using result_type = bit::stl::invoke_result_t<std::decay_t<Fn>>;
-
-  auto decay_copy = []( auto&& x ){ return x; };
-
-  union output
-  {
-    result_type    type;
-    struct empty{} empty;
+  using result_type = bit::stl::invoke_result_t<Fn,Args...>;
 
-    output() : empty{}{}
-  };
-
-  output out;
+  detail::task_result<result_type> result;
 
   auto thread = std::thread( [&]()
   {
-    out.type = decay_copy(fn)( decay_copy(args)... );
+    result.store( [&]() -> result_type
+    {
+      return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
+    });
   });
   thread.join();
 
-
-  return out.type;
+  return result.get();
 }
 
 //============================================================================
@@ -167,18 +541,17 @@ void bit::platform::sequential_thread_pool::post( Fn&& fn, Args&&...args )
   // NOTE:
   // technically a performance degradation; but this is done to preserve
   // semantic behaviour with other thread pools
-  auto decay_copy = []( auto&& x ){ return x; };
+  auto f     = std::decay_t<Fn>( std::forward<Fn>(fn) );
+  auto tuple = std::make_tuple( std::forward<Args>(args)... );
 
-  decay_copy(fn)( decay_copy(args)... );
+  stl::apply( std::move(f), std::move(tuple) );
 }
 
 template<typename Fn, typename...Args>
-bit::stl::invoke_result_t<std::decay_t<Fn>>
+bit::stl::invoke_result_t<Fn,Args...>
   bit::platform::sequential_thread_pool::post_and_wait( Fn&& fn,
                                                         Args&&...args )
 {
-  auto decay_copy = []( auto&& x ){ return x; };
-
-  return decay_copy(fn)( decay_copy(args)... );
+  return stl::invoke( std::forward<Fn>(fn), std::forward<Args>(args)... );
 }
 #endif /* BIT_PLATFORM_THREADING_DETAIL_THREAD_POOL_INL */
@@ -0,0 +1,82 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_TIMER_WHEEL_INL
+#define BIT_PLATFORM_THREADING_DETAIL_TIMER_WHEEL_INL
+
+//=============================================================================
+// timer_handle
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors
+//-----------------------------------------------------------------------------
+
+inline bit::platform::timer_handle::timer_handle()
+  noexcept
+  : m_node(nullptr),
+    m_generation(0)
+{
+
+}
+
+inline bit::platform::timer_handle::timer_handle( detail::timer_node* node,
+                                                  std::uint32_t generation )
+  noexcept
+  : m_node(node),
+    m_generation(generation)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Conversions
+//-----------------------------------------------------------------------------
+
+inline bit::platform::timer_handle::operator bool()
+  const noexcept
+{
+  return m_node != nullptr;
+}
+
+//=============================================================================
+// timer_wheel
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+inline bool bit::platform::timer_wheel::empty()
+  const noexcept
+{
+  return m_size == 0;
+}
+
+inline bit::platform::timer_wheel::size_type
+  bit::platform::timer_wheel::size()
+  const noexcept
+{
+  return m_size;
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+inline bit::platform::timer_wheel::duration
+  bit::platform::timer_wheel::resolution()
+  const noexcept
+{
+  return m_resolution;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+inline bit::platform::timer_handle
+  bit::platform::timer_wheel::schedule( time_point deadline,
+                                        callback_type callback )
+{
+  return schedule( deadline, duration::zero(), std::move(callback) );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_TIMER_WHEEL_INL */
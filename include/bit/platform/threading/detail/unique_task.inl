@@ -0,0 +1,297 @@
+#ifndef BIT_PLATFORM_THREADING_DETAIL_UNIQUE_TASK_INL
+#define BIT_PLATFORM_THREADING_DETAIL_UNIQUE_TASK_INL
+
+//=============================================================================
+// detail::inline_task_ops
+//=============================================================================
+
+template<typename Fn>
+constexpr bit::platform::detail::unique_task_vtable
+  bit::platform::detail::inline_task_ops<Fn>::vtable;
+
+template<typename Fn>
+inline void bit::platform::detail::inline_task_ops<Fn>::invoke( void* buffer )
+{
+  (*static_cast<Fn*>(buffer))();
+}
+
+template<typename Fn>
+inline void bit::platform::detail::inline_task_ops<Fn>
+  ::relocate( void* destination, void* source )
+{
+  auto* fn = static_cast<Fn*>(source);
+
+  ::new (destination) Fn( std::move(*fn) );
+  fn->~Fn();
+}
+
+template<typename Fn>
+inline void bit::platform::detail::inline_task_ops<Fn>::destroy( void* buffer )
+{
+  static_cast<Fn*>(buffer)->~Fn();
+}
+
+//=============================================================================
+// detail::allocated_task_ops
+//=============================================================================
+
+template<typename Fn, typename Allocator>
+constexpr bit::platform::detail::unique_task_vtable
+  bit::platform::detail::allocated_task_ops<Fn,Allocator>::vtable;
+
+template<typename Fn, typename Allocator>
+template<typename Func>
+inline bit::platform::detail::allocated_task_ops<Fn,Allocator>::box
+  ::box( const Allocator& allocator, Func&& fn )
+  : allocator(allocator),
+    fn(std::forward<Func>(fn))
+{
+
+}
+
+template<typename Fn, typename Allocator>
+inline void bit::platform::detail::allocated_task_ops<Fn,Allocator>
+  ::invoke( void* buffer )
+{
+  (*static_cast<box**>(buffer))->fn();
+}
+
+template<typename Fn, typename Allocator>
+inline void bit::platform::detail::allocated_task_ops<Fn,Allocator>
+  ::relocate( void* destination, void* source )
+{
+  ::new (destination) box*( *static_cast<box**>(source) );
+}
+
+template<typename Fn, typename Allocator>
+inline void bit::platform::detail::allocated_task_ops<Fn,Allocator>
+  ::destroy( void* buffer )
+{
+  auto* p = *static_cast<box**>(buffer);
+
+  // The allocator must outlive the box it is stored in
+  auto allocator = allocator_type( p->allocator );
+  alloc_traits::destroy( allocator, p );
+  alloc_traits::deallocate( allocator, p, 1 );
+}
+
+//=============================================================================
+// basic_unique_task
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+constexpr std::size_t bit::platform::basic_unique_task<BufferSize>::buffer_size;
+
+template<std::size_t BufferSize>
+template<typename Fn>
+inline constexpr bool bit::platform::basic_unique_task<BufferSize>
+  ::is_stored_inline()
+  noexcept
+{
+  return sizeof(Fn) <= BufferSize &&
+         alignof(Fn) <= alignof(storage_type) &&
+         std::is_nothrow_move_constructible<Fn>::value;
+}
+
+//-----------------------------------------------------------------------------
+// Constructors / Assignment / Destructor
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>::basic_unique_task()
+  noexcept
+  : m_vtable(nullptr)
+{
+
+}
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>
+  ::basic_unique_task( std::nullptr_t )
+  noexcept
+  : m_vtable(nullptr)
+{
+
+}
+
+template<std::size_t BufferSize>
+template<typename Fn, typename, typename>
+inline bit::platform::basic_unique_task<BufferSize>
+  ::basic_unique_task( Fn&& fn )
+  : m_vtable(nullptr)
+{
+  construct( std::allocator<char>(), std::forward<Fn>(fn) );
+}
+
+template<std::size_t BufferSize>
+template<typename Allocator, typename Fn, typename>
+inline bit::platform::basic_unique_task<BufferSize>
+  ::basic_unique_task( std::allocator_arg_t,
+                       const Allocator& allocator,
+                       Fn&& fn )
+  : m_vtable(nullptr)
+{
+  construct( allocator, std::forward<Fn>(fn) );
+}
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>
+  ::basic_unique_task( basic_unique_task&& other )
+  noexcept
+  : m_vtable(other.m_vtable)
+{
+  if( m_vtable ) {
+    m_vtable->relocate( &m_storage, &other.m_storage );
+    other.m_vtable = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>::~basic_unique_task()
+{
+  reset();
+}
+
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>&
+  bit::platform::basic_unique_task<BufferSize>
+  ::operator=( basic_unique_task&& other )
+  noexcept
+{
+  if( this == &other ) return (*this);
+
+  reset();
+
+  if( other.m_vtable ) {
+    other.m_vtable->relocate( &m_storage, &other.m_storage );
+    m_vtable       = other.m_vtable;
+    other.m_vtable = nullptr;
+  }
+  return (*this);
+}
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>&
+  bit::platform::basic_unique_task<BufferSize>::operator=( std::nullptr_t )
+  noexcept
+{
+  reset();
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline void bit::platform::basic_unique_task<BufferSize>
+  ::swap( basic_unique_task& other )
+  noexcept
+{
+  auto temp = std::move(other);
+  other = std::move(*this);
+  (*this) = std::move(temp);
+}
+
+//-----------------------------------------------------------------------------
+// Execution
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline void bit::platform::basic_unique_task<BufferSize>::operator()()
+{
+  assert( m_vtable != nullptr && "Cannot invoke an empty task" );
+
+  m_vtable->invoke( &m_storage );
+}
+
+//-----------------------------------------------------------------------------
+// Conversions
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+inline bit::platform::basic_unique_task<BufferSize>::operator bool()
+  const noexcept
+{
+  return m_vtable != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+template<std::size_t BufferSize>
+template<typename Allocator, typename Fn>
+inline void bit::platform::basic_unique_task<BufferSize>
+  ::construct( const Allocator& allocator, Fn&& fn )
+{
+  using fn_type = std::decay_t<Fn>;
+  using tag     = std::integral_constant<bool,is_stored_inline<fn_type>()>;
+
+  construct( tag{}, allocator, std::forward<Fn>(fn) );
+}
+
+template<std::size_t BufferSize>
+template<typename Allocator, typename Fn>
+inline void bit::platform::basic_unique_task<BufferSize>
+  ::construct( std::true_type, const Allocator&, Fn&& fn )
+{
+  using fn_type = std::decay_t<Fn>;
+
+  ::new (&m_storage) fn_type( std::forward<Fn>(fn) );
+  m_vtable = &detail::inline_task_ops<fn_type>::vtable;
+}
+
+template<std::size_t BufferSize>
+template<typename Allocator, typename Fn>
+inline void bit::platform::basic_unique_task<BufferSize>
+  ::construct( std::false_type, const Allocator& allocator, Fn&& fn )
+{
+  using ops_type       = detail::allocated_task_ops<std::decay_t<Fn>,Allocator>;
+  using allocator_type = typename ops_type::allocator_type;
+  using alloc_traits   = typename ops_type::alloc_traits;
+
+  auto box_allocator = allocator_type( allocator );
+  auto* p = alloc_traits::allocate( box_allocator, 1 );
+  try {
+    alloc_traits::construct( box_allocator, p, allocator, std::forward<Fn>(fn) );
+  } catch( ... ) {
+    alloc_traits::deallocate( box_allocator, p, 1 );
+    throw;
+  }
+
+  ::new (&m_storage) typename ops_type::box*( p );
+  m_vtable = &ops_type::vtable;
+}
+
+template<std::size_t BufferSize>
+inline void bit::platform::basic_unique_task<BufferSize>::reset()
+  noexcept
+{
+  if( m_vtable ) {
+    m_vtable->destroy( &m_storage );
+    m_vtable = nullptr;
+  }
+}
+
+//=============================================================================
+// Utilities
+//=============================================================================
+
+template<std::size_t BufferSize>
+inline void bit::platform::swap( basic_unique_task<BufferSize>& lhs,
+                                 basic_unique_task<BufferSize>& rhs )
+  noexcept
+{
+  lhs.swap( rhs );
+}
+
+#endif /* BIT_PLATFORM_THREADING_DETAIL_UNIQUE_TASK_INL */
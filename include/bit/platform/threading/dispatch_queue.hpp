@@ -9,27 +9,33 @@
 #ifndef BIT_PLATFORM_THREADING_DISPATCH_QUEUE_HPP
 #define BIT_PLATFORM_THREADING_DISPATCH_QUEUE_HPP
 
-#include "job.hpp" // job
+#include "job.hpp"               // job
+#include "detail/mpsc_queue.hpp" // detail::mpsc_queue
 
 #include <bit/stl/utilities/invoke.hpp>
 
-#include <atomic>  // std::atomic<bool>
-#include <condition_variable> // std::condition_variable
-#include <mutex>   // std::mutex
+#include <atomic>  // std::atomic
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t
 #include <thread>  // std::thread
 #include <utility> // std::forward
 
 namespace bit {
   namespace platform {
-    namespace detail {
-      class job_queue;
-    } // namespace detail
 
     ///////////////////////////////////////////////////////////////////////////
     /// \brief A dispatch queue that operates on jobs in a sequential,
     ///        thread-safe manner
     ///
     /// Posting an operation is thread-safe, and may be done from any thread.
+    ///
+    /// Jobs are linked into an intrusive lock-free queue, so posting costs a
+    /// single atomic exchange. The dispatching thread drains every available
+    /// job in one pass, and only sleeps on a futex once the queue is empty;
+    /// producers only issue a wake-up when they observe it sleeping.
+    ///
+    /// Threads that wait on a job sleep on the job itself, and are woken
+    /// by whichever thread finishes it.
     ///////////////////////////////////////////////////////////////////////////
     class dispatch_queue
     {
@@ -78,8 +84,9 @@ namespace bit {
 
       /// \brief Waits for a job \p job to be completed
       ///
-      /// The calling thread participates in executing jobs while waiting
-      /// for \p job to complete.
+      /// If called from a job running in this dispatch_queue, the calling
+      /// thread continues to execute jobs while waiting for \p job to
+      /// complete; otherwise it sleeps until woken for \p job.
       ///
       /// \param job the job to wait for
       void wait( job_handle job );
@@ -123,11 +130,10 @@ namespace bit {
       //-----------------------------------------------------------------------
     private:
 
-      std::unique_ptr<detail::job_queue> m_queue;
-      std::thread             m_thread;
-      std::mutex              m_mutex;
-      std::condition_variable m_cv;
-      std::atomic<bool>       m_is_running;
+      detail::mpsc_queue         m_queue;
+      std::thread                m_thread;
+      std::atomic<bool>          m_is_running;
+      std::atomic<std::uint32_t> m_sleeping; ///< Non-zero if the thread sleeps
 
       //-----------------------------------------------------------------------
       // Private Modifiers
@@ -137,11 +143,17 @@ namespace bit {
       /// \brief The thread function that operates on the job queue
       void run();
 
-      /// \brief Gets a job from the current queue, if one exists -- or waits
-      ///        until one becomes available
+      /// \brief Executes every job that is currently available
       ///
-      /// \return the job
-      job get_job();
+      /// \return the number of jobs executed
+      std::size_t drain();
+
+      /// \brief Puts the dispatching thread to sleep until a job is posted,
+      ///        or this queue is stopped
+      void sleep();
+
+      /// \brief Wakes the dispatching thread if it is sleeping
+      void wake();
     };
 
     //-------------------------------------------------------------------------
@@ -9,22 +9,31 @@
 #ifndef BIT_PLATFORM_THREADING_DISPATCHER_HPP
 #define BIT_PLATFORM_THREADING_DISPATCHER_HPP
 
-#include "job.hpp" // job
+#include "completion_flag.hpp" // completion_flag
+#include "job.hpp"             // job
+#include "spin_lock.hpp"       // spin_lock
+#include "timer_wheel.hpp"     // timer_wheel, timer_handle
 
 #include <bit/stl/utilities/invoke.hpp>
+#include <bit/stl/utilities/tuple.hpp> // stl::apply
 
 #include <cstdlib> // std::size_t
+#include <cstdint> // std::uint64_t
 #include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::duration, std::chrono::time_point
 #include <thread>  // std::thread
 #include <mutex>   // std::mutex
 #include <condition_variable> // std::condition_variable
 #include <vector>  // std::vector
+#include <string>  // std::string
 #include <tuple>   // std::tuple
 
 namespace bit {
   namespace platform {
     namespace detail {
       class job_queue;
+      class actor_base;
+      class pipeline_state;
 
       template<typename T>
       struct post_job_and_wait_impl;
@@ -43,24 +52,67 @@ namespace bit {
     /// \brief Constant used for tag dispatching assigning affinity
     constexpr assign_affinity_t assign_affinity = {};
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The configuration of a named group of workers in a dispatcher
+    ///
+    /// Jobs posted to a group are only executed by the workers of that group,
+    /// and workers only steal jobs from the other workers of their own group,
+    /// unless their group is allowed to overflow into other groups.
+    ///////////////////////////////////////////////////////////////////////////
+    struct worker_group
+    {
+      std::string              name;     ///< The name of the group
+      std::size_t              workers;  ///< The number of workers initially in the group
+      std::vector<std::size_t> cores;    ///< The cores to pin workers to, or empty for any core
+      std::vector<std::string> overflow; ///< The groups that idle workers may steal from
+    };
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief A dispatcher for managing the job-system.
     ///
     /// This uses a work-stealing queue system for stored jobs.
     ///
+    /// Workers may be partitioned into named worker groups, for example to
+    /// reserve cores for latency-sensitive jobs while batch jobs use the rest.
+    /// A dispatcher that is not given any groups places all of its workers in
+    /// a single group. The thread that runs the dispatcher is always a member
+    /// of the first group.
+    ///
+    /// Workers lease a slot from the global \ref concurrency_arbiter while
+    /// they look for and execute jobs, and give it up while they are parked.
+    ///
     /// \note Only the thread that creates and runs this dispatcher (typically
     ///       from the main message pump) is allowed to stop or destroy this
     ///       dispatcher.
     ///////////////////////////////////////////////////////////////////////////
     class dispatcher
     {
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief The index of a worker group in this dispatcher
+      using group_id = std::size_t;
+
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief The group_id returned when a group could not be found
+      static constexpr group_id no_group = static_cast<group_id>(-1);
+
+      /// \brief The maximum number of groups in a single dispatcher
+      static constexpr std::size_t max_groups = 64;
+
       //-----------------------------------------------------------------------
       // Constructors / Destructor / Assignment
       //-----------------------------------------------------------------------
     public:
 
       /// \brief Default-constructs this job_dispatcher with threads equal
-      ///        to the number of logical cores on the system - 1
+      ///        to the number of cores available to the process - 1
       dispatcher();
 
       /// \brief Constructs the job_dispatcher to use \p threads worker
@@ -70,7 +122,7 @@ namespace bit {
       explicit dispatcher( std::size_t threads );
 
       /// \brief Constructs this job_dispatcher with threads equal
-      ///        to the number of logical cores on the system - 1, and
+      ///        to the number of cores available to the process - 1, and
       ///        assigns affinity to each core
       explicit dispatcher( assign_affinity_t );
 
@@ -80,6 +132,18 @@ namespace bit {
       /// \param threads the number of worker threads
       explicit dispatcher( assign_affinity_t, std::size_t threads );
 
+      /// \brief Constructs worker threads for each of the worker \p groups
+      ///
+      /// The groups are given ids in the order they are specified in. Each
+      /// worker is pinned to the set of cores of its group, if any are
+      /// specified.
+      ///
+      /// \pre \p groups is not empty, and contains at most \c max_groups
+      ///      uniquely named groups
+      ///
+      /// \param groups the worker groups
+      explicit dispatcher( std::vector<worker_group> groups );
+
       // Deleted move constructor
       dispatcher( dispatcher&& other ) = delete;
 
@@ -130,6 +194,14 @@ namespace bit {
       /// \param job the job to wait for
       void wait( job_handle job );
 
+      /// \brief Waits for the flag \p flag to be signaled
+      ///
+      /// The calling thread participates in executing jobs while waiting
+      /// for \p flag to be signaled.
+      ///
+      /// \param flag the flag to wait for
+      void wait( const completion_flag& flag );
+
       //-----------------------------------------------------------------------
 
       /// \{
@@ -146,6 +218,8 @@ namespace bit {
 
       /// \brief Posts a job in this dispatcher
       ///
+      /// The job is executed by the group of the calling worker
+      ///
       /// \param job the job to post
       void post_job( job job );
 
@@ -164,19 +238,191 @@ namespace bit {
         post_and_wait( const job& parent, Fn&& fn, Args&&...args );
       /// \}
 
+      //-----------------------------------------------------------------------
+      // Worker Groups
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the number of worker groups in this dispatcher
+      ///
+      /// \return the number of groups
+      std::size_t groups() const noexcept;
+
+      /// \brief Finds the group with the specified \p name
+      ///
+      /// \param name the name of the group
+      /// \return the id of the group, or \c no_group if there is none
+      group_id find_group( const std::string& name ) const noexcept;
+
+      /// \brief Gets the number of workers currently in \p group
+      ///
+      /// \param group the group to query
+      /// \return the number of workers in the group
+      std::size_t group_size( group_id group ) const noexcept;
+
+      /// \brief Gets the group that the worker with the specified \p worker
+      ///        thread id is currently a member of
+      ///
+      /// \param worker the worker_thread_id of the worker
+      /// \return the id of the group
+      group_id group_of( std::ptrdiff_t worker ) const noexcept;
+
+      //-----------------------------------------------------------------------
+
+      /// \{
+      /// \brief Posts a job to be executed by the workers of \p group
+      ///
+      /// \param group the group to post the job to
+      /// \param parent the parent job
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      template<typename Fn, typename...Args>
+      void post_to( group_id group, Fn&& fn, Args&&...args );
+      template<typename Fn, typename...Args>
+      void post_to( group_id group, const job& parent, Fn&& fn, Args&&...args );
+      /// \}
+
+      /// \brief Posts a job to be executed by the workers of \p group
+      ///
+      /// \note Jobs posted to a group that has no workers are not executed
+      ///       until workers are moved into the group, or an idle group
+      ///       overflows into it.
+      ///
+      /// \param group the group to post the job to
+      /// \param job the job to post
+      void post_job_to( group_id group, job job );
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Moves up to \p count workers from the group \p from into the
+      ///        group \p to
+      ///
+      /// This allows the partitioning of workers to follow phase changes,
+      /// such as moving workers from loading into steady-state processing.
+      /// A moved worker finishes the job it is executing and takes the jobs
+      /// already queued on it into its new group. The thread running this
+      /// dispatcher is never moved.
+      ///
+      /// \param from the group to move workers out of
+      /// \param to the group to move workers into
+      /// \param count the number of workers to move
+      /// \return the number of workers that were moved
+      std::size_t move_workers( group_id from, group_id to, std::size_t count );
+
+      /// \brief Moves the worker with the specified \p worker thread id into
+      ///        \p group
+      ///
+      /// \pre \p worker is the worker_thread_id of a worker thread, and not
+      ///      the thread running this dispatcher
+      ///
+      /// \param worker the worker_thread_id of the worker
+      /// \param group the group to move the worker into
+      void move_worker( std::ptrdiff_t worker, group_id group );
+
+      /// \brief Sets whether idle workers of \p group may steal jobs from
+      ///        the group \p into
+      ///
+      /// \param group the group whose workers steal
+      /// \param into the group that is stolen from
+      /// \param enabled \c true to allow overflowing into \p into
+      void set_overflow( group_id group, group_id into, bool enabled ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Timers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Posts a job in this dispatcher that is executed once
+      ///        \p delay has elapsed
+      ///
+      /// Both \p fn and \p args... are copied before being executed, as if
+      /// by calling \c decay_copy.
+      ///
+      /// \param delay the duration to wait before posting the job
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      /// \return a handle to the timer, which may be used to cancel it
+      template<typename Rep, typename Period, typename Fn, typename...Args>
+      timer_handle post_after( const std::chrono::duration<Rep,Period>& delay,
+                               Fn&& fn, Args&&...args );
+
+      /// \brief Posts a job in this dispatcher that is executed once
+      ///        \p time has been reached
+      ///
+      /// Both \p fn and \p args... are copied before being executed, as if
+      /// by calling \c decay_copy.
+      ///
+      /// \param time the time to post the job at
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      /// \return a handle to the timer, which may be used to cancel it
+      template<typename Clock, typename Duration, typename Fn, typename...Args>
+      timer_handle post_at( const std::chrono::time_point<Clock,Duration>& time,
+                            Fn&& fn, Args&&...args );
+
+      /// \brief Posts a job in this dispatcher that is executed every
+      ///        \p period until cancelled
+      ///
+      /// The first execution occurs after \p period has elapsed. Both \p fn
+      /// and \p args... are copied once for every execution.
+      ///
+      /// \param period the period between each execution
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      /// \return a handle to the timer, which may be used to cancel it
+      template<typename Rep, typename Period, typename Fn, typename...Args>
+      timer_handle post_every( const std::chrono::duration<Rep,Period>& period,
+                               Fn&& fn, Args&&...args );
+
+      /// \brief Cancels a timer previously scheduled in this dispatcher
+      ///
+      /// A periodic timer that is cancelled while an execution of it is
+      /// already posted will still finish that execution.
+      ///
+      /// \param timer the handle of the timer to cancel
+      /// \return \c true if a pending timer was cancelled
+      bool cancel( timer_handle timer );
+
+      //-----------------------------------------------------------------------
+      // Private Member Types
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief The runtime state of a worker group
+      struct group_state
+      {
+        std::string                name;
+        std::vector<std::size_t>   cores;
+        detail::job_queue*         inbox = nullptr; ///< Jobs posted to the group
+        std::atomic<std::uint64_t> overflow{0};     ///< Mask of groups to steal from
+        std::atomic<std::size_t>   size{0};         ///< Workers in the group
+      };
+
       //-----------------------------------------------------------------------
       // Private Members
       //-----------------------------------------------------------------------
     private:
 
-      std::vector<std::thread>        m_threads;
-      std::vector<detail::job_queue*> m_queues;
-      std::thread::id                 m_owner;
-      std::mutex                      m_lock;
-      std::condition_variable         m_cv;
-      std::atomic<std::size_t>        m_running_threads;
-      bool                            m_running;
-      bool                            m_set_affinity;
+      std::vector<std::thread>           m_threads;
+      std::vector<detail::job_queue*>    m_queues;
+      std::vector<group_state>           m_groups;
+      std::vector<std::atomic<group_id>> m_worker_groups; ///< Group of each worker
+      std::thread::id                    m_owner;
+      std::mutex                         m_lock;
+      std::condition_variable            m_cv;
+      std::atomic<std::size_t>           m_running_threads;
+      bool                               m_running;
+      bool                               m_set_affinity;
+      timer_wheel                        m_timers;
+      spin_lock                          m_timer_lock;
+      std::atomic<std::size_t>           m_pending_timers;
+      std::vector<timer_wheel::callback_type> m_expired_timers; ///< Expired, not yet posted
+      std::size_t                        m_expired_index; ///< The next expired timer to post
+      detail::mpsc_queue                 m_actors;        ///< Actors with pending messages
+      spin_lock                          m_actor_lock;    ///< Serializes popping from m_actors
+      std::atomic<std::size_t>           m_actor_runners; ///< Jobs servicing m_actors
+      std::atomic<std::uint32_t>         m_epoch;         ///< Bumped to wake parked workers
+      std::atomic<std::size_t>           m_sleepers;      ///< The number of parking workers
 
       //-----------------------------------------------------------------------
       // Private Capacity
@@ -213,6 +459,62 @@ namespace bit {
       /// \param job the job to push
       void push_job( job job );
 
+      /// \brief Attempts to steal a job from the workers of \p group, or from
+      ///        jobs posted to it
+      ///
+      /// \param group the group to steal from
+      /// \return the job, or a null job if none could be stolen
+      job steal_job( group_id group );
+
+      /// \brief Parks the calling worker until a job is posted, or until
+      ///        the next timer expires
+      ///
+      /// The worker gives up its lease from the concurrency_arbiter while
+      /// it is parked
+      void park();
+
+      /// \brief Wakes parked workers after a job has been posted
+      void wake_workers();
+
+      /// \brief Pins the calling worker to the cores of \p group
+      ///
+      /// \param group the group the worker is a member of
+      void pin_to_group( group_id group );
+
+      /// \brief Pushes a job onto this queue behind all other jobs pending
+      ///        on the calling worker
+      ///
+      /// This is used by jobs that voluntarily yield their worker, such as
+      /// the drain of a serial_queue that exhausted its batch
+      ///
+      /// \param job the job to defer
+      void defer_job( job job );
+
+      /// \brief Schedules a timer callback in the timer wheel
+      ///
+      /// \param deadline the time the timer first expires
+      /// \param period the period of the timer, or zero if it is one-shot
+      /// \param callback the callback to post as a job on expiry
+      /// \return the handle to the timer
+      timer_handle schedule_timer( timer_wheel::time_point deadline,
+                                   timer_wheel::duration period,
+                                   timer_wheel::callback_type callback );
+
+      /// \brief Posts jobs for expired timers
+      ///
+      /// This is invoked from the search loop of idle workers, and is a no-op
+      /// if another worker is already servicing the timer wheel. Each call
+      /// posts at most half of \c job::max_jobs jobs, so that a burst of
+      /// timers cannot exhaust the job storage of a single worker; the
+      /// remainder is left for the next idle worker.
+      void poll_timers();
+
+      /// \brief Publishes the number of timers that are pending or expired
+      ///        but not yet posted
+      ///
+      /// \pre \c m_timer_lock is held
+      void update_pending_timers() noexcept;
+
       /// \brief Helps in processing jobs while a condition is met
       ///
       /// \param condition the condition to check for
@@ -232,6 +534,14 @@ namespace bit {
 
       /// \brief Performs the basic work cycle
       void do_work();
+
+      /// \brief Executes the jobs left in the queue of the calling thread,
+      ///        and in the inbox of its group, until both are empty
+      void drain();
+
+      friend class serial_queue;
+      friend class detail::actor_base;
+      friend class detail::pipeline_state;
     };
 
     //-------------------------------------------------------------------------
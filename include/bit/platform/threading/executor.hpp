@@ -0,0 +1,226 @@
+/**
+ * \file executor.hpp
+ *
+ * \brief This header contains the Executor concept, and a type-erased
+ *        reference to any type satisfying it
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_EXECUTOR_HPP
+#define BIT_PLATFORM_THREADING_EXECUTOR_HPP
+
+#include "job.hpp"                // job, make_job
+#include "unique_task.hpp"        // unique_task
+#include "detail/task_result.hpp" // detail::task_result
+
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke, stl::invoke_result_t
+#include <bit/stl/utilities/tuple.hpp>  // stl::apply
+
+#include <memory>      // std::addressof
+#include <tuple>       // std::make_tuple
+#include <type_traits> // std::decay_t, std::enable_if_t
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \concept Executor
+    ///
+    /// \brief This concept defines the required interface and semantics
+    ///        expected of anything that executes functions on behalf of the
+    ///        caller
+    ///
+    /// The \c Executor requirement expects the following.
+    ///
+    /// Provided:
+    ///
+    /// \c e - an instance of \c Executor,
+    /// \c f - an invokable object/function
+    /// \c args - arguments to pass to the function (possibly 0)
+    ///
+    /// the following expressions must be well-formed with the expected
+    /// side-effects:
+    ///
+    /// \code
+    /// e.post( f, args... )
+    /// \endcode
+    /// \c e schedules \c f to be invoked with \c args... whenever possible,
+    /// and returns without waiting for it. Both \c f and \c args... are
+    /// copied before being executed, as if by calling an imaginary function
+    /// \c decay_copy, and move-only types are supported.
+    ///
+    /// \code
+    /// auto v = e.post_and_wait( f, args... )
+    /// \endcode
+    /// \c e schedules \c f to be invoked with \c args... and blocks until
+    /// it finishes executing; at which point the return value of \c f is
+    /// returned and stored in \c v, which has the type
+    /// \c stl::invoke_result_t<decltype(f),decltype(args)...>. Since the
+    /// caller blocks, \c f and \c args... are forwarded rather than copied.
+    /// Exceptions thrown by \c f are propagated to the caller, unless
+    /// documented otherwise by the executor.
+    ///
+    /// where \c decay_copy is defined as
+    ///
+    /// \code
+    /// template<typename T>
+    /// std::decay_t<T> decay_copy(T&& v) { return std::forward<T>(v); }
+    /// \endcode
+    ///
+    /// Executors that accept a \ref unique_task in \c post without wrapping
+    /// it again, or that execute \ref job objects and provide
+    /// \c post_job(j), allow an \ref any_executor to post without
+    /// allocating.
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace detail {
+
+      /// \brief Type-trait to determine whether \p Executor executes jobs,
+      ///        by providing \c post_job(j)
+      template<typename Executor, typename = void>
+      struct is_job_executor : std::false_type{};
+
+      template<typename Executor>
+      struct is_job_executor<Executor,decltype(std::declval<Executor&>().post_job(std::declval<job>()),void())>
+        : std::true_type{};
+
+      /// \brief The operations of a type-erased executor
+      struct executor_vtable
+      {
+        /// Posts \c task to the executor
+        void (*post)( void* executor, unique_task task );
+
+        /// Posts \c j to the executor, or \c nullptr if the executor does
+        /// not execute jobs
+        void (*post_job)( void* executor, job j );
+
+        /// Posts a call to \c fn with \c data to the executor, and waits for
+        /// it to complete
+        void (*post_and_wait)( void* executor, void (*fn)( void* ), void* data );
+      };
+
+      /// \brief The operations of an executor of type \p Executor
+      template<typename Executor>
+      struct executor_ops
+      {
+        static void post( void* executor, unique_task task );
+        static void post_job( void* executor, job j );
+        static void post_and_wait( void* executor, void (*fn)( void* ), void* data );
+
+        static constexpr executor_vtable vtable = {
+          &post,
+          is_job_executor<Executor>::value ? &post_job : nullptr,
+          &post_and_wait
+        };
+
+      private:
+
+        static void do_post_job( Executor& executor, job j, std::true_type );
+        static void do_post_job( Executor& executor, job j, std::false_type );
+      };
+
+    } // namespace detail
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A non-owning, type-erased reference to an \c Executor
+    ///
+    /// This consists of only a pointer to the executor and a pointer to a
+    /// table of its operations, and never allocates by itself; it allows
+    /// library code to be written once against any of the dispatcher, the
+    /// queues, and the thread pools.
+    ///
+    /// Functions posted to executors of jobs, such as the dispatcher and the
+    /// queues, are constructed directly in a \ref job, so functions whose
+    /// captures fit in its inline storage are posted without allocating.
+    /// Functions posted to other executors are stored in a
+    /// \ref unique_task, which is posted without allocating to executors
+    /// that accept one directly, such as the thread pools. post_and_wait
+    /// never allocates, since the function stays on the caller's stack
+    /// while it waits.
+    ///
+    /// The referenced executor must outlive this any_executor.
+    ///
+    /// \satisfies Executor
+    //////////////////////////////////////////////////////////////////////////
+    class any_executor
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs an any_executor that refers to \p executor
+      ///
+      /// \param executor the executor to refer to
+      template<typename Executor,
+               typename=std::enable_if_t<!std::is_same<std::decay_t<Executor>,any_executor>::value>>
+      any_executor( Executor& executor ) noexcept;
+
+      /// \brief Copy-constructs an any_executor that refers to the same
+      ///        executor as \p other
+      ///
+      /// \param other the other any_executor to copy
+      any_executor( const any_executor& other ) noexcept = default;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Copy-assigns this any_executor to refer to the same executor
+      ///        as \p other
+      ///
+      /// \param other the other any_executor to copy
+      /// \return reference to \c (*this)
+      any_executor& operator=( const any_executor& other ) noexcept = default;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets a pointer to the referenced executor, if it is of type
+      ///        \p Executor
+      ///
+      /// \return pointer to the executor, or \c nullptr
+      template<typename Executor>
+      Executor* target() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Posts a function that will be executed by the referenced
+      ///        executor
+      ///
+      /// The function is called by decaying the arguments and performing a
+      /// copy
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      template<typename Fn, typename...Args>
+      void post( Fn&& fn, Args&&...args );
+
+      /// \brief Posts a function and waits for it to be executed by the
+      ///        referenced executor
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      /// \return the result from the function posted
+      template<typename Fn, typename...Args>
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      void*                          m_executor;
+      const detail::executor_vtable* m_vtable;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/executor.inl"
+
+#endif /* BIT_PLATFORM_THREADING_EXECUTOR_HPP */
@@ -0,0 +1,81 @@
+/**
+ * \file futex.hpp
+ *
+ * \brief This header contains primitives for blocking a thread on the value
+ *        of an atomic integer, and waking threads blocked on it
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_FUTEX_HPP
+#define BIT_PLATFORM_THREADING_FUTEX_HPP
+
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::duration
+#include <cstdint> // std::uint32_t
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /// \brief Blocks while \p address holds \p expected for no longer than
+      ///        \p timeout
+      ///
+      /// \return \c false if the timeout elapsed
+      bool futex_wait_for( const std::atomic<std::uint32_t>& address,
+                           std::uint32_t expected,
+                           std::chrono::nanoseconds timeout ) noexcept;
+
+    } // namespace detail
+
+    //-------------------------------------------------------------------------
+    // Waiting
+    //-------------------------------------------------------------------------
+
+    /// \brief Blocks the calling thread for as long as \p address holds the
+    ///        value \p expected
+    ///
+    /// This returns immediately if the value is already different. As with
+    /// any futex, the thread may wake spuriously, so callers must re-check
+    /// the value in a loop.
+    ///
+    /// This uses the native address-based wait of the platform where one is
+    /// available (\c futex on Linux, \c WaitOnAddress on Windows), and a
+    /// hashed table of condition variables otherwise.
+    ///
+    /// \param address the address to wait on
+    /// \param expected the value to block on
+    void futex_wait( const std::atomic<std::uint32_t>& address,
+                     std::uint32_t expected ) noexcept;
+
+    /// \brief Blocks the calling thread for as long as \p address holds the
+    ///        value \p expected, or until \p timeout has elapsed
+    ///
+    /// \param address the address to wait on
+    /// \param expected the value to block on
+    /// \param timeout the maximum duration to block for
+    /// \return \c false if the timeout elapsed
+    template<typename Rep, typename Period>
+    bool futex_wait_for( const std::atomic<std::uint32_t>& address,
+                         std::uint32_t expected,
+                         const std::chrono::duration<Rep,Period>& timeout );
+
+    //-------------------------------------------------------------------------
+    // Waking
+    //-------------------------------------------------------------------------
+
+    /// \brief Wakes at least one thread blocked on \p address
+    ///
+    /// \param address the address to wake
+    void futex_wake_one( std::atomic<std::uint32_t>& address ) noexcept;
+
+    /// \brief Wakes all threads blocked on \p address
+    ///
+    /// \param address the address to wake
+    void futex_wake_all( std::atomic<std::uint32_t>& address ) noexcept;
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/futex.inl"
+
+#endif /* BIT_PLATFORM_THREADING_FUTEX_HPP */
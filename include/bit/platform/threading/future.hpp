@@ -0,0 +1,602 @@
+/**
+ * \file future.hpp
+ *
+ * \brief This header contains a lightweight future/promise pair, with
+ *        continuations that may be scheduled onto any executor
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_FUTURE_HPP
+#define BIT_PLATFORM_THREADING_FUTURE_HPP
+
+#include "concurrency_arbiter.hpp" // blocking_region
+#include "futex.hpp"               // futex_wait, futex_wake_all
+#include "unique_task.hpp"         // unique_task
+#include "detail/task_result.hpp"  // detail::task_result
+
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke, stl::invoke_result_t
+#include <bit/stl/utilities/tuple.hpp>  // stl::apply
+
+#include <atomic>      // std::atomic
+#include <chrono>      // std::chrono::duration, std::chrono::time_point
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
+#include <exception>   // std::exception_ptr
+#include <future>      // std::future_error, std::future_errc
+#include <iterator>    // std::iterator_traits
+#include <tuple>       // std::tuple
+#include <type_traits> // std::decay_t
+#include <utility>     // std::move, std::forward
+#include <vector>      // std::vector
+
+namespace bit {
+  namespace platform {
+
+    template<typename T> class future;
+    template<typename T> class promise;
+
+    namespace detail {
+
+      /// \brief Allocates storage for a future's shared state from the
+      ///        calling thread's cache of blocks
+      ///
+      /// \param size the size of the state
+      /// \return pointer to the allocated storage
+      void* allocate_future_state( std::size_t size );
+
+      /// \brief Returns storage allocated with \ref allocate_future_state to
+      ///        the calling thread's cache of blocks
+      ///
+      /// \param p pointer to the storage
+      /// \param size the size of the state
+      void deallocate_future_state( void* p, std::size_t size ) noexcept;
+
+      class future_state_base;
+
+      /// \brief A function that schedules the continuation of \p state onto
+      ///        the type-erased \p executor
+      using schedule_function = void(*)( void* executor, future_state_base* state );
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The reference-counted state shared between a promise and
+      ///        its future
+      ///
+      /// Completion, attachment of a continuation, and the presence of a
+      /// blocked waiter are all tracked in a single atomic word, so that
+      /// exactly one of the producer and the consumer runs the continuation,
+      /// and the producer only issues a wake if a thread is blocked.
+      /////////////////////////////////////////////////////////////////////////
+      class future_state_base
+      {
+        //---------------------------------------------------------------------
+        // Constructor / Destructor
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Constructs a state that is referenced only by its creator
+        future_state_base() noexcept;
+
+        future_state_base( const future_state_base& other ) = delete;
+        future_state_base& operator=( const future_state_base& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Observers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Queries whether a result has been stored
+        bool ready() const noexcept;
+
+        //---------------------------------------------------------------------
+        // Waiting
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Blocks until a result has been stored
+        void wait() const noexcept;
+
+        /// \brief Blocks until a result has been stored, or until
+        ///        \p time_point has been reached
+        ///
+        /// \return \c true if the result has been stored
+        template<typename Clock, typename Duration>
+        bool wait_until( const std::chrono::time_point<Clock,Duration>& time_point ) const;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Attaches the \p continuation to this state, transferring
+        ///        the caller's reference to it
+        ///
+        /// The continuation is scheduled with \p schedule once the result
+        /// is stored, or immediately if it already has been. If \p schedule
+        /// is \c nullptr, the continuation runs on the thread that stores
+        /// the result.
+        ///
+        /// \param continuation the continuation to run
+        /// \param schedule the function to schedule the continuation with
+        /// \param executor the executor to pass to \p schedule
+        void set_continuation( unique_task continuation,
+                               schedule_function schedule,
+                               void* executor );
+
+        /// \brief Runs the attached continuation, transferring the reference
+        ///        held by the scheduler to it
+        void run_continuation();
+
+        /// \brief Adds a reference to this state
+        void retain() noexcept;
+
+        /// \brief Removes a reference from this state, destroying it once
+        ///        no references remain
+        void release() noexcept;
+
+        //---------------------------------------------------------------------
+        // Protected Members
+        //---------------------------------------------------------------------
+      protected:
+
+        ~future_state_base() = default;
+
+        /// \brief Marks the result as stored, waking any waiter and
+        ///        scheduling any continuation
+        void mark_ready();
+
+        /// \brief Destroys and deallocates this state
+        virtual void destroy() noexcept = 0;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        static constexpr std::uint32_t state_ready        = 1u;
+        static constexpr std::uint32_t state_continuation = 2u;
+        static constexpr std::uint32_t state_waiting      = 4u;
+
+        mutable std::atomic<std::uint32_t> m_state;
+        std::atomic<std::uint32_t>         m_references;
+        unique_task                        m_continuation;
+        schedule_function                  m_schedule;
+        void*                              m_executor;
+
+        /// \brief Hands the continuation to its scheduler
+        void trigger();
+
+        /// \brief Announces that a thread is about to block on this state
+        ///
+        /// \return the value to block on, or \c 0 if the state is ready
+        std::uint32_t prepare_wait() const noexcept;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The shared state of a future of type \p T
+      /////////////////////////////////////////////////////////////////////////
+      template<typename T>
+      class future_state final : public future_state_base
+      {
+      public:
+
+        /// \brief Creates a new state, allocated from the state pool
+        static future_state* make();
+
+        template<typename Fn>
+        void set_result( Fn&& fn );
+
+        void set_exception( std::exception_ptr error );
+
+        T get();
+
+      private:
+
+        future_state() = default;
+        ~future_state() = default;
+
+        void destroy() noexcept override;
+
+        task_result<T> m_result;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief An owning reference to a future_state_base, used to carry a
+      ///        scheduled continuation through an executor
+      /////////////////////////////////////////////////////////////////////////
+      class future_state_ref
+      {
+      public:
+
+        explicit future_state_ref( future_state_base* state ) noexcept;
+        future_state_ref( const future_state_ref& other ) noexcept;
+        future_state_ref( future_state_ref&& other ) noexcept;
+        ~future_state_ref();
+
+        future_state_ref& operator=( const future_state_ref& other ) = delete;
+        future_state_ref& operator=( future_state_ref&& other ) = delete;
+
+        /// \brief Runs the continuation, handing this reference to it
+        void operator()();
+
+      private:
+
+        future_state_base* m_state;
+      };
+
+      /// \brief Schedules the continuation of \p state by posting it to the
+      ///        \p Executor
+      template<typename Executor>
+      void schedule_continuation( void* executor, future_state_base* state );
+
+      /// \brief Attaches \p fn to be called with the ready \p f on the
+      ///        thread that completes it
+      template<typename T, typename Fn>
+      void attach( future<T>&& f, Fn&& fn );
+
+      /// \brief Sets the result of \p p to the result of invoking \p fn, or
+      ///        to the exception it throws
+      template<typename T, typename Fn>
+      void fulfil( promise<T>& p, Fn&& fn );
+
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The producing side of a future
+    ///
+    /// Unlike \c std::promise, the shared state is allocated from a
+    /// per-thread pool of blocks, and completion is signaled through a
+    /// single atomic word that waiters block on with a futex.
+    ///
+    /// Destroying a promise without storing a result stores a
+    /// \c std::future_error with \c std::future_errc::broken_promise.
+    ///
+    /// \tparam T the type of the result; may be a reference or \c void
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class promise
+    {
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment / Destructor
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a promise with a new shared state
+      promise();
+
+      /// \brief Move-constructs this promise from \p other
+      ///
+      /// \param other the other promise to move
+      promise( promise&& other ) noexcept;
+
+      // Deleted copy constructor
+      promise( const promise& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Abandons the shared state, breaking the promise if no result
+      ///        was stored
+      ~promise();
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Move-assigns this promise from \p other
+      ///
+      /// \param other the other promise to move
+      /// \return reference to \c (*this)
+      promise& operator=( promise&& other ) noexcept;
+
+      // Deleted copy assignment
+      promise& operator=( const promise& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the future associated with this promise
+      ///
+      /// \pre This may only be called once
+      ///
+      /// \return the future
+      future<T> get_future();
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Stores a result constructed from \p args, and makes the
+      ///        future ready
+      ///
+      /// \param args the arguments to construct the result from
+      template<typename...Args>
+      void set_value( Args&&...args );
+
+      /// \brief Stores the exception \p error, and makes the future ready
+      ///
+      /// \param error the exception to store
+      void set_exception( std::exception_ptr error );
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      detail::future_state<T>* m_state;
+      bool                     m_retrieved;
+      bool                     m_satisfied;
+
+      void abandon() noexcept;
+
+      template<typename U, typename Fn>
+      friend void detail::fulfil( promise<U>&, Fn&& );
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The consuming side of a promise
+    ///
+    /// A future is move-only, and is consumed by either \ref get or
+    /// \ref then.
+    ///
+    /// \tparam T the type of the result; may be a reference or \c void
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class future
+    {
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      using value_type = T;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment / Destructor
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Default-constructs a future without a shared state
+      future() noexcept;
+
+      /// \brief Move-constructs this future from \p other
+      ///
+      /// \param other the other future to move
+      future( future&& other ) noexcept;
+
+      // Deleted copy constructor
+      future( const future& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Releases the shared state
+      ~future();
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Move-assigns this future from \p other
+      ///
+      /// \param other the other future to move
+      /// \return reference to \c (*this)
+      future& operator=( future&& other ) noexcept;
+
+      // Deleted copy assignment
+      future& operator=( const future& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Queries whether this future has a shared state
+      ///
+      /// \return \c true if this future has a shared state
+      bool valid() const noexcept;
+
+      /// \brief Queries whether the result of this future is available
+      ///
+      /// \pre \c valid() is \c true
+      ///
+      /// \return \c true if the result is available
+      bool ready() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Waiting
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Blocks until the result is available
+      void wait() const;
+
+      /// \brief Blocks until the result is available, or until the
+      ///        specified \p duration has been waited for
+      ///
+      /// \param duration the amount of time to wait for
+      /// \return \c true if the result is available
+      template<typename Rep, typename Period>
+      bool wait_for( const std::chrono::duration<Rep,Period>& duration ) const;
+
+      /// \brief Blocks until the result is available, or until the
+      ///        specified \p time_point has been reached
+      ///
+      /// \param time_point the time to wait until
+      /// \return \c true if the result is available
+      template<typename Clock, typename Duration>
+      bool wait_until( const std::chrono::time_point<Clock,Duration>& time_point ) const;
+
+      //-----------------------------------------------------------------------
+      // Consumers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Waits for the result and retrieves it, rethrowing the
+      ///        stored exception if there is one
+      ///
+      /// This leaves the future without a shared state
+      ///
+      /// \return the result
+      T get();
+
+      /// \brief Attaches the continuation \p fn, which is invoked with this
+      ///        future on the thread that makes it ready
+      ///
+      /// This leaves the future without a shared state
+      ///
+      /// \param fn the continuation
+      /// \return a future to the result of \p fn
+      template<typename Fn>
+      future<stl::invoke_result_t<std::decay_t<Fn>&,future>> then( Fn&& fn );
+
+      /// \brief Attaches the continuation \p fn, which is posted to
+      ///        \p executor with this future once it is ready
+      ///
+      /// The executor must outlive the completion of this future, and must
+      /// provide \c post(f) for a move-only, nullary callable \c f.
+      ///
+      /// This leaves the future without a shared state
+      ///
+      /// \param executor the executor to run the continuation on
+      /// \param fn the continuation
+      /// \return a future to the result of \p fn
+      template<typename Executor, typename Fn>
+      future<stl::invoke_result_t<std::decay_t<Fn>&,future>>
+        then( Executor& executor, Fn&& fn );
+
+      //-----------------------------------------------------------------------
+      // Private Constructor
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Constructs a future that adopts a reference to \p state
+      explicit future( detail::future_state<T>* state ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      detail::future_state<T>* m_state;
+
+      template<typename Fn>
+      future<stl::invoke_result_t<std::decay_t<Fn>&,future>>
+        then( detail::schedule_function schedule, void* executor, Fn&& fn );
+
+      template<typename> friend class future;
+      template<typename> friend class promise;
+
+      template<typename U, typename Fn>
+      friend void detail::attach( future<U>&&, Fn&& );
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The result of \ref when_any
+    ///
+    /// \tparam T the result type of the futures
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    struct when_any_result
+    {
+      std::size_t index;  ///< The index of the first future to become ready
+      future<T>   result; ///< The first future to become ready
+    };
+
+    //-------------------------------------------------------------------------
+    // Factories
+    //-------------------------------------------------------------------------
+
+    /// \brief Makes a future that is already ready with a value constructed
+    ///        from \p value
+    ///
+    /// \param value the value
+    /// \return the ready future
+    template<typename T>
+    future<std::decay_t<T>> make_ready_future( T&& value );
+
+    /// \brief Makes a \c future<void> that is already ready
+    ///
+    /// \return the ready future
+    future<void> make_ready_future();
+
+    /// \brief Makes a future that is already ready with the exception
+    ///        \p error
+    ///
+    /// \param error the exception
+    /// \return the ready future
+    template<typename T>
+    future<T> make_exceptional_future( std::exception_ptr error );
+
+    //-------------------------------------------------------------------------
+    // Combinators
+    //-------------------------------------------------------------------------
+
+    /// \brief Makes a future that becomes ready once all of \p futures are
+    ///        ready, holding the ready futures
+    ///
+    /// \param futures the futures to wait on
+    /// \return a future to the tuple of ready futures
+    template<typename...Futures>
+    future<std::tuple<std::decay_t<Futures>...>> when_all( Futures&&...futures );
+
+    /// \brief Makes a future that becomes ready once all of the futures in
+    ///        the range [\p first, \p last) are ready, holding the ready
+    ///        futures
+    ///
+    /// The futures in the range are moved from
+    ///
+    /// \param first the start of the range of futures
+    /// \param last the end of the range of futures
+    /// \return a future to the vector of ready futures
+    template<typename InputIt>
+    future<std::vector<typename std::iterator_traits<InputIt>::value_type>>
+      when_all( InputIt first, InputIt last );
+
+    /// \brief Makes a future that becomes ready once any of the futures in
+    ///        the range [\p first, \p last) is ready, holding that future
+    ///
+    /// The futures in the range are moved from. The results of the others
+    /// are discarded when they become ready. An empty range yields an
+    /// index of \c -1 and a future without a shared state.
+    ///
+    /// \param first the start of the range of futures
+    /// \param last the end of the range of futures
+    /// \return a future to the first ready future, and its index
+    template<typename InputIt>
+    future<when_any_result<typename std::iterator_traits<InputIt>::value_type::value_type>>
+      when_any( InputIt first, InputIt last );
+
+    /// \brief Makes a future that becomes ready once any of \p first and
+    ///        \p rest is ready, holding that future
+    ///
+    /// \param first the first future
+    /// \param rest the remaining futures
+    /// \return a future to the first ready future, and its index
+    template<typename T, typename...Futures>
+    future<when_any_result<T>> when_any( future<T>&& first, Futures&&...rest );
+
+    //-------------------------------------------------------------------------
+    // Execution
+    //-------------------------------------------------------------------------
+
+    /// \brief Posts \p fn with \p args to \p executor, returning a future to
+    ///        its result
+    ///
+    /// This works with any executor providing \c post(f) for a move-only,
+    /// nullary callable \c f, such as the \ref dispatcher,
+    /// \ref dispatch_queue, \ref serial_queue, and the thread pools.
+    ///
+    /// Both \c fn and \c args... are copied before being executed, as if by
+    /// calling an imaginary function \c decay_copy.
+    ///
+    /// \param executor the executor to post to
+    /// \param fn the function to execute
+    /// \param args the arguments to forward to the function
+    /// \return a future to the result of the function
+    template<typename Executor, typename Fn, typename...Args>
+    future<stl::invoke_result_t<std::decay_t<Fn>,std::decay_t<Args>...>>
+      post_async( Executor& executor, Fn&& fn, Args&&...args );
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/future.inl"
+
+#endif /* BIT_PLATFORM_THREADING_FUTURE_HPP */
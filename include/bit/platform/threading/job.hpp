@@ -12,12 +12,14 @@
 
 #include <bit/stl/utilities/invoke.hpp> // stl::invoke
 
-#include "true_share.hpp" // true_share
+#include "futex.hpp"             // futex_wait, futex_wake_all
+#include "true_share.hpp"        // true_share
+#include "detail/mpsc_queue.hpp" // detail::mpsc_node
 
 #include <atomic>  // std::atomic
 #include <cassert> // assert
 #include <cstddef> // std::size_t
-#include <cstdint> // std::uint16_t
+#include <cstdint> // std::uint32_t
 #include <memory>  // std::align, std::unique_ptr
 #include <new>     // placement-new
 #include <tuple>   // std::tuple
@@ -46,6 +48,20 @@ namespace bit {
       std::decay_t<T> decay_copy( T&& v ) { return std::forward<T>(v); }
 
       class job_storage;
+
+      /// \brief Releases ownership of the storage of \p j, so that it may be
+      ///        linked into an intrusive mpsc_queue
+      ///
+      /// \param j the job to release
+      /// \return the node of the released job
+      mpsc_node* release_job( job&& j ) noexcept;
+
+      /// \brief Reacquires ownership of a job previously released with
+      ///        \ref release_job
+      ///
+      /// \param node the node of the released job
+      /// \return the job
+      job acquire_job( mpsc_node* node ) noexcept;
     } // namespace detail
 
     ///////////////////////////////////////////////////////////////////////////
@@ -161,6 +177,9 @@ namespace bit {
       friend bool operator==( const job&, const job& ) noexcept;
 
       friend class job_handle;
+
+      friend detail::mpsc_node* detail::release_job( job&& ) noexcept;
+      friend job detail::acquire_job( detail::mpsc_node* ) noexcept;
     };
 
     //-------------------------------------------------------------------------
@@ -250,6 +269,18 @@ namespace bit {
       /// \return \c true if this job is available to be executed
       bool available() const noexcept;
 
+      //-----------------------------------------------------------------------
+      // Waiting
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Blocks the calling thread until the job has completed
+      ///
+      /// Unlike waiting through an executor, the calling thread does not
+      /// execute any other jobs while it waits; it sleeps until woken by the
+      /// thread that finishes the job.
+      void wait() const noexcept;
+
       //-----------------------------------------------------------------------
       // Private Members
       //-----------------------------------------------------------------------
@@ -0,0 +1,303 @@
+/**
+ * \file parallel_region.hpp
+ *
+ * \brief This header contains persistent parallel regions, which run a
+ *        function on a team of dispatcher workers that synchronize through
+ *        team barriers
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_PARALLEL_REGION_HPP
+#define BIT_PLATFORM_THREADING_PARALLEL_REGION_HPP
+
+#include "completion_flag.hpp" // completion_flag
+#include "dispatcher.hpp"      // dispatcher
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke
+
+#include <algorithm>   // std::min
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t
+#include <memory>      // std::addressof
+#include <type_traits> // std::is_integral, std::remove_reference_t
+#include <utility>     // std::forward
+
+namespace bit {
+  namespace platform {
+
+    class team;
+
+    namespace detail {
+
+      ////////////////////////////////////////////////////////////////////////
+      /// \brief The state shared by the members of a team in a
+      ///        parallel_region
+      ///
+      /// This lives on the stack of the thread that started the region, which
+      /// does not return until every recruit job that was posted for the team
+      /// has finished.
+      ////////////////////////////////////////////////////////////////////////
+      class team_state
+      {
+        //--------------------------------------------------------------------
+        // Public Member Types
+        //--------------------------------------------------------------------
+      public:
+
+        using function_type = void(*)( void*, team& );
+
+        //--------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //--------------------------------------------------------------------
+      public:
+
+        /// \brief Constructs the state for a team of at most \p team_size
+        ///        members that invoke \p function with \p fn
+        ///
+        /// \param dispatcher the dispatcher to recruit workers from
+        /// \param team_size the number of members to recruit
+        /// \param function the function that invokes \p fn
+        /// \param fn pointer to the function of the region
+        team_state( dispatcher& dispatcher,
+                    std::size_t team_size,
+                    function_type function,
+                    void* fn ) noexcept;
+
+        // Deleted move constructor
+        team_state( team_state&& other ) = delete;
+
+        // Deleted copy constructor
+        team_state( const team_state& other ) = delete;
+
+        //--------------------------------------------------------------------
+
+        // Deleted move assignment
+        team_state& operator=( team_state&& other ) = delete;
+
+        // Deleted copy assignment
+        team_state& operator=( const team_state& other ) = delete;
+
+        //--------------------------------------------------------------------
+        // Execution
+        //--------------------------------------------------------------------
+      public:
+
+        /// \brief Forms the team, runs the region as its first member, and
+        ///        waits for every other member to finish
+        void run();
+
+        //--------------------------------------------------------------------
+        // Private Members
+        //--------------------------------------------------------------------
+      private:
+
+        dispatcher&                m_dispatcher;
+        function_type              m_function;
+        void*                      m_fn;
+        std::size_t                m_recruits;   ///< Recruit jobs posted
+        std::size_t                m_size;       ///< Published by m_started
+        std::atomic<std::size_t>   m_joined;     ///< Members joined, and the closed bit
+        std::atomic<std::size_t>   m_unresolved; ///< Recruit jobs still running
+        std::atomic<std::uint32_t> m_started;    ///< Set once the team is formed
+        std::atomic<std::size_t>   m_arrived;    ///< Members arrived at the barrier
+        std::atomic<std::uint32_t> m_sense;      ///< Flipped as the barrier opens
+        std::atomic<std::size_t>   m_parked;     ///< Members parked on a futex
+        std::atomic<std::size_t>   m_singles;    ///< Single constructs claimed
+        completion_flag            m_resolved;   ///< Signaled by the last recruit
+
+        //--------------------------------------------------------------------
+        // Private Member Functions
+        //--------------------------------------------------------------------
+      private:
+
+        /// \brief Joins the team as a new member if it is still forming, and
+        ///        runs the region
+        ///
+        /// This is the body of each recruit job
+        void recruit() noexcept;
+
+        /// \brief Runs the region as the member at \p index
+        ///
+        /// \param index the index of the member
+        void execute( std::size_t index ) noexcept;
+
+        /// \brief Marks a recruit job as finished
+        void resolve() noexcept;
+
+        /// \brief Arrives at the team barrier, waiting for every other member
+        ///        to arrive
+        ///
+        /// \param sense the sense of the barrier phase the member arrives at
+        void arrive( std::uint32_t sense ) noexcept;
+
+        /// \brief Claims the single construct with the specified \p ticket
+        ///
+        /// \param ticket the number of single constructs encountered before
+        /// \return \c true if the calling member executes the construct
+        bool claim_single( std::size_t ticket ) noexcept;
+
+        /// \brief Spins, and then parks, until \p word holds \p value
+        ///
+        /// \param word the word to wait on, which is either 0 or 1
+        /// \param value the value to wait for
+        void wait_for( const std::atomic<std::uint32_t>& word,
+                       std::uint32_t value ) noexcept;
+
+        friend class bit::platform::team;
+      };
+
+    } // namespace detail
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A member of the team of a parallel_region
+    ///
+    /// Every member of a team must encounter the same sequence of barriers,
+    /// single constructs, and work-sharing loops, as with OpenMP.
+    //////////////////////////////////////////////////////////////////////////
+    class team
+    {
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      // Deleted move constructor
+      team( team&& other ) = delete;
+
+      // Deleted copy constructor
+      team( const team& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      team& operator=( team&& other ) = delete;
+
+      // Deleted copy assignment
+      team& operator=( const team& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the index of this member in the team
+      ///
+      /// The thread that started the region is always the member at index 0
+      ///
+      /// \return the index of this member
+      std::size_t index() const noexcept;
+
+      /// \brief Gets the number of members in the team
+      ///
+      /// \return the size of the team
+      std::size_t size() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Synchronization
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Waits until every member of the team has arrived at this
+      ///        barrier
+      ///
+      /// Waiting members spin briefly before parking, and give up their
+      /// lease from the concurrency_arbiter while parked.
+      void barrier() noexcept;
+
+      /// \brief Invokes \p fn on exactly one member of the team, followed by
+      ///        a barrier
+      ///
+      /// \param fn the function to invoke
+      template<typename Fn>
+      void single( Fn&& fn );
+
+      //----------------------------------------------------------------------
+      // Work Sharing
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Invokes \p fn with every index in [\p first, \p last),
+      ///        dividing the range into one contiguous block per member,
+      ///        followed by a barrier
+      ///
+      /// \param first the first index
+      /// \param last the index past the last index
+      /// \param fn the function to invoke with each index
+      template<typename Integer, typename Fn>
+      void for_static( Integer first, Integer last, Fn&& fn );
+
+      /// \brief Invokes \p fn with every index in [\p first, \p last),
+      ///        dealing chunks of \p chunk indices to the members in a
+      ///        round-robin, followed by a barrier
+      ///
+      /// \pre \p chunk is greater than zero
+      ///
+      /// \param first the first index
+      /// \param last the index past the last index
+      /// \param chunk the number of indices in each chunk
+      /// \param fn the function to invoke with each index
+      template<typename Integer, typename Fn>
+      void for_static( Integer first, Integer last, Integer chunk, Fn&& fn );
+
+      //----------------------------------------------------------------------
+      // Private Constructor
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Constructs the member at \p index of the team of \p state
+      ///
+      /// \param state the state of the team
+      /// \param index the index of this member
+      team( detail::team_state& state, std::size_t index ) noexcept;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      detail::team_state& m_state;
+      std::size_t         m_index;
+      std::uint32_t       m_sense;   ///< The sense of the next barrier phase
+      std::size_t         m_singles; ///< Single constructs encountered
+
+      friend class detail::team_state;
+    };
+
+    //------------------------------------------------------------------------
+    // Free Functions
+    //------------------------------------------------------------------------
+
+    /// \brief Runs \p fn on a team of up to \p team_size threads of
+    ///        \p dispatcher, which persist for the whole region
+    ///
+    /// The calling thread is the first member of the team, and recruits the
+    /// others by posting a job for each of them. Workers that pick up these
+    /// jobs while the team is forming stay in the team until \p fn returns on
+    /// every member, so that iterations inside of the region only cost a
+    /// barrier rather than a fresh set of jobs. If there are not enough idle
+    /// workers, the team is formed with fewer members; \c team::size reports
+    /// the actual size.
+    ///
+    /// This returns once every member has returned from \p fn.
+    ///
+    /// \note \p fn is invoked concurrently by every member, and an exception
+    ///       that escapes \p fn calls std::terminate
+    ///
+    /// \pre \p team_size is greater than zero
+    ///
+    /// \param dispatcher the dispatcher to recruit workers from
+    /// \param team_size the maximum number of members, including the caller
+    /// \param fn the function to invoke with each member's \ref team
+    template<typename Fn>
+    void parallel_region( dispatcher& dispatcher,
+                          std::size_t team_size,
+                          Fn&& fn );
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/parallel_region.inl"
+
+#endif /* BIT_PLATFORM_THREADING_PARALLEL_REGION_HPP */
@@ -0,0 +1,540 @@
+/**
+ * \file pipeline.hpp
+ *
+ * \brief This header contains a pipeline of serial and parallel stages that
+ *        are overlapped across the workers of a dispatcher
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_PIPELINE_HPP
+#define BIT_PLATFORM_THREADING_PIPELINE_HPP
+
+#include "completion_flag.hpp" // completion_flag
+#include "dispatcher.hpp"      // dispatcher
+#include "spin_lock.hpp"       // spin_lock
+
+#include <bit/stl/containers/span.hpp>  // stl::span
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke, stl::invoke_result_t
+
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <exception>   // std::exception_ptr
+#include <memory>      // std::unique_ptr
+#include <new>         // placement new
+#include <type_traits> // std::decay_t, std::is_void
+#include <utility>     // std::forward, std::move
+#include <vector>      // std::vector
+
+namespace bit {
+  namespace platform {
+
+    /// \brief The way in which a stage of a pipeline processes its tokens
+    enum class stage_mode
+    {
+      serial_in_order,     ///< One token at a time, in the order produced
+      serial_out_of_order, ///< One token at a time, in any order
+      parallel,            ///< Any number of tokens at a time
+    };
+
+    namespace detail {
+      class pipeline_state;
+      struct pipeline_access;
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The control given to the source of a pipeline, used to signal
+    ///        the end of the input
+    ///////////////////////////////////////////////////////////////////////////
+    class flow_control
+    {
+      //-----------------------------------------------------------------------
+      // Constructor
+      //-----------------------------------------------------------------------
+    private:
+
+      explicit flow_control( stl::span<char> buffer ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the buffer owned by the token being produced
+      ///
+      /// The buffer is reused by the pipeline once the token leaves the last
+      /// stage, and so it may be referenced by the token's value for as long
+      /// as the token is in flight
+      ///
+      /// \return the buffer
+      stl::span<char> buffer() const noexcept;
+
+      /// \brief Queries whether the source has stopped
+      ///
+      /// \return \c true if stop was called
+      bool stopped() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Signals the end of the input
+      ///
+      /// The value returned by the source alongside this call is discarded
+      void stop() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      stl::span<char> m_buffer;
+      bool            m_stopped;
+
+      friend class detail::pipeline_state;
+    };
+
+    namespace detail {
+
+      /// \brief The result of invoking the stage function \p Fn with a \p T
+      template<typename Fn, typename T>
+      using pipeline_stage_result_t = std::decay_t<stl::invoke_result_t<Fn,T>>;
+
+      /// \brief The result of invoking the source function \p Fn
+      template<typename Fn>
+      using pipeline_source_result_t = pipeline_stage_result_t<Fn,flow_control&>;
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A token in flight in a pipeline
+      ///
+      /// Tokens are allocated once per pipeline and recycled, along with the
+      /// storage for their value and their buffer.
+      /////////////////////////////////////////////////////////////////////////
+      struct pipeline_token
+      {
+        pipeline_token* next;     ///< The next free or parked token
+        void*           value;    ///< Storage for the token's current value
+        stl::span<char> buffer;   ///< The buffer given to the source
+        std::size_t     sequence; ///< The order this token was produced in
+        std::size_t     stage;    ///< The next stage to execute
+        bool            empty;    ///< Whether a stage failed with this token
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The source of a pipeline, producing the value of each token
+      /////////////////////////////////////////////////////////////////////////
+      class pipeline_source
+      {
+      public:
+
+        virtual ~pipeline_source() = default;
+
+        /// \brief Produces a value into \p value, unless \p control is
+        ///        stopped
+        ///
+        /// \return \c true if a value was produced
+        virtual bool produce( flow_control& control, void* value ) = 0;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A stage of a pipeline, transforming the value of each token
+      ///        in-place
+      ///
+      /// The members other than the mode are only accessed by the
+      /// pipeline_state, and guard serial stages
+      /////////////////////////////////////////////////////////////////////////
+      class pipeline_stage
+      {
+      public:
+
+        explicit pipeline_stage( stage_mode mode ) noexcept;
+
+        virtual ~pipeline_stage() = default;
+
+        /// \brief Replaces the input value in \p value with the output
+        ///
+        /// If this throws, the input value is left intact
+        virtual void process( void* value ) = 0;
+
+        /// \brief Destroys the input value in \p value
+        virtual void discard( void* value ) noexcept = 0;
+
+        stage_mode      mode;
+        spin_lock       lock;
+        bool            busy;          ///< Whether a token is in this stage
+        std::size_t     next_sequence; ///< The next token to enter, if in-order
+        pipeline_token* parked;        ///< Tokens waiting to enter
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The source of type \p Fn, producing values of type \p T
+      /////////////////////////////////////////////////////////////////////////
+      template<typename Fn, typename T>
+      class pipeline_source_impl final : public pipeline_source
+      {
+      public:
+
+        template<typename Fn2>
+        explicit pipeline_source_impl( Fn2&& fn );
+
+        bool produce( flow_control& control, void* value ) override;
+
+      private:
+
+        Fn m_function;
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The stage of type \p Fn, transforming a \p In into an \p Out
+      /////////////////////////////////////////////////////////////////////////
+      template<typename Fn, typename In, typename Out>
+      class pipeline_stage_impl final : public pipeline_stage
+      {
+      public:
+
+        template<typename Fn2>
+        pipeline_stage_impl( stage_mode mode, Fn2&& fn );
+
+        void process( void* value ) override;
+
+        void discard( void* value ) noexcept override;
+
+      private:
+
+        Fn m_function;
+
+        void process( In* in, std::true_type );
+        void process( In* in, std::false_type );
+      };
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The type-independent stages and scheduling of a pipeline
+      /////////////////////////////////////////////////////////////////////////
+      class pipeline_state
+      {
+        //---------------------------------------------------------------------
+        // Constructors / Destructor
+        //---------------------------------------------------------------------
+      public:
+
+        pipeline_state( dispatcher& dispatcher,
+                        std::size_t max_tokens,
+                        std::size_t buffer_size,
+                        std::unique_ptr<pipeline_source> source,
+                        std::size_t value_size,
+                        void (*destroy)( void* ) );
+
+        pipeline_state( const pipeline_state& other ) = delete;
+
+        ~pipeline_state();
+
+        pipeline_state& operator=( const pipeline_state& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Modifiers
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Appends the stage \p stage, whose output is \p value_size
+        ///        bytes and is destroyed with \p destroy
+        void add_stage( std::unique_ptr<pipeline_stage> stage,
+                        std::size_t value_size,
+                        void (*destroy)( void* ) );
+
+        /// \brief Runs the pipeline until the source stops, and every token
+        ///        leaves the last stage
+        void run();
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        using stage_list = std::vector<std::unique_ptr<pipeline_stage>>;
+
+        dispatcher&                      m_dispatcher;
+        std::size_t                      m_max_tokens;
+        std::size_t                      m_buffer_size;
+        std::unique_ptr<pipeline_source> m_source;
+        stage_list                       m_stages;
+        std::size_t                      m_value_size;
+        void (*m_destroy)( void* );      ///< Destroys the final value
+
+        std::vector<pipeline_token>      m_tokens;
+        void*                            m_storage;
+
+        spin_lock          m_lock;        ///< Guards the members below
+        pipeline_token*    m_free;        ///< Tokens that are not in flight
+        std::size_t        m_live;        ///< Tokens that are in flight
+        std::size_t        m_pending;     ///< Posted, but not yet started, sources
+        std::size_t        m_sequence;    ///< The next sequence to produce
+        bool               m_producing;   ///< Whether the source is running
+        bool               m_stopped;     ///< Whether the source has stopped
+        std::exception_ptr m_exception;   ///< The first exception thrown
+        completion_flag*   m_done;
+
+        //---------------------------------------------------------------------
+        // Private Modifiers
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Allocates the tokens, their values, and their buffers
+        void allocate_tokens();
+
+        /// \brief Produces a new token, if the source is idle and a token is
+        ///        free
+        void start();
+
+        /// \brief Produces the value of \p token from the source
+        ///
+        /// \return \c true if a value was produced
+        bool produce( pipeline_token* token );
+
+        /// \brief Carries \p token through the remaining stages, and then
+        ///        carries the tokens recycled from it
+        void carry( pipeline_token* token );
+
+        /// \brief Executes the remaining stages of \p token
+        ///
+        /// \return \c true if \p token left the last stage, or \c false if
+        ///         it was parked
+        bool advance( pipeline_token* token );
+
+        /// \brief Executes the current stage of \p token, which must already
+        ///        have been entered
+        void execute( pipeline_token* token );
+
+        /// \brief Enters the serial stage \p stage, or parks \p token
+        ///
+        /// \return \c true if the stage was entered
+        bool enter( pipeline_stage& stage, pipeline_token* token ) noexcept;
+
+        /// \brief Leaves the serial stage \p stage, handing it to the next
+        ///        parked token that may enter it
+        void leave( pipeline_stage& stage );
+
+        /// \brief Returns \p token to the free list
+        ///
+        /// \return a token acquired for the source, if it is idle
+        pipeline_token* retire( pipeline_token* token );
+
+        /// \brief Records the current exception, and stops the source
+        void fail() noexcept;
+
+        /// \brief Takes a free token for the source, if it is idle
+        ///
+        /// \pre m_lock is held
+        pipeline_token* acquire() noexcept;
+
+        /// \brief Queries whether the run has completed
+        ///
+        /// \pre m_lock is held
+        bool completed() const noexcept;
+
+        /// \brief Signals the completion of the run
+        void complete() noexcept;
+      };
+
+    } // namespace detail
+
+    template<typename T>
+    class pipeline;
+
+    namespace detail {
+
+      /// \brief Grants make_pipeline access to the constructor of pipeline
+      struct pipeline_access
+      {
+        template<typename T>
+        static pipeline<T> make( std::unique_ptr<pipeline_state> state ) noexcept;
+      };
+
+    } // namespace detail
+
+    //-------------------------------------------------------------------------
+    // Free Functions
+    //-------------------------------------------------------------------------
+
+    /// \brief Makes a pipeline that executes on \p dispatcher, and that
+    ///        produces tokens from \p source
+    ///
+    /// \param dispatcher the dispatcher to execute on
+    /// \param max_tokens the maximum number of tokens in flight
+    /// \param source the source, invoked with a flow_control&
+    /// \param buffer_size the size of the buffer owned by each token
+    /// \return the pipeline
+    template<typename Source>
+    pipeline<detail::pipeline_source_result_t<Source>>
+      make_pipeline( dispatcher& dispatcher,
+                     std::size_t max_tokens,
+                     Source&& source,
+                     std::size_t buffer_size = 0 );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A pipeline whose last stage produces values of type \p T
+    ///
+    /// A pipeline starts with a source, which is invoked serially with a
+    /// flow_control to produce a value for each token until it calls
+    /// flow_control::stop. Each stage added with \ref then transforms the
+    /// value of a token, and is either serial-in-order, serial-out-of-order,
+    /// or parallel; a stage returning \c void ends the pipeline.
+    ///
+    /// No more than \c max_tokens tokens are ever in flight, which bounds
+    /// the memory held by the pipeline. Tokens are allocated once, and are
+    /// recycled once they leave the last stage -- along with the storage of
+    /// their value, and the buffer given to the source, which allows reading
+    /// directly into recycled buffers with \ref read_from.
+    ///
+    /// A token is carried from one stage to the next by the same job, so
+    /// its value usually stays in the cache of the worker that produced it;
+    /// it is only handed to another job when it has to wait for a serial
+    /// stage that is busy.
+    ///
+    /// \code
+    /// make_pipeline( dispatcher, 8, read_from(file), 64 * 1024 )
+    ///   .then( stage_mode::parallel, decompress )
+    ///   .then( stage_mode::parallel, parse )
+    ///   .then( stage_mode::serial_in_order, upload )
+    ///   .run();
+    /// \endcode
+    ///
+    /// \tparam T the type produced by the last stage
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class pipeline
+    {
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      using value_type = T;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Move-constructs this pipeline from an existing one
+      ///
+      /// \param other the other pipeline to move
+      pipeline( pipeline&& other ) noexcept = default;
+
+      // Deleted copy constructor
+      pipeline( const pipeline& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Move-assigns this pipeline from an existing one
+      ///
+      /// \param other the other pipeline to move
+      /// \return reference to \c (*this)
+      pipeline& operator=( pipeline&& other ) noexcept = default;
+
+      // Deleted copy assignment
+      pipeline& operator=( const pipeline& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Appends a stage that invokes \p fn with the value of each
+      ///        token
+      ///
+      /// \param mode the way the stage processes its tokens
+      /// \param fn the function to invoke
+      /// \return the pipeline, which now produces the result of \p fn
+      template<typename Fn>
+      pipeline<detail::pipeline_stage_result_t<Fn,T>>
+        then( stage_mode mode, Fn&& fn ) &&;
+
+      /// \brief Runs this pipeline until the source stops, and every token
+      ///        has left the last stage
+      ///
+      /// The calling thread participates in executing jobs of the dispatcher
+      /// while waiting. A pipeline may be run more than once.
+      ///
+      /// If a stage or the source throws, the source is stopped; the tokens
+      /// in flight still pass through the serial stages to preserve their
+      /// order, and the first exception is rethrown once they have all left
+      /// the pipeline.
+      void run();
+
+      //-----------------------------------------------------------------------
+      // Private Constructor
+      //-----------------------------------------------------------------------
+    private:
+
+      explicit pipeline( std::unique_ptr<detail::pipeline_state> state ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      std::unique_ptr<detail::pipeline_state> m_state;
+
+      template<typename> friend class pipeline;
+      friend struct detail::pipeline_access;
+    };
+
+    //-------------------------------------------------------------------------
+    // Sources
+    //-------------------------------------------------------------------------
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A pipeline source that reads a file, one token buffer at a
+    ///        time
+    ///
+    /// Each token's value is the span of its buffer that was read into; the
+    /// source stops at the end of the file.
+    ///
+    /// \tparam File a type with a \c read(stl::span<char>) member that
+    ///         returns the span read, such as \c file
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename File>
+    class file_source
+    {
+      //-----------------------------------------------------------------------
+      // Constructor
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs this file_source to read from \p file
+      ///
+      /// \param file the file to read from
+      explicit file_source( File& file ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Call
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Reads the next chunk of the file into the buffer of the
+      ///        token being produced
+      ///
+      /// \param control the flow control of the pipeline
+      /// \return the span of the buffer read into
+      stl::span<char> operator()( flow_control& control );
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      File* m_file;
+    };
+
+    /// \brief Makes a pipeline source that reads \p file
+    ///
+    /// \param file the file to read from
+    /// \return the source
+    template<typename File>
+    file_source<File> read_from( File& file ) noexcept;
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/pipeline.inl"
+
+#endif /* BIT_PLATFORM_THREADING_PIPELINE_HPP */
@@ -0,0 +1,243 @@
+/**
+ * \file serial_queue.hpp
+ *
+ * \brief This header contains the definition of a lightweight queue that
+ *        executes jobs sequentially on the workers of a dispatcher
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_SERIAL_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_SERIAL_QUEUE_HPP
+
+#include "job.hpp"                // job
+#include "dispatcher.hpp"         // dispatcher
+#include "detail/mpsc_queue.hpp"  // detail::mpsc_queue
+
+#include <bit/stl/utilities/invoke.hpp>
+
+#include <atomic>  // std::atomic<bool>
+#include <cstddef> // std::size_t
+#include <utility> // std::forward
+
+namespace bit {
+  namespace platform {
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A queue that executes its jobs one-at-a-time, in the order they
+    ///        were posted, on the workers of an existing dispatcher
+    ///
+    /// Unlike a dispatch_queue, a serial_queue owns no thread. Jobs are linked
+    /// into a lock-free intrusive list, and whenever the queue transitions
+    /// from idle to non-empty, a single drain job is posted to the dispatcher.
+    /// The drain executes at most \c batch_size jobs before yielding its
+    /// worker, so that one busy queue cannot starve the others.
+    ///
+    /// An idle serial_queue costs only its own footprint, which makes it
+    /// suitable for creating thousands of queues -- such as one per object
+    /// or per connection -- that are multiplexed onto a fixed set of
+    /// workers.
+    ///
+    /// Posting an operation is thread-safe, and may be done from any thread.
+    ///
+    /// \note The dispatcher must remain running for as long as the
+    ///       serial_queue has outstanding jobs
+    ///////////////////////////////////////////////////////////////////////////
+    class serial_queue
+    {
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      static constexpr std::size_t default_batch_size = 64u;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs this serial_queue to execute on the workers of
+      ///        \p dispatcher
+      ///
+      /// \param dispatcher the dispatcher to execute jobs on
+      /// \param batch_size the maximum number of jobs to execute before
+      ///                   yielding the worker
+      explicit serial_queue( dispatcher& dispatcher,
+                             std::size_t batch_size = default_batch_size ) noexcept;
+
+      // Deleted move constructor
+      serial_queue( serial_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      serial_queue( const serial_queue& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Destructs this serial_queue, waiting for all outstanding jobs
+      ///        to complete
+      ///
+      /// \note A serial_queue may not be destroyed from one of its own jobs
+      ~serial_queue();
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      serial_queue& operator=( serial_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      serial_queue& operator=( const serial_queue& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the dispatcher that this queue executes on
+      ///
+      /// \return reference to the dispatcher
+      dispatcher& get_dispatcher() const noexcept;
+
+      /// \brief Gets the maximum number of jobs executed before the worker
+      ///        is yielded
+      ///
+      /// \return the batch size
+      std::size_t batch_size() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Waits for a job \p job to be completed
+      ///
+      /// The calling thread participates in executing jobs of the dispatcher
+      /// while waiting for \p job to complete.
+      ///
+      /// \note This may not be called from one of this queue's own jobs,
+      ///       since the job being waited on could never be reached
+      ///
+      /// \param job the job to wait for
+      void wait( job_handle job );
+
+      //-----------------------------------------------------------------------
+
+      /// \{
+      /// \brief Posts a job in this serial queue
+      ///
+      /// \param parent the parent job
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      template<typename Fn, typename...Args>
+      void post( Fn&& fn, Args&&...args );
+      template<typename Fn, typename...Args>
+      void post( const job& parent, Fn&& fn, Args&&...args );
+      /// \}
+
+      /// \brief Posts a job in this serial queue
+      ///
+      /// \param job the job to post
+      void post_job( job job );
+
+      /// \{
+      /// \brief Posts a job in this serial queue, waiting for the result
+      ///
+      /// \param parent the parent job
+      /// \param fn the function to dispatch
+      /// \param args the arguments to forward to the function
+      /// \return the result of the function
+      template<typename Fn, typename...Args>
+      stl::invoke_result_t<Fn,Args...>
+        post_and_wait( Fn&& fn, Args&&...args );
+      template<typename Fn, typename...Args>
+      stl::invoke_result_t<Fn,Args...>
+        post_and_wait( const job& parent, Fn&& fn, Args&&...args );
+      /// \}
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      dispatcher&        m_dispatcher;
+      detail::mpsc_queue m_queue;
+      std::atomic<bool>  m_scheduled;  ///< Whether a drain job is outstanding
+      std::atomic<bool>  m_draining;   ///< Whether a drain is touching the queue
+      std::size_t        m_batch_size;
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Executes up to batch_size jobs from this queue, and then
+      ///        either reschedules itself or marks the queue idle
+      void drain();
+    };
+
+    //-------------------------------------------------------------------------
+    // Free Functions
+    //-------------------------------------------------------------------------
+
+    /// \brief Posts a job for execution to \p queue
+    ///
+    /// \param queue the serial_queue to post the job to
+    /// \param job the job to dispatch
+    void post_job( serial_queue& queue, job job );
+
+    /// \brief Waits for the job based on the handle
+    ///
+    /// \param queue the queue to wait on
+    /// \param job the handle to wait for
+    void wait( serial_queue& queue, job_handle job );
+
+    //-------------------------------------------------------------------------
+
+    /// \{
+    /// \brief Creates and posts a job to the specified \p queue
+    ///
+    /// \param queue the serial_queue to post the job to
+    /// \param parent the parent job
+    /// \param fn the function to invoke
+    /// \param args the arguments to forward to \p fn
+    template<typename Fn, typename...Args, typename = decltype(std::declval<Fn>()(std::declval<Args>()...),void())>
+    void post( serial_queue& queue, Fn&& fn, Args&&...args );
+    template<typename Fn, typename...Args, typename = decltype(std::declval<Fn>()(std::declval<Args>()...),void())>
+    void post( serial_queue& queue,
+               const job& parent, Fn&& fn, Args&&...args );
+    template<typename Fn, typename...Args>
+    void post( serial_queue&, std::nullptr_t, Fn&&, Args&&... ) = delete;
+    /// \}
+
+    //-------------------------------------------------------------------------
+
+    /// \{
+    /// \brief Creates, posts, and waits for the completion of a specified
+    ///        job.
+    ///
+    /// This makes the result appear synchronous, despite the fact that it
+    /// may be invoked on a different thread.
+    ///
+    /// \param queue the serial_queue to post the job to
+    /// \param parent the parent job
+    /// \param fn the function to invoke
+    /// \param args the arguments to forward to \p fn
+    /// \return the result of the invocation
+    template<typename Fn, typename...Args, typename = decltype(std::declval<Fn>()(std::declval<Args>()...),void())>
+    stl::invoke_result_t<Fn,Args...>
+      post_and_wait( serial_queue& queue, Fn&& fn, Args&&...args );
+    template<typename Fn, typename...Args, typename = decltype(std::declval<Fn>()(std::declval<Args>()...),void())>
+    stl::invoke_result_t<Fn,Args...>
+      post_and_wait( serial_queue& queue,
+                     const job& parent, Fn&& fn, Args&&...args );
+    template<typename Fn, typename...Args>
+    stl::invoke_result_t<Fn,Args...>
+      post_and_wait( serial_queue&,
+                     std::nullptr_t, Fn&&, Args&&... ) = delete;
+    /// \}
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/serial_queue.inl"
+
+#endif /* BIT_PLATFORM_THREADING_SERIAL_QUEUE_HPP */
@@ -0,0 +1,485 @@
+/**
+ * \file sharded_executor.hpp
+ *
+ * \brief This header contains a shared-nothing executor, which runs one
+ *        pinned thread per core that owns a shard of the program's state
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_SHARDED_EXECUTOR_HPP
+#define BIT_PLATFORM_THREADING_SHARDED_EXECUTOR_HPP
+
+#include "completion_flag.hpp"     // completion_flag
+#include "concurrency_arbiter.hpp" // yield_lease
+#include "future.hpp"              // future, post_async
+#include "spin_lock.hpp"           // spin_lock
+#include "timer_wheel.hpp"         // timer_wheel, timer_handle
+#include "unique_task.hpp"         // unique_task
+#include "detail/task_result.hpp"  // detail::task_result
+
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+#include <bit/stl/utilities/invoke.hpp> // stl::invoke, stl::invoke_result_t
+#include <bit/stl/utilities/tuple.hpp>  // stl::apply
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t, std::max_align_t
+#include <cstdint>     // std::uint32_t
+#include <deque>       // std::deque
+#include <memory>      // std::unique_ptr
+#include <thread>      // std::thread
+#include <tuple>       // std::make_tuple
+#include <type_traits> // std::decay_t
+#include <utility>     // std::forward, std::move
+#include <vector>      // std::vector
+
+namespace bit {
+  namespace platform {
+
+    class sharded_executor;
+
+    namespace detail {
+      class shard_ring;
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A monotonic arena of memory owned by a single shard
+    ///
+    /// Memory is carved out of chunks that are allocated, and so first
+    /// touched, by the shard's own pinned thread; this keeps the memory
+    /// local to the shard's core and NUMA node. Individual deallocations are
+    /// no-ops, and all memory is reclaimed at once by \ref release.
+    ///
+    /// \note An arena may only be used from the thread of its shard
+    ///////////////////////////////////////////////////////////////////////////
+    class shard_arena
+    {
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      static constexpr std::size_t default_chunk_size = 64u * 1024u;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs an arena that allocates chunks of \p chunk_size
+      ///        bytes as needed
+      ///
+      /// \param chunk_size the size of each chunk
+      explicit shard_arena( std::size_t chunk_size = default_chunk_size ) noexcept;
+
+      // Deleted move constructor
+      shard_arena( shard_arena&& other ) = delete;
+
+      // Deleted copy constructor
+      shard_arena( const shard_arena& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Releases every chunk of this arena
+      ~shard_arena();
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      shard_arena& operator=( shard_arena&& other ) = delete;
+
+      // Deleted copy assignment
+      shard_arena& operator=( const shard_arena& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Allocation
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Allocates \p size bytes aligned to \p align
+      ///
+      /// \param size the number of bytes to allocate
+      /// \param align the alignment of the allocation
+      /// \return pointer to the allocated bytes
+      void* allocate( std::size_t size,
+                      std::size_t align = alignof(std::max_align_t) );
+
+      /// \brief Deallocates the \p size bytes at \p p
+      ///
+      /// This does nothing; memory is only reclaimed by \ref release
+      ///
+      /// \param p pointer to the bytes
+      /// \param size the number of bytes
+      void deallocate( void* p, std::size_t size ) noexcept;
+
+      /// \brief Releases every allocation made from this arena
+      ///
+      /// The first chunk is kept, so that an arena which is released after
+      /// each request does not return to the heap
+      void release() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      struct chunk
+      {
+        chunk*      next;
+        std::size_t size;
+      };
+
+      chunk*      m_chunks;  ///< The chunk being allocated from, first
+      char*       m_current;
+      char*       m_end;
+      std::size_t m_chunk_size;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A single shard of a sharded_executor; one pinned thread and the
+    ///        state that it alone may touch
+    ///
+    /// \satisfies Executor
+    ///////////////////////////////////////////////////////////////////////////
+    class executor_shard
+    {
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs the shard at \p index of \p executor
+      ///
+      /// \param executor the executor that owns this shard
+      /// \param index the index of this shard
+      /// \param shards the number of shards in \p executor
+      executor_shard( sharded_executor& executor,
+                      std::size_t index,
+                      std::size_t shards );
+
+      // Deleted move constructor
+      executor_shard( executor_shard&& other ) = delete;
+
+      // Deleted copy constructor
+      executor_shard( const executor_shard& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      executor_shard& operator=( executor_shard&& other ) = delete;
+
+      // Deleted copy assignment
+      executor_shard& operator=( const executor_shard& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the index of this shard in its executor
+      ///
+      /// \return the index
+      std::size_t index() const noexcept;
+
+      /// \brief Gets the executor that owns this shard
+      ///
+      /// \return reference to the executor
+      sharded_executor& get_executor() const noexcept;
+
+      /// \brief Gets the memory arena of this shard
+      ///
+      /// \pre The calling thread is this shard's thread
+      ///
+      /// \return reference to the arena
+      shard_arena& arena() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Execution
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Posts a function to be executed on this shard
+      ///
+      /// The function is called by decaying the arguments and performing a
+      /// copy
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      template<typename Fn, typename...Args>
+      void post( Fn&& fn, Args&&...args );
+
+      /// \brief Posts a task to be executed on this shard
+      ///
+      /// From another shard, the task is pushed into the ring between the
+      /// two shards. From this shard, it is queued locally, and from any
+      /// other thread it goes through a locked inbox.
+      ///
+      /// Any exception thrown by the task is discarded.
+      ///
+      /// \param task the task to execute
+      void post( unique_task task );
+
+      /// \brief Posts a function and waits for it to be executed by this
+      ///        shard
+      ///
+      /// If called from this shard, the function is invoked immediately. A
+      /// different shard keeps running its own tasks while it waits.
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      /// \return the result from the function posted
+      template<typename Fn, typename...Args>
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
+
+      //-----------------------------------------------------------------------
+      // Timers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Schedules \p callback to run on this shard at \p deadline
+      ///
+      /// \pre The calling thread is this shard's thread
+      ///
+      /// \param deadline the time that the timer expires
+      /// \param callback the callback to run on expiry
+      /// \return a handle to the scheduled timer
+      timer_handle schedule_timer( timer_wheel::time_point deadline,
+                                   timer_wheel::callback_type callback );
+
+      /// \brief Schedules \p callback to run on this shard at \p deadline,
+      ///        and again every \p period afterwards until cancelled
+      ///
+      /// \pre The calling thread is this shard's thread
+      ///
+      /// \param deadline the time that the timer first expires
+      /// \param period the period between expiries
+      /// \param callback the callback to run on every expiry
+      /// \return a handle to the scheduled timer
+      timer_handle schedule_timer( timer_wheel::time_point deadline,
+                                   timer_wheel::duration period,
+                                   timer_wheel::callback_type callback );
+
+      /// \brief Cancels the timer referred to by \p handle
+      ///
+      /// \pre The calling thread is this shard's thread
+      ///
+      /// \param handle the handle of the timer to cancel
+      /// \return \c true if a pending timer was cancelled
+      bool cancel_timer( timer_handle handle ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      sharded_executor&                       m_executor;
+      std::size_t                             m_index;
+      std::deque<unique_task>                 m_local;     ///< Posted from this shard
+      std::vector<std::deque<unique_task>>    m_backlog;   ///< Per target, while its ring is full
+      std::size_t                             m_backlogged;
+      spin_lock                               m_inbox_lock;
+      std::vector<unique_task>                m_inbox;     ///< Posted from other threads
+      std::atomic<bool>                       m_has_inbox;
+      timer_wheel                             m_timers;
+      std::vector<timer_wheel::callback_type> m_expired;
+      shard_arena                             m_arena;
+      std::atomic<std::uint32_t>              m_sleeping;
+      std::atomic<std::size_t>                m_sent;      ///< Tasks forwarded to other shards
+      std::atomic<std::size_t>                m_received;  ///< Tasks received from other shards
+      std::atomic<bool>                       m_idle;      ///< Whether out of work, once stopped
+      std::thread                             m_thread;
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief The function executed by the thread of this shard
+      void run();
+
+      /// \brief Runs every task and timer that is ready on this shard
+      ///
+      /// \return the number of tasks run and forwarded
+      std::size_t poll();
+
+      /// \brief Blocks until a task is posted to this shard, or until the
+      ///        next timer is due
+      void sleep();
+
+      /// \brief Wakes the thread of this shard, if it is sleeping
+      void wake() noexcept;
+
+      /// \brief Queries whether any task is waiting to be run or forwarded
+      ///        by this shard
+      bool has_work() const noexcept;
+
+      /// \brief Pushes \p task into the ring towards \p target, or into the
+      ///        backlog if the ring is full
+      void forward( executor_shard& target, unique_task task );
+
+      friend class sharded_executor;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A shared-nothing executor with one pinned thread per shard
+    ///
+    /// Each shard is a thread pinned to its own core, which owns a shard of
+    /// the program's data. Nothing is stolen between shards; work only moves
+    /// to another shard when it is explicitly submitted there. Because only
+    /// a shard's own thread touches its data, that data needs no locks, and
+    /// its cache lines never bounce between cores.
+    ///
+    /// Tasks submitted from one shard to another pass through a
+    /// single-producer single-consumer ring dedicated to that pair of shards,
+    /// which each shard polls in its run loop. Submitting therefore takes no
+    /// lock, and only contends on the cache lines of the one ring. A shard
+    /// that finds no work spins briefly, and then parks until it is
+    /// submitted to or its next timer is due.
+    ///
+    /// Each shard also has its own timer wheel and memory arena, neither of
+    /// which is synchronized.
+    ///
+    /// \code
+    /// sharded_executor executor;
+    ///
+    /// auto count = executor.submit_to( shard_for(key), [&]{
+    ///   return table[sharded_executor::this_shard()->index()].count(key);
+    /// });
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////////////
+    class sharded_executor
+    {
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      static constexpr std::size_t default_ring_capacity = 1024u;
+
+      //-----------------------------------------------------------------------
+      // Constructor / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a sharded_executor with one shard per core
+      ///        available to the process
+      sharded_executor();
+
+      /// \brief Constructs a sharded_executor with \p shards shards
+      ///
+      /// Shard \c i is pinned to core \c i, modulo the number of cores.
+      ///
+      /// \param shards the number of shards
+      /// \param ring_capacity the capacity of each ring between two shards;
+      ///                      rounded up to a power of two
+      explicit sharded_executor( std::size_t shards,
+                                 std::size_t ring_capacity = default_ring_capacity );
+
+      // Deleted move constructor
+      sharded_executor( sharded_executor&& other ) = delete;
+
+      // Deleted copy constructor
+      sharded_executor( const sharded_executor& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Runs every task that was submitted, and then joins the
+      ///        thread of each shard
+      ///
+      /// This includes the tasks that the shards submit to each other while
+      /// they are stopping.
+      ///
+      /// \note This may not be called from one of the shards
+      ~sharded_executor();
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      sharded_executor& operator=( sharded_executor&& other ) = delete;
+
+      // Deleted copy assignment
+      sharded_executor& operator=( const sharded_executor& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the number of shards
+      ///
+      /// \return the number of shards
+      std::size_t size() const noexcept;
+
+      /// \brief Gets the shard at \p index
+      ///
+      /// \param index the index of the shard
+      /// \return reference to the shard
+      executor_shard& operator[]( std::size_t index ) noexcept;
+
+      /// \brief Gets the shard whose thread is the calling thread
+      ///
+      /// \return pointer to the shard, or \c nullptr if the calling thread
+      ///         is not a shard of any executor
+      static executor_shard* this_shard() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Execution
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Executes \p fn with \p args on the shard at \p index
+      ///
+      /// Both \c fn and \c args... are copied before being executed, as if
+      /// by calling an imaginary function \c decay_copy.
+      ///
+      /// \param index the index of the shard to execute on
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      /// \return a future to the result of the function
+      template<typename Fn, typename...Args>
+      future<stl::invoke_result_t<std::decay_t<Fn>,std::decay_t<Args>...>>
+        submit_to( std::size_t index, Fn&& fn, Args&&...args );
+
+      /// \brief Posts \p task to the shard at \p index, without a future
+      ///
+      /// \param index the index of the shard to execute on
+      /// \param task the task to execute
+      void post_to( std::size_t index, unique_task task );
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      std::vector<std::unique_ptr<executor_shard>> m_shards;
+      std::unique_ptr<detail::shard_ring[]>        m_rings; ///< [from * size + to]
+      std::atomic<bool>                            m_running;
+      std::atomic<bool>                            m_stopped; ///< Whether the shards may exit
+
+      //-----------------------------------------------------------------------
+      // Private Observers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Gets the ring from the shard \p from to the shard \p to
+      detail::shard_ring& ring( std::size_t from, std::size_t to ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Waits until every shard is out of work, and no task is in
+      ///        flight between two shards
+      ///
+      /// \pre m_running is \c false
+      void quiesce();
+
+      friend class executor_shard;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/sharded_executor.inl"
+
+#endif /* BIT_PLATFORM_THREADING_SHARDED_EXECUTOR_HPP */
@@ -0,0 +1,465 @@
+/**
+ * \file spsc_queue.hpp
+ *
+ * \brief This header contains wait-free queues for exactly one producer and
+ *        one consumer thread
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_SPSC_QUEUE_HPP
+#define BIT_PLATFORM_THREADING_SPSC_QUEUE_HPP
+
+#include "true_share.hpp" // cache_line_size
+
+#include <bit/stl/containers/span.hpp>  // stl::span
+#include <bit/stl/utilities/assert.hpp> // BIT_ASSERT
+
+#include <atomic>      // std::atomic
+#include <cstddef>     // std::size_t
+#include <memory>      // std::allocator, std::allocator_traits
+#include <new>         // placement new
+#include <type_traits> // std::aligned_storage_t
+#include <utility>     // std::forward, std::move
+
+namespace bit {
+  namespace platform {
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \class bit::platform::spsc_queue
+    ///
+    /// \brief A bounded, wait-free queue for a single producer thread and a
+    ///        single consumer thread
+    ///
+    /// This is a ring of entries with a power-of-two capacity. The producer
+    /// owns the tail index and the consumer owns the head index, and each
+    /// side keeps a cached copy of the other side's index on its own cache
+    /// line. The other side's index is only reloaded when the cached copy
+    /// says the ring is full (or empty), so in steady state the two threads
+    /// only share the cache lines of the entries themselves.
+    ///
+    /// The producer functions may only be called from one thread at a time,
+    /// and likewise for the consumer functions. Nothing blocks; a consumer
+    /// that needs to sleep should pair this with a \ref waitable_event or a
+    /// \ref futex_wait on a word of its own.
+    ///
+    /// \tparam T the type of the queue
+    /// \tparam Allocator the allocator used for the ring
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator = std::allocator<T>>
+    class spsc_queue
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using pointer         = T*;
+      using const_pointer   = const T*;
+
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a queue that holds at least \p capacity entries
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      explicit spsc_queue( size_type capacity );
+
+      /// \brief Constructs a queue that holds at least \p capacity entries,
+      ///        using the specified allocator
+      ///
+      /// \param capacity the minimum capacity, which is rounded up to a
+      ///        power of two
+      /// \param alloc the allocator to use
+      spsc_queue( size_type capacity, const Allocator& alloc );
+
+      // Deleted move constructor
+      spsc_queue( spsc_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      spsc_queue( const spsc_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys any entries left in the queue
+      ~spsc_queue();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      spsc_queue& operator=( spsc_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      spsc_queue& operator=( const spsc_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Capacity
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this queue is empty
+      ///
+      /// \note this function is not thread safe, since the value returned
+      ///       can easily be different between the time it's retrieved vs
+      ///       the time it's read
+      /// \return \c true if this queue is empty
+      bool empty() const noexcept;
+
+      /// \brief Returns the size of this queue
+      ///
+      /// \note this function is not thread safe, since the value returned
+      ///       can easily be different between the time it's retrieved vs
+      ///       the time it's read
+      /// \return the size of this queue
+      size_type size() const noexcept;
+
+      /// \brief Returns the maximum number of entries in this queue
+      ///
+      /// \return the capacity of this queue
+      size_type capacity() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator from this queue
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Consumer
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Attempts to pop the front element in the queue, returning
+      ///        immediately if the queue is empty
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if a value was acquired
+      bool try_pop( T* value );
+
+      /// \brief Pops up to \c values.size() elements from the front of the
+      ///        queue into \p values
+      ///
+      /// \note This uses move-assignment to store the results
+      /// \param values the entries to store the results in
+      /// \return the number of elements popped
+      size_type pop_n( stl::span<T> values );
+
+      //----------------------------------------------------------------------
+      // Producer
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Attempts to push an entry into the queue, returning
+      ///        immediately if the queue is full
+      ///
+      /// \param value the value to push back
+      /// \return \c true if the value was inserted
+      bool try_push_back( const T& value );
+
+      /// \copydoc spsc_queue::try_push_back
+      bool try_push_back( T&& value );
+
+      /// \brief Attempts to emplace an entry into the queue, returning
+      ///        immediately if the queue is full
+      ///
+      /// \param args the arguments to construct the entry
+      /// \return \c true if the value was inserted
+      template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+      bool try_emplace_back( Args&&...args );
+
+      /// \brief Pushes copies of as many of \p values as there is room for
+      ///        into the queue
+      ///
+      /// All of the entries are published to the consumer at once
+      ///
+      /// \param values the values to push
+      /// \return the number of values pushed
+      size_type push_n( stl::span<const T> values );
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      using storage_type      = std::aligned_storage_t<sizeof(T),alignof(T)>;
+      using alloc_traits      = std::allocator_traits<Allocator>;
+      using storage_allocator = typename alloc_traits::template rebind_alloc<storage_type>;
+      using storage_traits    = std::allocator_traits<storage_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      storage_allocator m_allocator;
+      storage_type*     m_buffer;
+      size_type         m_mask;        ///< The capacity, minus one
+
+      char m_padding0[cache_line_size()];
+
+      std::atomic<size_type> m_tail;   ///< Written by the producer
+      size_type m_cached_head;         ///< The producer's copy of m_head
+
+      char m_padding1[cache_line_size()];
+
+      std::atomic<size_type> m_head;   ///< Written by the consumer
+      size_type m_cached_tail;         ///< The consumer's copy of m_tail
+
+      char m_padding2[cache_line_size()];
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Gets the entry at \p position
+      T* entry( size_type position ) const noexcept;
+
+      /// \brief Gets the number of entries the producer can push, reloading
+      ///        the head only if the cached copy shows fewer than \p wanted
+      size_type free_slots( size_type tail, size_type wanted ) noexcept;
+
+      /// \brief Gets the number of entries the consumer can pop, reloading
+      ///        the tail only if the cached copy shows fewer than \p wanted
+      size_type used_slots( size_type head, size_type wanted ) noexcept;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \class bit::platform::unbounded_spsc_queue
+    ///
+    /// \brief An unbounded, wait-free queue for a single producer thread and
+    ///        a single consumer thread
+    ///
+    /// Entries are stored in a linked list of fixed-size segments. The
+    /// consumer hands every segment it finishes back to the producer, which
+    /// reuses it before allocating a new one, so a queue that stays under
+    /// its high-water mark never allocates after warming up; \ref reserve
+    /// can be used to warm it up in advance.
+    ///
+    /// Pushing is wait-free apart from allocating a new segment, and popping
+    /// is always wait-free.
+    ///
+    /// \tparam T the type of the queue
+    /// \tparam Allocator the allocator used for the segments
+    //////////////////////////////////////////////////////////////////////////
+    template<typename T, typename Allocator = std::allocator<T>>
+    class unbounded_spsc_queue
+    {
+      static_assert( !std::is_reference<T>::value, "T cannot be a reference type" );
+
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using value_type      = T;
+      using reference       = T&;
+      using const_reference = const T&;
+      using pointer         = T*;
+      using const_pointer   = const T*;
+
+      using allocator_type  = Allocator;
+      using size_type       = std::size_t;
+
+      //----------------------------------------------------------------------
+      // Public Static Members
+      //----------------------------------------------------------------------
+    public:
+
+      /// The number of entries in each segment, which is chosen so that a
+      /// segment spans roughly a page
+      static constexpr size_type segment_size = (sizeof(T) * 32u < 4096u) ? (4096u / sizeof(T)) : 32u;
+
+      //----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Default constructs an unbounded_spsc_queue
+      unbounded_spsc_queue();
+
+      /// \brief Constructs an unbounded_spsc_queue that uses the specified
+      ///        allocator
+      ///
+      /// \param alloc the allocator to use
+      explicit unbounded_spsc_queue( const Allocator& alloc );
+
+      // Deleted move constructor
+      unbounded_spsc_queue( unbounded_spsc_queue&& other ) = delete;
+
+      // Deleted copy constructor
+      unbounded_spsc_queue( const unbounded_spsc_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Destroys any entries left in the queue, and frees every
+      ///        segment
+      ~unbounded_spsc_queue();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      unbounded_spsc_queue& operator=( unbounded_spsc_queue&& other ) = delete;
+
+      // Deleted copy assignment
+      unbounded_spsc_queue& operator=( const unbounded_spsc_queue& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the underlying allocator from this queue
+      ///
+      /// \return the allocator
+      Allocator get_allocator() const;
+
+      //----------------------------------------------------------------------
+      // Consumer
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns whether this queue is empty
+      ///
+      /// \note This may only be called by the consumer
+      /// \return \c true if this queue is empty
+      bool empty() const noexcept;
+
+      /// \brief Attempts to pop the front element in the queue, returning
+      ///        immediately if the queue is empty
+      ///
+      /// \note This uses move-assignment to store the result
+      /// \param value pointer to the entry to store the result
+      /// \return \c true if a value was acquired
+      bool try_pop( T* value );
+
+      /// \brief Pops up to \c values.size() elements from the front of the
+      ///        queue into \p values
+      ///
+      /// \note This uses move-assignment to store the results
+      /// \param values the entries to store the results in
+      /// \return the number of elements popped
+      size_type pop_n( stl::span<T> values );
+
+      //----------------------------------------------------------------------
+      // Producer
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Pushes an entry into the queue
+      ///
+      /// \param value the value to push
+      void push_back( const T& value );
+
+      /// \copydoc unbounded_spsc_queue::push_back
+      void push_back( T&& value );
+
+      /// \brief Emplaces an entry in the queue
+      ///
+      /// \param args the arguments to construct the entry
+      template<typename...Args, std::enable_if_t<std::is_constructible<T,Args...>::value>* = nullptr>
+      void emplace_back( Args&&...args );
+
+      /// \brief Pushes copies of all of \p values into the queue
+      ///
+      /// The entries of each segment are published to the consumer at once
+      ///
+      /// \param values the values to push
+      void push_n( stl::span<const T> values );
+
+      /// \brief Ensures that at least \p count more entries can be pushed
+      ///        without allocating
+      ///
+      /// \note This may only be called by the producer
+      /// \param count the number of entries
+      void reserve( size_type count );
+
+      //----------------------------------------------------------------------
+      // Private Member Types
+      //----------------------------------------------------------------------
+    private:
+
+      struct segment
+      {
+        segment() noexcept;
+
+        std::atomic<segment*>  next;  ///< The segment the producer moved to
+        std::atomic<size_type> count; ///< The number of published entries
+        segment*               free;  ///< The next segment in a free list
+        std::aligned_storage_t<sizeof(T),alignof(T)> entries[segment_size];
+      };
+
+      using alloc_traits      = std::allocator_traits<Allocator>;
+      using segment_allocator = typename alloc_traits::template rebind_alloc<segment>;
+      using segment_traits    = std::allocator_traits<segment_allocator>;
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      segment_allocator m_allocator;
+
+      char m_padding0[cache_line_size()];
+
+      segment*  m_tail;         ///< The segment the producer writes to
+      size_type m_tail_index;   ///< The producer's copy of m_tail->count
+      segment*  m_spare;        ///< Segments the producer may reuse
+
+      char m_padding1[cache_line_size()];
+
+      segment*  m_head;         ///< The segment the consumer reads from
+      size_type m_head_index;   ///< The next entry the consumer reads
+      size_type m_cached_count; ///< The consumer's copy of m_head->count
+
+      char m_padding2[cache_line_size()];
+
+      /// Segments handed back by the consumer; the producer takes the whole
+      /// list at once, so the list never suffers from ABA
+      std::atomic<segment*> m_recycled;
+
+      //----------------------------------------------------------------------
+      // Private Member Functions
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Gets the entry at \p index in \p s
+      static T* entry( segment* s, size_type index ) noexcept;
+
+      /// \brief Moves the producer onto a fresh segment
+      void advance_tail();
+
+      /// \brief Takes a segment to reuse, allocating one if there is none
+      segment* acquire_segment();
+
+      /// \brief Reloads the published count of the head segment, moving the
+      ///        consumer onto the next segment once the head is drained
+      ///
+      /// \return the number of entries the consumer can pop from m_head
+      size_type readable() noexcept;
+
+      /// \brief Hands a drained segment back to the producer
+      void recycle( segment* s ) noexcept;
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/spsc_queue.inl"
+
+#endif /* BIT_PLATFORM_THREADING_SPSC_QUEUE_HPP */
@@ -9,11 +9,40 @@
 #ifndef BIT_PLATFORM_THREADING_THREAD_HPP
 #define BIT_PLATFORM_THREADING_THREAD_HPP
 
+#include <cstddef> // std::size_t
 #include <thread>
+#include <vector>  // std::vector
 
 namespace bit {
   namespace platform {
 
+    //-------------------------------------------------------------------------
+    // Concurrency
+    //-------------------------------------------------------------------------
+
+    /// \brief Gets the number of threads that this process can run
+    ///        concurrently
+    ///
+    /// Unlike std::thread::hardware_concurrency, this honors the limits that
+    /// are placed on the process rather than on the machine: the affinity
+    /// mask of the process, and on Linux the cpusets and CPU quotas of its
+    /// cgroup (v1 and v2). A fractional CPU quota is rounded up. This is the
+    /// default number of workers for the executors in this library.
+    ///
+    /// \note The limits are read once and cached, since reading them on
+    ///       Linux parses several files. A cgroup's quota may be changed
+    ///       while the process runs; refresh_available_concurrency re-reads
+    ///       the limits
+    ///
+    /// \return the number of threads, which is at least 1
+    std::size_t available_concurrency() noexcept;
+
+    /// \brief Re-reads the limits placed on this process, and updates the
+    ///        result of available_concurrency
+    ///
+    /// \return the number of threads, which is at least 1
+    std::size_t refresh_available_concurrency() noexcept;
+
     //-------------------------------------------------------------------------
     // Affinity
     //-------------------------------------------------------------------------
@@ -27,6 +56,16 @@ namespace bit {
     /// \param core_id the id of the core
     void set_affinity( std::thread& thread, std::size_t core_id );
 
+    /// \brief Sets the specified thread's affinity to a set of cores, so that
+    ///        it may run on any of them
+    ///
+    /// \brief This may not be implemented in some architectures that do not
+    ///        support thread affinity
+    ///
+    /// \param thread the thread to set the affinity of
+    /// \param cores the ids of the cores
+    void set_affinity( std::thread& thread, const std::vector<std::size_t>& cores );
+
     //-------------------------------------------------------------------------
 
     /// \brief Accesses the specified thread's affinity
@@ -51,6 +90,15 @@ namespace bit {
       /// \param core_id the id of the core
       void set_affinity( std::size_t core_id );
 
+      /// \brief Sets this thread's affinity to a set of cores, so that it
+      ///        may run on any of them
+      ///
+      /// \brief This may not be implemented in some architectures that do not
+      ///        support thread affinity
+      ///
+      /// \param cores the ids of the cores
+      void set_affinity( const std::vector<std::size_t>& cores );
+
       /// \brief Accesses the current thread's affinity
       ///
       /// \return the affinity of the thread
@@ -9,11 +9,23 @@
 #ifndef BIT_PLATFORM_THREADING_THREAD_POOL_HPP
 #define BIT_PLATFORM_THREADING_THREAD_POOL_HPP
 
-#include "waitable_event.hpp"
-#include "concurrent_queue.hpp"
-
-#include <thread> // std::thread
-#include <future> // std::packaged_task
+#include "completion_flag.hpp"     // completion_flag
+#include "concurrency_arbiter.hpp" // concurrency_arbiter, blocking_region
+#include "executor.hpp"            // Executor
+#include "futex.hpp"               // futex_wait, futex_wake_one
+#include "spin_lock.hpp"           // spin_lock
+#include "thread.hpp"              // available_concurrency
+#include "true_share.hpp"          // cache_line_size
+#include "unique_task.hpp"         // unique_task
+#include "detail/task_result.hpp"  // detail::task_result
+
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::seconds
+#include <cstdint> // std::uint32_t
+#include <memory>  // std::allocator_arg_t, std::allocator_traits
+#include <mutex>   // std::lock_guard, std::unique_lock
+#include <thread>  // std::thread
+#include <vector>  // std::vector
 
 #include <bit/stl/utilities/tuple.hpp>  // stl::apply
 #include <bit/stl/utilities/invoke.hpp> // stl::invoke_result_t
@@ -27,51 +39,64 @@ namespace bit {
     /// \brief This concept defines the required interface and semantics
     ///        expected of a thread pool
     ///
-    /// A \c ThreadPool has the ability to dispatch function calls onto a
-    /// pool of worker threads that will never return; or alternatively wait
-    /// for the return result with a blocking call
-    ///
-    /// The \c ThreadPool requirement expects the following.
+    /// A \c ThreadPool is an \c Executor that dispatches function calls
+    /// onto a pool of worker threads; see \ref executor.hpp for the
+    /// semantics of \c post and \c post_and_wait.
     ///
-    /// Provided:
+    /// In addition to the \c Executor requirements, provided:
     ///
     /// \c t - an instance of \c ThreadPool,
-    /// \c f - an invokable object/function
-    /// \c args - arguments to pass to the function (possibly 0)
+    /// \c task - an rvalue of type \ref unique_task
     ///
-    /// the following expressions must be well-formed with the expected
+    /// the following expression must be well-formed with the expected
     /// side-effects:
     ///
     /// \code
-    /// t.post( f, args... )
-    /// \endcode
-    /// \c t posts a job to the ThreadPool that will be executed whenever
-    /// possible. Both \c f and \c args... are copied before being executed,
-    /// as if by calling an imaginary function \c decay_copy.
-    ///
-    /// \code
-    /// auto v = t.post_and_wait( f, args... )
-    /// \endcode
-    /// \c t posts a job to the ThreadPool that will be executed whenever
-    /// possible. The call to this function blocks until \p f finishes
-    /// executing; at which point the return value of \c f is returned and
-    /// stored in \c v. Both \c f and \c args... are copied before being
-    /// executed, as if by calling an imaginary function \c decay_copy.
-    ///
-    /// where \c decay_copy is defined as
-    ///
-    /// \code
-    /// template<typename T>
-    /// std::decay_t<T> decay_copy(T&& v) { return std::forward<T>(v); }
+    /// t.post( std::move(task) )
     /// \endcode
+    /// \c t posts \c task directly, without wrapping it in another task.
     //////////////////////////////////////////////////////////////////////////
 
+    namespace detail {
+
+      /// \brief The pool and worker index of the calling thread, if it is a
+      ///        worker of a basic_thread_pool
+      struct thread_pool_context
+      {
+        const void* pool;
+        std::size_t index;
+      };
+
+      /// \brief Gets the thread_pool_context for the calling thread
+      ///
+      /// \return reference to the context
+      thread_pool_context& this_thread_pool_context() noexcept;
+
+    } // namespace detail
 
     //////////////////////////////////////////////////////////////////////////
-    /// \brief A basic thread pool system that uses a concurrent queue for
+    /// \brief A basic thread pool system that uses work-stealing queues for
     ///        managing tasks to deploy
     ///
-    /// This type is templated on the type of allocator to be used.
+    /// Each worker owns a local queue. Tasks posted from a worker are pushed
+    /// onto that worker's queue and popped back in LIFO order, which keeps
+    /// recursively spawned work cache-hot; tasks posted from any other
+    /// thread go through a single global injection queue. Idle workers take
+    /// from the injection queue, and then steal the oldest task from the
+    /// other workers, before parking on a futex. Posting only issues a wake
+    /// when a worker is parked.
+    ///
+    /// Workers lease a slot from the global \ref concurrency_arbiter while
+    /// they run tasks, and give it up while they are parked.
+    ///
+    /// Tasks are stored as \ref unique_task, so posting a callable whose
+    /// captures fit in its inline buffer does not allocate. post_and_wait
+    /// keeps its result on the waiting thread's stack, and blocks on a
+    /// \ref completion_flag.
+    ///
+    /// This type is templated on the type of allocator to be used, which is
+    /// used for the threads, the queues, and any tasks that are too large
+    /// to be stored inline.
     ///
     /// \tparam Allocator the allocator for the thread data
     /// \satisfies ThreadPool
@@ -79,13 +104,20 @@ namespace bit {
     template<typename Allocator>
     class basic_thread_pool
     {
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using allocator_type = Allocator;
+
       //----------------------------------------------------------------------
       // Constructors / Destructor / Assignment
       //----------------------------------------------------------------------
     public:
 
       /// \brief Default constructs a thread pool with threads equal to the
-      ///        number of active cores on the current system
+      ///        number of cores available to the process
       basic_thread_pool();
 
       /// \brief Constructs a thread pool with the specified \p capacity
@@ -96,7 +128,7 @@ namespace bit {
       /// \brief Constructs a thread pool using the specified \p allocator
       ///
       /// This defaults the number of threads in the pool to the number of
-      /// active cores on the current system
+      /// cores available to the process
       ///
       /// \param allocator the allocator to use
       explicit basic_thread_pool( const Allocator& allocator );
@@ -109,15 +141,32 @@ namespace bit {
       explicit basic_thread_pool( std::size_t capacity,
                                   const Allocator& allocator );
 
-      /// \brief Default move-construction
-      basic_thread_pool( basic_thread_pool&& other ) = default;
+      /// \brief Constructs a thread pool using the specified \p allocator
+      ///
+      /// This defaults the number of threads in the pool to the number of
+      /// cores available to the process
+      ///
+      /// \param allocator the allocator to use
+      basic_thread_pool( std::allocator_arg_t, const Allocator& allocator );
+
+      /// \brief Constructs a thread pool with the specified \p capacity
+      ///        using the specified \p allocator
+      ///
+      /// \param allocator the allocator to use
+      /// \param capacity the number of threads to support
+      basic_thread_pool( std::allocator_arg_t,
+                         const Allocator& allocator,
+                         std::size_t capacity );
+
+      // Deleted move constructor
+      basic_thread_pool( basic_thread_pool&& other ) = delete;
 
       // Deleted copy constructor
       basic_thread_pool( const basic_thread_pool& other ) = delete;
 
       //----------------------------------------------------------------------
 
-      /// \brief Waits for all dispatched threads
+      /// \brief Executes all remaining tasks, and then joins all threads
       ~basic_thread_pool();
 
       //----------------------------------------------------------------------
@@ -128,6 +177,21 @@ namespace bit {
       // Deleted copy assignment
       basic_thread_pool& operator=( const basic_thread_pool& other ) = delete;
 
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the allocator used by this thread pool
+      ///
+      /// \return the allocator
+      allocator_type get_allocator() const;
+
+      /// \brief Gets the number of worker threads in this thread pool
+      ///
+      /// \return the number of worker threads
+      std::size_t capacity() const noexcept;
+
       //----------------------------------------------------------------------
       // Modifiers
       //----------------------------------------------------------------------
@@ -137,48 +201,298 @@ namespace bit {
       ///        when a thread becomes available
       ///
       /// The function is called by decaying the arguments and performing a
-      /// copy
+      /// copy. Any exception thrown by the function is discarded.
       ///
       /// \param fn the function to execute
       /// \param args the arguments to forward to the function
       template<typename Fn, typename...Args>
       void post( Fn&& fn, Args&&...args );
 
+      /// \brief Posts a task that will be executed by the thread pool when
+      ///        a thread becomes available
+      ///
+      /// Any exception thrown by the task is discarded.
+      ///
+      /// \param task the task to execute
+      void post( unique_task task );
+
       /// \brief Posts a function and waits for to be executed by this thread
       ///        pool
       ///
+      /// If called from a worker of this pool, the worker continues to
+      /// execute other tasks while it waits.
+      ///
       /// \param fn the function to execute
       /// \param args the arguments to forward to the function
       /// \return the result from the function posted
       template<typename Fn, typename...Args>
-      stl::invoke_result_t<std::decay_t<Fn>> post_and_wait( Fn&& fn,
-                                                            Args&&...args );
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
 
       //----------------------------------------------------------------------
       // Private Member Types
       //----------------------------------------------------------------------
     private:
 
-      using value_type = std::packaged_task<void()>;
+      using value_type = unique_task;
+
+      using alloc_traits     = std::allocator_traits<Allocator>;
+      using task_allocator   = typename alloc_traits::template rebind_alloc<value_type>;
+      using thread_allocator = typename alloc_traits::template rebind_alloc<std::thread>;
+      using thread_container = std::vector<std::thread,thread_allocator>;
+
+      ////////////////////////////////////////////////////////////////////////
+      /// \brief A lock-protected double-ended queue of tasks
+      ///
+      /// Tasks are kept in a ring buffer that only ever grows, so that a
+      /// warmed-up queue never allocates on push or pop
+      ////////////////////////////////////////////////////////////////////////
+      class task_queue
+      {
+      public:
+
+        explicit task_queue( const task_allocator& allocator );
+        ~task_queue();
+
+        bool empty() const;
+
+        void push( value_type task );
+
+        bool try_pop_back( value_type* task );
+
+        bool try_pop_front( value_type* task );
+
+        bool try_steal( value_type* task );
+
+      private:
+
+        using task_traits = std::allocator_traits<task_allocator>;
+
+        static constexpr std::size_t initial_capacity = 64u;
+
+        mutable spin_lock m_lock;
+        task_allocator    m_allocator;
+        value_type*       m_buffer;
+        std::size_t       m_capacity; ///< Always a power of two
+        std::size_t       m_head;     ///< The index of the front task
+        std::size_t       m_size;
+
+        // Keeps the locks of neighbouring queues off of a shared cache line
+        char m_padding[cache_line_size()];
 
-      using thread_container       = std::vector<std::thread,Allocator>;
-      using pending_jobs_container = concurrent_queue<value_type,std::mutex,Allocator>;
+        void grow();
+
+        void pop_front( value_type* task );
+      };
+
+      using queue_allocator = typename alloc_traits::template rebind_alloc<task_queue>;
+      using queue_traits    = std::allocator_traits<queue_allocator>;
 
       //----------------------------------------------------------------------
       // Private Members
       //----------------------------------------------------------------------
     private:
 
-      thread_container       m_threads;
-      pending_jobs_container m_queue;
-      bool                   m_is_running;
+      thread_container           m_threads;
+      queue_allocator            m_allocator;
+      task_queue                 m_injection; ///< Tasks from external threads
+      task_queue*                m_workers;   ///< Local queue of each worker
+      std::size_t                m_capacity;  ///< The number of workers
+      std::atomic<std::uint32_t> m_epoch;     ///< Bumped to wake parked workers
+      std::atomic<std::size_t>   m_sleepers;  ///< The number of parking workers
+      std::atomic<bool>          m_is_running;
+
+      //----------------------------------------------------------------------
+      // Private Modifiers
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Enqueues \p task on the calling worker's local queue, or on
+      ///        the injection queue if called from an external thread
+      void enqueue( value_type task );
+
+      /// \brief Acquires a task for the worker at \p index, stealing from
+      ///        other queues if its own is empty
+      bool try_acquire( std::size_t index, value_type* task );
+
+      /// \brief Executes a single task for the worker at \p index
+      ///
+      /// \return \c true if a task was executed
+      bool run_one( std::size_t index );
+
+      /// \brief Queries whether any queue in this pool has pending tasks
+      bool has_pending_tasks() const;
+
+      /// \brief The function executed by the worker at \p index
+      void work( std::size_t index );
     };
 
     using thread_pool = basic_thread_pool<std::allocator<char>>;
 
+    namespace detail { struct cached_thread_pool_worker; } // namespace detail
+
+    //////////////////////////////////////////////////////////////////////////
+    /// \brief A thread pool with unbounded concurrency that caches idle
+    ///        threads for reuse
+    ///
+    /// Every posted task runs as soon as it is posted, as with
+    /// \ref unlimited_thread_pool; however, threads that finish their task
+    /// park for up to \ref idle_timeout waiting for another one, and a new
+    /// thread is only created when no thread is idle. This makes bursts of
+    /// blocking work cost a single futex wake per task, rather than a
+    /// thread creation.
+    ///
+    /// The most recently idled thread is always reused first, so threads in
+    /// excess of the steady-state demand are the ones that retire.
+    ///
+    /// \satisfies ThreadPool
+    //////////////////////////////////////////////////////////////////////////
+    class cached_thread_pool
+    {
+      //----------------------------------------------------------------------
+      // Public Member Types
+      //----------------------------------------------------------------------
+    public:
+
+      using duration = std::chrono::steady_clock::duration;
+
+      //----------------------------------------------------------------------
+      // Public Static Members
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief The default duration that idle threads are kept alive for
+      static constexpr duration default_idle_timeout() noexcept;
+
+      //----------------------------------------------------------------------
+      // Constructor / Destructor / Assignment
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a cached_thread_pool that retires threads after
+      ///        \ref default_idle_timeout
+      cached_thread_pool();
+
+      /// \brief Constructs a cached_thread_pool that retires threads after
+      ///        they have been idle for \p idle_timeout
+      ///
+      /// \param idle_timeout the duration to keep idle threads alive for
+      explicit cached_thread_pool( duration idle_timeout );
+
+      // Deleted move constructor
+      cached_thread_pool( cached_thread_pool&& other ) = delete;
+
+      // Deleted copy constructor
+      cached_thread_pool( const cached_thread_pool& other ) = delete;
+
+      //----------------------------------------------------------------------
+
+      /// \brief Waits for all running tasks to complete, and then retires
+      ///        all threads
+      ~cached_thread_pool();
+
+      //----------------------------------------------------------------------
+
+      // Deleted move assignment
+      cached_thread_pool& operator=( cached_thread_pool&& other ) = delete;
+
+      // Deleted copy assignment
+      cached_thread_pool& operator=( const cached_thread_pool& other ) = delete;
+
+      //----------------------------------------------------------------------
+      // Observers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the duration that idle threads are kept alive for
+      ///
+      /// \return the idle timeout
+      duration idle_timeout() const noexcept;
+
+      /// \brief Gets the number of threads currently owned by this pool,
+      ///        whether running or idle
+      ///
+      /// \return the number of threads
+      std::size_t size() const noexcept;
+
+      /// \brief Gets the number of threads currently waiting for a task
+      ///
+      /// \return the number of idle threads
+      std::size_t idle() const noexcept;
+
+      /// \brief Gets the largest number of threads that this pool has owned
+      ///        at once
+      ///
+      /// \return the peak number of threads
+      std::size_t peak_size() const noexcept;
+
+      //----------------------------------------------------------------------
+      // Modifiers
+      //----------------------------------------------------------------------
+    public:
+
+      /// \brief Posts a function that will be executed immediately, on an
+      ///        idle thread if one is available, or on a new thread
+      ///        otherwise
+      ///
+      /// The function is called by decaying the arguments and performing a
+      /// copy. Any exception thrown by the function is discarded.
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      template<typename Fn, typename...Args>
+      void post( Fn&& fn, Args&&...args );
+
+      /// \brief Posts a task that will be executed immediately, on an idle
+      ///        thread if one is available, or on a new thread otherwise
+      ///
+      /// Any exception thrown by the task is discarded.
+      ///
+      /// \param task the task to execute
+      void post( unique_task task );
+
+      /// \brief Posts a function and waits for to be executed by this thread
+      ///        pool
+      ///
+      /// \param fn the function to execute
+      /// \param args the arguments to forward to the function
+      /// \return the result from the function posted
+      template<typename Fn, typename...Args>
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
+
+      //----------------------------------------------------------------------
+      // Private Members
+      //----------------------------------------------------------------------
+    private:
+
+      using worker = detail::cached_thread_pool_worker;
+
+      duration                   m_idle_timeout;
+      mutable spin_lock          m_lock;
+      worker*                    m_idle;      ///< Stack of idle threads
+      std::size_t                m_idle_size;
+      std::atomic<std::uint32_t> m_size;      ///< Threads that have not exited
+      std::atomic<std::uint32_t> m_peak_size;
+      bool                       m_is_running;
+
+      //----------------------------------------------------------------------
+      // Private Modifiers
+      //----------------------------------------------------------------------
+    private:
+
+      /// \brief Hands \p task to an idle thread, or to a new thread if none
+      ///        are idle
+      void dispatch( unique_task task );
+
+      /// \brief The function executed by each thread, starting with \p task
+      void work( unique_task task );
+    };
+
     //////////////////////////////////////////////////////////////////////////
     /// \brief A thread pool that dispatches a thread for each job
     ///
+    /// \note Prefer \ref cached_thread_pool, which has the same semantics
+    ///       but reuses idle threads.
+    ///
     /// \satisfies ThreadPool
     //////////////////////////////////////////////////////////////////////////
     class unlimited_thread_pool
@@ -231,8 +545,7 @@ namespace bit {
       /// \param args the arguments to forward to the function
       /// \return the result from the function posted
       template<typename Fn, typename...Args>
-      stl::invoke_result_t<std::decay_t<Fn>> post_and_wait( Fn&& fn,
-                                                            Args&&...args );
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -293,8 +606,7 @@ namespace bit {
       /// \param args the arguments to forward to the function
       /// \return the result from the function posted
       template<typename Fn, typename...Args>
-      stl::invoke_result_t<std::decay_t<Fn>> post_and_wait( Fn&& fn,
-                                                            Args&&...args );
+      stl::invoke_result_t<Fn,Args...> post_and_wait( Fn&& fn, Args&&...args );
     };
   } // namespace platform
 } // namespace bit
@@ -0,0 +1,296 @@
+/**
+ * \file timer_wheel.hpp
+ *
+ * \brief This header contains the definition of a hashed hierarchical
+ *        timer wheel used for scheduling delayed and periodic callbacks
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_TIMER_WHEEL_HPP
+#define BIT_PLATFORM_THREADING_TIMER_WHEEL_HPP
+
+#include <array>      // std::array
+#include <chrono>     // std::chrono::steady_clock
+#include <cstddef>    // std::size_t
+#include <cstdint>    // std::uint32_t, std::uint64_t
+#include <functional> // std::function
+#include <memory>     // std::unique_ptr
+#include <vector>     // std::vector
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+      struct timer_node;
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A non-owning handle that refers to a timer scheduled in a
+    ///        \ref timer_wheel
+    ///
+    /// A timer_handle may outlive the timer it refers to; cancelling a timer
+    /// that has already expired (or that was already cancelled) is a no-op.
+    ///////////////////////////////////////////////////////////////////////////
+    class timer_handle
+    {
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Default-constructs a timer_handle that refers to no timer
+      timer_handle() noexcept;
+
+      timer_handle( const timer_handle& other ) noexcept = default;
+
+      timer_handle( timer_handle&& other ) noexcept = default;
+
+      //-----------------------------------------------------------------------
+
+      timer_handle& operator=( const timer_handle& other ) noexcept = default;
+
+      timer_handle& operator=( timer_handle&& other ) noexcept = default;
+
+      //-----------------------------------------------------------------------
+      // Conversions
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns a bool indicating whether this handle refers to a
+      ///        timer
+      explicit operator bool() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Constructor
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Constructs a handle to the specified \p node at the given
+      ///        \p generation
+      ///
+      /// \param node the node of the timer
+      /// \param generation the generation of the node at scheduling time
+      timer_handle( detail::timer_node* node,
+                    std::uint32_t generation ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      detail::timer_node* m_node;
+      std::uint32_t       m_generation;
+
+      friend class timer_wheel;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A hashed hierarchical timer wheel
+    ///
+    /// Timers are hashed into one of 4 levels of 64 slots each, where every
+    /// level covers 64 times the range of the level beneath it. Scheduling
+    /// and cancelling a timer are O(1) operations; expired timers are only
+    /// ever touched when their slot comes due, or when a higher level
+    /// cascades down into a lower one.
+    ///
+    /// Timer nodes are recycled through an internal free-list, so a wheel
+    /// that oscillates around a steady number of outstanding timers does not
+    /// allocate after warming up.
+    ///
+    /// \note This type is not thread-safe; callers that share a timer_wheel
+    ///       across threads must provide their own synchronization.
+    ///////////////////////////////////////////////////////////////////////////
+    class timer_wheel
+    {
+      //-----------------------------------------------------------------------
+      // Public Member Types
+      //-----------------------------------------------------------------------
+    public:
+
+      using clock_type    = std::chrono::steady_clock;
+      using time_point    = clock_type::time_point;
+      using duration      = clock_type::duration;
+      using callback_type = std::function<void()>;
+      using size_type     = std::size_t;
+
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      static constexpr std::size_t levels          = 4u;
+      static constexpr std::size_t slots_per_level = 64u;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Destructor / Assignment
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Constructs a timer_wheel that ticks at the given
+      ///        \p resolution
+      ///
+      /// \param resolution the duration of a single tick of the wheel
+      explicit timer_wheel( duration resolution = std::chrono::milliseconds(1) );
+
+      // Deleted move constructor
+      timer_wheel( timer_wheel&& other ) = delete;
+
+      // Deleted copy constructor
+      timer_wheel( const timer_wheel& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Destroys this timer_wheel, discarding all pending timers
+      ~timer_wheel();
+
+      //-----------------------------------------------------------------------
+
+      // Deleted move assignment
+      timer_wheel& operator=( timer_wheel&& other ) = delete;
+
+      // Deleted copy assignment
+      timer_wheel& operator=( const timer_wheel& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Capacity
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Queries whether there are no pending timers in this wheel
+      ///
+      /// \return \c true if there are no pending timers
+      bool empty() const noexcept;
+
+      /// \brief Gets the number of pending timers in this wheel
+      ///
+      /// \return the number of pending timers
+      size_type size() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Observers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Gets the duration of a single tick of this wheel
+      ///
+      /// \return the resolution
+      duration resolution() const noexcept;
+
+      /// \brief Gets the earliest time that a call to \ref advance may
+      ///        expire a timer
+      ///
+      /// This is a lower bound on the next expiry, which is suitable for
+      /// computing how long an idle thread may sleep for. If the wheel is
+      /// empty, this returns \c time_point::max()
+      ///
+      /// \return the time of the next potential expiry
+      time_point next_expiry() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Schedules \p callback to expire once at \p deadline
+      ///
+      /// \param deadline the time that the timer expires
+      /// \param callback the callback to produce on expiry
+      /// \return a handle to the scheduled timer
+      timer_handle schedule( time_point deadline, callback_type callback );
+
+      /// \brief Schedules \p callback to first expire at \p deadline, and
+      ///        again every \p period afterwards until cancelled
+      ///
+      /// Periods shorter than the resolution of the wheel are rounded up
+      /// to a single tick.
+      ///
+      /// \param deadline the time that the timer first expires
+      /// \param period the period between expiries
+      /// \param callback the callback to produce on every expiry
+      /// \return a handle to the scheduled timer
+      timer_handle schedule( time_point deadline,
+                             duration period,
+                             callback_type callback );
+
+      /// \brief Cancels the timer referred to by \p handle
+      ///
+      /// \param handle the handle of the timer to cancel
+      /// \return \c true if a pending timer was cancelled
+      bool cancel( timer_handle handle ) noexcept;
+
+      /// \brief Advances this wheel up to the time \p now, appending the
+      ///        callbacks of all expired timers to \p expired
+      ///
+      /// One-shot timers have their callbacks moved into \p expired, whereas
+      /// periodic timers have their callbacks copied and are rescheduled.
+      ///
+      /// \param now the current time
+      /// \param expired the container to append expired callbacks to
+      /// \return the number of timers that expired
+      size_type advance( time_point now, std::vector<callback_type>& expired );
+
+      /// \brief Cancels all pending timers
+      void clear() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Member Types
+      //-----------------------------------------------------------------------
+    private:
+
+      using tick_type  = std::uint64_t;
+      using level_type = std::array<detail::timer_node*,slots_per_level>;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      std::array<level_type,levels>    m_slots;    ///< The slots of each level
+      std::array<std::uint64_t,levels> m_occupied; ///< Bitmaps of non-empty slots
+      std::vector<std::unique_ptr<detail::timer_node[]>> m_chunks;
+      detail::timer_node* m_free;       ///< Free-list of recycled nodes
+      time_point          m_origin;     ///< The time of tick 0
+      duration            m_resolution; ///< The duration of a tick
+      tick_type           m_current;    ///< The next tick to process
+      size_type           m_size;       ///< The number of pending timers
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Converts a time point to the first tick at or after it
+      tick_type to_tick( time_point time ) const noexcept;
+
+      /// \brief Converts a duration to a non-zero number of ticks
+      tick_type to_ticks( duration period ) const noexcept;
+
+      /// \brief Acquires a node from the free-list, allocating more if needed
+      detail::timer_node* acquire_node();
+
+      /// \brief Returns \p node back to the free-list
+      void release_node( detail::timer_node* node ) noexcept;
+
+      /// \brief Hashes \p node into its slot relative to the current tick
+      void link( detail::timer_node* node ) noexcept;
+
+      /// \brief Removes \p node from the slot it is hashed into
+      void unlink( detail::timer_node* node ) noexcept;
+
+      /// \brief Re-hashes all nodes in the due slot of \p level downward
+      ///
+      /// \return the index of the slot that was cascaded
+      std::size_t cascade( std::size_t level ) noexcept;
+
+      /// \brief Expires all nodes in slot \p index of the lowest level,
+      ///        rescheduling periodic timers past the \p target tick
+      size_type expire( std::size_t index,
+                        tick_type target,
+                        std::vector<callback_type>& expired );
+    };
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/timer_wheel.inl"
+
+#endif /* BIT_PLATFORM_THREADING_TIMER_WHEEL_HPP */
@@ -0,0 +1,256 @@
+/**
+ * \file unique_task.hpp
+ *
+ * \brief This header contains a move-only, type-erased nullary task with an
+ *        inline small-object buffer
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef BIT_PLATFORM_THREADING_UNIQUE_TASK_HPP
+#define BIT_PLATFORM_THREADING_UNIQUE_TASK_HPP
+
+#include <bit/stl/utilities/invoke.hpp> // stl::is_invocable
+
+#include <cassert>     // assert
+#include <cstddef>     // std::size_t, std::max_align_t, std::nullptr_t
+#include <memory>      // std::allocator, std::allocator_arg_t, std::allocator_traits
+#include <new>         // placement-new
+#include <type_traits> // std::aligned_storage_t, std::enable_if_t, std::integral_constant
+#include <utility>     // std::move, std::forward
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /// \brief The operations of a type-erased task
+      struct unique_task_vtable
+      {
+        /// Invokes the task stored in the buffer
+        void (*invoke)( void* buffer );
+
+        /// Move-constructs the task from \c source into the uninitialized
+        /// \c destination, and then destroys \c source
+        void (*relocate)( void* destination, void* source );
+
+        /// Destroys the task stored in the buffer
+        void (*destroy)( void* buffer );
+      };
+
+      /// \brief The operations of a task of type \p Fn, stored directly in
+      ///        the buffer
+      template<typename Fn>
+      struct inline_task_ops
+      {
+        static void invoke( void* buffer );
+        static void relocate( void* destination, void* source );
+        static void destroy( void* buffer );
+
+        static constexpr unique_task_vtable vtable = {
+          &invoke, &relocate, &destroy
+        };
+      };
+
+      /// \brief The operations of a task of type \p Fn, allocated with an
+      ///        \p Allocator and stored by pointer in the buffer
+      template<typename Fn, typename Allocator>
+      struct allocated_task_ops
+      {
+        struct box
+        {
+          template<typename Func>
+          box( const Allocator& allocator, Func&& fn );
+
+          Allocator allocator;
+          Fn        fn;
+        };
+
+        using allocator_type = typename std::allocator_traits<Allocator>
+                                 ::template rebind_alloc<box>;
+        using alloc_traits   = std::allocator_traits<allocator_type>;
+
+        static void invoke( void* buffer );
+        static void relocate( void* destination, void* source );
+        static void destroy( void* buffer );
+
+        static constexpr unique_task_vtable vtable = {
+          &invoke, &relocate, &destroy
+        };
+      };
+
+    } // namespace detail
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief A move-only, type-erased task that is invoked with no arguments
+    ///
+    /// Callables that fit in \p BufferSize bytes, are no more aligned than
+    /// \c std::max_align_t, and are nothrow move-constructible are stored
+    /// inline, and never allocate. Anything else is allocated, either with
+    /// \c std::allocator or with the allocator supplied on construction.
+    ///
+    /// Unlike \c std::packaged_task, this has no shared state; it is
+    /// intended for fire-and-forget work, where results are communicated
+    /// through the callable itself.
+    ///
+    /// \tparam BufferSize the size of the inline buffer, in bytes
+    ///////////////////////////////////////////////////////////////////////////
+    template<std::size_t BufferSize>
+    class basic_unique_task
+    {
+      static_assert( BufferSize >= sizeof(void*),
+                     "The buffer must be able to hold a pointer" );
+
+      //-----------------------------------------------------------------------
+      // Public Static Members
+      //-----------------------------------------------------------------------
+    public:
+
+      static constexpr std::size_t buffer_size = BufferSize;
+
+      /// \brief Queries whether a callable of type \p Fn is stored inline,
+      ///        without allocating
+      ///
+      /// \return \c true if \p Fn is stored inline
+      template<typename Fn>
+      static constexpr bool is_stored_inline() noexcept;
+
+      //-----------------------------------------------------------------------
+      // Constructors / Assignment / Destructor
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Default-constructs an empty task
+      basic_unique_task() noexcept;
+
+      /// \brief Constructs an empty task
+      basic_unique_task( std::nullptr_t ) noexcept;
+
+      /// \brief Constructs a task from the callable \p fn
+      ///
+      /// \param fn the callable to store
+      template<typename Fn,
+               typename=std::enable_if_t<!std::is_same<std::decay_t<Fn>,basic_unique_task>::value>,
+               typename=std::enable_if_t<stl::is_invocable<std::decay_t<Fn>&>::value>>
+      basic_unique_task( Fn&& fn );
+
+      /// \brief Constructs a task from the callable \p fn, using
+      ///        \p allocator if it cannot be stored inline
+      ///
+      /// \param allocator the allocator to use
+      /// \param fn the callable to store
+      template<typename Allocator, typename Fn,
+               typename=std::enable_if_t<stl::is_invocable<std::decay_t<Fn>&>::value>>
+      basic_unique_task( std::allocator_arg_t,
+                         const Allocator& allocator,
+                         Fn&& fn );
+
+      /// \brief Move-constructs this task from \p other, leaving \p other
+      ///        empty
+      ///
+      /// \param other the other task to move
+      basic_unique_task( basic_unique_task&& other ) noexcept;
+
+      // Deleted copy constructor
+      basic_unique_task( const basic_unique_task& other ) = delete;
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Destroys the stored callable
+      ~basic_unique_task();
+
+      //-----------------------------------------------------------------------
+
+      /// \brief Move-assigns this task from \p other, leaving \p other empty
+      ///
+      /// \param other the other task to move
+      /// \return reference to \c (*this)
+      basic_unique_task& operator=( basic_unique_task&& other ) noexcept;
+
+      /// \brief Destroys the stored callable, leaving this task empty
+      ///
+      /// \return reference to \c (*this)
+      basic_unique_task& operator=( std::nullptr_t ) noexcept;
+
+      // Deleted copy assignment
+      basic_unique_task& operator=( const basic_unique_task& other ) = delete;
+
+      //-----------------------------------------------------------------------
+      // Modifiers
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Swaps the callables of this and \p other
+      ///
+      /// \param other the other task to swap with
+      void swap( basic_unique_task& other ) noexcept;
+
+      //-----------------------------------------------------------------------
+      // Execution
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Invokes the stored callable
+      ///
+      /// \pre \c (*this) is not empty
+      void operator()();
+
+      //-----------------------------------------------------------------------
+      // Conversions
+      //-----------------------------------------------------------------------
+    public:
+
+      /// \brief Returns a bool indicating whether this task has a callable
+      explicit operator bool() const noexcept;
+
+      //-----------------------------------------------------------------------
+      // Private Member Types
+      //-----------------------------------------------------------------------
+    private:
+
+      using storage_type = std::aligned_storage_t<BufferSize,alignof(std::max_align_t)>;
+
+      //-----------------------------------------------------------------------
+      // Private Members
+      //-----------------------------------------------------------------------
+    private:
+
+      storage_type                      m_storage;
+      const detail::unique_task_vtable* m_vtable;
+
+      //-----------------------------------------------------------------------
+      // Private Modifiers
+      //-----------------------------------------------------------------------
+    private:
+
+      template<typename Allocator, typename Fn>
+      void construct( const Allocator& allocator, Fn&& fn );
+
+      template<typename Allocator, typename Fn>
+      void construct( std::true_type, const Allocator& allocator, Fn&& fn );
+
+      template<typename Allocator, typename Fn>
+      void construct( std::false_type, const Allocator& allocator, Fn&& fn );
+
+      void reset() noexcept;
+    };
+
+    /// \brief A unique_task that occupies 64 bytes on common 64-bit targets
+    using unique_task = basic_unique_task<48>;
+
+    //-------------------------------------------------------------------------
+    // Utilities
+    //-------------------------------------------------------------------------
+
+    /// \brief Swaps the callables of \p lhs and \p rhs
+    ///
+    /// \param lhs the left task to swap
+    /// \param rhs the right task to swap
+    template<std::size_t BufferSize>
+    void swap( basic_unique_task<BufferSize>& lhs,
+               basic_unique_task<BufferSize>& rhs ) noexcept;
+
+  } // namespace platform
+} // namespace bit
+
+#include "detail/unique_task.inl"
+
+#endif /* BIT_PLATFORM_THREADING_UNIQUE_TASK_HPP */
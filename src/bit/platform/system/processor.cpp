@@ -1,4 +1,5 @@
 #include <bit/platform/system/processor.hpp>
+#include <bit/platform/threading/thread.hpp>
 
 #include "cpuid.hpp"
 
@@ -72,7 +73,7 @@ bit::platform::processor::processor()
 
   //-------------------------------------------------------------------------
 
-  m_logical_cores  = std::thread::hardware_concurrency();
+  m_logical_cores  = available_concurrency();
 
 
   int apic_id_size = 0;
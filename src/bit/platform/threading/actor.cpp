@@ -0,0 +1,279 @@
+#include <bit/platform/threading/actor.hpp>
+#include <bit/platform/threading/spin_lock.hpp>
+
+#include "detail/small_block_pool.hpp" // detail::small_block_pool
+
+#include <cassert> // assert
+#include <mutex>   // std::lock_guard
+#include <thread>  // std::this_thread::yield
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Constants
+  //---------------------------------------------------------------------------
+
+  /// The maximum number of actors drained by a runner before it yields
+  constexpr std::size_t actors_per_run = 64u;
+
+  //---------------------------------------------------------------------------
+  // Types
+  //---------------------------------------------------------------------------
+
+  /// \brief A mailbox entry used to wait for all messages ahead of it
+  struct flush_message : bit::platform::detail::actor_message_base
+  {
+    explicit flush_message( bit::platform::job job ) noexcept;
+
+    bit::platform::job job;
+  };
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Executes the job of a flush_message
+  void receive_flush( bit::platform::detail::actor_base& self,
+                      bit::platform::detail::actor_message_base* message );
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// Messages are usually allocated by the sender and deallocated by the
+  /// worker that processed them, so surplus blocks return to the senders
+  /// through the depot
+  bit::platform::detail::small_block_pool g_message_pool( bit::platform::detail::block_source::slab_depot );
+
+  /// The actor whose drain is running on this thread, if any
+  thread_local const bit::platform::detail::actor_base* g_this_actor = nullptr;
+
+} // namespace anonymous
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+void* bit::platform::detail::allocate_actor_message( std::size_t size )
+{
+  return g_message_pool.allocate( size );
+}
+
+void bit::platform::detail::deallocate_actor_message( void* p, std::size_t size )
+  noexcept
+{
+  g_message_pool.deallocate( p, size );
+}
+
+//=============================================================================
+// detail::actor_base
+//=============================================================================
+
+constexpr std::size_t bit::platform::detail::actor_base::default_batch_size;
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::actor_base::actor_base( dispatcher& dispatcher,
+                                               std::size_t batch_size )
+  noexcept
+  : m_dispatcher(dispatcher),
+    m_mailbox(),
+    m_scheduled(false),
+    m_draining(false),
+    m_batch_size(batch_size ? batch_size : 1u)
+{
+
+}
+
+bit::platform::detail::actor_base::~actor_base()
+{
+  assert( !m_scheduled.load() && !m_draining.load() && "actor destroyed with pending messages" );
+}
+
+//-----------------------------------------------------------------------------
+// Protected Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::actor_base::enqueue( actor_message_base* message )
+{
+  m_mailbox.push( message );
+
+  // Only the sender that transitions the actor out of idle schedules it;
+  // all others piggy-back on the outstanding drain
+  if( !m_scheduled.exchange( true ) ) {
+    schedule();
+  }
+}
+
+void bit::platform::detail::actor_base::flush()
+{
+  assert( g_this_actor != this && "actor cannot be destroyed from its own handler" );
+
+  // Flush everything that was sent so far by waiting on a job placed behind
+  // it in the mailbox
+  if( m_scheduled.load() ) {
+    auto j = make_job([]{});
+    auto handle = job_handle(j);
+
+    flush_message message( std::move(j) );
+    enqueue( &message );
+    m_dispatcher.wait( handle );
+  }
+
+  // Wait for the last drain to release this actor
+  while( m_scheduled.load() || m_draining.load( std::memory_order_acquire ) ) {
+    std::this_thread::yield();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::actor_base::schedule()
+{
+  m_dispatcher.m_actors.push( this );
+
+  add_runner( m_dispatcher );
+}
+
+void bit::platform::detail::actor_base::drain()
+{
+  m_draining.store( true, std::memory_order_relaxed );
+
+  const auto* old = g_this_actor;
+  g_this_actor = this;
+
+  for( auto i = std::size_t{0}; i < m_batch_size; ++i ) {
+    auto* node = m_mailbox.pop();
+    if( !node ) break;
+
+    auto* message = static_cast<actor_message_base*>(node);
+    (*message->receive)( *this, message );
+  }
+
+  g_this_actor = old;
+
+  // Either the batch was exhausted, or a sender is mid-push; requeue this
+  // actor behind every other ready actor before continuing
+  if( !m_mailbox.empty() ) {
+    schedule();
+  } else {
+    m_scheduled.store( false );
+
+    // A sender may have pushed after the mailbox was observed empty, but
+    // before the flag was cleared -- in which case it did not schedule this
+    // actor
+    if( !m_mailbox.empty() && !m_scheduled.exchange( true ) ) {
+      schedule();
+    }
+  }
+
+  // This must be the last access to the actor, since it may be destroyed
+  // as soon as it is observed
+  m_draining.store( false, std::memory_order_release );
+}
+
+//-----------------------------------------------------------------------------
+// Private Static Functions
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::actor_base::add_runner( dispatcher& dispatcher )
+{
+  // One runner per worker is enough to keep every worker busy with actors
+  const auto limit = dispatcher.m_queues.size();
+
+  auto runners = dispatcher.m_actor_runners.load();
+  while( runners < limit ) {
+    if( dispatcher.m_actor_runners.compare_exchange_weak( runners, runners + 1 ) ) {
+      dispatcher.post_job( make_job( [&dispatcher]{ run( dispatcher ); } ) );
+      return;
+    }
+  }
+}
+
+void bit::platform::detail::actor_base::run( dispatcher& dispatcher )
+{
+  auto more = true;
+
+  // Each actor only drains a bounded batch, so a runner may drain several
+  // actors before yielding its worker
+  for( auto i = std::size_t{0}; more && i < actors_per_run; ++i ) {
+    auto* actor = static_cast<actor_base*>(nullptr);
+
+    { // critical section; the run queue only supports a single consumer
+      std::lock_guard<spin_lock> lock(dispatcher.m_actor_lock);
+
+      if( auto* node = dispatcher.m_actors.pop() ) {
+        actor = static_cast<actor_base*>(node);
+      }
+      more = !dispatcher.m_actors.empty();
+    }
+
+    // A sender is mid-push; yield rather than spinning on it
+    if( !actor ) break;
+
+    actor->drain();
+
+    std::lock_guard<spin_lock> lock(dispatcher.m_actor_lock);
+    more = !dispatcher.m_actors.empty();
+  }
+
+  // Yield the worker to everything else pending, so that actors cannot
+  // starve other jobs
+  if( more ) {
+    dispatcher.defer_job( make_job( [&dispatcher]{ run( dispatcher ); } ) );
+    return;
+  }
+
+  dispatcher.m_actor_runners.fetch_sub( 1 );
+
+  // An actor may have been queued after the run queue was observed empty,
+  // but while the number of runners was still at its limit
+  {
+    std::lock_guard<spin_lock> lock(dispatcher.m_actor_lock);
+    more = !dispatcher.m_actors.empty();
+  }
+  if( more ) {
+    add_runner( dispatcher );
+  }
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // flush_message
+  //---------------------------------------------------------------------------
+
+  flush_message::flush_message( bit::platform::job job )
+    noexcept
+    : actor_message_base(&receive_flush),
+      job(std::move(job))
+  {
+
+  }
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  void receive_flush( bit::platform::detail::actor_base&,
+                      bit::platform::detail::actor_message_base* message )
+  {
+    // The job is finalized as it leaves scope, after which the waiting
+    // thread may destroy the message
+    auto job = std::move(static_cast<flush_message*>(message)->job);
+    job.execute();
+  }
+
+} // namespace anonymous
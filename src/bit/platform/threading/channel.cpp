@@ -0,0 +1,325 @@
+#include <bit/platform/threading/channel.hpp>
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+#include <bit/platform/threading/detail/this_thread.hpp>
+
+#include <cassert> // assert
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Attempts to receive from each of \p count cases, starting at
+  ///        \p start
+  ///
+  /// \return the index of the case that received, otherwise
+  ///         \c select_closed or \c select_empty
+  std::size_t try_cases( bit::platform::detail::select_case* const* cases,
+                         std::size_t count,
+                         std::size_t start );
+
+} // namespace anonymous
+
+//=============================================================================
+// detail::channel_waiter
+//=============================================================================
+
+constexpr std::uint32_t bit::platform::detail::channel_waiter::no_notifier;
+
+//=============================================================================
+// detail::channel_wait_list
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::channel_wait_list::channel_wait_list()
+  noexcept
+  : m_head(nullptr),
+    m_tail(nullptr)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Capacity
+//-----------------------------------------------------------------------------
+
+bool bit::platform::detail::channel_wait_list::empty()
+  const noexcept
+{
+  return m_head == nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::channel_wait_list::push_back( channel_wait_node* node )
+  noexcept
+{
+  node->prev   = m_tail;
+  node->next   = nullptr;
+  node->linked = true;
+
+  if( m_tail ) {
+    m_tail->next = node;
+  } else {
+    m_head = node;
+  }
+  m_tail = node;
+}
+
+void bit::platform::detail::channel_wait_list::remove( channel_wait_node* node )
+  noexcept
+{
+  if( !node->linked ) return;
+
+  if( node->prev ) {
+    node->prev->next = node->next;
+  } else {
+    m_head = node->next;
+  }
+  if( node->next ) {
+    node->next->prev = node->prev;
+  } else {
+    m_tail = node->prev;
+  }
+  node->linked = false;
+}
+
+bit::platform::detail::channel_waiter*
+  bit::platform::detail::channel_wait_list::notify_one()
+  noexcept
+{
+  while( m_head ) {
+    auto* node = m_head;
+    remove( node );
+
+    // A waiter in a select may have been notified by another channel
+    // already, in which case it no longer waits on this one
+    if( node->waiter->notify( node->index ) ) return node->waiter;
+  }
+  return nullptr;
+}
+
+void bit::platform::detail::channel_wait_list::notify( std::size_t count )
+  noexcept
+{
+  for( auto i = std::size_t{0}; i < count; ++i ) {
+    auto* waiter = notify_one();
+    if( !waiter ) return;
+
+    waiter->wake();
+  }
+}
+
+void bit::platform::detail::channel_wait_list::notify_all()
+  noexcept
+{
+  while( auto* waiter = notify_one() ) {
+    waiter->wake();
+  }
+}
+
+//=============================================================================
+// detail::channel_base
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::channel_base::channel_base()
+  noexcept
+  : m_lock(),
+    m_receivers(),
+    m_senders(),
+    m_closed(false)
+{
+
+}
+
+bit::platform::detail::channel_base::~channel_base()
+{
+  assert( m_receivers.empty() && m_senders.empty() && "channel destroyed while threads are blocked on it" );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+bool bit::platform::detail::channel_base::closed()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_closed;
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::channel_base::close()
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( m_closed ) return;
+
+  m_closed = true;
+  m_receivers.notify_all();
+  m_senders.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Protected Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::channel_base::park( channel_wait_list& list,
+                                                std::unique_lock<spin_lock>& lock )
+  noexcept
+{
+  channel_waiter waiter;
+  auto node = channel_wait_node{ &waiter, 0u, nullptr, nullptr, false };
+
+  list.push_back( &node );
+  lock.unlock();
+
+  // The node is unlinked by whoever notifies the waiter, so it is no longer
+  // referenced once the lock is reacquired
+  {
+    blocking_region region;
+    waiter.wait();
+  }
+  lock.lock();
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::channel_base::add_receiver( channel_wait_node* node )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  m_receivers.push_back( node );
+}
+
+void bit::platform::detail::channel_base::remove_receiver( channel_wait_node* node )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  m_receivers.remove( node );
+}
+
+void bit::platform::detail::channel_base::notify_receiver()
+  noexcept
+{
+  std::unique_lock<spin_lock> lock(m_lock);
+
+  auto* waiter = m_receivers.notify_one();
+  lock.unlock();
+
+  if( waiter ) waiter->wake();
+}
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+std::size_t bit::platform::detail::select( select_case* const* cases,
+                                           channel_wait_node* nodes,
+                                           std::size_t count,
+                                           bool block )
+{
+  // Starting from a random case keeps a busy channel from starving the
+  // channels that follow it
+  auto index = try_cases( cases, count, this_thread_random() % count );
+
+  if( index != select_empty || !block ) return index;
+
+  channel_waiter waiter;
+  auto notifier = channel_waiter::no_notifier;
+
+  const auto unlink = [&]
+  {
+    for( auto i = std::size_t{0}; i < count; ++i ) {
+      cases[i]->source->remove_receiver( &nodes[i] );
+    }
+  };
+
+  while( index == select_empty ) {
+    for( auto i = std::size_t{0}; i < count; ++i ) {
+      nodes[i] = channel_wait_node{ &waiter, static_cast<std::uint32_t>(i), nullptr, nullptr, false };
+      cases[i]->source->add_receiver( &nodes[i] );
+    }
+
+    // Any value sent after the waiter is linked notifies it, so checking
+    // the cases once more cannot miss a value before blocking
+    try {
+      index = try_cases( cases, count, this_thread_random() % count );
+    } catch( ... ) {
+      unlink();
+      throw;
+    }
+    if( index == select_empty ) {
+      blocking_region region;
+      waiter.wait();
+    }
+    unlink();
+
+    if( waiter.notifier() != channel_waiter::no_notifier ) {
+      notifier = waiter.notifier();
+      waiter.reset();
+    }
+  }
+
+  // The notification of a channel that was not received from is passed on,
+  // so that its value is not left behind while other receivers are blocked
+  if( notifier != channel_waiter::no_notifier && notifier != index ) {
+    cases[notifier]->source->notify_receiver();
+  }
+  return index;
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  std::size_t try_cases( bit::platform::detail::select_case* const* cases,
+                         std::size_t count,
+                         std::size_t start )
+  {
+    auto closed = std::size_t{0};
+
+    for( auto i = std::size_t{0}; i < count; ++i ) {
+      const auto index = (start + i) % count;
+      auto& c = *cases[index];
+
+      const auto status = c.receive( c );
+
+      if( status == bit::platform::channel_status::ok ) return index;
+      if( status == bit::platform::channel_status::closed ) ++closed;
+    }
+
+    return (closed == count) ? bit::platform::select_closed
+                             : bit::platform::select_empty;
+  }
+
+} // namespace anonymous
@@ -0,0 +1,266 @@
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+#include <bit/platform/threading/futex.hpp>
+#include <bit/platform/threading/thread.hpp>
+
+#include <cassert> // assert
+#include <cstdint> // std::uint32_t
+#include <mutex>   // std::lock_guard
+
+//=============================================================================
+// detail::arbiter_waiter
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief A thread waiting for a lease, linked into the arbiter's queue of
+  ///        waiters for the duration of the wait
+  struct arbiter_waiter
+  {
+    std::atomic<std::uint32_t> granted; ///< Set once the lease is handed over
+    arbiter_waiter*            next;
+  };
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// The arbiter that the calling thread holds a lease from, if any
+  thread_local bit::platform::concurrency_arbiter* g_lease = nullptr;
+
+} // namespace anonymous
+
+//=============================================================================
+// concurrency_arbiter
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Public Static Functions
+//-----------------------------------------------------------------------------
+
+bit::platform::concurrency_arbiter& bit::platform::concurrency_arbiter::global()
+  noexcept
+{
+  static concurrency_arbiter s_arbiter( default_budget() );
+
+  return s_arbiter;
+}
+
+std::size_t bit::platform::concurrency_arbiter::default_budget()
+  noexcept
+{
+  return available_concurrency();
+}
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+bit::platform::concurrency_arbiter::concurrency_arbiter( std::size_t budget )
+  noexcept
+  : m_lock(),
+    m_budget(budget ? budget : 1u),
+    m_active(0),
+    m_head(nullptr),
+    m_tail(nullptr),
+    m_waiting(0),
+    m_registered(0)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::concurrency_arbiter::budget()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_budget;
+}
+
+std::size_t bit::platform::concurrency_arbiter::active()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_active;
+}
+
+std::size_t bit::platform::concurrency_arbiter::waiting()
+  const noexcept
+{
+  return m_waiting.load( std::memory_order_relaxed );
+}
+
+std::size_t bit::platform::concurrency_arbiter::registered()
+  const noexcept
+{
+  return m_registered.load( std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::concurrency_arbiter::set_budget( std::size_t budget )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  m_budget = budget ? budget : 1u;
+
+  // Raising the budget grants leases to as many waiters as now fit. Waking
+  // only hashes the address, so the waiter may leave as soon as it is granted
+  while( m_head && m_active < m_budget ) {
+    auto* waiter = m_head;
+    m_head = waiter->next;
+    if( !m_head ) m_tail = nullptr;
+
+    ++m_active;
+    m_waiting.fetch_sub( 1u, std::memory_order_relaxed );
+
+    waiter->granted.store( 1u, std::memory_order_release );
+    futex_wake_one( waiter->granted );
+  }
+}
+
+void bit::platform::concurrency_arbiter::attach( std::size_t workers )
+  noexcept
+{
+  m_registered.fetch_add( workers, std::memory_order_relaxed );
+}
+
+void bit::platform::concurrency_arbiter::detach( std::size_t workers )
+  noexcept
+{
+  m_registered.fetch_sub( workers, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Leasing
+//-----------------------------------------------------------------------------
+
+void bit::platform::concurrency_arbiter::acquire()
+  noexcept
+{
+  assert( g_lease == nullptr && "concurrency_arbiter::acquire: thread already holds a lease" );
+
+  detail::arbiter_waiter waiter;
+  waiter.granted.store( 0u, std::memory_order_relaxed );
+  waiter.next = nullptr;
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    // Threads that are already waiting are served first, so a free slot is
+    // only taken directly when nobody is queued for it
+    if( !m_head && m_active < m_budget ) {
+      ++m_active;
+      g_lease = this;
+      return;
+    }
+
+    if( m_tail ) {
+      m_tail->next = &waiter;
+    } else {
+      m_head = &waiter;
+    }
+    m_tail = &waiter;
+    m_waiting.fetch_add( 1u, std::memory_order_relaxed );
+  }
+
+  while( waiter.granted.load( std::memory_order_acquire ) == 0u ) {
+    futex_wait( waiter.granted, 0u );
+  }
+  g_lease = this;
+}
+
+bool bit::platform::concurrency_arbiter::try_acquire()
+  noexcept
+{
+  assert( g_lease == nullptr && "concurrency_arbiter::try_acquire: thread already holds a lease" );
+
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( m_head || m_active >= m_budget ) return false;
+
+  ++m_active;
+  g_lease = this;
+  return true;
+}
+
+void bit::platform::concurrency_arbiter::release()
+  noexcept
+{
+  assert( g_lease == this && "concurrency_arbiter::release: thread does not hold a lease" );
+
+  g_lease = nullptr;
+
+  auto* waiter = static_cast<detail::arbiter_waiter*>(nullptr);
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    // The slot is handed over directly, so that the releasing thread cannot
+    // take it back before the waiter wakes up
+    if( m_head && m_active <= m_budget ) {
+      waiter = m_head;
+      m_head = waiter->next;
+      if( !m_head ) m_tail = nullptr;
+
+      m_waiting.fetch_sub( 1u, std::memory_order_relaxed );
+      waiter->granted.store( 1u, std::memory_order_release );
+    } else {
+      --m_active;
+    }
+  }
+
+  if( waiter ) futex_wake_one( waiter->granted );
+}
+
+//=============================================================================
+// blocking_region
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::blocking_region::blocking_region()
+  noexcept
+  : m_arbiter(g_lease)
+{
+  if( m_arbiter ) m_arbiter->release();
+}
+
+bit::platform::blocking_region::~blocking_region()
+{
+  if( m_arbiter ) m_arbiter->acquire();
+}
+
+//=============================================================================
+// Free Functions
+//=============================================================================
+
+void bit::platform::yield_lease()
+  noexcept
+{
+  auto* arbiter = g_lease;
+
+  if( !arbiter || arbiter->waiting() == 0 ) return;
+
+  // Releasing hands the slot to the longest waiting thread, and acquiring
+  // again queues behind any others
+  arbiter->release();
+  arbiter->acquire();
+}
@@ -0,0 +1,161 @@
+#include <bit/platform/threading/detail/cgroup.hpp>
+
+#include <algorithm> // std::min
+#include <cstdlib>   // std::strtoull, std::strtoll
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Lowers \p cpus to \p limit, if there is a limit
+  ///
+  /// \param cpus the current number of CPUs, or 0 if there is no limit yet
+  /// \param limit the limit, or 0 if there is none
+  void apply_limit( std::size_t& cpus, std::size_t limit ) noexcept;
+
+} // namespace anonymous
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+std::size_t bit::platform::detail::count_cpu_list( const std::string& list )
+  noexcept
+{
+  auto count = std::size_t{0};
+  auto* p    = list.c_str();
+
+  while( *p ) {
+    auto* end = static_cast<char*>(nullptr);
+
+    const auto first = std::strtoull( p, &end, 10 );
+    if( end == p ) break;
+    p = end;
+
+    auto last = first;
+    if( *p == '-' ) {
+      last = std::strtoull( p + 1, &end, 10 );
+      p = end;
+    }
+    if( last >= first ) count += static_cast<std::size_t>(last - first + 1);
+
+    if( *p != ',' ) break;
+    ++p;
+  }
+
+  return count;
+}
+
+std::size_t bit::platform::detail::quota_to_cpus( long long quota,
+                                                  long long period )
+  noexcept
+{
+  if( quota <= 0 || period <= 0 ) return 0u;
+
+  return static_cast<std::size_t>( (quota + period - 1) / period );
+}
+
+std::size_t bit::platform::detail::parse_cpu_max( const std::string& value )
+  noexcept
+{
+  // 'max period' is unlimited, and fails to parse as a quota
+  const auto space = value.find( ' ' );
+  if( space == std::string::npos || value.compare( 0, space, "max" ) == 0 ) {
+    return 0u;
+  }
+
+  return quota_to_cpus( std::strtoll( value.c_str(), nullptr, 10 ),
+                        std::strtoll( value.c_str() + space + 1, nullptr, 10 ) );
+}
+
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::detail::cgroup_concurrency( std::istream& cgroups,
+                                                       const cgroup_file_reader& read_line )
+{
+  static const auto root = std::string("/sys/fs/cgroup");
+
+  auto limit = std::size_t{0};
+  auto line  = std::string{};
+  auto value = std::string{};
+
+  // Each line is of the form 'hierarchy-id:controllers:path', where the
+  // unified (v2) hierarchy has the id 0 and no controllers
+  while( std::getline( cgroups, line ) ) {
+    const auto first  = line.find( ':' );
+    const auto second = line.find( ':', first + 1 );
+    if( first == std::string::npos || second == std::string::npos ) continue;
+
+    const auto controllers = "," + line.substr( first + 1, second - first - 1 ) + ",";
+    auto path = line.substr( second + 1 );
+    if( path == "/" ) path.clear();
+
+    if( controllers == ",," ) {
+      // A quota set on any ancestor also limits this cgroup. Inside of a
+      // cgroup namespace the path is relative to the mount, so the walk
+      // ends at the mount itself
+      for( auto dir = path; ; dir.erase( dir.rfind( '/' ) ) ) {
+        if( read_line( root + dir + "/cpu.max", value ) ) {
+          apply_limit( limit, parse_cpu_max( value ) );
+        }
+        if( dir.empty() ) break;
+      }
+
+      if( read_line( root + path + "/cpuset.cpus.effective", value ) ) {
+        apply_limit( limit, count_cpu_list( value ) );
+      }
+      continue;
+    }
+
+    // cgroup v1 controllers are mounted separately; the mount only
+    // contains the path of the process when it is not namespaced
+    if( controllers.find( ",cpu," ) != std::string::npos ) {
+      for( auto& dir : { root + "/cpu" + path, root + "/cpu" } ) {
+        auto period = std::string{};
+
+        if( read_line( dir + "/cpu.cfs_quota_us", value ) &&
+            read_line( dir + "/cpu.cfs_period_us", period ) ) {
+          apply_limit( limit, quota_to_cpus( std::strtoll( value.c_str(), nullptr, 10 ),
+                                             std::strtoll( period.c_str(), nullptr, 10 ) ) );
+          break;
+        }
+      }
+    }
+    if( controllers.find( ",cpuset," ) != std::string::npos ) {
+      for( auto& dir : { root + "/cpuset" + path, root + "/cpuset" } ) {
+        if( read_line( dir + "/cpuset.cpus", value ) ) {
+          apply_limit( limit, count_cpu_list( value ) );
+          break;
+        }
+      }
+    }
+  }
+
+  return limit;
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  void apply_limit( std::size_t& cpus, std::size_t limit )
+    noexcept
+  {
+    if( limit == 0 ) return;
+
+    cpus = (cpus == 0) ? limit : std::min( cpus, limit );
+  }
+
+} // namespace anonymous
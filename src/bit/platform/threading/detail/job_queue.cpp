@@ -21,7 +21,14 @@ void bit::platform::detail::job_queue::push( job j )
 {
   std::lock_guard<std::mutex> lock(m_lock);
 
-  m_jobs[m_bottom++ % max_jobs] = std::move(j);
+  m_jobs[index_of(m_bottom++)] = std::move(j);
+}
+
+void bit::platform::detail::job_queue::defer( job j )
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_jobs[index_of(--m_top)] = std::move(j);
 }
 
 //----------------------------------------------------------------------------
@@ -33,7 +40,7 @@ bit::platform::job bit::platform::detail::job_queue::pop()
   // If there are no jobs, return null
   if( m_bottom <= m_top ) return job{};
 
-  return std::move(m_jobs[--m_bottom % max_jobs]);
+  return std::move(m_jobs[index_of(--m_bottom)]);
 }
 
 bit::platform::job bit::platform::detail::job_queue::steal()
@@ -43,7 +50,7 @@ bit::platform::job bit::platform::detail::job_queue::steal()
   // If there are no jobs, return null
   if( m_bottom <= m_top ) return job{};
 
-  return std::move(m_jobs[m_top++ % max_jobs]);
+  return std::move(m_jobs[index_of(m_top++)]);
 }
 
 //----------------------------------------------------------------------------
@@ -57,3 +64,17 @@ bool bit::platform::detail::job_queue::empty()
 
   return m_bottom == m_top;
 }
+
+//----------------------------------------------------------------------------
+// Private Observers
+//----------------------------------------------------------------------------
+
+std::size_t bit::platform::detail::job_queue::index_of( std::ptrdiff_t position )
+  noexcept
+{
+  // Deferred jobs may move the top below zero; since max_jobs is a power of
+  // two, the unsigned conversion wraps onto the correct index
+  static_assert( (max_jobs & (max_jobs - 1)) == 0, "max_jobs must be a power of two" );
+
+  return static_cast<std::size_t>(position) % max_jobs;
+}
@@ -46,6 +46,12 @@ namespace bit {
       /// \param j the job to push
       void push( job j );
 
+      /// \brief Pushes a job behind all other jobs in this queue, so that it
+      ///        is the last to be popped and the first to be stolen
+      ///
+      /// \param j the job to defer
+      void defer( job j );
+
       /// \brief Pops a job from the front of this job_queue
       ///
       /// \return the popped job, or nullptr on failure
@@ -77,6 +83,17 @@ namespace bit {
       std::ptrdiff_t           m_bottom;
       std::ptrdiff_t           m_top;
       mutable std::mutex       m_lock;
+
+      //-----------------------------------------------------------------------
+      // Private Observers
+      //-----------------------------------------------------------------------
+    private:
+
+      /// \brief Converts a (possibly negative) position into an index
+      ///
+      /// \param position the position in the queue
+      /// \return the index into the job buffer
+      static std::size_t index_of( std::ptrdiff_t position ) noexcept;
     };
 
     } // namespace detail
@@ -0,0 +1,248 @@
+#include "small_block_pool.hpp"
+
+#include <atomic>  // std::atomic
+#include <cassert> // assert
+#include <mutex>   // std::lock_guard
+#include <new>     // operator new, operator delete
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief The caches of a thread for every pool, which are given back
+      ///        to their pools when the thread exits
+      /////////////////////////////////////////////////////////////////////////
+      class thread_block_caches
+      {
+      public:
+
+        using block_list = small_block_pool::block_list;
+
+        thread_block_caches() noexcept;
+        ~thread_block_caches();
+
+        small_block_pool* pools[small_block_pool::max_pools];
+        block_list        lists[small_block_pool::max_pools][small_block_pool::block_classes];
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// The number of pools constructed so far
+  std::atomic<std::size_t> g_pool_count{0};
+
+  thread_local bit::platform::detail::thread_block_caches g_thread_caches;
+
+} // namespace anonymous
+
+//=============================================================================
+// detail::thread_block_caches
+//=============================================================================
+
+bit::platform::detail::thread_block_caches::thread_block_caches()
+  noexcept
+  : pools{},
+    lists{}
+{
+
+}
+
+bit::platform::detail::thread_block_caches::~thread_block_caches()
+{
+  for( auto i = std::size_t{0}; i < small_block_pool::max_pools; ++i ) {
+    if( pools[i] ) pools[i]->release_thread( lists[i] );
+  }
+}
+
+//=============================================================================
+// detail::small_block_pool
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Static Members
+//-----------------------------------------------------------------------------
+
+constexpr std::size_t bit::platform::detail::small_block_pool::block_granularity;
+constexpr std::size_t bit::platform::detail::small_block_pool::block_classes;
+constexpr std::size_t bit::platform::detail::small_block_pool::max_pools;
+constexpr std::size_t bit::platform::detail::small_block_pool::slab_size;
+constexpr std::size_t bit::platform::detail::small_block_pool::batch_blocks;
+constexpr std::size_t bit::platform::detail::small_block_pool::max_cached_blocks;
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::small_block_pool::small_block_pool( block_source source )
+  noexcept
+  : m_source(source),
+    m_index(g_pool_count.fetch_add( 1u, std::memory_order_relaxed )),
+    m_lock(),
+    m_batches{},
+    m_slabs()
+{
+  assert( m_index < max_pools && "small_block_pool: too many pools" );
+}
+
+bit::platform::detail::small_block_pool::~small_block_pool()
+{
+  for( auto* slab : m_slabs ) {
+    ::operator delete( slab );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Allocation
+//-----------------------------------------------------------------------------
+
+void* bit::platform::detail::small_block_pool::allocate( std::size_t size )
+{
+  const auto size_class = size_class_of( size );
+  if( size_class >= block_classes ) {
+    return ::operator new( size );
+  }
+
+  auto& list = thread_lists()[size_class];
+
+  if( !list.head ) {
+    if( m_source == block_source::heap ) {
+      return ::operator new( (size_class + 1) * block_granularity );
+    }
+
+    auto* batch = acquire( size_class );
+    list.head = batch;
+    list.size = batch->size;
+  }
+
+  auto* block = list.head;
+  list.head = block->next;
+  --list.size;
+  return block;
+}
+
+void bit::platform::detail::small_block_pool::deallocate( void* p,
+                                                          std::size_t size )
+  noexcept
+{
+  const auto size_class = size_class_of( size );
+  if( size_class >= block_classes ) {
+    ::operator delete( p );
+    return;
+  }
+
+  auto& list = thread_lists()[size_class];
+
+  if( m_source == block_source::heap && list.size == max_cached_blocks ) {
+    ::operator delete( p );
+    return;
+  }
+
+  list.head = ::new (p) free_block{ list.head, nullptr, 0u };
+
+  if( ++list.size <= max_cached_blocks ) return;
+
+  // Keep the most recently freed blocks, since they are the most likely to
+  // still be in this thread's data cache, and return the rest
+  auto* last = list.head;
+  for( auto i = std::size_t{1}; i < batch_blocks; ++i ) {
+    last = last->next;
+  }
+  auto* batch = last->next;
+  last->next  = nullptr;
+
+  batch->size = list.size - batch_blocks;
+  list.size   = batch_blocks;
+  release( batch, size_class );
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::detail::small_block_pool::size_class_of( std::size_t size )
+  noexcept
+{
+  return (size + block_granularity - 1) / block_granularity - 1;
+}
+
+bit::platform::detail::small_block_pool::block_list*
+  bit::platform::detail::small_block_pool::thread_lists()
+  noexcept
+{
+  // The thread's caches only learn of this pool once it first uses it
+  g_thread_caches.pools[m_index] = this;
+
+  return g_thread_caches.lists[m_index];
+}
+
+bit::platform::detail::small_block_pool::free_block*
+  bit::platform::detail::small_block_pool::acquire( std::size_t size_class )
+{
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    if( auto* batch = m_batches[size_class] ) {
+      m_batches[size_class] = batch->next_batch;
+      return batch;
+    }
+    m_slabs.reserve( m_slabs.size() + 1 );
+  }
+
+  const auto block_size = (size_class + 1) * block_granularity;
+  const auto count      = slab_size / block_size;
+
+  auto* slab = static_cast<char*>(::operator new( slab_size ));
+
+  auto* batch = static_cast<free_block*>(nullptr);
+  for( auto i = count; i > 0; --i ) {
+    batch = ::new (slab + (i - 1) * block_size) free_block{ batch, nullptr, 0u };
+  }
+  batch->size = count;
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+    m_slabs.push_back( slab );
+  }
+  return batch;
+}
+
+void bit::platform::detail::small_block_pool::release( free_block* batch,
+                                                       std::size_t size_class )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  batch->next_batch = m_batches[size_class];
+  m_batches[size_class] = batch;
+}
+
+void bit::platform::detail::small_block_pool::release_thread( block_list* lists )
+  noexcept
+{
+  for( auto i = std::size_t{0}; i < block_classes; ++i ) {
+    auto& list = lists[i];
+
+    if( m_source == block_source::heap ) {
+      while( auto* block = list.head ) {
+        list.head = block->next;
+        ::operator delete( block );
+      }
+    } else if( list.head ) {
+      list.head->size = list.size;
+      release( list.head, i );
+    }
+    list = block_list{ nullptr, 0u };
+  }
+}
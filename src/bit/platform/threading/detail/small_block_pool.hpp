@@ -0,0 +1,185 @@
+/**
+ * \file small_block_pool.hpp
+ *
+ * \brief This header contains a pool of small blocks that are cached
+ *        per-thread in size classes
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+#ifndef SRC_BIT_PLATFORM_THREADING_DETAIL_SMALL_BLOCK_POOL_HPP
+#define SRC_BIT_PLATFORM_THREADING_DETAIL_SMALL_BLOCK_POOL_HPP
+
+#include <bit/platform/threading/spin_lock.hpp> // spin_lock
+
+#include <cstddef> // std::size_t
+#include <vector>  // std::vector
+
+namespace bit {
+  namespace platform {
+    namespace detail {
+
+      /// \brief Where a small_block_pool gets its blocks from, and where the
+      ///        blocks that a thread has too many of go
+      enum class block_source
+      {
+        heap,       ///< Blocks are allocated one at a time, and surplus
+                    ///< blocks are freed
+        slab_depot, ///< Blocks are carved out of shared slabs, and surplus
+                    ///< blocks return to a shared depot in batches
+      };
+
+      class thread_block_caches;
+
+      //=======================================================================
+      // small_block_pool
+      //=======================================================================
+
+      /////////////////////////////////////////////////////////////////////////
+      /// \brief A pool of small blocks, cached per-thread in size classes
+      ///
+      /// Blocks are returned to the cache of whichever thread frees them, so
+      /// blocks migrate from the threads that consume objects to the threads
+      /// that produce them. With \ref block_source::slab_depot, a thread that
+      /// frees more blocks than it allocates hands them back to the
+      /// producers in batches through a shared depot, rather than to the
+      /// heap.
+      ///
+      /// Requests larger than the largest size class go to operator new.
+      /////////////////////////////////////////////////////////////////////////
+      class small_block_pool
+      {
+        //---------------------------------------------------------------------
+        // Public Static Members
+        //---------------------------------------------------------------------
+      public:
+
+        /// The granularity of the size classes
+        static constexpr std::size_t block_granularity = 64u;
+
+        /// The number of size classes; larger blocks are not pooled
+        static constexpr std::size_t block_classes = 4u;
+
+        /// The maximum number of pools in a process
+        static constexpr std::size_t max_pools = 4u;
+
+        //---------------------------------------------------------------------
+        // Constructors / Destructor / Assignment
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Constructs a pool that gets its blocks from \p source
+        ///
+        /// \param source where the blocks come from
+        explicit small_block_pool( block_source source ) noexcept;
+
+        // Deleted move constructor
+        small_block_pool( small_block_pool&& other ) = delete;
+
+        // Deleted copy constructor
+        small_block_pool( const small_block_pool& other ) = delete;
+
+        //---------------------------------------------------------------------
+
+        /// \brief Frees every slab of this pool
+        ~small_block_pool();
+
+        //---------------------------------------------------------------------
+
+        // Deleted move assignment
+        small_block_pool& operator=( small_block_pool&& other ) = delete;
+
+        // Deleted copy assignment
+        small_block_pool& operator=( const small_block_pool& other ) = delete;
+
+        //---------------------------------------------------------------------
+        // Allocation
+        //---------------------------------------------------------------------
+      public:
+
+        /// \brief Allocates a block of at least \p size bytes
+        ///
+        /// \param size the size of the block
+        /// \return the block
+        void* allocate( std::size_t size );
+
+        /// \brief Returns block \p p, allocated with a \p size of \p size,
+        ///        to the pool
+        ///
+        /// \param p the block
+        /// \param size the size that \p p was allocated with
+        void deallocate( void* p, std::size_t size ) noexcept;
+
+        //---------------------------------------------------------------------
+        // Private Member Types
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief A free block, linked in place of the object that used to
+        ///        occupy it
+        ///
+        /// The first block of a batch in the depot also records the batch
+        /// size, and links to the next batch
+        struct free_block
+        {
+          free_block* next;
+          free_block* next_batch;
+          std::size_t size;
+        };
+
+        /// \brief The free blocks of one size class that a thread caches
+        struct block_list
+        {
+          free_block* head;
+          std::size_t size;
+        };
+
+        /// The size of each slab that is carved into blocks
+        static constexpr std::size_t slab_size = 16384u;
+
+        /// The number of blocks exchanged between a thread and the depot at
+        /// once
+        static constexpr std::size_t batch_blocks = 32u;
+
+        /// The maximum number of blocks cached per size class, per thread
+        static constexpr std::size_t max_cached_blocks = 2u * batch_blocks;
+
+        friend class thread_block_caches;
+
+        //---------------------------------------------------------------------
+        // Private Members
+        //---------------------------------------------------------------------
+      private:
+
+        block_source       m_source;
+        std::size_t        m_index;  ///< The caches of this pool in each thread
+        spin_lock          m_lock;
+        free_block*        m_batches[block_classes];
+        std::vector<void*> m_slabs;
+
+        //---------------------------------------------------------------------
+        // Private Member Functions
+        //---------------------------------------------------------------------
+      private:
+
+        /// \brief Gets the size class of blocks that fit \p size bytes
+        static std::size_t size_class_of( std::size_t size ) noexcept;
+
+        /// \brief Gets the caches of the calling thread for this pool
+        block_list* thread_lists() noexcept;
+
+        /// \brief Acquires a batch of free blocks from the depot, carving a
+        ///        new slab if none are available
+        free_block* acquire( std::size_t size_class );
+
+        /// \brief Releases the batch \p batch to the depot
+        void release( free_block* batch, std::size_t size_class ) noexcept;
+
+        /// \brief Gives up the caches \p lists of a thread that is exiting
+        void release_thread( block_list* lists ) noexcept;
+      };
+
+    } // namespace detail
+  } // namespace platform
+} // namespace bit
+
+#endif /* SRC_BIT_PLATFORM_THREADING_DETAIL_SMALL_BLOCK_POOL_HPP */
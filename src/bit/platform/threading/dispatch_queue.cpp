@@ -1,24 +1,15 @@
 #include <bit/platform/threading/dispatch_queue.hpp>
-
-#include <random> // std::random_device, sdt::uniform_distribution, etc
-#include <memory> // std::unique_ptr
-#include <vector> // std::vector
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+#include <bit/platform/threading/futex.hpp>
 
 #include <cassert> // assert
 
-#include "detail/job_queue.hpp" // detail::job_queue
-
 //=============================================================================
 // Anonymous Declarations
 //=============================================================================
 
 namespace {
 
-  /// \brief Gets the address of this thread's active job queue
-  ///
-  /// \return pointer to the job queue
-//  bit::platform::detail::job_queue* get_job_queue();
-
   //---------------------------------------------------------------------------
   // Globals
   //---------------------------------------------------------------------------
@@ -28,7 +19,7 @@ namespace {
 } // namespace anonymous
 
 //=============================================================================
-// Anonymous Declarations
+// dispatch_queue
 //=============================================================================
 
 //-----------------------------------------------------------------------------
@@ -36,8 +27,10 @@ namespace {
 //-----------------------------------------------------------------------------
 
 bit::platform::dispatch_queue::dispatch_queue()
-  : m_is_running(false),
-    m_queue(std::make_unique<detail::job_queue>()) // HACK: temporary m_queue
+  : m_queue(),
+    m_thread(),
+    m_is_running(false),
+    m_sleeping(0)
 {
 
 }
@@ -56,6 +49,7 @@ void bit::platform::dispatch_queue::start()
   if( m_is_running ) return;
 
   m_is_running = true;
+  concurrency_arbiter::global().attach( 1u );
   m_thread = std::thread(&dispatch_queue::run,this);
 }
 
@@ -64,17 +58,35 @@ void bit::platform::dispatch_queue::stop()
   if( !m_is_running ) return;
 
   m_is_running = false;
-  m_cv.notify_all();
+
+  m_sleeping.store( 0 );
+  futex_wake_one( m_sleeping );
+
   m_thread.join();
+  concurrency_arbiter::global().detach( 1u );
 }
 
 void bit::platform::dispatch_queue::wait( job_handle job )
 {
-  // wait until job is completed
-  std::mutex mutex;
-  std::unique_lock<std::mutex> lock(mutex);
+  if( job.completed() ) return;
+
+  // Waiting from inside of this queue would otherwise deadlock, so the
+  // calling thread keeps dispatching instead
+  if( g_this_queue == this ) {
+    while( !job.completed() ) {
+      if( drain() != 0 ) continue;
+
+      yield_lease();
+      std::this_thread::yield();
+    }
+    return;
+  }
 
-  m_cv.wait(lock, [&]{ return job.completed(); });
+  // The job wakes this thread itself once it, and all of its children,
+  // have finished -- wherever they were executed. The waiting thread may
+  // be a worker of another executor
+  blocking_region region;
+  job.wait();
 }
 
 //-----------------------------------------------------------------------------
@@ -84,7 +96,8 @@ void bit::platform::dispatch_queue::post_job( job job )
   if( !m_is_running )
     std::terminate();
 
-  m_queue->push( std::move(job) );
+  m_queue.push( detail::release_job( std::move(job) ) );
+  wake();
 }
 
 //-----------------------------------------------------------------------------
@@ -95,28 +108,56 @@ void bit::platform::dispatch_queue::run()
 {
   g_this_queue = this;
 
+  auto& arbiter = concurrency_arbiter::global();
+  arbiter.acquire();
+
   while( true ) {
+    if( drain() != 0 ) continue;
+
+    if( !m_is_running && m_queue.empty() ) break;
 
-    if( !m_is_running && m_queue->empty() ) break;
+    sleep();
+  }
+
+  arbiter.release();
+}
 
-    // wait until job is entered into queue
-    {
-      std::unique_lock<std::mutex> lock(m_mutex);
-      m_cv.wait(lock, [&]{ return !m_queue->empty(); });
+std::size_t bit::platform::dispatch_queue::drain()
+{
+  auto count = std::size_t{0};
+
+  while( auto* node = m_queue.pop() ) {
+    { // The job is finalized as it leaves scope
+      auto j = detail::acquire_job( node );
+      j.execute();
     }
+    ++count;
+  }
 
-    auto j = get_job();
+  return count;
+}
 
-    assert( j != nullptr );
+void bit::platform::dispatch_queue::sleep()
+{
+  m_sleeping.store( 1 );
 
-    j.execute();
-    m_cv.notify_all();
+  // Producers push before checking the flag, and this checks the queue after
+  // setting it, so either the producer sees the flag or this sees the job
+  if( m_queue.empty() && m_is_running ) {
+    blocking_region region;
+    futex_wait( m_sleeping, 1 );
   }
+
+  m_sleeping.store( 0, std::memory_order_relaxed );
 }
 
-bit::platform::job bit::platform::dispatch_queue::get_job()
+void bit::platform::dispatch_queue::wake()
 {
-  return m_queue->steal();
+  if( m_sleeping.load() == 0 ) return;
+
+  if( m_sleeping.exchange( 0 ) != 0 ) {
+    futex_wake_one( m_sleeping );
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -152,18 +193,3 @@ void bit::platform::this_dispatch_queue::wait( job_handle job )
   auto& queue = *g_this_queue;
   queue.wait( job );
 }
-
-//=============================================================================
-// Anonymous Definitions
-//=============================================================================
-
-namespace {
-
-//  bit::platform::detail::job_queue* get_job_queue()
-//  {
-//    thread_local bit::platform::detail::job_queue s_queue;
-//
-//    return &s_queue;
-//  }
-
-} // namespace anonymous
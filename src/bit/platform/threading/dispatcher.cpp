@@ -1,9 +1,13 @@
 #include <bit/platform/threading/dispatcher.hpp>
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+#include <bit/platform/threading/futex.hpp>
 #include <bit/platform/threading/thread.hpp>
 
-#include <random> // std::random_device, sdt::uniform_distribution, etc
-#include <memory> // std::unique_ptr
-#include <vector> // std::vector
+#include <algorithm> // std::min
+#include <iterator>  // std::make_move_iterator
+#include <random>    // std::random_device, sdt::uniform_distribution, etc
+#include <memory>    // std::unique_ptr
+#include <vector>    // std::vector
 
 #include <cassert> // assert
 
@@ -15,6 +19,19 @@
 
 namespace {
 
+  //--------------------------------------------------------------------------
+  // Constants
+  //--------------------------------------------------------------------------
+
+  /// The number of consecutive failed searches for a job before a worker
+  /// parks
+  constexpr auto idle_spins = std::size_t{256};
+
+  /// The maximum number of expired timers a worker posts at once. Each is
+  /// allocated from, and pushed to, the storage of the polling worker,
+  /// which holds at most job::max_jobs jobs
+  constexpr auto timer_batch_size = std::size_t{bit::platform::job::max_jobs / 2};
+
   //--------------------------------------------------------------------------
   // Utility Functions
   //--------------------------------------------------------------------------
@@ -32,6 +49,12 @@ namespace {
   /// \return pointer to the job queue
   bit::platform::detail::job_queue* get_job_queue();
 
+  /// \brief Counts the total number of workers in \p groups
+  ///
+  /// \param groups the worker groups
+  /// \return the number of workers
+  std::size_t count_workers( const std::vector<bit::platform::worker_group>& groups );
+
   //--------------------------------------------------------------------------
   // Globals
   //--------------------------------------------------------------------------
@@ -39,6 +62,13 @@ namespace {
   thread_local std::ptrdiff_t     g_thread_index = 0;
   thread_local bit::platform::dispatcher* g_this_dispatcher = nullptr;
 
+  /// The worker group that the calling worker was last pinned for
+  thread_local std::size_t g_thread_group = 0;
+
+  /// Scratch buffer of expired timer callbacks, reused between polls so that
+  /// servicing timers does not allocate in the steady state
+  thread_local std::vector<bit::platform::timer_wheel::callback_type> g_expired_timers;
+
 } // namespace anonymous
 
 std::ptrdiff_t bit::platform::worker_thread_id()
@@ -50,41 +80,108 @@ std::ptrdiff_t bit::platform::worker_thread_id()
 // job_dispatcher
 //============================================================================
 
+//----------------------------------------------------------------------------
+// Public Static Members
+//----------------------------------------------------------------------------
+
+constexpr bit::platform::dispatcher::group_id bit::platform::dispatcher::no_group;
+constexpr std::size_t bit::platform::dispatcher::max_groups;
+
 //----------------------------------------------------------------------------
 // Constructors / Destructor
 //----------------------------------------------------------------------------
 
 bit::platform::dispatcher::dispatcher()
-  : dispatcher( std::thread::hardware_concurrency() - 1 )
+  : dispatcher( available_concurrency() - 1 )
 {
 
 }
 
 bit::platform::dispatcher::dispatcher( std::size_t threads )
-  : m_running(false),
+  : m_groups(1),
+    m_worker_groups(threads+1),
+    m_running_threads(0),
+    m_running(false),
     m_set_affinity(false),
-    m_running_threads(0)
+    m_pending_timers(0),
+    m_expired_timers(),
+    m_expired_index(0),
+    m_actor_runners(0),
+    m_epoch(0),
+    m_sleepers(0)
 {
   m_threads.resize(threads);
   m_queues.resize(threads+1);
+  m_groups.front().size.store( threads, std::memory_order_relaxed );
 }
 
 
 bit::platform::dispatcher::dispatcher( assign_affinity_t )
-  : dispatcher( assign_affinity, std::thread::hardware_concurrency() - 1 )
+  : dispatcher( assign_affinity, available_concurrency() - 1 )
 {
 
 }
 
 bit::platform::dispatcher::dispatcher( assign_affinity_t, std::size_t threads )
-: m_running(false),
-  m_set_affinity(true),
+: m_groups(1),
+  m_worker_groups(threads+1),
   m_owner(),
-  m_running_threads(0)
+  m_running_threads(0),
+  m_running(false),
+  m_set_affinity(true),
+  m_pending_timers(0),
+  m_expired_timers(),
+  m_expired_index(0),
+  m_actor_runners(0),
+  m_epoch(0),
+  m_sleepers(0)
+{
+  m_threads.resize(threads);
+  m_queues.resize(threads+1);
+  m_groups.front().size.store( threads, std::memory_order_relaxed );
+}
 
+bit::platform::dispatcher::dispatcher( std::vector<worker_group> groups )
+  : m_groups(groups.size()),
+    m_worker_groups(count_workers(groups)+1),
+    m_running_threads(0),
+    m_running(false),
+    m_set_affinity(false),
+    m_pending_timers(0),
+    m_expired_timers(),
+    m_expired_index(0),
+    m_actor_runners(0),
+    m_epoch(0),
+    m_sleepers(0)
 {
+  assert( !groups.empty() && groups.size() <= max_groups && "dispatcher requires between 1 and max_groups worker groups" );
+
+  const auto threads = m_worker_groups.size() - 1;
   m_threads.resize(threads);
   m_queues.resize(threads+1);
+
+  for( auto i = group_id{0}; i < groups.size(); ++i ) {
+    m_groups[i].name  = std::move(groups[i].name);
+    m_groups[i].cores = std::move(groups[i].cores);
+  }
+
+  // Workers are numbered consecutively through the groups, in order
+  auto worker = std::size_t{1};
+  for( auto i = group_id{0}; i < groups.size(); ++i ) {
+    assert( find_group( m_groups[i].name ) == i && "dispatcher worker groups must be uniquely named" );
+
+    for( auto& name : groups[i].overflow ) {
+      const auto into = find_group( name );
+
+      assert( into != no_group && "dispatcher worker group overflows into an unknown group" );
+      set_overflow( i, into, true );
+    }
+
+    for( auto n = std::size_t{0}; n < groups[i].workers; ++n ) {
+      m_worker_groups[worker++].store( i, std::memory_order_relaxed );
+    }
+    m_groups[i].size.store( groups[i].workers, std::memory_order_relaxed );
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -103,12 +200,31 @@ void bit::platform::dispatcher::stop()
   assert( m_owner == std::this_thread::get_id() && "job_dispatcher can only be stopped on the creating thread");
 
   if(!m_running) return;
-  m_running = false;
+
+  // The workers finish their own queues once they stop, but nothing else
+  // would ever execute the jobs left in the queue of this thread
+  drain();
+
+  { // critical section
+    std::lock_guard<spin_lock> lock(m_timer_lock);
+
+    // Workers take expired timers under this lock, so clearing m_running
+    // here ensures that no timer expires once the dispatcher stops
+    m_timers.clear();
+    m_expired_timers.clear();
+    m_expired_index = 0;
+    m_pending_timers.store( 0u, std::memory_order_relaxed );
+    m_running = false;
+  }
+
+  m_epoch.fetch_add( 1 );
+  futex_wake_all( m_epoch );
 
   // Join all joinable threads
   for( auto& thread : m_threads ) {
     thread.join();
   }
+  concurrency_arbiter::global().detach( m_threads.size() );
 }
 
 //----------------------------------------------------------------------------
@@ -118,11 +234,141 @@ void bit::platform::dispatcher::wait( job_handle job )
   help_while([&]{ return !job.completed(); });
 }
 
+void bit::platform::dispatcher::wait( const completion_flag& flag )
+{
+  help_while([&]{ return !flag.signaled(); });
+}
+
 void bit::platform::dispatcher::post_job( job job )
 {
   push_job( std::move(job) );
 }
 
+//----------------------------------------------------------------------------
+// Worker Groups
+//----------------------------------------------------------------------------
+
+std::size_t bit::platform::dispatcher::groups()
+  const noexcept
+{
+  return m_groups.size();
+}
+
+bit::platform::dispatcher::group_id
+  bit::platform::dispatcher::find_group( const std::string& name )
+  const noexcept
+{
+  for( auto i = group_id{0}; i < m_groups.size(); ++i ) {
+    if( m_groups[i].name == name ) return i;
+  }
+  return no_group;
+}
+
+std::size_t bit::platform::dispatcher::group_size( group_id group )
+  const noexcept
+{
+  assert( group < m_groups.size() && "dispatcher::group_size: invalid group" );
+
+  return m_groups[group].size.load( std::memory_order_relaxed );
+}
+
+bit::platform::dispatcher::group_id
+  bit::platform::dispatcher::group_of( std::ptrdiff_t worker )
+  const noexcept
+{
+  assert( worker >= 0 && static_cast<std::size_t>(worker) < m_worker_groups.size() && "dispatcher::group_of: invalid worker" );
+
+  return m_worker_groups[worker].load( std::memory_order_relaxed );
+}
+
+//----------------------------------------------------------------------------
+
+void bit::platform::dispatcher::post_job_to( group_id group, job job )
+{
+  assert( group < m_groups.size() && "dispatcher::post_job_to: invalid group" );
+
+  if( !m_running ) std::terminate();
+
+  // Workers of the group keep the job local, where it is stolen from like
+  // any other job they push
+  if( g_this_dispatcher == this &&
+      m_worker_groups[g_thread_index].load( std::memory_order_relaxed ) == group ) {
+    m_queues[g_thread_index]->push( std::move(job) );
+  } else {
+    m_groups[group].inbox->push( std::move(job) );
+  }
+  m_cv.notify_all();
+  wake_workers();
+}
+
+//----------------------------------------------------------------------------
+
+std::size_t bit::platform::dispatcher::move_workers( group_id from,
+                                                     group_id to,
+                                                     std::size_t count )
+{
+  assert( from < m_groups.size() && to < m_groups.size() && "dispatcher::move_workers: invalid group" );
+
+  if( from == to ) return 0u;
+
+  auto moved = std::size_t{0};
+
+  // Worker 0 is the thread running the dispatcher, which is never moved
+  for( auto worker = std::size_t{1}; worker < m_worker_groups.size() && moved < count; ++worker ) {
+    auto expected = from;
+
+    if( m_worker_groups[worker].compare_exchange_strong( expected, to, std::memory_order_relaxed ) ) {
+      ++moved;
+    }
+  }
+
+  m_groups[from].size.fetch_sub( moved, std::memory_order_relaxed );
+  m_groups[to].size.fetch_add( moved, std::memory_order_relaxed );
+
+  return moved;
+}
+
+void bit::platform::dispatcher::move_worker( std::ptrdiff_t worker, group_id group )
+{
+  assert( worker > 0 && static_cast<std::size_t>(worker) < m_worker_groups.size() && "dispatcher::move_worker: invalid worker" );
+  assert( group < m_groups.size() && "dispatcher::move_worker: invalid group" );
+
+  const auto from = m_worker_groups[worker].exchange( group, std::memory_order_relaxed );
+
+  m_groups[from].size.fetch_sub( 1u, std::memory_order_relaxed );
+  m_groups[group].size.fetch_add( 1u, std::memory_order_relaxed );
+}
+
+void bit::platform::dispatcher::set_overflow( group_id group,
+                                              group_id into,
+                                              bool enabled )
+  noexcept
+{
+  assert( group < m_groups.size() && into < m_groups.size() && "dispatcher::set_overflow: invalid group" );
+
+  const auto bit = std::uint64_t{1} << into;
+
+  if( enabled ) {
+    m_groups[group].overflow.fetch_or( bit, std::memory_order_relaxed );
+  } else {
+    m_groups[group].overflow.fetch_and( ~bit, std::memory_order_relaxed );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Timers
+//----------------------------------------------------------------------------
+
+bool bit::platform::dispatcher::cancel( timer_handle timer )
+{
+  std::lock_guard<spin_lock> lock(m_timer_lock);
+
+  const auto cancelled = m_timers.cancel( timer );
+  update_pending_timers();
+
+  return cancelled;
+}
+
 //----------------------------------------------------------------------------
 // Private Capacity
 //----------------------------------------------------------------------------
@@ -133,6 +379,9 @@ bool bit::platform::dispatcher::has_remaining_jobs()
   for( auto& queue : m_queues ) {
     if( !queue->empty() ) return true;
   }
+  for( auto& group : m_groups ) {
+    if( !group.inbox->empty() ) return true;
+  }
   return false;
 }
 
@@ -159,6 +408,11 @@ void bit::platform::dispatcher::start()
   for( auto& queue : m_queues ) {
     queue = get_job_queue();
   }
+  for( auto& group : m_groups ) {
+    group.inbox = get_job_queue();
+  }
+
+  concurrency_arbiter::global().attach( m_threads.size() );
 
   // Makes n working threads
   auto index = std::ptrdiff_t{1};
@@ -169,6 +423,8 @@ void bit::platform::dispatcher::start()
   // Sets the affinity on every thread
   if( m_set_affinity ) {
     this_thread::set_affinity( 0 );
+  } else {
+    pin_to_group( 0 );
   }
 }
 
@@ -176,14 +432,17 @@ std::thread bit::platform::dispatcher::make_worker_thread( std::ptrdiff_t index
 {
   return std::thread([this,index]()
   {
+    g_thread_index = index;
+    g_this_dispatcher = this;
+    g_thread_group = m_worker_groups[index].load( std::memory_order_relaxed );
+
     if( m_set_affinity ) {
       auto const cpus = std::thread::hardware_concurrency();
       this_thread::set_affinity( static_cast<std::size_t>(index) % cpus );
+    } else {
+      pin_to_group( g_thread_group );
     }
 
-    g_thread_index = index;
-    g_this_dispatcher = this;
-
     ++m_running_threads;
     do_work();
     --m_running_threads;
@@ -203,27 +462,40 @@ bit::platform::job bit::platform::dispatcher::get_job()
   auto j = queue.pop();
   if( j ) return j;
 
-  const auto max    = static_cast<std::ptrdiff_t>(m_queues.size()) - 1;
-  const auto victim = generate_number_in_range(0, max);
+  // Idle workers service expired timers before attempting to steal, which
+  // posts them into this worker's own queue
+  poll_timers();
 
-  auto& steal_queue = *m_queues[victim];
+  j = queue.pop();
+  if( j ) return j;
 
-  // If the two queues are the same, yield processor time
-  if( &queue == &steal_queue ) {
-    std::this_thread::yield();
-    return job{};
+  // Workers moved into another group are re-pinned the next time they look
+  // for work
+  const auto group = m_worker_groups[g_thread_index].load( std::memory_order_relaxed );
+  if( group != g_thread_group ) {
+    g_thread_group = group;
+    pin_to_group( group );
   }
 
   // Attempt to steal a job
-  j = steal_queue.steal();
+  j = steal_job( group );
+  if( j ) return j;
+
+  // Only once the group has run dry are the groups it overflows into
+  // stolen from
+  auto overflow = m_groups[group].overflow.load( std::memory_order_relaxed );
+  for( auto into = group_id{0}; overflow != 0; ++into, overflow >>= 1 ) {
+    if( (overflow & 1u) == 0 ) continue;
 
-  // If job is not stolen, yield processor time
-  if( !j ) {
-    std::this_thread::yield();
-    return job{};
+    j = steal_job( into );
+    if( j ) return j;
   }
 
-  return j;
+  // If job is not stolen, yield processor time, along with the lease of
+  // this thread if another worker is waiting for one
+  yield_lease();
+  std::this_thread::yield();
+  return job{};
 }
 
 void bit::platform::dispatcher::push_job( job job )
@@ -231,8 +503,179 @@ void bit::platform::dispatcher::push_job( job job )
   if( !m_running ) std::terminate();
   m_queues[g_thread_index]->push( std::move(job) );
   m_cv.notify_all();
+  wake_workers();
+}
+
+bit::platform::job bit::platform::dispatcher::steal_job( group_id group )
+{
+  // Jobs posted to the group are taken first, in the order they were posted
+  auto j = m_groups[group].inbox->steal();
+  if( j ) return j;
+
+  const auto count = static_cast<std::ptrdiff_t>(m_queues.size());
+  const auto start = generate_number_in_range(0, count - 1);
+
+  // A single victim is chosen at random from the members of the group
+  for( auto i = std::ptrdiff_t{0}; i < count; ++i ) {
+    const auto victim = (start + i) % count;
+
+    if( victim == g_thread_index ) continue;
+    if( m_worker_groups[victim].load( std::memory_order_relaxed ) != group ) continue;
+
+    return m_queues[victim]->steal();
+  }
+  return job{};
 }
 
+void bit::platform::dispatcher::park()
+{
+  const auto epoch = m_epoch.load();
+  ++m_sleepers;
+
+  // Posting pushes the job before checking for sleepers, and this checks
+  // the queues after registering, so either side observes the other
+  if( !m_running || has_remaining_jobs() ) {
+    --m_sleepers;
+    return;
+  }
+
+  auto has_deadline = false;
+  auto deadline     = timer_wheel::time_point{};
+
+  if( m_pending_timers.load( std::memory_order_relaxed ) != 0 ) {
+    std::lock_guard<spin_lock> lock(m_timer_lock);
+
+    // Timers that expired but were not yet posted are due immediately
+    if( m_expired_index != m_expired_timers.size() ) {
+      --m_sleepers;
+      return;
+    }
+    has_deadline = !m_timers.empty();
+    if( has_deadline ) deadline = m_timers.next_expiry();
+  }
+
+  { // Parked workers do not occupy a slot of the arbiter
+    blocking_region region;
+
+    if( !has_deadline ) {
+      futex_wait( m_epoch, epoch );
+    } else {
+      const auto now = timer_wheel::clock_type::now();
+
+      if( deadline > now ) {
+        futex_wait_for( m_epoch, epoch, deadline - now );
+      }
+    }
+  }
+  --m_sleepers;
+}
+
+void bit::platform::dispatcher::wake_workers()
+{
+  if( m_sleepers.load() == 0 ) return;
+
+  m_epoch.fetch_add( 1 );
+
+  // A single woken worker may not be able to take a job posted to a group
+  // that it is not a member of
+  if( m_groups.size() == 1 ) {
+    futex_wake_one( m_epoch );
+  } else {
+    futex_wake_all( m_epoch );
+  }
+}
+
+void bit::platform::dispatcher::pin_to_group( group_id group )
+{
+  const auto& cores = m_groups[group].cores;
+
+  // Workers moved into a group without cores keep their previous affinity
+  if( cores.empty() ) return;
+
+  // Workers may run on any core of their group, so that the scheduler can
+  // balance them across the cores when some of them are busy
+  this_thread::set_affinity( cores );
+}
+
+void bit::platform::dispatcher::defer_job( job job )
+{
+  if( !m_running ) std::terminate();
+  m_queues[g_thread_index]->defer( std::move(job) );
+  wake_workers();
+}
+
+bit::platform::timer_handle
+  bit::platform::dispatcher::schedule_timer( timer_wheel::time_point deadline,
+                                             timer_wheel::duration period,
+                                             timer_wheel::callback_type callback )
+{
+  std::lock_guard<spin_lock> lock(m_timer_lock);
+
+  auto handle = m_timers.schedule( deadline, period, std::move(callback) );
+  update_pending_timers();
+
+  // Parked workers wait for the timer that was the earliest when they
+  // parked, so each of them has to see the new deadline
+  if( m_sleepers.load() != 0 ) {
+    m_epoch.fetch_add( 1 );
+    futex_wake_all( m_epoch );
+  }
+
+  return handle;
+}
+
+void bit::platform::dispatcher::poll_timers()
+{
+  if( m_pending_timers.load( std::memory_order_relaxed ) == 0 ) return;
+
+  // Only a single worker needs to advance the wheel at a time
+  if( !m_timer_lock.try_lock() ) return;
+
+  { // critical section
+    std::lock_guard<spin_lock> lock(m_timer_lock, std::adopt_lock);
+
+    // A stopped dispatcher has already discarded its timers
+    if( !m_running ) return;
+
+    if( m_expired_index == m_expired_timers.size() ) {
+      m_expired_timers.clear();
+      m_expired_index = 0;
+      m_timers.advance( timer_wheel::clock_type::now(), m_expired_timers );
+    }
+
+    // Only a bounded batch is taken; the rest is left for other workers
+    const auto count = std::min( m_expired_timers.size() - m_expired_index,
+                                 timer_batch_size );
+    const auto first = m_expired_timers.begin() + static_cast<std::ptrdiff_t>(m_expired_index);
+
+    g_expired_timers.assign( std::make_move_iterator(first),
+                             std::make_move_iterator(first + static_cast<std::ptrdiff_t>(count)) );
+    m_expired_index += count;
+    update_pending_timers();
+  }
+
+  // Jobs are made and pushed outside of the lock. The dispatcher may stop
+  // in the meantime, but the calling worker still drains its own queue
+  // before it exits, so these are pushed without the check in push_job
+  for( auto& callback : g_expired_timers ) {
+    m_queues[g_thread_index]->push( make_job( std::move(callback) ) );
+  }
+  g_expired_timers.clear();
+
+  m_cv.notify_all();
+  wake_workers();
+}
+
+void bit::platform::dispatcher::update_pending_timers()
+  noexcept
+{
+  const auto expired = m_expired_timers.size() - m_expired_index;
+
+  m_pending_timers.store( m_timers.size() + expired, std::memory_order_relaxed );
+}
+
+//----------------------------------------------------------------------------
+
 template<typename Condition>
 void bit::platform::dispatcher::help_while( Condition&& condition )
 {
@@ -254,11 +697,40 @@ void bit::platform::dispatcher::help_while_unavailable( const job& j )
 
 void bit::platform::dispatcher::do_work()
 {
-  help_while( [&]{ return m_running; } );
+  auto& arbiter = concurrency_arbiter::global();
+  arbiter.acquire();
+
+  auto idle = std::size_t{0};
+
+  while( m_running ) {
+    auto j = get_job();
+
+    if( j ) {
+      help_while_unavailable( j );
+
+      j.execute();
+      idle = 0;
+    } else if( ++idle >= idle_spins ) {
+      park();
+      idle = 0;
+    }
+  }
 
   // This duplication is to avoid breaking cache coherency per iteration
   // in the normal running case.
-  help_while( [&]{ return !m_queues[g_thread_index]->empty(); } );
+  drain();
+
+  arbiter.release();
+}
+
+void bit::platform::dispatcher::drain()
+{
+  help_while( [&]
+  {
+    const auto group = m_worker_groups[g_thread_index].load( std::memory_order_relaxed );
+
+    return !m_queues[g_thread_index]->empty() || !m_groups[group].inbox->empty();
+  });
 }
 
 //----------------------------------------------------------------------------
@@ -321,4 +793,15 @@ namespace {
     return s_queues.back().get();
   }
 
+  //--------------------------------------------------------------------------
+
+  std::size_t count_workers( const std::vector<bit::platform::worker_group>& groups )
+  {
+    auto workers = std::size_t{0};
+    for( auto& group : groups ) {
+      workers += group.workers;
+    }
+    return workers;
+  }
+
 } // namespace anonymous
@@ -0,0 +1,180 @@
+#include <bit/platform/threading/future.hpp>
+
+#include "detail/small_block_pool.hpp" // detail::small_block_pool
+
+#include <cassert> // assert
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// Shared states are released by whichever thread drops the last
+  /// reference, so blocks are cached by that thread for the next producer
+  bit::platform::detail::small_block_pool g_state_pool( bit::platform::detail::block_source::heap );
+
+} // namespace anonymous
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+void* bit::platform::detail::allocate_future_state( std::size_t size )
+{
+  return g_state_pool.allocate( size );
+}
+
+void bit::platform::detail::deallocate_future_state( void* p, std::size_t size )
+  noexcept
+{
+  g_state_pool.deallocate( p, size );
+}
+
+//=============================================================================
+// detail::future_state_base
+//=============================================================================
+
+constexpr std::uint32_t bit::platform::detail::future_state_base::state_ready;
+constexpr std::uint32_t bit::platform::detail::future_state_base::state_continuation;
+constexpr std::uint32_t bit::platform::detail::future_state_base::state_waiting;
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::future_state_base::future_state_base()
+  noexcept
+  : m_state(0),
+    m_references(1),
+    m_continuation(),
+    m_schedule(nullptr),
+    m_executor(nullptr)
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+bool bit::platform::detail::future_state_base::ready()
+  const noexcept
+{
+  return (m_state.load( std::memory_order_acquire ) & state_ready) != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::future_state_base::wait()
+  const noexcept
+{
+  auto expected = prepare_wait();
+  if( expected == 0u ) return;
+
+  blocking_region region;
+  do {
+    futex_wait( m_state, expected );
+    expected = prepare_wait();
+  } while( expected != 0u );
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::future_state_base
+  ::set_continuation( unique_task continuation,
+                      schedule_function schedule,
+                      void* executor )
+{
+  m_continuation = std::move(continuation);
+  m_schedule     = schedule;
+  m_executor     = executor;
+
+  // Whichever of this and mark_ready sets its bit second runs the
+  // continuation; the other has already published everything it needs
+  const auto state = m_state.fetch_or( state_continuation, std::memory_order_acq_rel );
+
+  assert( (state & state_continuation) == 0 && "A future may only have one continuation" );
+
+  if( state & state_ready ) {
+    trigger();
+  }
+}
+
+void bit::platform::detail::future_state_base::run_continuation()
+{
+  // Moved out, since the continuation may release the last reference
+  auto continuation = std::move(m_continuation);
+
+  continuation();
+}
+
+void bit::platform::detail::future_state_base::retain()
+  noexcept
+{
+  m_references.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void bit::platform::detail::future_state_base::release()
+  noexcept
+{
+  if( m_references.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+    destroy();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Protected Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::future_state_base::mark_ready()
+{
+  const auto state = m_state.fetch_or( state_ready, std::memory_order_acq_rel );
+
+  assert( (state & state_ready) == 0 && "A result may only be stored once" );
+
+  // The producer still holds a reference, so the state outlives both
+  if( state & state_waiting ) {
+    futex_wake_all( m_state );
+  }
+  if( state & state_continuation ) {
+    trigger();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::future_state_base::trigger()
+{
+  if( m_schedule ) {
+    (*m_schedule)( m_executor, this );
+  } else {
+    run_continuation();
+  }
+}
+
+std::uint32_t bit::platform::detail::future_state_base::prepare_wait()
+  const noexcept
+{
+  auto state = m_state.load( std::memory_order_acquire );
+
+  while( (state & state_ready) == 0 ) {
+    if( state & state_waiting ) return state;
+
+    if( m_state.compare_exchange_weak( state, state | state_waiting ) ) {
+      return state | state_waiting;
+    }
+  }
+  return 0u;
+}
+
@@ -21,7 +21,7 @@ void* bit::platform::detail::allocate_job()
   // If there are any unfinished jobs in the job being allocated, it means that
   // we have allocated more than max_jobs worth of jobs -- and that the previous
   // job has not yet completed.
-  assert( j->m_unfinished == 0 && "too many jobs allocated; buffer overflow occurred" );
+  assert( j->completed() && "too many jobs allocated; buffer overflow occurred" );
 
   return j;
 }
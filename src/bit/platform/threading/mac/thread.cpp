@@ -3,6 +3,24 @@
 // Mac, as far as I'm aware, does not support any manner of setting
 // thread affinity to different cores.
 
+//-----------------------------------------------------------------------------
+// Concurrency
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::available_concurrency()
+  noexcept
+{
+  const auto threads = std::thread::hardware_concurrency();
+
+  return threads ? threads : 1u;
+}
+
+std::size_t bit::platform::refresh_available_concurrency()
+  noexcept
+{
+  return available_concurrency();
+}
+
 //-----------------------------------------------------------------------------
 // Affinity
 //-----------------------------------------------------------------------------
@@ -13,6 +31,13 @@ void bit::platform::set_affinity( std::thread& thread, std::size_t core_id )
   (void) core_id;
 }
 
+void bit::platform::set_affinity( std::thread& thread,
+                                  const std::vector<std::size_t>& cores )
+{
+  (void) thread;
+  (void) cores;
+}
+
 //-----------------------------------------------------------------------------
 
 
@@ -31,6 +56,11 @@ void bit::platform::this_thread::set_affinity( std::size_t core_id )
   (void) core_id;
 }
 
+void bit::platform::this_thread::set_affinity( const std::vector<std::size_t>& cores )
+{
+  (void) cores;
+}
+
 std::size_t bit::platform::this_thread::affinity()
 {
   return ((std::size_t)-1);
@@ -0,0 +1,192 @@
+#include <bit/platform/threading/parallel_region.hpp>
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+#include <bit/platform/threading/futex.hpp>
+
+#include <limits> // std::numeric_limits
+#include <thread> // std::this_thread::yield
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Constants
+  //---------------------------------------------------------------------------
+
+  /// The bit of team_state::m_joined that is set once the team is formed, so
+  /// that recruits arriving afterwards do not join
+  constexpr std::size_t closed_bit =
+    std::size_t(1) << (std::numeric_limits<std::size_t>::digits - 1);
+
+  /// The number of times the first member checks for idle workers picking up
+  /// its recruits before it forms the team without the rest of them
+  constexpr std::size_t formation_spins = 1024u;
+
+  /// The number of times a member checks the barrier before it parks
+  constexpr std::size_t barrier_spins = 1024u;
+
+} // namespace anonymous
+
+//=============================================================================
+// detail::team_state
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::team_state::team_state( dispatcher& dispatcher,
+                                               std::size_t team_size,
+                                               function_type function,
+                                               void* fn )
+  noexcept
+  : m_dispatcher(dispatcher),
+    m_function(function),
+    m_fn(fn),
+    m_recruits(team_size - 1),
+    m_size(1u),
+    m_joined(0u),
+    m_unresolved(team_size - 1),
+    m_started(0u),
+    m_arrived(0u),
+    m_sense(0u),
+    m_parked(0u),
+    m_singles(0u),
+    m_resolved()
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Execution
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::team_state::run()
+{
+  for( auto i = 0u; i < m_recruits; ++i ) {
+    m_dispatcher.post_job( make_job( [this]{ recruit(); } ) );
+  }
+
+  // Give idle workers a chance to pick up the recruits. Formation ends early
+  // once every recruit has either joined or been picked up too late
+  for( auto i = 0u; i < formation_spins; ++i ) {
+    const auto joined = m_joined.load( std::memory_order_acquire );
+
+    if( joined == m_unresolved.load( std::memory_order_acquire ) ) break;
+
+    yield_lease();
+    std::this_thread::yield();
+  }
+
+  const auto joined = m_joined.fetch_or( closed_bit, std::memory_order_acq_rel );
+
+  m_size = joined + 1;
+  m_started.store( 1u );
+  if( m_parked.load() != 0u ) {
+    futex_wake_all( m_started );
+  }
+
+  execute( 0u );
+
+  // Recruits that did not join still reference this state, so this helps the
+  // dispatcher until the last of them has run
+  if( m_recruits != 0u ) {
+    m_dispatcher.wait( m_resolved );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Member Functions
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::team_state::recruit()
+  noexcept
+{
+  auto joined = m_joined.load( std::memory_order_relaxed );
+
+  do {
+    if( joined & closed_bit ) {
+      resolve();
+      return;
+    }
+  } while( !m_joined.compare_exchange_weak( joined, joined + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed ) );
+
+  wait_for( m_started, 1u );
+  execute( joined + 1 );
+  resolve();
+}
+
+void bit::platform::detail::team_state::execute( std::size_t index )
+  noexcept
+{
+  team member( *this, index );
+
+  m_function( m_fn, member );
+}
+
+void bit::platform::detail::team_state::resolve()
+  noexcept
+{
+  if( m_unresolved.fetch_sub( 1u, std::memory_order_acq_rel ) == 1u ) {
+    m_resolved.signal();
+  }
+}
+
+void bit::platform::detail::team_state::arrive( std::uint32_t sense )
+  noexcept
+{
+  if( m_arrived.fetch_add( 1u, std::memory_order_acq_rel ) + 1u == m_size ) {
+    // No member arrives at the next phase before the sense flips, so the
+    // count can be reset before releasing them
+    m_arrived.store( 0u, std::memory_order_relaxed );
+    m_sense.store( sense );
+
+    if( m_parked.load() != 0u ) {
+      futex_wake_all( m_sense );
+    }
+    return;
+  }
+
+  wait_for( m_sense, sense );
+}
+
+bool bit::platform::detail::team_state::claim_single( std::size_t ticket )
+  noexcept
+{
+  auto expected = ticket;
+
+  return m_singles.compare_exchange_strong( expected, ticket + 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed );
+}
+
+void bit::platform::detail::team_state::wait_for( const std::atomic<std::uint32_t>& word,
+                                                  std::uint32_t value )
+  noexcept
+{
+  for( auto i = 0u; i < barrier_spins; ++i ) {
+    if( word.load( std::memory_order_acquire ) == value ) return;
+
+    yield_lease();
+    std::this_thread::yield();
+  }
+
+  // Pairs with the check of m_parked after storing the word: either the
+  // waker sees this member parked, or this member sees the new value
+  m_parked.fetch_add( 1u );
+
+  if( word.load() != value ) {
+    // Parked members do not occupy a slot of the arbiter
+    blocking_region region;
+
+    do {
+      futex_wait( word, value ^ 1u );
+    } while( word.load( std::memory_order_acquire ) != value );
+  }
+
+  m_parked.fetch_sub( 1u, std::memory_order_relaxed );
+}
@@ -0,0 +1,420 @@
+#include <bit/platform/threading/pipeline.hpp>
+
+#include <algorithm> // std::max
+#include <cassert>   // assert
+#include <mutex>     // std::lock_guard
+#include <new>       // operator new, operator delete
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Constants
+  //---------------------------------------------------------------------------
+
+  /// The maximum number of tokens carried by one job before it yields its
+  /// worker
+  constexpr std::size_t max_carried_tokens = 16u;
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Rounds \p size up to a multiple of the fundamental alignment
+  std::size_t align_size( std::size_t size ) noexcept;
+
+} // namespace anonymous
+
+//=============================================================================
+// detail::pipeline_state
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::pipeline_state
+  ::pipeline_state( dispatcher& dispatcher,
+                    std::size_t max_tokens,
+                    std::size_t buffer_size,
+                    std::unique_ptr<pipeline_source> source,
+                    std::size_t value_size,
+                    void (*destroy)( void* ) )
+  : m_dispatcher(dispatcher),
+    m_max_tokens(max_tokens ? max_tokens : 1u),
+    m_buffer_size(buffer_size),
+    m_source(std::move(source)),
+    m_stages(),
+    m_value_size(value_size),
+    m_destroy(destroy),
+    m_tokens(),
+    m_storage(nullptr),
+    m_lock(),
+    m_free(nullptr),
+    m_live(0),
+    m_pending(0),
+    m_sequence(0),
+    m_producing(false),
+    m_stopped(false),
+    m_exception(),
+    m_done(nullptr)
+{
+
+}
+
+bit::platform::detail::pipeline_state::~pipeline_state()
+{
+  ::operator delete( m_storage );
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::pipeline_state
+  ::add_stage( std::unique_ptr<pipeline_stage> stage,
+               std::size_t value_size,
+               void (*destroy)( void* ) )
+{
+  assert( m_tokens.empty() && "stages cannot be added to a pipeline that has run" );
+
+  m_stages.push_back( std::move(stage) );
+  m_value_size = std::max( m_value_size, value_size );
+  m_destroy    = destroy;
+}
+
+void bit::platform::detail::pipeline_state::run()
+{
+  if( m_tokens.empty() ) {
+    allocate_tokens();
+  }
+
+  completion_flag done;
+
+  m_free = nullptr;
+  for( auto it = m_tokens.rbegin(); it != m_tokens.rend(); ++it ) {
+    it->next = m_free;
+    m_free   = &*it;
+  }
+  for( auto& stage : m_stages ) {
+    stage->busy          = false;
+    stage->next_sequence = 0;
+    stage->parked        = nullptr;
+  }
+  m_live      = 0;
+  m_pending   = 1;
+  m_sequence  = 0;
+  m_producing = false;
+  m_stopped   = false;
+  m_exception = nullptr;
+  m_done      = &done;
+
+  m_dispatcher.post_job( make_job( [this]{ start(); } ) );
+  m_dispatcher.wait( done );
+
+  if( m_exception ) {
+    auto exception = std::move(m_exception);
+    m_exception = nullptr;
+
+    std::rethrow_exception( std::move(exception) );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::pipeline_state::allocate_tokens()
+{
+  // The value and buffer of each token are adjacent, so that both are
+  // brought into the cache of whichever worker carries the token
+  const auto value_stride  = align_size( m_value_size );
+  const auto buffer_stride = align_size( m_buffer_size );
+  const auto token_stride  = value_stride + buffer_stride;
+
+  m_storage = ::operator new( m_max_tokens * token_stride );
+  m_tokens.resize( m_max_tokens );
+
+  auto* p = static_cast<char*>(m_storage);
+  for( auto& token : m_tokens ) {
+    token.next     = nullptr;
+    token.value    = p;
+    token.buffer   = stl::span<char>( p + value_stride, m_buffer_size );
+    token.sequence = 0;
+    token.stage    = 0;
+    token.empty    = false;
+
+    p += token_stride;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void bit::platform::detail::pipeline_state::start()
+{
+  auto* token   = static_cast<pipeline_token*>(nullptr);
+  auto finished = false;
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    --m_pending;
+    token    = acquire();
+    finished = !token && completed();
+  }
+
+  if( token ) {
+    if( produce( token ) ) carry( token );
+  } else if( finished ) {
+    complete();
+  }
+}
+
+bool bit::platform::detail::pipeline_state::produce( pipeline_token* token )
+{
+  auto control  = flow_control( token->buffer );
+  auto produced = false;
+
+  try {
+    produced = m_source->produce( control, token->value );
+  } catch( ... ) {
+    fail();
+  }
+
+  auto spawn    = false;
+  auto finished = false;
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    m_producing = false;
+    if( produced ) {
+      token->sequence = m_sequence++;
+      token->stage    = 0;
+      token->empty    = false;
+
+      // Another token can be produced while this one is carried through
+      // the stages; one outstanding job is enough to keep the source busy
+      spawn = m_free && !m_stopped && m_pending == 0;
+      if( spawn ) ++m_pending;
+    } else {
+      m_stopped   = true;
+      token->next = m_free;
+      m_free      = token;
+      --m_live;
+      finished = completed();
+    }
+  }
+
+  // The job is placed where idle workers steal from first
+  if( spawn ) {
+    m_dispatcher.defer_job( make_job( [this]{ start(); } ) );
+  } else if( finished ) {
+    complete();
+  }
+  return produced;
+}
+
+void bit::platform::detail::pipeline_state::carry( pipeline_token* token )
+{
+  for( auto i = std::size_t{1}; advance( token ); ++i ) {
+    token = retire( token );
+    if( !token ) return;
+
+    // The recycled token is reused by this worker, unless this job has
+    // already carried its share of tokens
+    if( i == max_carried_tokens ) {
+      m_dispatcher.defer_job( make_job( [this,token]
+      {
+        if( produce( token ) ) carry( token );
+      }));
+      return;
+    }
+    if( !produce( token ) ) return;
+  }
+}
+
+bool bit::platform::detail::pipeline_state::advance( pipeline_token* token )
+{
+  while( token->stage < m_stages.size() ) {
+    auto& stage = *m_stages[token->stage];
+
+    if( stage.mode != stage_mode::parallel && !enter( stage, token ) ) {
+      return false;
+    }
+    execute( token );
+  }
+  return true;
+}
+
+void bit::platform::detail::pipeline_state::execute( pipeline_token* token )
+{
+  auto& stage = *m_stages[token->stage];
+
+  // A token whose value was lost still passes through the serial stages,
+  // so that the tokens behind it are not held up
+  if( !token->empty ) {
+    try {
+      stage.process( token->value );
+    } catch( ... ) {
+      stage.discard( token->value );
+      token->empty = true;
+      fail();
+    }
+  }
+  ++token->stage;
+
+  if( stage.mode != stage_mode::parallel ) {
+    leave( stage );
+  }
+}
+
+bool bit::platform::detail::pipeline_state::enter( pipeline_stage& stage,
+                                                   pipeline_token* token )
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(stage.lock);
+
+  const auto in_order = stage.mode == stage_mode::serial_in_order;
+
+  if( !stage.busy && (!in_order || token->sequence == stage.next_sequence) ) {
+    stage.busy = true;
+    return true;
+  }
+
+  // Parked tokens are kept ordered, so the next in sequence is at the front
+  auto** link = &stage.parked;
+  while( *link && (*link)->sequence < token->sequence ) {
+    link = &(*link)->next;
+  }
+  token->next = *link;
+  *link = token;
+
+  return false;
+}
+
+void bit::platform::detail::pipeline_state::leave( pipeline_stage& stage )
+{
+  auto* next = static_cast<pipeline_token*>(nullptr);
+
+  {
+    std::lock_guard<spin_lock> lock(stage.lock);
+
+    const auto in_order = stage.mode == stage_mode::serial_in_order;
+    if( in_order ) {
+      ++stage.next_sequence;
+    }
+
+    auto* head = stage.parked;
+    if( head && (!in_order || head->sequence == stage.next_sequence) ) {
+      // The stage stays busy, since it is handed directly to the next token
+      stage.parked = head->next;
+      next = head;
+    } else {
+      stage.busy = false;
+    }
+  }
+
+  // The token that just left is still hot in this worker's cache, so it
+  // keeps this worker; the next token is picked up by a new job. Like every
+  // job of the pipeline, it is deferred so that this worker runs them in the
+  // order they were made, and none is left behind a chain of hand-offs
+  if( next ) {
+    m_dispatcher.defer_job( make_job( [this,next]
+    {
+      execute( next );
+      carry( next );
+    }));
+  }
+}
+
+bit::platform::detail::pipeline_token*
+  bit::platform::detail::pipeline_state::retire( pipeline_token* token )
+{
+  if( !token->empty ) {
+    (*m_destroy)( token->value );
+  }
+
+  auto* next    = static_cast<pipeline_token*>(nullptr);
+  auto finished = false;
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    token->next = m_free;
+    m_free      = token;
+    --m_live;
+
+    next     = acquire();
+    finished = !next && completed();
+  }
+
+  if( finished ) {
+    complete();
+  }
+  return next;
+}
+
+void bit::platform::detail::pipeline_state::fail()
+  noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  if( !m_exception ) {
+    m_exception = std::current_exception();
+  }
+  m_stopped = true;
+}
+
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::pipeline_token*
+  bit::platform::detail::pipeline_state::acquire()
+  noexcept
+{
+  if( m_producing || m_stopped || !m_free ) return nullptr;
+
+  auto* token = m_free;
+  m_free      = token->next;
+  m_producing = true;
+  ++m_live;
+
+  return token;
+}
+
+bool bit::platform::detail::pipeline_state::completed()
+  const noexcept
+{
+  return m_stopped && m_live == 0 && m_pending == 0;
+}
+
+void bit::platform::detail::pipeline_state::complete()
+  noexcept
+{
+  // This must be the last access to the pipeline, since run may return as
+  // soon as it is observed
+  m_done->signal();
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  std::size_t align_size( std::size_t size )
+    noexcept
+  {
+    constexpr auto alignment = alignof(std::max_align_t);
+
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+} // namespace anonymous
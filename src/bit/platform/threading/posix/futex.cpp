@@ -0,0 +1,172 @@
+#include <bit/platform/threading/futex.hpp>
+
+#if defined(__linux__)
+# include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+# include <sys/syscall.h> // SYS_futex
+# include <unistd.h>      // ::syscall
+# include <ctime>         // ::timespec
+# include <climits>       // INT_MAX
+# include <cerrno>        // errno, ETIMEDOUT
+#else
+# include <array>              // std::array
+# include <condition_variable> // std::condition_variable
+# include <cstdint>            // std::uintptr_t
+# include <mutex>              // std::mutex
+#endif
+
+static_assert( sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+               "futex words must have the same layout as their underlying integer" );
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+#if defined(__linux__)
+
+  /// \brief Invokes the futex syscall on \p address
+  long futex( const std::atomic<std::uint32_t>& address,
+              int op,
+              std::uint32_t value,
+              const ::timespec* timeout ) noexcept;
+
+#else
+
+  /// \brief A slot in the parking table, shared by all addresses that hash
+  ///        into it
+  struct alignas(64) parking_slot
+  {
+    std::mutex              mutex;
+    std::condition_variable cv;
+  };
+
+  /// \brief Gets the parking slot for the given \p address
+  parking_slot& slot_for( const void* address ) noexcept;
+
+#endif
+
+} // namespace anonymous
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+bool bit::platform::detail::futex_wait_for( const std::atomic<std::uint32_t>& address,
+                                            std::uint32_t expected,
+                                            std::chrono::nanoseconds timeout )
+  noexcept
+{
+#if defined(__linux__)
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+
+  auto ts = ::timespec{};
+  ts.tv_sec  = static_cast<::time_t>(seconds.count());
+  ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+
+  // The timeout is relative for FUTEX_WAIT
+  const auto result = futex( address, FUTEX_WAIT_PRIVATE, expected, &ts );
+
+  return !(result == -1 && errno == ETIMEDOUT);
+#else
+  auto& slot = slot_for( &address );
+
+  std::unique_lock<std::mutex> lock(slot.mutex);
+  if( address.load( std::memory_order_acquire ) != expected ) return true;
+
+  return slot.cv.wait_for( lock, timeout ) == std::cv_status::no_timeout;
+#endif
+}
+
+//=============================================================================
+// Free Functions
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+void bit::platform::futex_wait( const std::atomic<std::uint32_t>& address,
+                                std::uint32_t expected )
+  noexcept
+{
+#if defined(__linux__)
+  futex( address, FUTEX_WAIT_PRIVATE, expected, nullptr );
+#else
+  auto& slot = slot_for( &address );
+
+  // The value is checked under the slot's lock, and wakers acquire the same
+  // lock before notifying, so a wake-up cannot be lost in between
+  std::unique_lock<std::mutex> lock(slot.mutex);
+  if( address.load( std::memory_order_acquire ) != expected ) return;
+
+  slot.cv.wait( lock );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Waking
+//-----------------------------------------------------------------------------
+
+void bit::platform::futex_wake_one( std::atomic<std::uint32_t>& address )
+  noexcept
+{
+#if defined(__linux__)
+  futex( address, FUTEX_WAKE_PRIVATE, 1, nullptr );
+#else
+  // Slots are shared between addresses, so every waiter must be woken for
+  // the intended one to be reached
+  futex_wake_all( address );
+#endif
+}
+
+void bit::platform::futex_wake_all( std::atomic<std::uint32_t>& address )
+  noexcept
+{
+#if defined(__linux__)
+  futex( address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr );
+#else
+  auto& slot = slot_for( &address );
+
+  { // Synchronize with any waiter between its check and its wait
+    std::lock_guard<std::mutex> lock(slot.mutex);
+  }
+  slot.cv.notify_all();
+#endif
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+#if defined(__linux__)
+
+  long futex( const std::atomic<std::uint32_t>& address,
+              int op,
+              std::uint32_t value,
+              const ::timespec* timeout )
+    noexcept
+  {
+    auto* word = const_cast<std::atomic<std::uint32_t>*>(&address);
+
+    return ::syscall( SYS_futex, static_cast<void*>(word), op, value, timeout, nullptr, 0 );
+  }
+
+#else
+
+  parking_slot& slot_for( const void* address )
+    noexcept
+  {
+    static std::array<parking_slot,64> s_slots;
+
+    // Discard the low bits, which are equal for all aligned words
+    const auto hash = reinterpret_cast<std::uintptr_t>(address) >> 4;
+
+    return s_slots[hash % s_slots.size()];
+  }
+
+#endif
+
+} // namespace anonymous
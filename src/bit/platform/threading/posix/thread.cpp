@@ -1,4 +1,5 @@
 #include <bit/platform/threading/thread.hpp>
+#include <bit/platform/threading/detail/cgroup.hpp>
 
 #define _GNU_SOURCE
 #include <sched.h>
@@ -6,6 +7,85 @@
 #include <unistd.h>
 #include <pthread.h>
 
+#include <algorithm> // std::min, std::max, std::max_element
+#include <atomic>    // std::atomic
+#include <fstream>   // std::ifstream
+#include <string>    // std::string, std::getline
+#include <vector>    // std::vector
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Lowers \p threads to \p limit, if there is a limit
+  ///
+  /// \param threads the current number of threads
+  /// \param limit the limit, or 0 if there is none
+  void apply_limit( std::size_t& threads, std::size_t limit ) noexcept;
+
+  /// \brief Determines the number of threads that this process may run
+  ///        concurrently, by reading its affinity mask and cgroup limits
+  ///
+  /// \return the number of threads, which is at least 1
+  std::size_t compute_concurrency() noexcept;
+
+  /// \brief Gets the cached result of compute_concurrency
+  ///
+  /// \return reference to the cached concurrency
+  std::atomic<std::size_t>& cached_concurrency() noexcept;
+
+  /// \brief Sets the affinity of \p thread to the cores \p cores
+  ///
+  /// \param thread the thread to set the affinity of
+  /// \param cores the ids of the cores
+  void set_affinity_mask( ::pthread_t thread, const std::vector<std::size_t>& cores );
+
+  /// \brief Counts the CPUs in the affinity mask of this process
+  ///
+  /// \return the number of CPUs, or 0 if it could not be determined
+  std::size_t affinity_concurrency() noexcept;
+
+  /// \brief Determines the number of CPUs that the cgroup of this process
+  ///        is limited to by its cpusets and CPU quotas
+  ///
+  /// \return the number of CPUs, or 0 if there is no limit
+  std::size_t cgroup_concurrency();
+
+  /// \brief Reads the first line of the file at \p path
+  ///
+  /// \param path the path to the file
+  /// \param line the string to read the line into
+  /// \return \c true if a non-empty line was read
+  bool read_line( const std::string& path, std::string& line );
+
+} // namespace anonymous
+
+//-----------------------------------------------------------------------------
+// Concurrency
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::available_concurrency()
+  noexcept
+{
+  return cached_concurrency().load( std::memory_order_relaxed );
+}
+
+std::size_t bit::platform::refresh_available_concurrency()
+  noexcept
+{
+  const auto threads = compute_concurrency();
+
+  cached_concurrency().store( threads, std::memory_order_relaxed );
+
+  return threads;
+}
+
 //-----------------------------------------------------------------------------
 // Affinity
 //-----------------------------------------------------------------------------
@@ -26,6 +106,12 @@ void bit::platform::set_affinity( std::thread& thread, std::size_t core_id )
   ::pthread_setaffinity_np(current_thread, sizeof(::cpu_set_t), &cpuset);
 }
 
+void bit::platform::set_affinity( std::thread& thread,
+                                  const std::vector<std::size_t>& cores )
+{
+  set_affinity_mask( thread.native_handle(), cores );
+}
+
 //-----------------------------------------------------------------------------
 
 std::size_t bit::platform::affinity( std::thread& thread )
@@ -58,6 +144,11 @@ void bit::platform::this_thread::set_affinity( std::size_t core_id )
   ::pthread_setaffinity_np(current_thread, sizeof(::cpu_set_t), &cpuset);
 }
 
+void bit::platform::this_thread::set_affinity( const std::vector<std::size_t>& cores )
+{
+  set_affinity_mask( ::pthread_self(), cores );
+}
+
 std::size_t bit::platform::this_thread::affinity()
 {
   ::cpu_set_t cpuset;
@@ -74,3 +165,121 @@ std::size_t bit::platform::this_thread::active_core()
 {
   return ::sched_getcpu();
 }
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  void apply_limit( std::size_t& threads, std::size_t limit )
+    noexcept
+  {
+    if( limit == 0 ) return;
+
+    threads = (threads == 0) ? limit : std::min( threads, limit );
+  }
+
+  std::size_t compute_concurrency()
+    noexcept
+  {
+    auto threads = static_cast<std::size_t>( std::thread::hardware_concurrency() );
+
+    apply_limit( threads, affinity_concurrency() );
+
+    // Failing to read the cgroup files is not an error; the process is simply
+    // not limited by them
+    try {
+      apply_limit( threads, cgroup_concurrency() );
+    } catch( ... ) {}
+
+    return std::max( threads, std::size_t{1} );
+  }
+
+  std::atomic<std::size_t>& cached_concurrency()
+    noexcept
+  {
+    static std::atomic<std::size_t> s_concurrency{ compute_concurrency() };
+
+    return s_concurrency;
+  }
+
+  void set_affinity_mask( ::pthread_t thread, const std::vector<std::size_t>& cores )
+  {
+    if( cores.empty() ) return;
+
+#if defined(__linux__)
+    // The mask is sized for the largest core, since machines with more than
+    // CPU_SETSIZE CPUs do not fit in a cpu_set_t
+    const auto cpus = std::max( *std::max_element( cores.begin(), cores.end() ) + 1u,
+                                std::size_t{CPU_SETSIZE} );
+    auto* set = CPU_ALLOC( cpus );
+    if( !set ) return;
+
+    const auto size = CPU_ALLOC_SIZE( cpus );
+    CPU_ZERO_S( size, set );
+
+    for( auto core : cores ) {
+      CPU_SET_S( core, size, set );
+    }
+    ::pthread_setaffinity_np( thread, size, set );
+    CPU_FREE( set );
+#else
+    ::cpu_set_t cpuset;
+
+    CPU_ZERO(&cpuset);
+    for( auto core : cores ) {
+      if( core < CPU_SETSIZE ) CPU_SET(core, &cpuset);
+    }
+    ::pthread_setaffinity_np( thread, sizeof(::cpu_set_t), &cpuset );
+#endif
+  }
+
+  std::size_t affinity_concurrency()
+    noexcept
+  {
+#if defined(__linux__)
+    // The mask is sized for every configured CPU, since machines with more
+    // than CPU_SETSIZE CPUs do not fit in a cpu_set_t
+    const auto cpus = std::max( ::sysconf(_SC_NPROCESSORS_CONF), long{CPU_SETSIZE} );
+    auto* set = CPU_ALLOC( cpus );
+    if( !set ) return 0u;
+
+    const auto size = CPU_ALLOC_SIZE( cpus );
+    CPU_ZERO_S( size, set );
+
+    auto count = std::size_t{0};
+    if( ::sched_getaffinity( 0, size, set ) == 0 ) {
+      count = static_cast<std::size_t>( CPU_COUNT_S( size, set ) );
+    }
+    CPU_FREE( set );
+
+    return count;
+#else
+    return 0u;
+#endif
+  }
+
+  std::size_t cgroup_concurrency()
+  {
+#if defined(__linux__)
+    auto file = std::ifstream("/proc/self/cgroup");
+
+    return bit::platform::detail::cgroup_concurrency( file, &read_line );
+#else
+    return 0u;
+#endif
+  }
+
+  bool read_line( const std::string& path, std::string& line )
+  {
+    auto file = std::ifstream( path );
+
+    return std::getline( file, line ) && !line.empty();
+  }
+
+} // namespace anonymous
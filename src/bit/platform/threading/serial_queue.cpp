@@ -0,0 +1,138 @@
+#include <bit/platform/threading/serial_queue.hpp>
+
+#include <cassert> // assert
+#include <thread>  // std::this_thread::yield
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// The serial_queue whose drain is running on this thread, if any
+  thread_local const bit::platform::serial_queue* g_this_queue = nullptr;
+
+} // namespace anonymous
+
+//=============================================================================
+// serial_queue
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::serial_queue::serial_queue( dispatcher& dispatcher,
+                                           std::size_t batch_size )
+  noexcept
+  : m_dispatcher(dispatcher),
+    m_queue(),
+    m_scheduled(false),
+    m_draining(false),
+    m_batch_size(batch_size ? batch_size : 1u)
+{
+
+}
+
+bit::platform::serial_queue::~serial_queue()
+{
+  assert( g_this_queue != this && "serial_queue cannot be destroyed from one of its own jobs" );
+
+  // Flush everything that was posted so far by waiting on a job placed
+  // behind it
+  if( m_scheduled.load() ) {
+    auto j = make_job([]{});
+    auto handle = job_handle(j);
+
+    post_job( std::move(j) );
+    wait( handle );
+  }
+
+  // Wait for the last drain to release this queue
+  while( m_scheduled.load() || m_draining.load( std::memory_order_acquire ) ) {
+    std::this_thread::yield();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::serial_queue::wait( job_handle job )
+{
+  assert( g_this_queue != this && "wait cannot be called from a job in the same serial_queue" );
+
+  m_dispatcher.wait( job );
+}
+
+void bit::platform::serial_queue::post_job( job job )
+{
+  assert( job && "cannot post a null job" );
+
+  m_queue.push( detail::release_job( std::move(job) ) );
+
+  // Only the producer that transitions the queue out of idle schedules the
+  // drain; all others piggy-back on the outstanding one
+  if( !m_scheduled.exchange( true ) ) {
+    m_dispatcher.post_job( make_job( [this]{ drain(); } ) );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::serial_queue::drain()
+{
+  m_draining.store( true, std::memory_order_relaxed );
+
+  const auto* old = g_this_queue;
+  g_this_queue = this;
+
+  for( auto i = std::size_t{0}; i < m_batch_size; ++i ) {
+    auto* node = m_queue.pop();
+    if( !node ) break;
+
+    // The job is finalized as it leaves scope
+    detail::acquire_job( node ).execute();
+  }
+
+  g_this_queue = old;
+
+  // Either the batch was exhausted, or a producer is mid-push; yield the
+  // worker to everything else pending before continuing
+  if( !m_queue.empty() ) {
+    m_dispatcher.defer_job( make_job( [this]{ drain(); } ) );
+  } else {
+    m_scheduled.store( false );
+
+    // A producer may have pushed after the queue was observed empty, but
+    // before the flag was cleared -- in which case it did not schedule a
+    // drain
+    if( !m_queue.empty() && !m_scheduled.exchange( true ) ) {
+      m_dispatcher.defer_job( make_job( [this]{ drain(); } ) );
+    }
+  }
+
+  // This must be the last access to the queue, since it may be destroyed
+  // as soon as it is observed
+  m_draining.store( false, std::memory_order_release );
+}
+
+//-----------------------------------------------------------------------------
+// Free Functions
+//-----------------------------------------------------------------------------
+
+void bit::platform::post_job( serial_queue& queue, job job )
+{
+  queue.post_job( std::move(job) );
+}
+
+void bit::platform::wait( serial_queue& queue, job_handle job )
+{
+  queue.wait( job );
+}
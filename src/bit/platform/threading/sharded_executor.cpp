@@ -0,0 +1,716 @@
+#include <bit/platform/threading/sharded_executor.hpp>
+#include <bit/platform/threading/futex.hpp>
+#include <bit/platform/threading/thread.hpp>
+
+#include <algorithm> // std::max
+#include <cassert>   // assert
+#include <cstdint>   // std::uintptr_t
+#include <mutex>     // std::lock_guard
+#include <new>       // operator new, operator delete
+#include <utility>   // std::pair
+
+//=============================================================================
+// detail::shard_ring
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// \brief A bounded single-producer single-consumer ring of tasks between
+  ///        two shards
+  ///
+  /// The producer and consumer indices live on separate cache lines, and
+  /// each side caches the last index it read of the other, so that the
+  /// shared line is only touched when the ring appears full or empty.
+  /////////////////////////////////////////////////////////////////////////////
+  class shard_ring
+  {
+  public:
+
+    shard_ring() noexcept;
+
+    /// \brief Allocates the slots of this ring
+    ///
+    /// \param capacity the capacity; a power of two
+    void reserve( std::size_t capacity );
+
+    /// \brief Returns whether this ring appears empty to the consumer
+    bool empty() const noexcept;
+
+    /// \brief Moves \p task into this ring, unless it is full
+    ///
+    /// \return \c true if the task was pushed
+    bool push( unique_task& task ) noexcept;
+
+    /// \brief Moves the next task into \p task, unless this ring is empty
+    ///
+    /// \return \c true if a task was popped
+    bool pop( unique_task* task ) noexcept;
+
+  private:
+
+    static constexpr std::size_t cache_line_size = 64u;
+
+    std::unique_ptr<unique_task[]> m_slots;
+    std::size_t                    m_mask;
+
+    char m_pad0[cache_line_size];
+
+    std::atomic<std::size_t> m_head;       ///< Written by the consumer
+    std::size_t              m_tail_cache; ///< The consumer's view of m_tail
+
+    char m_pad1[cache_line_size - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+
+    std::atomic<std::size_t> m_tail;       ///< Written by the producer
+    std::size_t              m_head_cache; ///< The producer's view of m_head
+
+    char m_pad2[cache_line_size - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+  };
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Constants
+  //---------------------------------------------------------------------------
+
+  /// The maximum number of tasks taken from one ring per poll, so that a
+  /// busy ring cannot starve the others
+  constexpr std::size_t ring_batch_size = 64u;
+
+  /// The number of empty polls a shard spins for before it sleeps
+  constexpr std::size_t idle_spins = 1024u;
+
+  //---------------------------------------------------------------------------
+  // Globals
+  //---------------------------------------------------------------------------
+
+  /// The shard whose thread this is, if any
+  thread_local bit::platform::executor_shard* g_this_shard = nullptr;
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Gets the number of hardware threads, which is at least 1
+  std::size_t hardware_threads() noexcept;
+
+  /// \brief Rounds \p n up to the next power of two
+  std::size_t next_power_of_two( std::size_t n ) noexcept;
+
+  /// \brief Aligns \p p up to \p align
+  char* align_up( char* p, std::size_t align ) noexcept;
+
+  /// \brief Executes \p task, discarding any exception that it throws
+  void execute( bit::platform::unique_task& task ) noexcept;
+
+} // namespace anonymous
+
+//=============================================================================
+// detail::shard_ring
+//=============================================================================
+
+constexpr std::size_t bit::platform::detail::shard_ring::cache_line_size;
+
+bit::platform::detail::shard_ring::shard_ring()
+  noexcept
+  : m_slots(),
+    m_mask(0),
+    m_head(0),
+    m_tail_cache(0),
+    m_tail(0),
+    m_head_cache(0)
+{
+
+}
+
+void bit::platform::detail::shard_ring::reserve( std::size_t capacity )
+{
+  m_slots.reset( new unique_task[capacity] );
+  m_mask = capacity - 1u;
+}
+
+bool bit::platform::detail::shard_ring::empty()
+  const noexcept
+{
+  return m_head.load( std::memory_order_relaxed ) ==
+         m_tail.load( std::memory_order_acquire );
+}
+
+bool bit::platform::detail::shard_ring::push( unique_task& task )
+  noexcept
+{
+  const auto tail = m_tail.load( std::memory_order_relaxed );
+
+  if( tail - m_head_cache > m_mask ) {
+    m_head_cache = m_head.load( std::memory_order_acquire );
+    if( tail - m_head_cache > m_mask ) return false;
+  }
+
+  m_slots[tail & m_mask] = std::move(task);
+  m_tail.store( tail + 1u, std::memory_order_release );
+  return true;
+}
+
+bool bit::platform::detail::shard_ring::pop( unique_task* task )
+  noexcept
+{
+  const auto head = m_head.load( std::memory_order_relaxed );
+
+  if( head == m_tail_cache ) {
+    m_tail_cache = m_tail.load( std::memory_order_acquire );
+    if( head == m_tail_cache ) return false;
+  }
+
+  (*task) = std::move(m_slots[head & m_mask]);
+  m_head.store( head + 1u, std::memory_order_release );
+  return true;
+}
+
+//=============================================================================
+// shard_arena
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor / Destructor
+//-----------------------------------------------------------------------------
+
+constexpr std::size_t bit::platform::shard_arena::default_chunk_size;
+
+bit::platform::shard_arena::shard_arena( std::size_t chunk_size )
+  noexcept
+  : m_chunks(nullptr),
+    m_current(nullptr),
+    m_end(nullptr),
+    m_chunk_size(chunk_size)
+{
+
+}
+
+bit::platform::shard_arena::~shard_arena()
+{
+  while( m_chunks ) {
+    auto* next = m_chunks->next;
+    ::operator delete( m_chunks );
+    m_chunks = next;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Allocation
+//-----------------------------------------------------------------------------
+
+void* bit::platform::shard_arena::allocate( std::size_t size, std::size_t align )
+{
+  auto* p = m_current ? align_up( m_current, align ) : nullptr;
+
+  if( !p || p > m_end || static_cast<std::size_t>(m_end - p) < size ) {
+    // Allocations larger than a chunk get a chunk of their own
+    const auto chunk_size = std::max( m_chunk_size, sizeof(chunk) + size + align );
+
+    auto* c = static_cast<chunk*>( ::operator new( chunk_size ) );
+    c->next = m_chunks;
+    c->size = chunk_size;
+
+    m_chunks  = c;
+    m_current = reinterpret_cast<char*>(c + 1);
+    m_end     = reinterpret_cast<char*>(c) + chunk_size;
+
+    p = align_up( m_current, align );
+  }
+
+  m_current = p + size;
+  return p;
+}
+
+void bit::platform::shard_arena::release()
+  noexcept
+{
+  if( !m_chunks ) return;
+
+  // The oldest chunk is at the back of the list
+  while( m_chunks->next ) {
+    auto* next = m_chunks->next;
+    ::operator delete( m_chunks );
+    m_chunks = next;
+  }
+
+  m_current = reinterpret_cast<char*>(m_chunks + 1);
+  m_end     = reinterpret_cast<char*>(m_chunks) + m_chunks->size;
+}
+
+//=============================================================================
+// executor_shard
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+bit::platform::executor_shard::executor_shard( sharded_executor& executor,
+                                               std::size_t index,
+                                               std::size_t shards )
+  : m_executor(executor),
+    m_index(index),
+    m_local(),
+    m_backlog(shards),
+    m_backlogged(0),
+    m_inbox_lock(),
+    m_inbox(),
+    m_has_inbox(false),
+    m_timers(),
+    m_expired(),
+    m_arena(),
+    m_sleeping(0),
+    m_sent(0),
+    m_received(0),
+    m_idle(false),
+    m_thread()
+{
+
+}
+
+//-----------------------------------------------------------------------------
+// Execution
+//-----------------------------------------------------------------------------
+
+void bit::platform::executor_shard::post( unique_task task )
+{
+  auto* const current = g_this_shard;
+
+  if( current == this ) {
+    m_local.push_back( std::move(task) );
+    return;
+  }
+
+  if( current && &current->m_executor == &m_executor ) {
+    current->forward( *this, std::move(task) );
+    return;
+  }
+
+  {
+    std::lock_guard<spin_lock> lock(m_inbox_lock);
+
+    m_inbox.push_back( std::move(task) );
+    m_has_inbox.store( true, std::memory_order_release );
+  }
+  wake();
+}
+
+//-----------------------------------------------------------------------------
+// Timers
+//-----------------------------------------------------------------------------
+
+bit::platform::timer_handle
+  bit::platform::executor_shard::schedule_timer( timer_wheel::time_point deadline,
+                                                 timer_wheel::callback_type callback )
+{
+  assert( g_this_shard == this && "timers may only be scheduled from the shard's own thread" );
+
+  return m_timers.schedule( deadline, std::move(callback) );
+}
+
+bit::platform::timer_handle
+  bit::platform::executor_shard::schedule_timer( timer_wheel::time_point deadline,
+                                                 timer_wheel::duration period,
+                                                 timer_wheel::callback_type callback )
+{
+  assert( g_this_shard == this && "timers may only be scheduled from the shard's own thread" );
+
+  return m_timers.schedule( deadline, period, std::move(callback) );
+}
+
+bool bit::platform::executor_shard::cancel_timer( timer_handle handle )
+  noexcept
+{
+  assert( g_this_shard == this && "timers may only be cancelled from the shard's own thread" );
+
+  return m_timers.cancel( handle );
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::executor_shard::run()
+{
+  g_this_shard = this;
+  this_thread::set_affinity( m_index % hardware_threads() );
+
+  auto& arbiter = concurrency_arbiter::global();
+  arbiter.acquire();
+
+  auto idle = std::size_t{0};
+
+  while( m_executor.m_running.load( std::memory_order_acquire ) ) {
+    if( poll() ) {
+      idle = 0;
+      continue;
+    }
+    // Yielding costs nothing while the shard has its core to itself, but
+    // lets the shards make progress when cores are oversubscribed
+    if( ++idle < idle_spins ) {
+      yield_lease();
+      std::this_thread::yield();
+      continue;
+    }
+
+    sleep();
+    idle = 0;
+  }
+
+  // Once stopped, shards may still forward tasks to each other, so a shard
+  // only exits once the executor has seen every shard out of work. Work is
+  // only polled after clearing the idle flag, so that the executor never
+  // sees an idle shard that is running a task
+  while( true ) {
+    if( has_work() ) {
+      m_idle.store( false );
+      if( poll() ) continue;
+    } else if( m_executor.m_stopped.load( std::memory_order_acquire ) ) {
+      break;
+    } else if( !m_idle.load( std::memory_order_relaxed ) ) {
+      m_idle.store( true );
+    }
+    // The shards that this one waits on, such as those with a full ring or
+    // still waiting for a lease, need to run before it can make progress
+    yield_lease();
+    std::this_thread::yield();
+  }
+
+  arbiter.release();
+  g_this_shard = nullptr;
+}
+
+std::size_t bit::platform::executor_shard::poll()
+{
+  auto count = std::size_t{0};
+
+  // Only the tasks queued before this poll are run, so that a task which
+  // keeps posting to its own shard cannot starve the rings
+  for( auto n = m_local.size(); n > 0; --n ) {
+    auto task = std::move(m_local.front());
+    m_local.pop_front();
+
+    execute( task );
+    ++count;
+  }
+
+  const auto shards = m_executor.size();
+  auto task = unique_task{};
+
+  for( auto from = std::size_t{0}; from < shards; ++from ) {
+    if( from == m_index ) continue;
+
+    auto& ring = m_executor.ring( from, m_index );
+    for( auto i = std::size_t{0}; i < ring_batch_size && ring.pop( &task ); ++i ) {
+      m_received.store( m_received.load( std::memory_order_relaxed ) + 1u,
+                        std::memory_order_release );
+      execute( task );
+      task = nullptr;
+      ++count;
+    }
+  }
+
+  if( m_has_inbox.load( std::memory_order_acquire ) ) {
+    auto inbox = std::vector<unique_task>{};
+    {
+      std::lock_guard<spin_lock> lock(m_inbox_lock);
+
+      inbox.swap( m_inbox );
+      m_has_inbox.store( false, std::memory_order_relaxed );
+    }
+    for( auto& t : inbox ) {
+      execute( t );
+      ++count;
+    }
+  }
+
+  if( m_backlogged ) {
+    for( auto to = std::size_t{0}; to < shards; ++to ) {
+      auto& backlog = m_backlog[to];
+      if( backlog.empty() ) continue;
+
+      auto& ring   = m_executor.ring( m_index, to );
+      auto  pushed = false;
+      while( !backlog.empty() && ring.push( backlog.front() ) ) {
+        backlog.pop_front();
+        --m_backlogged;
+        ++count;
+        pushed = true;
+      }
+      if( pushed ) m_executor[to].wake();
+    }
+  }
+
+  if( !m_timers.empty() ) {
+    const auto now = timer_wheel::clock_type::now();
+
+    if( now >= m_timers.next_expiry() ) {
+      m_timers.advance( now, m_expired );
+      for( auto& callback : m_expired ) {
+        callback();
+        ++count;
+      }
+      m_expired.clear();
+    }
+  }
+
+  return count;
+}
+
+void bit::platform::executor_shard::sleep()
+{
+  m_sleeping.store( 1u, std::memory_order_relaxed );
+
+  // Pairs with the fence in wake(): either the producer sees this shard
+  // sleeping, or this shard sees the producer's task
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  if( has_work() || !m_executor.m_running.load( std::memory_order_acquire ) ) {
+    m_sleeping.store( 0u, std::memory_order_relaxed );
+    return;
+  }
+
+  // Sleeping shards do not occupy a slot of the arbiter
+  blocking_region region;
+
+  if( m_timers.empty() ) {
+    futex_wait( m_sleeping, 1u );
+  } else {
+    const auto deadline = m_timers.next_expiry();
+    const auto now      = timer_wheel::clock_type::now();
+
+    if( deadline > now ) {
+      futex_wait_for( m_sleeping, 1u, deadline - now );
+    }
+  }
+  m_sleeping.store( 0u, std::memory_order_relaxed );
+}
+
+void bit::platform::executor_shard::wake()
+  noexcept
+{
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  if( m_sleeping.load( std::memory_order_relaxed ) == 0u ) return;
+
+  if( m_sleeping.exchange( 0u ) != 0u ) {
+    futex_wake_one( m_sleeping );
+  }
+}
+
+bool bit::platform::executor_shard::has_work()
+  const noexcept
+{
+  if( !m_local.empty() || m_backlogged ) return true;
+  if( m_has_inbox.load( std::memory_order_acquire ) ) return true;
+
+  const auto shards = m_executor.size();
+  for( auto from = std::size_t{0}; from < shards; ++from ) {
+    if( from != m_index && !m_executor.ring( from, m_index ).empty() ) return true;
+  }
+  return false;
+}
+
+void bit::platform::executor_shard::forward( executor_shard& target,
+                                             unique_task task )
+{
+  auto& backlog = m_backlog[target.m_index];
+
+  m_sent.store( m_sent.load( std::memory_order_relaxed ) + 1u,
+                std::memory_order_release );
+
+  // Tasks already in the backlog go first, to keep the order of submission
+  if( backlog.empty() && m_executor.ring( m_index, target.m_index ).push( task ) ) {
+    target.wake();
+    return;
+  }
+
+  backlog.push_back( std::move(task) );
+  ++m_backlogged;
+}
+
+//=============================================================================
+// sharded_executor
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+constexpr std::size_t bit::platform::sharded_executor::default_ring_capacity;
+
+bit::platform::sharded_executor::sharded_executor()
+  : sharded_executor( available_concurrency() )
+{
+
+}
+
+bit::platform::sharded_executor::sharded_executor( std::size_t shards,
+                                                   std::size_t ring_capacity )
+  : m_shards(),
+    m_rings(),
+    m_running(true),
+    m_stopped(false)
+{
+  shards = std::max( shards, std::size_t{1} );
+  ring_capacity = next_power_of_two( std::max( ring_capacity, std::size_t{2} ) );
+
+  m_shards.reserve( shards );
+  for( auto i = std::size_t{0}; i < shards; ++i ) {
+    m_shards.emplace_back( new executor_shard( *this, i, shards ) );
+  }
+
+  m_rings.reset( new detail::shard_ring[shards * shards] );
+  for( auto from = std::size_t{0}; from < shards; ++from ) {
+    for( auto to = std::size_t{0}; to < shards; ++to ) {
+      // A shard never posts to itself through a ring
+      if( from != to ) ring( from, to ).reserve( ring_capacity );
+    }
+  }
+
+  concurrency_arbiter::global().attach( shards );
+
+  // Threads are only started once every shard exists, since any of them
+  // may immediately be posted to
+  for( auto& shard : m_shards ) {
+    auto* s = shard.get();
+    s->m_thread = std::thread( [s]{ s->run(); } );
+  }
+}
+
+bit::platform::sharded_executor::~sharded_executor()
+{
+  assert( g_this_shard == nullptr && "sharded_executor cannot be destroyed from one of its shards" );
+
+  m_running.store( false, std::memory_order_release );
+
+  for( auto& shard : m_shards ) {
+    shard->wake();
+  }
+  quiesce();
+  m_stopped.store( true, std::memory_order_release );
+
+  for( auto& shard : m_shards ) {
+    shard->m_thread.join();
+  }
+  concurrency_arbiter::global().detach( m_shards.size() );
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+bit::platform::executor_shard* bit::platform::sharded_executor::this_shard()
+  noexcept
+{
+  return g_this_shard;
+}
+
+//-----------------------------------------------------------------------------
+// Private Observers
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::shard_ring&
+  bit::platform::sharded_executor::ring( std::size_t from, std::size_t to )
+  noexcept
+{
+  return m_rings[from * m_shards.size() + to];
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::sharded_executor::quiesce()
+{
+  using counts = std::pair<std::size_t,std::size_t>; // sent, received
+
+  // A shard only becomes busy again by receiving a task from a busy shard,
+  // so once two consecutive scans see every shard idle with the same counts,
+  // and every task that was sent has been received, no shard can ever
+  // receive another task
+  auto previous = std::vector<counts>{};
+  auto current  = std::vector<counts>{};
+  current.reserve( m_shards.size() );
+
+  while( true ) {
+    current.clear();
+
+    auto sent     = std::size_t{0};
+    auto received = std::size_t{0};
+    auto idle     = true;
+
+    for( auto& shard : m_shards ) {
+      if( !shard->m_idle.load() ) {
+        idle = false;
+        break;
+      }
+      current.emplace_back( shard->m_sent.load( std::memory_order_acquire ),
+                            shard->m_received.load( std::memory_order_acquire ) );
+      sent     += current.back().first;
+      received += current.back().second;
+    }
+
+    if( idle && sent == received ) {
+      if( current == previous ) return;
+      previous.swap( current );
+    } else {
+      previous.clear();
+    }
+    std::this_thread::yield();
+  }
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  std::size_t hardware_threads()
+    noexcept
+  {
+    return std::max( std::thread::hardware_concurrency(), 1u );
+  }
+
+  std::size_t next_power_of_two( std::size_t n )
+    noexcept
+  {
+    auto result = std::size_t{1};
+    while( result < n ) result <<= 1;
+
+    return result;
+  }
+
+  char* align_up( char* p, std::size_t align )
+    noexcept
+  {
+    const auto address = reinterpret_cast<std::uintptr_t>(p);
+
+    return p + ((align - (address % align)) % align);
+  }
+
+  void execute( bit::platform::unique_task& task )
+    noexcept
+  {
+    // As with the thread pools, an exception from a posted task is
+    // discarded rather than terminating the shard
+    try {
+      task();
+    } catch( ... ) {
+      // discarded
+    }
+  }
+
+} // namespace anonymous
@@ -28,7 +28,7 @@ void bit::platform::spin_lock::lock()
 bool bit::platform::spin_lock::try_lock()
   noexcept
 {
-  return m_lock.test_and_set(std::memory_order_acquire);
+  return !m_lock.test_and_set(std::memory_order_acquire);
 }
 
 void bit::platform::spin_lock::unlock()
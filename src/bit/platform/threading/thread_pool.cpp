@@ -0,0 +1,222 @@
+#include <bit/platform/threading/thread_pool.hpp>
+
+#include <cassert> // assert
+
+//=============================================================================
+// detail::cached_thread_pool_worker
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief A thread of a cached_thread_pool, linked into the pool's stack
+  ///        of idle threads while it waits for a task
+  ///
+  /// This lives on the stack of the thread it describes, and is only ever
+  /// accessed by other threads while it is linked into the idle stack.
+  struct cached_thread_pool_worker
+  {
+    static constexpr std::uint32_t state_idle     = 0u;
+    static constexpr std::uint32_t state_assigned = 1u;
+    static constexpr std::uint32_t state_stopped  = 2u;
+
+    unique_task                task;  ///< The task handed to this thread
+    std::atomic<std::uint32_t> state;
+    cached_thread_pool_worker* prev;  ///< The more recently idled thread
+    cached_thread_pool_worker* next;  ///< The less recently idled thread
+  };
+
+  constexpr std::uint32_t cached_thread_pool_worker::state_idle;
+  constexpr std::uint32_t cached_thread_pool_worker::state_assigned;
+  constexpr std::uint32_t cached_thread_pool_worker::state_stopped;
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// cached_thread_pool
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::cached_thread_pool::cached_thread_pool()
+  : cached_thread_pool( default_idle_timeout() )
+{
+
+}
+
+bit::platform::cached_thread_pool::cached_thread_pool( duration idle_timeout )
+  : m_idle_timeout(idle_timeout),
+    m_lock(),
+    m_idle(nullptr),
+    m_idle_size(0),
+    m_size(0),
+    m_peak_size(0),
+    m_is_running(true)
+{
+
+}
+
+bit::platform::cached_thread_pool::~cached_thread_pool()
+{
+  { // Idle threads are stopped now; running threads stop once they finish
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    m_is_running = false;
+
+    while( auto* w = m_idle ) {
+      m_idle = w->next;
+
+      w->state.store( worker::state_stopped, std::memory_order_release );
+      futex_wake_one( w->state );
+    }
+    m_idle_size = 0;
+  }
+
+  // Threads are detached, so the pool waits for each to announce its exit
+  auto size = m_size.load();
+  while( size != 0 ) {
+    futex_wait( m_size, size );
+    size = m_size.load();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+bit::platform::cached_thread_pool::duration
+  bit::platform::cached_thread_pool::idle_timeout()
+  const noexcept
+{
+  return m_idle_timeout;
+}
+
+std::size_t bit::platform::cached_thread_pool::size()
+  const noexcept
+{
+  return m_size.load( std::memory_order_relaxed );
+}
+
+std::size_t bit::platform::cached_thread_pool::idle()
+  const noexcept
+{
+  std::lock_guard<spin_lock> lock(m_lock);
+
+  return m_idle_size;
+}
+
+std::size_t bit::platform::cached_thread_pool::peak_size()
+  const noexcept
+{
+  return m_peak_size.load( std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+void bit::platform::cached_thread_pool::dispatch( unique_task task )
+{
+  auto* w = static_cast<worker*>(nullptr);
+
+  {
+    std::lock_guard<spin_lock> lock(m_lock);
+
+    assert( m_is_running && "Cannot post to a cached_thread_pool that is being destroyed" );
+
+    w = m_idle;
+    if( w ) {
+      m_idle = w->next;
+      if( m_idle ) m_idle->prev = nullptr;
+      --m_idle_size;
+
+      // Handing the task over under the lock means that a thread which
+      // times out concurrently sees that it has been assigned work
+      w->task = std::move(task);
+      w->state.store( worker::state_assigned, std::memory_order_release );
+    } else {
+      const auto size = m_size.fetch_add( 1 ) + 1;
+
+      auto peak = m_peak_size.load( std::memory_order_relaxed );
+      while( peak < size &&
+             !m_peak_size.compare_exchange_weak( peak, size, std::memory_order_relaxed ) ) {
+        // retry with the updated peak
+      }
+    }
+  }
+
+  if( w ) {
+    futex_wake_one( w->state );
+    return;
+  }
+
+  try {
+    std::thread( [this, task = std::move(task)]() mutable
+    {
+      work( std::move(task) );
+    }).detach();
+  } catch( ... ) {
+    if( m_size.fetch_sub( 1 ) == 1 ) futex_wake_all( m_size );
+    throw;
+  }
+}
+
+void bit::platform::cached_thread_pool::work( unique_task task )
+{
+  worker self;
+  self.task = std::move(task);
+  self.state.store( worker::state_assigned, std::memory_order_relaxed );
+  self.prev = nullptr;
+  self.next = nullptr;
+
+  while( self.state.load( std::memory_order_acquire ) == worker::state_assigned ) {
+    // As with basic_thread_pool, an exception from a posted task is
+    // discarded rather than terminating the thread
+    try {
+      self.task();
+    } catch( ... ) {
+      // discarded
+    }
+    self.task = nullptr;
+
+    {
+      std::lock_guard<spin_lock> lock(m_lock);
+
+      if( !m_is_running ) break;
+
+      self.state.store( worker::state_idle, std::memory_order_relaxed );
+      self.prev = nullptr;
+      self.next = m_idle;
+      if( m_idle ) m_idle->prev = &self;
+      m_idle = &self;
+      ++m_idle_size;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + m_idle_timeout;
+
+    while( self.state.load( std::memory_order_acquire ) == worker::state_idle ) {
+      const auto now = std::chrono::steady_clock::now();
+
+      if( now < deadline ) {
+        futex_wait_for( self.state, worker::state_idle, deadline - now );
+        continue;
+      }
+
+      // Timed out; retire, unless work was handed over in the meantime
+      std::lock_guard<spin_lock> lock(m_lock);
+      if( self.state.load( std::memory_order_relaxed ) != worker::state_idle ) continue;
+
+      if( self.prev ) self.prev->next = self.next;
+      else            m_idle = self.next;
+      if( self.next ) self.next->prev = self.prev;
+      --m_idle_size;
+
+      self.state.store( worker::state_stopped, std::memory_order_relaxed );
+    }
+  }
+
+  // The pool may be destroyed as soon as the count is released; waking
+  // only hashes the address of the count
+  if( m_size.fetch_sub( 1 ) == 1 ) futex_wake_all( m_size );
+}
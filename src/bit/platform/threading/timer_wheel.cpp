@@ -0,0 +1,411 @@
+#include <bit/platform/threading/timer_wheel.hpp>
+
+#include <algorithm> // std::min, std::max
+#include <cassert>   // assert
+#include <utility>   // std::move
+
+#if defined(_MSC_VER)
+# include <intrin.h> // _BitScanForward64
+#endif
+
+//=============================================================================
+// detail::timer_node
+//=============================================================================
+
+namespace bit { namespace platform { namespace detail {
+
+  /// \brief An intrusive node for a single timer in the timer_wheel
+  struct timer_node
+  {
+    timer_node*   prev;       ///< The previous node in the slot
+    timer_node*   next;       ///< The next node in the slot (or free-list)
+    std::uint64_t expiry;     ///< The tick this timer expires on
+    std::uint64_t period;     ///< The period in ticks (0 if one-shot)
+    std::function<void()> callback; ///< The callback for the timer
+    std::uint32_t generation; ///< Incremented each time the node is recycled
+    std::uint8_t  level;      ///< The level the node is hashed into
+    std::uint8_t  slot;       ///< The slot the node is hashed into
+    bool          armed;      ///< Whether this node is an active timer
+  };
+
+} } } // namespace bit::platform::detail
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  constexpr auto bits_per_level = 6u;
+  constexpr auto slot_mask      = std::uint64_t{63u};
+  constexpr auto nodes_per_chunk = std::size_t{256u};
+
+  static_assert( (1u << bits_per_level) == bit::platform::timer_wheel::slots_per_level,
+                 "slots_per_level must be a power of two matching bits_per_level" );
+
+  /// \brief Counts the number of trailing zero bits in \p x
+  ///
+  /// \pre \p x is non-zero
+  ///
+  /// \param x the value to count
+  /// \return the number of trailing zeros
+  std::uint64_t count_trailing_zeros( std::uint64_t x ) noexcept;
+
+} // namespace anonymous
+
+//=============================================================================
+// timer_wheel
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructors / Destructor
+//-----------------------------------------------------------------------------
+
+bit::platform::timer_wheel::timer_wheel( duration resolution )
+  : m_slots(),
+    m_occupied(),
+    m_chunks(),
+    m_free(nullptr),
+    m_origin(clock_type::now()),
+    m_resolution(resolution > duration::zero() ? resolution : duration(1)),
+    m_current(0),
+    m_size(0)
+{
+  for( auto& level : m_slots ) {
+    level.fill(nullptr);
+  }
+  m_occupied.fill(0u);
+}
+
+bit::platform::timer_wheel::~timer_wheel()
+{
+  clear();
+}
+
+//-----------------------------------------------------------------------------
+// Observers
+//-----------------------------------------------------------------------------
+
+bit::platform::timer_wheel::time_point
+  bit::platform::timer_wheel::next_expiry()
+  const noexcept
+{
+  if( m_size == 0 ) return time_point::max();
+
+  const auto index   = m_current & slot_mask;
+  const auto pending = m_occupied[0] >> index;
+
+  // If nothing is due in the current rotation, the next potential expiry is
+  // when the next level cascades
+  const auto tick = pending ? (m_current + count_trailing_zeros(pending))
+                            : ((m_current | slot_mask) + 1);
+
+  return m_origin + m_resolution * static_cast<duration::rep>(tick);
+}
+
+//-----------------------------------------------------------------------------
+// Modifiers
+//-----------------------------------------------------------------------------
+
+bit::platform::timer_handle
+  bit::platform::timer_wheel::schedule( time_point deadline,
+                                        duration period,
+                                        callback_type callback )
+{
+  auto* node = acquire_node();
+
+  node->expiry   = to_tick( deadline );
+  node->period   = period > duration::zero() ? to_ticks( period ) : 0u;
+  node->callback = std::move(callback);
+  node->armed    = true;
+
+  link( node );
+  ++m_size;
+
+  return timer_handle{ node, node->generation };
+}
+
+bool bit::platform::timer_wheel::cancel( timer_handle handle )
+  noexcept
+{
+  auto* node = handle.m_node;
+
+  if( !node || !node->armed || node->generation != handle.m_generation ) {
+    return false;
+  }
+
+  unlink( node );
+  release_node( node );
+  --m_size;
+
+  return true;
+}
+
+bit::platform::timer_wheel::size_type
+  bit::platform::timer_wheel::advance( time_point now,
+                                       std::vector<callback_type>& expired )
+{
+  if( now < m_origin ) return 0u;
+
+  const auto target = static_cast<tick_type>( (now - m_origin) / m_resolution );
+  auto count = size_type{0};
+
+  while( m_current <= target ) {
+
+    // Nothing left to expire; jump straight to the target
+    if( m_size == 0 ) {
+      m_current = target + 1;
+      break;
+    }
+
+    const auto index = static_cast<std::size_t>(m_current & slot_mask);
+
+    // Each full rotation of a level cascades the next level down
+    if( index == 0 ) {
+      for( auto level = std::size_t{1}; level < levels; ++level ) {
+        if( cascade( level ) != 0 ) break;
+      }
+    }
+
+    const auto pending = m_occupied[0] >> index;
+
+    // Skip to the next rotation if nothing else is due in this one
+    if( pending == 0 ) {
+      m_current = std::min( (m_current | slot_mask) + 1, target + 1 );
+      continue;
+    }
+
+    // Skip directly to the next occupied slot
+    const auto skip = count_trailing_zeros(pending);
+    if( skip != 0 ) {
+      m_current = std::min( m_current + skip, target + 1 );
+      continue;
+    }
+
+    count += expire( index, target, expired );
+    ++m_current;
+  }
+
+  return count;
+}
+
+void bit::platform::timer_wheel::clear()
+  noexcept
+{
+  for( auto level = std::size_t{0}; level < levels; ++level ) {
+    for( auto& head : m_slots[level] ) {
+      while( head ) {
+        auto* node = head;
+        head = node->next;
+        release_node( node );
+      }
+    }
+    m_occupied[level] = 0u;
+  }
+  m_size = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Private Modifiers
+//-----------------------------------------------------------------------------
+
+bit::platform::timer_wheel::tick_type
+  bit::platform::timer_wheel::to_tick( time_point time )
+  const noexcept
+{
+  if( time <= m_origin ) return 0u;
+
+  // Round up so that a timer never expires before its deadline
+  const auto elapsed = time - m_origin;
+  const auto ticks   = elapsed / m_resolution;
+  const auto partial = (elapsed % m_resolution) != duration::zero();
+
+  return static_cast<tick_type>(ticks) + (partial ? 1u : 0u);
+}
+
+bit::platform::timer_wheel::tick_type
+  bit::platform::timer_wheel::to_ticks( duration period )
+  const noexcept
+{
+  const auto ticks   = static_cast<tick_type>(period / m_resolution);
+  const auto partial = (period % m_resolution) != duration::zero();
+
+  return std::max( ticks + (partial ? 1u : 0u), tick_type{1u} );
+}
+
+//-----------------------------------------------------------------------------
+
+bit::platform::detail::timer_node* bit::platform::timer_wheel::acquire_node()
+{
+  if( !m_free ) {
+    auto chunk = std::unique_ptr<detail::timer_node[]>(
+      new detail::timer_node[nodes_per_chunk]()
+    );
+
+    for( auto i = std::size_t{0}; i < nodes_per_chunk; ++i ) {
+      chunk[i].next = m_free;
+      m_free = &chunk[i];
+    }
+    m_chunks.push_back( std::move(chunk) );
+  }
+
+  auto* node = m_free;
+  m_free = node->next;
+
+  node->prev = nullptr;
+  node->next = nullptr;
+
+  return node;
+}
+
+void bit::platform::timer_wheel::release_node( detail::timer_node* node )
+  noexcept
+{
+  node->armed    = false;
+  node->callback = nullptr;
+  ++node->generation;
+
+  node->prev = nullptr;
+  node->next = m_free;
+  m_free = node;
+}
+
+//-----------------------------------------------------------------------------
+
+void bit::platform::timer_wheel::link( detail::timer_node* node )
+  noexcept
+{
+  // Timers that are already due are expired on the next processed tick
+  if( node->expiry < m_current ) node->expiry = m_current;
+
+  const auto delta = node->expiry - m_current;
+
+  auto level = std::size_t{0};
+  auto span  = tick_type{slots_per_level};
+  while( level < (levels - 1) && delta >= span ) {
+    ++level;
+    span <<= bits_per_level;
+  }
+
+  // Timers beyond the range of the wheel are parked in the furthest slot of
+  // the top level, and are re-hashed when that slot cascades
+  const auto expiry = (delta >= span) ? (m_current + span - 1) : node->expiry;
+  const auto slot   = static_cast<std::size_t>(
+    (expiry >> (bits_per_level * level)) & slot_mask
+  );
+
+  auto& head = m_slots[level][slot];
+
+  node->level = static_cast<std::uint8_t>(level);
+  node->slot  = static_cast<std::uint8_t>(slot);
+  node->prev  = nullptr;
+  node->next  = head;
+  if( head ) head->prev = node;
+  head = node;
+
+  m_occupied[level] |= (std::uint64_t{1} << slot);
+}
+
+void bit::platform::timer_wheel::unlink( detail::timer_node* node )
+  noexcept
+{
+  auto& head = m_slots[node->level][node->slot];
+
+  if( node->prev ) {
+    node->prev->next = node->next;
+  } else {
+    head = node->next;
+  }
+  if( node->next ) node->next->prev = node->prev;
+
+  if( !head ) {
+    m_occupied[node->level] &= ~(std::uint64_t{1} << node->slot);
+  }
+
+  node->prev = nullptr;
+  node->next = nullptr;
+}
+
+std::size_t bit::platform::timer_wheel::cascade( std::size_t level )
+  noexcept
+{
+  const auto index = static_cast<std::size_t>(
+    (m_current >> (bits_per_level * level)) & slot_mask
+  );
+
+  auto* node = m_slots[level][index];
+  m_slots[level][index] = nullptr;
+  m_occupied[level] &= ~(std::uint64_t{1} << index);
+
+  while( node ) {
+    auto* next = node->next;
+    link( node );
+    node = next;
+  }
+
+  return index;
+}
+
+bit::platform::timer_wheel::size_type
+  bit::platform::timer_wheel::expire( std::size_t index,
+                                      tick_type target,
+                                      std::vector<callback_type>& expired )
+{
+  auto* node = m_slots[0][index];
+  m_slots[0][index] = nullptr;
+  m_occupied[0] &= ~(std::uint64_t{1} << index);
+
+  auto count = size_type{0};
+
+  while( node ) {
+    auto* next = node->next;
+
+    assert( node->expiry == m_current && "timer expired on the wrong tick" );
+
+    if( node->period ) {
+      expired.push_back( node->callback );
+
+      // Skip any periods that were missed while the wheel was not advanced,
+      // rather than expiring in a burst
+      const auto missed = (target - node->expiry) / node->period + 1;
+      node->expiry += missed * node->period;
+      link( node );
+    } else {
+      expired.push_back( std::move(node->callback) );
+      release_node( node );
+      --m_size;
+    }
+
+    ++count;
+    node = next;
+  }
+
+  return count;
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  std::uint64_t count_trailing_zeros( std::uint64_t x )
+    noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::uint64_t>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    ::_BitScanForward64( &index, x );
+    return index;
+#else
+    auto count = std::uint64_t{0};
+    while( !(x & 1u) ) {
+      x >>= 1;
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+} // namespace anonymous
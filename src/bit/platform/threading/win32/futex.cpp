@@ -0,0 +1,91 @@
+#include <bit/platform/threading/futex.hpp>
+
+#ifndef NOMINMAX
+# define NOMINMAX 1
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+
+static_assert( sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+               "futex words must have the same layout as their underlying integer" );
+
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  /// \brief Gets the address of the underlying word of \p address
+  volatile void* address_of( const std::atomic<std::uint32_t>& address ) noexcept;
+
+} // namespace anonymous
+
+//=============================================================================
+// Detail Functions
+//=============================================================================
+
+bool bit::platform::detail::futex_wait_for( const std::atomic<std::uint32_t>& address,
+                                            std::uint32_t expected,
+                                            std::chrono::nanoseconds timeout )
+  noexcept
+{
+  // WaitOnAddress only has millisecond granularity; round up, and stay
+  // clear of the INFINITE sentinel
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+  if( ms < timeout ) ++ms;
+
+  const auto limit = static_cast<::DWORD>(INFINITE - 1);
+  const auto count = (ms.count() < limit) ? static_cast<::DWORD>(ms.count()) : limit;
+
+  if( ::WaitOnAddress( address_of(address), &expected, sizeof(expected), count ) ) {
+    return true;
+  }
+  return ::GetLastError() != ERROR_TIMEOUT;
+}
+
+//=============================================================================
+// Free Functions
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Waiting
+//-----------------------------------------------------------------------------
+
+void bit::platform::futex_wait( const std::atomic<std::uint32_t>& address,
+                                std::uint32_t expected )
+  noexcept
+{
+  ::WaitOnAddress( address_of(address), &expected, sizeof(expected), INFINITE );
+}
+
+//-----------------------------------------------------------------------------
+// Waking
+//-----------------------------------------------------------------------------
+
+void bit::platform::futex_wake_one( std::atomic<std::uint32_t>& address )
+  noexcept
+{
+  ::WakeByAddressSingle( const_cast<void*>(address_of(address)) );
+}
+
+void bit::platform::futex_wake_all( std::atomic<std::uint32_t>& address )
+  noexcept
+{
+  ::WakeByAddressAll( const_cast<void*>(address_of(address)) );
+}
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  volatile void* address_of( const std::atomic<std::uint32_t>& address )
+    noexcept
+  {
+    return const_cast<std::atomic<std::uint32_t>*>(&address);
+  }
+
+} // namespace anonymous
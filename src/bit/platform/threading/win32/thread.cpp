@@ -8,6 +8,58 @@
 #endif
 #include <windows.h>
 
+//=============================================================================
+// Anonymous Declarations
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  /// \brief Makes an affinity mask of the cores \p cores
+  ///
+  /// Only the cores of the processor group that the thread runs in fit in
+  /// the mask; any others are ignored
+  ///
+  /// \param cores the ids of the cores
+  /// \return the mask
+  ::DWORD_PTR make_affinity_mask( const std::vector<std::size_t>& cores ) noexcept;
+
+} // namespace anonymous
+
+//-----------------------------------------------------------------------------
+// Concurrency
+//-----------------------------------------------------------------------------
+
+std::size_t bit::platform::available_concurrency()
+  noexcept
+{
+  auto process_mask = ::DWORD_PTR{};
+  auto system_mask  = ::DWORD_PTR{};
+
+  auto threads = std::size_t{0};
+
+  // The process mask only covers the processor group the process runs in
+  if( ::GetProcessAffinityMask( ::GetCurrentProcess(), &process_mask, &system_mask ) ) {
+    for( ; process_mask != 0; process_mask &= (process_mask - 1) ) {
+      ++threads;
+    }
+  }
+
+  if( threads == 0 ) threads = std::thread::hardware_concurrency();
+
+  return threads ? threads : 1u;
+}
+
+std::size_t bit::platform::refresh_available_concurrency()
+  noexcept
+{
+  // The affinity mask is read on every call, so there is nothing to refresh
+  return available_concurrency();
+}
+
 //-----------------------------------------------------------------------------
 // Affinity
 //-----------------------------------------------------------------------------
@@ -17,6 +69,15 @@ void bit::platform::set_affinity( std::thread& thread, std::size_t core_id )
   ::SetThreadAffinityMask( (::HANDLE) thread.native_handle(), (1 << core_id) );
 }
 
+void bit::platform::set_affinity( std::thread& thread,
+                                  const std::vector<std::size_t>& cores )
+{
+  const auto mask = make_affinity_mask( cores );
+  if( mask == 0 ) return;
+
+  ::SetThreadAffinityMask( (::HANDLE) thread.native_handle(), mask );
+}
+
 //-----------------------------------------------------------------------------
 
 
@@ -37,6 +98,14 @@ void bit::platform::this_thread::set_affinity( std::size_t core_id )
   ::SetThreadAffinityMask( ::GetCurrentThread(), (1 << core_id) );
 }
 
+void bit::platform::this_thread::set_affinity( const std::vector<std::size_t>& cores )
+{
+  const auto mask = make_affinity_mask( cores );
+  if( mask == 0 ) return;
+
+  ::SetThreadAffinityMask( ::GetCurrentThread(), mask );
+}
+
 std::size_t bit::platform::this_thread::affinity()
 {
   // There must be an easier way for this to be implemented
@@ -54,3 +123,26 @@ std::size_t bit::platform::this_thread::active_core()
 {
   return (std::size_t) ::GetCurrentProcessorNumber();
 }
+
+//=============================================================================
+// Anonymous Definitions
+//=============================================================================
+
+namespace {
+
+  //---------------------------------------------------------------------------
+  // Functions
+  //---------------------------------------------------------------------------
+
+  ::DWORD_PTR make_affinity_mask( const std::vector<std::size_t>& cores )
+    noexcept
+  {
+    auto mask = ::DWORD_PTR{0};
+
+    for( auto core : cores ) {
+      if( core < sizeof(::DWORD_PTR) * 8 ) mask |= (::DWORD_PTR{1} << core);
+    }
+    return mask;
+  }
+
+} // namespace anonymous
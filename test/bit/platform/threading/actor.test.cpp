@@ -0,0 +1,189 @@
+/**
+ * \file actor.test.cpp
+ *
+ * \brief This file contains unit tests for actor
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/actor.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+TEST_CASE("actor::actor( dispatcher&, handler_type, std::size_t )", "[ctor]")
+{
+  bit::platform::dispatcher dispatcher(1);
+
+  SECTION("Uses the default batch size")
+  {
+    bit::platform::actor<int> actor( dispatcher, []( int& ){} );
+
+    REQUIRE( actor.batch_size() == bit::platform::actor<int>::default_batch_size );
+    REQUIRE( &actor.get_dispatcher() == &dispatcher );
+  }
+
+  SECTION("Uses the specified batch size")
+  {
+    bit::platform::actor<int> actor( dispatcher, []( int& ){}, 4u );
+
+    REQUIRE( actor.batch_size() == 4u );
+  }
+
+  dispatcher.run([&]{ dispatcher.stop(); });
+}
+
+TEST_CASE("actor::~actor()", "[dtor]")
+{
+  static constexpr auto count = 10000;
+
+  bit::platform::dispatcher dispatcher(2);
+  auto received = 0;
+
+  SECTION("Processes every message sent before it was destroyed")
+  {
+    dispatcher.run([&]
+    {
+      {
+        bit::platform::actor<int> actor( dispatcher, [&]( int& ){ ++received; }, 8u );
+
+        for( auto i = 0; i < count; ++i ) {
+          actor.send( i );
+        }
+      }
+      dispatcher.stop();
+    });
+
+    REQUIRE( received == count );
+  }
+
+  SECTION("Does nothing when no message was sent")
+  {
+    dispatcher.run([&]
+    {
+      {
+        bit::platform::actor<int> actor( dispatcher, [&]( int& ){ ++received; } );
+      }
+      dispatcher.stop();
+    });
+
+    REQUIRE( received == 0 );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("actor::send( Message&& )", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  bit::platform::dispatcher dispatcher(2);
+
+  SECTION("Processes messages in the order they were sent")
+  {
+    auto order = std::vector<int>{};
+
+    dispatcher.run([&]
+    {
+      {
+        bit::platform::actor<int> actor( dispatcher, [&]( int& value ){ order.push_back( value ); }, 4u );
+
+        for( auto i = 0; i < count; ++i ) {
+          actor.send( i );
+        }
+      }
+      dispatcher.stop();
+    });
+
+    auto expected = std::vector<int>(count);
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE( order == expected );
+  }
+
+  SECTION("Never invokes the handler concurrently with itself")
+  {
+    static constexpr auto actors = 16;
+
+    std::atomic<bool> overlapped{false};
+    std::atomic<int>  received{0};
+
+    dispatcher.run([&]
+    {
+      {
+        auto running = std::vector<std::atomic<int>>(actors);
+        auto mailboxes = std::vector<std::unique_ptr<bit::platform::actor<int>>>{};
+
+        for( auto a = 0; a < actors; ++a ) {
+          mailboxes.push_back( std::make_unique<bit::platform::actor<int>>( dispatcher, [&,a]( int& )
+          {
+            if( ++running[a] != 1 ) overlapped = true;
+            ++received;
+            --running[a];
+          }, 2u ) );
+        }
+
+        for( auto i = 0; i < count; ++i ) {
+          mailboxes[i % actors]->send( i );
+        }
+      }
+      dispatcher.stop();
+    });
+
+    REQUIRE_FALSE( overlapped.load() );
+    REQUIRE( received.load() == count );
+  }
+
+  SECTION("Processes messages sent from the handler of another actor")
+  {
+    std::atomic<int> sum{0};
+
+    dispatcher.run([&]
+    {
+      {
+        bit::platform::actor<int> second( dispatcher, [&]( int& value ){ sum += value; } );
+        bit::platform::actor<int> first( dispatcher, [&]( int& value ){ second.send( value * 2 ); } );
+
+        for( auto i = 0; i < count; ++i ) {
+          first.send( 1 );
+        }
+      }
+      dispatcher.stop();
+    });
+
+    REQUIRE( sum.load() == count * 2 );
+  }
+}
+
+TEST_CASE("actor::emplace( Args&&... )", "[modifiers]")
+{
+  bit::platform::dispatcher dispatcher(1);
+  auto received = std::vector<std::string>{};
+
+  dispatcher.run([&]
+  {
+    {
+      bit::platform::actor<std::string> actor( dispatcher, [&]( std::string& value )
+      {
+        received.push_back( std::move(value) );
+      });
+
+      actor.emplace( 3u, 'a' );
+      actor.emplace( "hello" );
+    }
+    dispatcher.stop();
+  });
+
+  REQUIRE( received == (std::vector<std::string>{ "aaa", "hello" }) );
+}
@@ -0,0 +1,187 @@
+/**
+ * \file bounded_concurrent_queue.test.cpp
+ *
+ * \brief This file contains unit tests for bounded_concurrent_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/bounded_concurrent_queue.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("bounded_concurrent_queue::bounded_concurrent_queue( size_type )", "[ctor]")
+{
+  SECTION("Rounds the capacity up to a power of two")
+  {
+    bit::platform::bounded_concurrent_queue<int> queue(5);
+
+    REQUIRE( queue.capacity() == 8u );
+  }
+
+  SECTION("Starts empty")
+  {
+    bit::platform::bounded_concurrent_queue<int> queue(8);
+
+    REQUIRE( queue.empty() );
+    REQUIRE( queue.size() == 0u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Element Access
+//----------------------------------------------------------------------------
+
+TEST_CASE("bounded_concurrent_queue::try_pop( T* )", "[element access]")
+{
+  bit::platform::bounded_concurrent_queue<int> queue(4);
+  auto value = 0;
+
+  SECTION("Fails on an empty queue")
+  {
+    REQUIRE_FALSE( queue.try_pop( &value ) );
+  }
+
+  SECTION("Pops entries in the order they were pushed")
+  {
+    for( auto i = 0; i < 4; ++i ) {
+      queue.push_back( i );
+    }
+
+    for( auto i = 0; i < 4; ++i ) {
+      REQUIRE( queue.try_pop( &value ) );
+      REQUIRE( value == i );
+    }
+    REQUIRE( queue.empty() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("bounded_concurrent_queue::try_push_back( const T& )", "[modifiers]")
+{
+  bit::platform::bounded_concurrent_queue<int> queue(4);
+
+  SECTION("Succeeds until the queue is full")
+  {
+    for( auto i = 0; i < 4; ++i ) {
+      REQUIRE( queue.try_push_back( i ) );
+    }
+
+    REQUIRE( queue.size() == 4u );
+    REQUIRE_FALSE( queue.try_push_back( 4 ) );
+  }
+
+  SECTION("Succeeds again once an entry is popped")
+  {
+    auto value = 0;
+    for( auto i = 0; i < 4; ++i ) {
+      queue.push_back( i );
+    }
+    queue.pop( &value );
+
+    REQUIRE( queue.try_push_back( 4 ) );
+  }
+}
+
+TEST_CASE("bounded_concurrent_queue::emplace_back( Args&&... )", "[modifiers]")
+{
+  bit::platform::bounded_concurrent_queue<std::string> queue(4);
+  auto value = std::string();
+
+  queue.emplace_back( 3u, 'a' );
+  queue.pop( &value );
+
+  REQUIRE( value == "aaa" );
+}
+
+TEST_CASE("bounded_concurrent_queue::clear()", "[modifiers]")
+{
+  bit::platform::bounded_concurrent_queue<std::string> queue(4);
+
+  queue.push_back( "a" );
+  queue.push_back( "b" );
+  queue.clear();
+
+  SECTION("Drains the queue")
+  {
+    REQUIRE( queue.empty() );
+  }
+
+  SECTION("Leaves the queue usable")
+  {
+    auto value = std::string();
+    queue.push_back( "c" );
+    queue.pop( &value );
+
+    REQUIRE( value == "c" );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Concurrency
+//----------------------------------------------------------------------------
+
+TEST_CASE("bounded_concurrent_queue with multiple producers and consumers", "[concurrency]")
+{
+  static constexpr auto producers = 4;
+  static constexpr auto consumers = 4;
+  static constexpr auto count     = 10000;
+
+  // A small ring, so that producers also block on a full queue
+  bit::platform::bounded_concurrent_queue<int> queue(16);
+  auto seen = std::vector<std::atomic<int>>(producers * count);
+  std::atomic<bool> ordered{true};
+
+  for( auto& s : seen ) s.store( 0 );
+
+  auto threads = std::vector<std::thread>{};
+  for( auto p = 0; p < producers; ++p ) {
+    threads.emplace_back([&queue,p]
+    {
+      for( auto i = 0; i < count; ++i ) {
+        queue.push_back( p * count + i );
+      }
+    });
+  }
+  for( auto c = 0; c < consumers; ++c ) {
+    threads.emplace_back([&]
+    {
+      // Each producer's entries must arrive in the order they were pushed
+      auto last = std::vector<int>(producers, -1);
+
+      for( auto i = 0; i < count; ++i ) {
+        auto value = 0;
+        queue.pop( &value );
+
+        auto& previous = last[value / count];
+        if( value <= previous ) ordered = false;
+        previous = value;
+        seen[value].fetch_add( 1 );
+      }
+    });
+  }
+  for( auto& thread : threads ) {
+    thread.join();
+  }
+
+  auto exactly_once = true;
+  for( auto& s : seen ) {
+    exactly_once = exactly_once && s.load() == 1;
+  }
+
+  REQUIRE( exactly_once );
+  REQUIRE( ordered.load() );
+  REQUIRE( queue.empty() );
+}
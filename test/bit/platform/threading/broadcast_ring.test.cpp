@@ -0,0 +1,303 @@
+/**
+ * \file broadcast_ring.test.cpp
+ *
+ * \brief This file contains unit tests for broadcast_ring
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/broadcast_ring.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// A producer publishes a rising sequence while each of \p consumers
+  /// consumers, waiting with \p wait, must see all of it in order
+  void check_producer_and_consumers( int consumers,
+                                     bit::platform::wait_strategy wait )
+  {
+    static constexpr auto count = 50000;
+
+    // A small ring, so that the producer also waits for the consumers
+    bit::platform::broadcast_ring<int> ring(64,consumers);
+    auto subscriptions = std::vector<bit::platform::broadcast_ring<int>::consumer>{};
+    std::atomic<bool> ordered{true};
+    std::atomic<bool> complete{true};
+
+    subscriptions.reserve( static_cast<std::size_t>(consumers) );
+    for( auto c = 0; c < consumers; ++c ) {
+      subscriptions.push_back( ring.subscribe( wait ) );
+    }
+
+    auto threads = std::vector<std::thread>{};
+    for( auto c = 0; c < consumers; ++c ) {
+      threads.emplace_back([&,c]
+      {
+        auto expected = 0;
+        while( subscriptions[c].wait( [&]( int value )
+        {
+          if( value != expected ) ordered = false;
+          ++expected;
+        }) != 0u ) {}
+
+        if( expected != count ) complete = false;
+      });
+    }
+
+    for( auto i = 0; i < count; ++i ) {
+      ring.publish( i );
+    }
+    ring.close();
+
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    REQUIRE( ordered.load() );
+    REQUIRE( complete.load() );
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("broadcast_ring::broadcast_ring( size_type, size_type, wait_strategy )", "[ctor]")
+{
+  bit::platform::broadcast_ring<int> ring(5,3);
+
+  SECTION("Rounds the capacity up to a power of two")
+  {
+    REQUIRE( ring.capacity() == 8u );
+  }
+
+  SECTION("Holds the maximum number of consumers")
+  {
+    REQUIRE( ring.max_consumers() == 3u );
+  }
+
+  SECTION("Starts open")
+  {
+    REQUIRE_FALSE( ring.closed() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Consumers
+//----------------------------------------------------------------------------
+
+TEST_CASE("broadcast_ring::subscribe( wait_strategy )", "[consumers]")
+{
+  bit::platform::broadcast_ring<int> ring(4,2);
+  auto first = ring.subscribe( bit::platform::wait_strategy::yield );
+
+  SECTION("Uses the wait strategy of the consumer")
+  {
+    REQUIRE( first.strategy() == bit::platform::wait_strategy::yield );
+  }
+
+  SECTION("Throws once every consumer slot is in use")
+  {
+    auto second = ring.subscribe();
+
+    REQUIRE_THROWS_AS( ring.subscribe(), std::out_of_range );
+  }
+
+  SECTION("Reuses the slot of a destroyed consumer")
+  {
+    {
+      auto second = ring.subscribe();
+    }
+    auto third = ring.subscribe();
+
+    REQUIRE( third.available() == 0u );
+  }
+
+  SECTION("Only sees entries published after subscribing")
+  {
+    ring.publish( 1 );
+    auto second = ring.subscribe();
+    ring.publish( 2 );
+
+    auto values = std::vector<int>{};
+    second.poll( [&]( int value ){ values.push_back( value ); } );
+
+    REQUIRE( first.available() == 2u );
+    REQUIRE( values == (std::vector<int>{ 2 }) );
+  }
+}
+
+TEST_CASE("broadcast_ring::consumer::poll( Fn&& )", "[consumers]")
+{
+  bit::platform::broadcast_ring<std::string> ring(8,2);
+  auto first  = ring.subscribe();
+  auto second = ring.subscribe();
+  auto values = std::vector<std::string>{};
+
+  const auto append = [&]( const std::string& value ){ values.push_back( value ); };
+
+  SECTION("Returns immediately when no entry is ready")
+  {
+    REQUIRE( first.poll( append ) == 0u );
+    REQUIRE( values.empty() );
+  }
+
+  SECTION("Every consumer sees every entry in order")
+  {
+    ring.publish( "a" );
+    ring.publish( "b" );
+    ring.publish( "c" );
+
+    REQUIRE( first.poll( append ) == 3u );
+    REQUIRE( second.poll( append ) == 3u );
+    REQUIRE( values == (std::vector<std::string>{ "a", "b", "c", "a", "b", "c" }) );
+    REQUIRE( first.available() == 0u );
+  }
+
+  SECTION("Handles the entry that threw again on the next call")
+  {
+    ring.publish( "a" );
+    ring.publish( "b" );
+
+    auto calls = 0;
+    REQUIRE_THROWS( first.poll( [&]( const std::string& value )
+    {
+      if( ++calls == 2 ) throw std::runtime_error("fail");
+      values.push_back( value );
+    }));
+
+    REQUIRE( first.poll( append ) == 1u );
+    REQUIRE( values == (std::vector<std::string>{ "a", "b" }) );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Producer
+//----------------------------------------------------------------------------
+
+TEST_CASE("broadcast_ring::try_publish( const T& )", "[producer]")
+{
+  bit::platform::broadcast_ring<int> ring(4,2);
+  auto fast = ring.subscribe();
+  auto slow = ring.subscribe();
+
+  for( auto i = 0; i < 4; ++i ) {
+    REQUIRE( ring.try_publish( i ) );
+  }
+
+  SECTION("Fails once the slowest consumer is a full ring behind")
+  {
+    fast.poll( []( int ){} );
+
+    REQUIRE_FALSE( ring.try_publish( 4 ) );
+  }
+
+  SECTION("Succeeds again once the slowest consumer makes room")
+  {
+    fast.poll( []( int ){} );
+    slow.poll( []( int ){} );
+
+    REQUIRE( ring.try_publish( 4 ) );
+    REQUIRE( slow.available() == 1u );
+  }
+}
+
+TEST_CASE("broadcast_ring::publish_n( span<const T> )", "[producer]")
+{
+  bit::platform::broadcast_ring<int> ring(4,1);
+  auto subscription = ring.subscribe();
+  auto values       = std::vector<int>{};
+
+  // More entries than the ring holds, so the producer waits for room
+  const auto published = std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+  auto consumer = std::thread([&]
+  {
+    while( values.size() < published.size() ) {
+      subscription.wait( [&]( int value ){ values.push_back( value ); } );
+    }
+  });
+  ring.publish_n( bit::stl::span<const int>( published.data(), published.size() ) );
+  consumer.join();
+
+  REQUIRE( values == published );
+}
+
+TEST_CASE("broadcast_ring::close()", "[producer]")
+{
+  bit::platform::broadcast_ring<int> ring(8,1);
+  auto subscription = ring.subscribe();
+  auto values       = std::vector<int>{};
+
+  const auto append = [&]( int value ){ values.push_back( value ); };
+
+  ring.publish( 1 );
+  ring.publish( 2 );
+  ring.close();
+
+  SECTION("Marks the ring as closed")
+  {
+    REQUIRE( ring.closed() );
+  }
+
+  SECTION("Drains the remaining entries before wait returns 0")
+  {
+    REQUIRE( subscription.wait( append ) == 2u );
+    REQUIRE( subscription.wait( append ) == 0u );
+    REQUIRE( values == (std::vector<int>{ 1, 2 }) );
+  }
+
+  SECTION("Wakes a consumer that is parked for entries")
+  {
+    bit::platform::broadcast_ring<int> empty(8,1);
+    auto parked = empty.subscribe();
+    auto result = std::size_t(1);
+
+    auto consumer = std::thread([&]
+    {
+      result = parked.wait( append );
+    });
+    empty.close();
+    consumer.join();
+
+    REQUIRE( result == 0u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Concurrency
+//----------------------------------------------------------------------------
+
+TEST_CASE("broadcast_ring with a producer and multiple consumers", "[concurrency]")
+{
+  SECTION("Parking consumers")
+  {
+    check_producer_and_consumers( 4, bit::platform::wait_strategy::park );
+  }
+
+  SECTION("Yielding consumers")
+  {
+    check_producer_and_consumers( 4, bit::platform::wait_strategy::yield );
+  }
+
+  SECTION("Spinning consumers")
+  {
+    // Spinning consumers need a core each, next to the producer's
+    const auto cores     = static_cast<int>(std::thread::hardware_concurrency());
+    const auto consumers = std::min( cores - 1, 4 );
+
+    if( consumers > 0 ) {
+      check_producer_and_consumers( consumers, bit::platform::wait_strategy::busy_spin );
+    }
+  }
+}
@@ -0,0 +1,204 @@
+/**
+ * \file cgroup.test.cpp
+ *
+ * \brief This file contains unit tests for the parsing of cgroup limits
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/detail/cgroup.hpp>
+
+#include <catch.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+
+  using file_map = std::map<std::string,std::string>;
+
+  /// Determines the concurrency of the cgroups listed in \p cgroups, with
+  /// the files under '/sys/fs/cgroup' given by \p files
+  std::size_t concurrency_of( const std::string& cgroups, const file_map& files )
+  {
+    auto stream = std::istringstream(cgroups);
+
+    return bit::platform::detail::cgroup_concurrency( stream, [&]( const std::string& path,
+                                                                   std::string& line )
+    {
+      const auto it = files.find( path );
+      if( it == files.end() ) return false;
+
+      line = it->second;
+      return !line.empty();
+    });
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Parsing
+//----------------------------------------------------------------------------
+
+TEST_CASE("detail::count_cpu_list( const std::string& )", "[parsing]")
+{
+  using bit::platform::detail::count_cpu_list;
+
+  SECTION("Counts single CPUs")
+  {
+    REQUIRE( count_cpu_list( "0" ) == 1u );
+    REQUIRE( count_cpu_list( "1,3,5" ) == 3u );
+  }
+
+  SECTION("Counts ranges of CPUs")
+  {
+    REQUIRE( count_cpu_list( "0-3" ) == 4u );
+    REQUIRE( count_cpu_list( "0-3,8" ) == 5u );
+    REQUIRE( count_cpu_list( "0-1,4-7" ) == 6u );
+  }
+
+  SECTION("Counts nothing in an empty or malformed list")
+  {
+    REQUIRE( count_cpu_list( "" ) == 0u );
+    REQUIRE( count_cpu_list( "none" ) == 0u );
+  }
+}
+
+TEST_CASE("detail::quota_to_cpus( long long, long long )", "[parsing]")
+{
+  using bit::platform::detail::quota_to_cpus;
+
+  SECTION("Rounds a fractional quota up")
+  {
+    REQUIRE( quota_to_cpus( 50000, 100000 ) == 1u );
+    REQUIRE( quota_to_cpus( 150000, 100000 ) == 2u );
+    REQUIRE( quota_to_cpus( 200000, 100000 ) == 2u );
+  }
+
+  SECTION("Is unlimited without a quota or a period")
+  {
+    REQUIRE( quota_to_cpus( -1, 100000 ) == 0u );
+    REQUIRE( quota_to_cpus( 100000, 0 ) == 0u );
+  }
+}
+
+TEST_CASE("detail::parse_cpu_max( const std::string& )", "[parsing]")
+{
+  using bit::platform::detail::parse_cpu_max;
+
+  SECTION("Converts a quota and period")
+  {
+    REQUIRE( parse_cpu_max( "150000 100000" ) == 2u );
+  }
+
+  SECTION("Is unlimited for a 'max' quota")
+  {
+    REQUIRE( parse_cpu_max( "max 100000" ) == 0u );
+  }
+
+  SECTION("Is unlimited when the file is malformed")
+  {
+    REQUIRE( parse_cpu_max( "" ) == 0u );
+    REQUIRE( parse_cpu_max( "100000" ) == 0u );
+  }
+}
+
+//----------------------------------------------------------------------------
+
+TEST_CASE("detail::cgroup_concurrency( std::istream&, const cgroup_file_reader& )", "[parsing]")
+{
+  SECTION("Is unlimited when no cgroup sets a limit")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/cpu.max", "max 100000"},
+      {"/sys/fs/cgroup/app/cpu.max", "max 100000"},
+    };
+
+    REQUIRE( concurrency_of( "0::/app\n", files ) == 0u );
+  }
+
+  SECTION("Is limited by the cpu.max of a v2 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/app/cpu.max", "250000 100000"},
+    };
+
+    REQUIRE( concurrency_of( "0::/app\n", files ) == 3u );
+  }
+
+  SECTION("Is limited by the cpu.max of an ancestor of a v2 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/system.slice/cpu.max", "200000 100000"},
+      {"/sys/fs/cgroup/system.slice/app.service/cpu.max", "max 100000"},
+    };
+
+    REQUIRE( concurrency_of( "0::/system.slice/app.service\n", files ) == 2u );
+  }
+
+  SECTION("Is limited by the smallest quota along the path of a v2 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/a/cpu.max", "100000 100000"},
+      {"/sys/fs/cgroup/a/b/cpu.max", "400000 100000"},
+    };
+
+    REQUIRE( concurrency_of( "0::/a/b\n", files ) == 1u );
+  }
+
+  SECTION("Is limited by the effective cpuset of a v2 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/app/cpuset.cpus.effective", "0-3,8"},
+    };
+
+    REQUIRE( concurrency_of( "0::/app\n", files ) == 5u );
+  }
+
+  SECTION("Is limited by the cpu controller of a v1 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/cpu/docker/abc/cpu.cfs_quota_us", "150000"},
+      {"/sys/fs/cgroup/cpu/docker/abc/cpu.cfs_period_us", "100000"},
+    };
+
+    REQUIRE( concurrency_of( "4:cpu,cpuacct:/docker/abc\n", files ) == 2u );
+  }
+
+  SECTION("Reads the mount of a namespaced v1 cgroup")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "300000"},
+      {"/sys/fs/cgroup/cpu/cpu.cfs_period_us", "100000"},
+    };
+
+    REQUIRE( concurrency_of( "4:cpu,cpuacct:/docker/abc\n", files ) == 3u );
+  }
+
+  SECTION("Is limited by the smaller of the v1 cpu and cpuset controllers")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/cpu/app/cpu.cfs_quota_us", "400000"},
+      {"/sys/fs/cgroup/cpu/app/cpu.cfs_period_us", "100000"},
+      {"/sys/fs/cgroup/cpuset/app/cpuset.cpus", "0-1"},
+    };
+
+    REQUIRE( concurrency_of( "4:cpu,cpuacct:/app\n3:cpuset:/app\n", files ) == 2u );
+  }
+
+  SECTION("Is unlimited for an unlimited v1 quota")
+  {
+    const auto files = file_map{
+      {"/sys/fs/cgroup/cpu/app/cpu.cfs_quota_us", "-1"},
+      {"/sys/fs/cgroup/cpu/app/cpu.cfs_period_us", "100000"},
+    };
+
+    REQUIRE( concurrency_of( "4:cpu,cpuacct:/app\n", files ) == 0u );
+  }
+
+  SECTION("Ignores malformed lines and other controllers")
+  {
+    REQUIRE( concurrency_of( "garbage\n5:memory:/app\n", file_map{} ) == 0u );
+  }
+}
@@ -0,0 +1,442 @@
+/**
+ * \file channel.test.cpp
+ *
+ * \brief This file contains unit tests for channel and select
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/channel.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("channel::channel( size_type, const Allocator& )", "[ctor]")
+{
+  SECTION("Is unbounded by default")
+  {
+    bit::platform::channel<int> channel;
+
+    REQUIRE( channel.capacity() == bit::platform::channel<int>::unbounded );
+    REQUIRE( channel.empty() );
+    REQUIRE( channel.size() == 0u );
+    REQUIRE_FALSE( channel.closed() );
+  }
+
+  SECTION("Uses the specified capacity")
+  {
+    bit::platform::channel<int> channel(4);
+
+    REQUIRE( channel.capacity() == 4u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("channel::try_send( T&& )", "[modifiers]")
+{
+  bit::platform::channel<int> channel(2);
+
+  SECTION("Sends while there is room")
+  {
+    REQUIRE( channel.try_send( 1 ) == bit::platform::channel_status::ok );
+    REQUIRE( channel.try_send( 2 ) == bit::platform::channel_status::ok );
+    REQUIRE( channel.size() == 2u );
+  }
+
+  SECTION("Fails when the channel is full")
+  {
+    channel.try_send( 1 );
+    channel.try_send( 2 );
+
+    REQUIRE( channel.try_send( 3 ) == bit::platform::channel_status::full );
+  }
+
+  SECTION("Fails when the channel is closed")
+  {
+    channel.close();
+
+    REQUIRE( channel.try_send( 1 ) == bit::platform::channel_status::closed );
+  }
+}
+
+TEST_CASE("channel::try_recv( T* )", "[modifiers]")
+{
+  bit::platform::channel<int> channel;
+  auto value = 0;
+
+  SECTION("Receives values in the order they were sent")
+  {
+    channel.send( 1 );
+    channel.send( 2 );
+
+    REQUIRE( channel.try_recv( &value ) == bit::platform::channel_status::ok );
+    REQUIRE( value == 1 );
+    REQUIRE( channel.try_recv( &value ) == bit::platform::channel_status::ok );
+    REQUIRE( value == 2 );
+  }
+
+  SECTION("Fails when the channel is empty")
+  {
+    REQUIRE( channel.try_recv( &value ) == bit::platform::channel_status::empty );
+  }
+
+  SECTION("Receives values sent before the channel was closed")
+  {
+    channel.send( 1 );
+    channel.close();
+
+    REQUIRE( channel.try_recv( &value ) == bit::platform::channel_status::ok );
+    REQUIRE( value == 1 );
+    REQUIRE( channel.try_recv( &value ) == bit::platform::channel_status::closed );
+  }
+}
+
+TEST_CASE("channel::send( T&& )", "[modifiers]")
+{
+  static constexpr auto count = 10000;
+
+  SECTION("Blocks while the channel is full")
+  {
+    bit::platform::channel<int> channel(1);
+    std::atomic<bool> sent{false};
+
+    channel.send( 1 );
+    auto sender = std::thread([&]
+    {
+      channel.send( 2 );
+      sent = true;
+    });
+
+    std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+    REQUIRE_FALSE( sent.load() );
+
+    auto value = 0;
+    channel.recv( &value );
+    sender.join();
+
+    REQUIRE( sent.load() );
+  }
+
+  SECTION("Fails when the channel is closed")
+  {
+    bit::platform::channel<int> channel;
+    channel.close();
+
+    REQUIRE_FALSE( channel.send( 1 ) );
+  }
+
+  SECTION("Wakes a blocked sender when the channel is closed")
+  {
+    bit::platform::channel<int> channel(1);
+    auto result = true;
+
+    channel.send( 1 );
+    auto sender = std::thread([&]
+    {
+      result = channel.send( 2 );
+    });
+
+    std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+    channel.close();
+    sender.join();
+
+    REQUIRE_FALSE( result );
+  }
+
+  SECTION("Passes every value from many senders to many receivers")
+  {
+    static constexpr auto threads = 4;
+
+    bit::platform::channel<int> channel(16);
+    std::atomic<long long> sum{0};
+
+    auto senders   = std::vector<std::thread>{};
+    auto receivers = std::vector<std::thread>{};
+    for( auto t = 0; t < threads; ++t ) {
+      senders.emplace_back([&,t]
+      {
+        for( auto i = t; i < count; i += threads ) {
+          channel.send( i );
+        }
+      });
+      receivers.emplace_back([&]
+      {
+        auto value = 0;
+        while( channel.recv( &value ) ) {
+          sum += value;
+        }
+      });
+    }
+    for( auto& sender : senders ) sender.join();
+    channel.close();
+    for( auto& receiver : receivers ) receiver.join();
+
+    REQUIRE( sum.load() == static_cast<long long>(count) * (count - 1) / 2 );
+  }
+}
+
+TEST_CASE("channel::emplace( Args&&... )", "[modifiers]")
+{
+  bit::platform::channel<std::unique_ptr<int>> channel;
+  auto value = std::unique_ptr<int>{};
+
+  REQUIRE( channel.emplace( new int(5) ) );
+  REQUIRE( channel.recv( &value ) );
+  REQUIRE( *value == 5 );
+}
+
+TEST_CASE("channel::recv( T* )", "[modifiers]")
+{
+  bit::platform::channel<int> channel;
+  auto value = 0;
+
+  SECTION("Blocks until a value is sent")
+  {
+    auto sender = std::thread([&]
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+      channel.send( 5 );
+    });
+
+    REQUIRE( channel.recv( &value ) );
+    REQUIRE( value == 5 );
+    sender.join();
+  }
+
+  SECTION("Wakes a blocked receiver when the channel is closed")
+  {
+    auto result = true;
+    auto receiver = std::thread([&]
+    {
+      result = channel.recv( &value );
+    });
+
+    std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+    channel.close();
+    receiver.join();
+
+    REQUIRE_FALSE( result );
+  }
+}
+
+TEST_CASE("channel::recv_batch( OutputIt, size_type )", "[modifiers]")
+{
+  bit::platform::channel<int> channel;
+  auto values = std::vector<int>{};
+
+  for( auto i = 0; i < 10; ++i ) {
+    channel.send( i );
+  }
+
+  SECTION("Receives up to max values at once")
+  {
+    REQUIRE( channel.recv_batch( std::back_inserter(values), 4 ) == 4u );
+    REQUIRE( values == (std::vector<int>{ 0, 1, 2, 3 }) );
+  }
+
+  SECTION("Receives only the values that are buffered")
+  {
+    REQUIRE( channel.recv_batch( std::back_inserter(values), 100 ) == 10u );
+  }
+
+  SECTION("Returns 0 once the channel is closed and drained")
+  {
+    channel.close();
+
+    REQUIRE( channel.recv_batch( std::back_inserter(values), 100 ) == 10u );
+    REQUIRE( channel.recv_batch( std::back_inserter(values), 100 ) == 0u );
+  }
+}
+
+TEST_CASE("channel::close()", "[modifiers]")
+{
+  bit::platform::channel<int> channel;
+
+  channel.close();
+
+  SECTION("Closes the channel")
+  {
+    REQUIRE( channel.closed() );
+  }
+
+  SECTION("Has no effect on a closed channel")
+  {
+    channel.close();
+
+    REQUIRE( channel.closed() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Select
+//----------------------------------------------------------------------------
+
+TEST_CASE("select( Cases&&... )", "[select]")
+{
+  bit::platform::channel<int>  numbers;
+  bit::platform::channel<char> letters;
+  auto number = 0;
+  auto letter = char{};
+
+  SECTION("Receives from the channel that has a value")
+  {
+    letters.send( 'a' );
+
+    const auto index = bit::platform::select(
+      bit::platform::on_recv( numbers, [&]( int value ){ number = value; } ),
+      bit::platform::on_recv( letters, [&]( char value ){ letter = value; } )
+    );
+
+    REQUIRE( index == 1u );
+    REQUIRE( letter == 'a' );
+    REQUIRE( number == 0 );
+  }
+
+  SECTION("Blocks until one of the channels has a value")
+  {
+    auto sender = std::thread([&]
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+      numbers.send( 5 );
+    });
+
+    const auto index = bit::platform::select(
+      bit::platform::on_recv( numbers, [&]( int value ){ number = value; } ),
+      bit::platform::on_recv( letters, [&]( char value ){ letter = value; } )
+    );
+    sender.join();
+
+    REQUIRE( index == 0u );
+    REQUIRE( number == 5 );
+  }
+
+  SECTION("Skips closed channels")
+  {
+    numbers.close();
+    letters.send( 'b' );
+
+    const auto index = bit::platform::select(
+      bit::platform::on_recv( numbers, [&]( int value ){ number = value; } ),
+      bit::platform::on_recv( letters, [&]( char value ){ letter = value; } )
+    );
+
+    REQUIRE( index == 1u );
+    REQUIRE( letter == 'b' );
+  }
+
+  SECTION("Returns select_closed once every channel is closed and drained")
+  {
+    numbers.send( 1 );
+    numbers.close();
+    letters.close();
+
+    auto received = 0;
+    auto index    = std::size_t{0};
+    while( (index = bit::platform::select(
+              bit::platform::on_recv( numbers, [&]( int ){ ++received; } ),
+              bit::platform::on_recv( letters, [&]( char ){ ++received; } )
+            )) != bit::platform::select_closed ) {
+      // keep receiving
+    }
+
+    REQUIRE( received == 1 );
+  }
+
+  SECTION("Wakes a blocked select when every channel is closed")
+  {
+    auto index = std::size_t{0};
+    auto receiver = std::thread([&]
+    {
+      index = bit::platform::select(
+        bit::platform::on_recv( numbers, [&]( int value ){ number = value; } ),
+        bit::platform::on_recv( letters, [&]( char value ){ letter = value; } )
+      );
+    });
+
+    std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+    numbers.close();
+    letters.close();
+    receiver.join();
+
+    REQUIRE( index == bit::platform::select_closed );
+  }
+
+  SECTION("Does not starve either channel")
+  {
+    static constexpr auto count = 1000;
+
+    auto received = std::vector<int>(2,0);
+    for( auto i = 0; i < count; ++i ) {
+      numbers.send( i );
+      letters.send( 'x' );
+    }
+
+    for( auto i = 0; i < count; ++i ) {
+      const auto index = bit::platform::select(
+        bit::platform::on_recv( numbers, []( int ){} ),
+        bit::platform::on_recv( letters, []( char ){} )
+      );
+      ++received[index];
+    }
+
+    REQUIRE( received[0] > 0 );
+    REQUIRE( received[1] > 0 );
+  }
+}
+
+TEST_CASE("try_select( Cases&&... )", "[select]")
+{
+  bit::platform::channel<int> first;
+  bit::platform::channel<int> second;
+  auto value = 0;
+
+  SECTION("Returns select_empty when no channel has a value")
+  {
+    const auto index = bit::platform::try_select(
+      bit::platform::on_recv( first,  [&]( int v ){ value = v; } ),
+      bit::platform::on_recv( second, [&]( int v ){ value = v; } )
+    );
+
+    REQUIRE( index == bit::platform::select_empty );
+  }
+
+  SECTION("Receives from a channel that has a value")
+  {
+    second.send( 3 );
+
+    const auto index = bit::platform::try_select(
+      bit::platform::on_recv( first,  [&]( int v ){ value = v; } ),
+      bit::platform::on_recv( second, [&]( int v ){ value = v; } )
+    );
+
+    REQUIRE( index == 1u );
+    REQUIRE( value == 3 );
+  }
+
+  SECTION("Returns select_closed when every channel is closed and drained")
+  {
+    first.close();
+    second.close();
+
+    const auto index = bit::platform::try_select(
+      bit::platform::on_recv( first,  [&]( int v ){ value = v; } ),
+      bit::platform::on_recv( second, [&]( int v ){ value = v; } )
+    );
+
+    REQUIRE( index == bit::platform::select_closed );
+  }
+}
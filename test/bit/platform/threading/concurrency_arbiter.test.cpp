@@ -0,0 +1,294 @@
+/**
+ * \file concurrency_arbiter.test.cpp
+ *
+ * \brief This file contains unit tests for concurrency_arbiter
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/concurrency_arbiter.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// Yields until \p arbiter has \p count waiting threads
+  void wait_for_waiters( const bit::platform::concurrency_arbiter& arbiter,
+                         std::size_t count )
+  {
+    while( arbiter.waiting() != count ) {
+      std::this_thread::yield();
+    }
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrency_arbiter::concurrency_arbiter( std::size_t )", "[ctor]")
+{
+  bit::platform::concurrency_arbiter arbiter(4);
+
+  SECTION("Uses the specified budget")
+  {
+    REQUIRE( arbiter.budget() == 4u );
+  }
+
+  SECTION("Has no leases, waiters, or workers")
+  {
+    REQUIRE( arbiter.active() == 0u );
+    REQUIRE( arbiter.waiting() == 0u );
+    REQUIRE( arbiter.registered() == 0u );
+  }
+}
+
+TEST_CASE("concurrency_arbiter::default_budget()", "[ctor]")
+{
+  REQUIRE( bit::platform::concurrency_arbiter::default_budget() >= 1u );
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrency_arbiter::set_budget( std::size_t )", "[modifiers]")
+{
+  bit::platform::concurrency_arbiter arbiter(1);
+
+  SECTION("Uses a budget of at least 1")
+  {
+    arbiter.set_budget( 0 );
+
+    REQUIRE( arbiter.budget() == 1u );
+  }
+
+  SECTION("Does not revoke held leases when lowered")
+  {
+    arbiter.set_budget( 2 );
+
+    auto other = std::thread([&]
+    {
+      arbiter.acquire();
+    });
+    other.join();
+    arbiter.acquire();
+
+    arbiter.set_budget( 1 );
+
+    REQUIRE( arbiter.active() == 2u );
+
+    // Releasing while over budget does not hand the slot to anyone
+    arbiter.release();
+
+    REQUIRE( arbiter.active() == 1u );
+  }
+
+  SECTION("Grants leases to waiting threads when raised")
+  {
+    std::atomic<int> granted{0};
+
+    arbiter.acquire();
+
+    auto threads = std::vector<std::thread>{};
+    for( auto i = 0; i < 2; ++i ) {
+      threads.emplace_back([&]
+      {
+        arbiter.acquire();
+        ++granted;
+        arbiter.release();
+      });
+    }
+    wait_for_waiters( arbiter, 2 );
+
+    REQUIRE( granted.load() == 0 );
+
+    arbiter.set_budget( 3 );
+    for( auto& t : threads ) t.join();
+
+    REQUIRE( granted.load() == 2 );
+    REQUIRE( arbiter.active() == 1u );
+
+    arbiter.release();
+  }
+}
+
+TEST_CASE("concurrency_arbiter::attach( std::size_t )", "[modifiers]")
+{
+  bit::platform::concurrency_arbiter arbiter(1);
+
+  arbiter.attach( 4 );
+  arbiter.attach( 2 );
+
+  SECTION("Registers the workers")
+  {
+    REQUIRE( arbiter.registered() == 6u );
+  }
+
+  SECTION("Unregisters the workers when detached")
+  {
+    arbiter.detach( 4 );
+
+    REQUIRE( arbiter.registered() == 2u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Leasing
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrency_arbiter::try_acquire()", "[leasing]")
+{
+  bit::platform::concurrency_arbiter arbiter(1);
+
+  SECTION("Acquires a lease while the budget has room")
+  {
+    REQUIRE( arbiter.try_acquire() );
+    REQUIRE( arbiter.active() == 1u );
+
+    arbiter.release();
+
+    REQUIRE( arbiter.active() == 0u );
+  }
+
+  SECTION("Fails once the budget is exhausted")
+  {
+    auto other = std::thread([&]{ arbiter.acquire(); });
+    other.join();
+
+    REQUIRE_FALSE( arbiter.try_acquire() );
+    REQUIRE( arbiter.active() == 1u );
+  }
+}
+
+TEST_CASE("concurrency_arbiter::acquire()", "[leasing]")
+{
+  static constexpr auto budget  = 2u;
+  static constexpr auto threads = 8;
+  static constexpr auto count   = 1000;
+
+  SECTION("Never leases more slots than the budget")
+  {
+    bit::platform::concurrency_arbiter arbiter(budget);
+    std::atomic<unsigned> running{0};
+    std::atomic<bool>     exceeded{false};
+
+    auto workers = std::vector<std::thread>{};
+    for( auto t = 0; t < threads; ++t ) {
+      workers.emplace_back([&]
+      {
+        for( auto i = 0; i < count; ++i ) {
+          arbiter.acquire();
+          if( ++running > budget ) exceeded = true;
+          --running;
+          arbiter.release();
+        }
+      });
+    }
+    for( auto& w : workers ) w.join();
+
+    REQUIRE_FALSE( exceeded.load() );
+    REQUIRE( arbiter.active() == 0u );
+    REQUIRE( arbiter.waiting() == 0u );
+  }
+
+  SECTION("Grants leases in the order they were requested")
+  {
+    bit::platform::concurrency_arbiter arbiter(1);
+    auto order = std::vector<int>{};
+
+    arbiter.acquire();
+
+    auto workers = std::vector<std::thread>{};
+    for( auto t = 0; t < 3; ++t ) {
+      workers.emplace_back([&,t]
+      {
+        arbiter.acquire();
+        order.push_back( t );
+        arbiter.release();
+      });
+      wait_for_waiters( arbiter, static_cast<std::size_t>(t + 1) );
+    }
+
+    arbiter.release();
+    for( auto& w : workers ) w.join();
+
+    REQUIRE( order == (std::vector<int>{ 0, 1, 2 }) );
+  }
+}
+
+TEST_CASE("blocking_region::blocking_region()", "[leasing]")
+{
+  bit::platform::concurrency_arbiter arbiter(1);
+  std::atomic<bool> granted{false};
+
+  arbiter.acquire();
+
+  auto other = std::thread([&]
+  {
+    arbiter.acquire();
+    granted = true;
+    arbiter.release();
+  });
+  wait_for_waiters( arbiter, 1 );
+
+  {
+    bit::platform::blocking_region region;
+
+    // The lease is handed to the waiting thread for the duration
+    other.join();
+
+    REQUIRE( granted.load() );
+    REQUIRE( arbiter.active() == 0u );
+  }
+
+  SECTION("Reacquires the lease when the region ends")
+  {
+    REQUIRE( arbiter.active() == 1u );
+  }
+
+  arbiter.release();
+}
+
+TEST_CASE("yield_lease()", "[leasing]")
+{
+  bit::platform::concurrency_arbiter arbiter(1);
+
+  SECTION("Does nothing when no thread is waiting")
+  {
+    arbiter.acquire();
+    bit::platform::yield_lease();
+
+    REQUIRE( arbiter.active() == 1u );
+
+    arbiter.release();
+  }
+
+  SECTION("Hands the lease to a waiting thread")
+  {
+    std::atomic<bool> granted{false};
+
+    arbiter.acquire();
+
+    auto other = std::thread([&]
+    {
+      arbiter.acquire();
+      granted = true;
+      arbiter.release();
+    });
+    wait_for_waiters( arbiter, 1 );
+
+    bit::platform::yield_lease();
+    other.join();
+
+    REQUIRE( granted.load() );
+    REQUIRE( arbiter.active() == 1u );
+
+    arbiter.release();
+  }
+}
@@ -0,0 +1,318 @@
+/**
+ * \file concurrent_hash_map.test.cpp
+ *
+ * \brief This file contains unit tests for concurrent_hash_map
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/concurrent_hash_map.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// A hash that maps every key onto a few values, so that probes are long
+  /// and pass over erased slots
+  struct colliding_hash
+  {
+    std::size_t operator()( int key ) const noexcept
+    {
+      return static_cast<std::size_t>(key % 4);
+    }
+  };
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_hash_map::concurrent_hash_map()", "[ctor]")
+{
+  bit::platform::concurrent_hash_map<int,int> map;
+
+  REQUIRE( map.empty() );
+  REQUIRE( map.size() == 0u );
+  REQUIRE_FALSE( map.contains( 0 ) );
+}
+
+//----------------------------------------------------------------------------
+// Lookup
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_hash_map::find( const Key&, T* )", "[lookup]")
+{
+  bit::platform::concurrent_hash_map<int,std::string> map;
+  auto value = std::string();
+
+  map.insert_or_assign( 1, "one" );
+
+  SECTION("Copies the value of a key that is in the map")
+  {
+    REQUIRE( map.find( 1, &value ) );
+    REQUIRE( value == "one" );
+  }
+
+  SECTION("Fails for a key that is not in the map")
+  {
+    REQUIRE_FALSE( map.find( 2, &value ) );
+  }
+}
+
+TEST_CASE("concurrent_hash_map::visit( const Key&, Fn&& )", "[lookup]")
+{
+  bit::platform::concurrent_hash_map<int,std::string> map;
+  auto length = std::size_t(0);
+
+  map.insert_or_assign( 1, "one" );
+
+  SECTION("Invokes the function with the entry of a key that is in the map")
+  {
+    const auto found = map.visit( 1, [&]( const std::pair<const int,std::string>& entry )
+    {
+      length = entry.second.size();
+    });
+
+    REQUIRE( found );
+    REQUIRE( length == 3u );
+  }
+
+  SECTION("Does not invoke the function for a key that is not in the map")
+  {
+    const auto found = map.visit( 2, [&]( const std::pair<const int,std::string>& )
+    {
+      length = 1u;
+    });
+
+    REQUIRE_FALSE( found );
+    REQUIRE( length == 0u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_hash_map::insert_or_assign( const Key&, M&& )", "[modifiers]")
+{
+  bit::platform::concurrent_hash_map<int,std::string> map;
+  auto value = std::string();
+
+  SECTION("Returns true when the key is inserted")
+  {
+    REQUIRE( map.insert_or_assign( 1, "one" ) );
+    REQUIRE( map.size() == 1u );
+  }
+
+  SECTION("Returns false when the value of the key is replaced")
+  {
+    map.insert_or_assign( 1, "one" );
+
+    REQUIRE_FALSE( map.insert_or_assign( 1, "uno" ) );
+    REQUIRE( map.size() == 1u );
+    REQUIRE( map.find( 1, &value ) );
+    REQUIRE( value == "uno" );
+  }
+}
+
+TEST_CASE("concurrent_hash_map::erase( const Key& )", "[modifiers]")
+{
+  bit::platform::concurrent_hash_map<int,int> map;
+
+  map.insert_or_assign( 1, 1 );
+
+  SECTION("Returns true when the key is erased")
+  {
+    REQUIRE( map.erase( 1 ) );
+    REQUIRE_FALSE( map.contains( 1 ) );
+    REQUIRE( map.empty() );
+  }
+
+  SECTION("Returns false when the key is not in the map")
+  {
+    REQUIRE_FALSE( map.erase( 2 ) );
+    REQUIRE( map.size() == 1u );
+  }
+
+  SECTION("Allows the key to be inserted again")
+  {
+    map.erase( 1 );
+
+    REQUIRE( map.insert_or_assign( 1, 2 ) );
+    REQUIRE( map.contains( 1 ) );
+  }
+}
+
+TEST_CASE("concurrent_hash_map with colliding keys", "[modifiers]")
+{
+  bit::platform::concurrent_hash_map<int,int,colliding_hash> map;
+  auto value = 0;
+
+  for( auto i = 0; i < 100; ++i ) {
+    map.insert_or_assign( i, i );
+  }
+  for( auto i = 0; i < 100; i += 2 ) {
+    map.erase( i );
+  }
+
+  // Lookups must probe past the erased slots
+  auto correct = true;
+  for( auto i = 0; i < 100; ++i ) {
+    const auto found = map.find( i, &value );
+    correct = correct && (i % 2 == 0 ? !found : found && value == i);
+  }
+
+  REQUIRE( correct );
+  REQUIRE( map.size() == 50u );
+}
+
+TEST_CASE("concurrent_hash_map grows past its initial capacity", "[modifiers]")
+{
+  static constexpr auto count = 100000;
+
+  bit::platform::concurrent_hash_map<int,int> map;
+  auto value = 0;
+
+  for( auto i = 0; i < count; ++i ) {
+    map.insert_or_assign( i, i );
+  }
+
+  auto found = true;
+  for( auto i = 0; i < count; ++i ) {
+    found = found && map.find( i, &value ) && value == i;
+  }
+
+  REQUIRE( found );
+  REQUIRE( map.size() == static_cast<std::size_t>(count) );
+  REQUIRE_FALSE( map.contains( count ) );
+}
+
+//----------------------------------------------------------------------------
+// Concurrency
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_hash_map finds every published key while it grows", "[concurrency]")
+{
+  static constexpr auto writers = 4;
+  static constexpr auto readers = 4;
+  static constexpr auto count   = 20000;
+
+  bit::platform::concurrent_hash_map<int,std::string> map;
+
+  // The number of keys each writer has finished inserting
+  auto published = std::vector<std::atomic<int>>(writers);
+  std::atomic<bool> done{false};
+  std::atomic<bool> correct{true};
+
+  for( auto& p : published ) p.store( 0 );
+
+  auto threads = std::vector<std::thread>{};
+  for( auto w = 0; w < writers; ++w ) {
+    threads.emplace_back([&,w]
+    {
+      for( auto i = 0; i < count; ++i ) {
+        const auto key = i * writers + w;
+        map.insert_or_assign( key, std::to_string(key) );
+        published[w].store( i + 1 );
+      }
+    });
+  }
+  for( auto r = 0; r < readers; ++r ) {
+    threads.emplace_back([&,r]
+    {
+      auto value = std::string();
+      auto i     = r;
+
+      // Keys that were published before the lookup must be found, however
+      // many resizes have happened since
+      while( !done.load() ) {
+        const auto w   = i % writers;
+        const auto end = published[w].load();
+        if( end != 0 ) {
+          const auto key = (i % end) * writers + w;
+          if( !map.find( key, &value ) || value != std::to_string(key) ) {
+            correct = false;
+          }
+        }
+        ++i;
+      }
+    });
+  }
+  for( auto w = 0; w < writers; ++w ) {
+    threads[w].join();
+  }
+  done = true;
+  for( auto r = writers; r < writers + readers; ++r ) {
+    threads[r].join();
+  }
+
+  auto found = true;
+  for( auto key = 0; key < writers * count; ++key ) {
+    found = found && map.contains( key );
+  }
+
+  REQUIRE( correct.load() );
+  REQUIRE( found );
+  REQUIRE( map.size() == static_cast<std::size_t>(writers * count) );
+}
+
+TEST_CASE("concurrent_hash_map with concurrent writers and readers", "[concurrency]")
+{
+  static constexpr auto writers = 4;
+  static constexpr auto readers = 2;
+  static constexpr auto keys    = 2000;
+  static constexpr auto rounds  = 10000;
+
+  bit::platform::concurrent_hash_map<int,std::string> map;
+  std::atomic<bool> done{false};
+  std::atomic<bool> correct{true};
+
+  auto threads = std::vector<std::thread>{};
+  for( auto w = 0; w < writers; ++w ) {
+    threads.emplace_back([&,w]
+    {
+      for( auto i = 0; i < rounds; ++i ) {
+        const auto key = (i * 7 + w) % keys;
+        map.insert_or_assign( key, std::to_string(key) );
+        if( i % 3 == 0 ) map.erase( (key + 11) % keys );
+      }
+    });
+  }
+  for( auto r = 0; r < readers; ++r ) {
+    threads.emplace_back([&]
+    {
+      auto value = std::string();
+
+      // Entries may come and go, but a value that is read is never torn
+      while( !done.load() ) {
+        for( auto key = 0; key < keys; ++key ) {
+          if( map.find( key, &value ) && value != std::to_string(key) ) {
+            correct = false;
+          }
+        }
+      }
+    });
+  }
+  for( auto w = 0; w < writers; ++w ) {
+    threads[w].join();
+  }
+  done = true;
+  for( auto r = writers; r < writers + readers; ++r ) {
+    threads[r].join();
+  }
+
+  auto count = std::size_t(0);
+  for( auto key = 0; key < keys; ++key ) {
+    count += map.contains( key ) ? 1u : 0u;
+  }
+
+  REQUIRE( correct.load() );
+  REQUIRE( count == map.size() );
+}
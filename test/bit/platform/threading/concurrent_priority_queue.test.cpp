@@ -0,0 +1,314 @@
+/**
+ * \file concurrent_priority_queue.test.cpp
+ *
+ * \brief This file contains unit tests for concurrent_priority_queue and
+ *        relaxed_priority_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/concurrent_priority_queue.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// Producers push interleaved keys while consumers pop with \p pop, and
+  /// each entry must be popped exactly once
+  template<typename Queue, typename Pop>
+  void check_producers_and_consumers( Queue& queue, Pop pop )
+  {
+    static constexpr auto producers = 4;
+    static constexpr auto consumers = 4;
+    static constexpr auto count     = 5000;
+
+    auto seen = std::vector<std::atomic<int>>(producers * count);
+    std::atomic<int> popped{0};
+
+    for( auto& s : seen ) s.store( 0 );
+
+    auto threads = std::vector<std::thread>{};
+    for( auto p = 0; p < producers; ++p ) {
+      threads.emplace_back([&queue,p]
+      {
+        for( auto i = 0; i < count; ++i ) {
+          queue.push( i * producers + p );
+        }
+      });
+    }
+    for( auto c = 0; c < consumers; ++c ) {
+      threads.emplace_back([&]
+      {
+        auto values = std::vector<int>{};
+
+        while( popped.load() < producers * count ) {
+          values.clear();
+          if( pop( queue, values ) == 0u ) {
+            std::this_thread::yield();
+            continue;
+          }
+
+          for( auto value : values ) {
+            seen[value].fetch_add( 1 );
+          }
+          popped.fetch_add( static_cast<int>(values.size()) );
+        }
+      });
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    auto exactly_once = true;
+    for( auto& s : seen ) {
+      exactly_once = exactly_once && s.load() == 1;
+    }
+
+    REQUIRE( exactly_once );
+    REQUIRE( queue.empty() );
+  }
+
+  /// Pops a single entry with try_pop_min
+  struct pop_one
+  {
+    template<typename Queue>
+    std::size_t operator()( Queue& queue, std::vector<int>& values ) const
+    {
+      auto value = 0;
+      if( !queue.try_pop_min( &value ) ) return 0u;
+
+      values.push_back( value );
+      return 1u;
+    }
+  };
+
+  /// Pops a batch of entries with try_pop_n
+  struct pop_batch
+  {
+    template<typename Queue>
+    std::size_t operator()( Queue& queue, std::vector<int>& values ) const
+    {
+      return queue.try_pop_n( std::back_inserter(values), 4u );
+    }
+  };
+
+} // anonymous namespace
+
+//============================================================================
+// concurrent_priority_queue
+//============================================================================
+
+TEST_CASE("concurrent_priority_queue::try_pop_min( T* )", "[element access]")
+{
+  bit::platform::concurrent_priority_queue<int> queue;
+  auto value = 0;
+
+  SECTION("Fails on an empty queue")
+  {
+    REQUIRE_FALSE( queue.try_pop_min( &value ) );
+  }
+
+  SECTION("Pops the least entry first")
+  {
+    for( auto v : { 5, 3, 9, 1, 7 } ) {
+      queue.push( v );
+    }
+
+    REQUIRE( queue.size() == 5u );
+    for( auto expected : { 1, 3, 5, 7, 9 } ) {
+      REQUIRE( queue.try_pop_min( &value ) );
+      REQUIRE( value == expected );
+    }
+    REQUIRE( queue.empty() );
+  }
+}
+
+TEST_CASE("concurrent_priority_queue::try_pop_n( OutputIterator, size_type )", "[element access]")
+{
+  bit::platform::concurrent_priority_queue<int> queue;
+  auto values = std::vector<int>{};
+
+  for( auto v : { 4, 2, 5, 1, 3 } ) {
+    queue.push( v );
+  }
+
+  REQUIRE( queue.try_pop_n( std::back_inserter(values), 3u ) == 3u );
+  REQUIRE( values == (std::vector<int>{ 1, 2, 3 }) );
+  REQUIRE( queue.try_pop_n( std::back_inserter(values), 3u ) == 2u );
+  REQUIRE( values == (std::vector<int>{ 1, 2, 3, 4, 5 }) );
+}
+
+TEST_CASE("concurrent_priority_queue with a custom ordering", "[element access]")
+{
+  bit::platform::concurrent_priority_queue<std::string,std::greater<std::string>> queue;
+  auto value = std::string();
+
+  queue.push( "a" );
+  queue.push( "c" );
+  queue.push( "b" );
+
+  REQUIRE( queue.try_pop_min( &value ) );
+  REQUIRE( value == "c" );
+}
+
+TEST_CASE("concurrent_priority_queue::clear()", "[modifiers]")
+{
+  bit::platform::concurrent_priority_queue<std::string> queue;
+  auto value = std::string();
+
+  queue.push( "a" );
+  queue.push( "b" );
+  queue.clear();
+
+  REQUIRE( queue.empty() );
+  REQUIRE_FALSE( queue.try_pop_min( &value ) );
+}
+
+TEST_CASE("concurrent_priority_queue with multiple producers and consumers", "[concurrency]")
+{
+  bit::platform::concurrent_priority_queue<int> queue;
+
+  SECTION("Popping single entries")
+  {
+    check_producers_and_consumers( queue, pop_one{} );
+  }
+
+  SECTION("Popping batches")
+  {
+    check_producers_and_consumers( queue, pop_batch{} );
+  }
+}
+
+TEST_CASE("concurrent_priority_queue pops in strict order once producers are done", "[concurrency]")
+{
+  static constexpr auto producers = 4;
+  static constexpr auto consumers = 4;
+  static constexpr auto count     = 2000;
+
+  bit::platform::concurrent_priority_queue<int> queue;
+
+  auto threads = std::vector<std::thread>{};
+  for( auto p = 0; p < producers; ++p ) {
+    threads.emplace_back([&queue,p]
+    {
+      for( auto i = count; i > 0; --i ) {
+        queue.push( i * producers + p );
+      }
+    });
+  }
+  for( auto& thread : threads ) {
+    thread.join();
+  }
+  threads.clear();
+
+  // Every pop takes the least entry, so each consumer sees a rising sequence
+  std::atomic<bool> ordered{true};
+  for( auto c = 0; c < consumers; ++c ) {
+    threads.emplace_back([&]
+    {
+      auto last  = -1;
+      auto value = 0;
+      while( queue.try_pop_min( &value ) ) {
+        if( value < last ) ordered = false;
+        last = value;
+      }
+    });
+  }
+  for( auto& thread : threads ) {
+    thread.join();
+  }
+
+  REQUIRE( ordered.load() );
+  REQUIRE( queue.empty() );
+}
+
+//============================================================================
+// relaxed_priority_queue
+//============================================================================
+
+TEST_CASE("relaxed_priority_queue::relaxed_priority_queue( size_type )", "[ctor]")
+{
+  bit::platform::relaxed_priority_queue<int> queue(4);
+
+  REQUIRE( queue.heap_count() == 4u );
+  REQUIRE( queue.empty() );
+}
+
+TEST_CASE("relaxed_priority_queue::try_pop_min( T* )", "[element access]")
+{
+  SECTION("Pops in strict order with a single heap")
+  {
+    bit::platform::relaxed_priority_queue<int> queue(1);
+    auto value = 0;
+
+    for( auto v : { 5, 3, 9, 1, 7 } ) {
+      queue.push( v );
+    }
+    for( auto expected : { 1, 3, 5, 7, 9 } ) {
+      REQUIRE( queue.try_pop_min( &value ) );
+      REQUIRE( value == expected );
+    }
+    REQUIRE_FALSE( queue.try_pop_min( &value ) );
+  }
+
+  SECTION("Stays close to the least entry with several heaps")
+  {
+    static constexpr auto count = 10000;
+
+    bit::platform::relaxed_priority_queue<int> queue(8);
+    auto taken = std::vector<bool>(count);
+    auto value = 0;
+    auto least = 0;
+    auto error = 0.0;
+
+    for( auto i = 0; i < count; ++i ) {
+      queue.push( i );
+    }
+
+    // The rank error of a pop is the number of lesser entries left behind
+    while( queue.try_pop_min( &value ) ) {
+      while( taken[least] ) ++least;
+      error += static_cast<double>(std::count( taken.begin() + least, taken.begin() + value, false ));
+      taken[value] = true;
+    }
+
+    REQUIRE( std::count( taken.begin(), taken.end(), false ) == 0 );
+    REQUIRE( error / count <= 2.0 * static_cast<double>(queue.rank_error_bound()) );
+  }
+}
+
+TEST_CASE("relaxed_priority_queue::clear()", "[modifiers]")
+{
+  bit::platform::relaxed_priority_queue<std::string> queue(4);
+  auto value = std::string();
+
+  queue.push( "a" );
+  queue.push( "b" );
+  queue.clear();
+
+  REQUIRE( queue.empty() );
+  REQUIRE_FALSE( queue.try_pop_min( &value ) );
+}
+
+TEST_CASE("relaxed_priority_queue with multiple producers and consumers", "[concurrency]")
+{
+  bit::platform::relaxed_priority_queue<int> queue(8);
+
+  SECTION("Popping single entries")
+  {
+    check_producers_and_consumers( queue, pop_one{} );
+  }
+
+  SECTION("Popping batches")
+  {
+    check_producers_and_consumers( queue, pop_batch{} );
+  }
+}
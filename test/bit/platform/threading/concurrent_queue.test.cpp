@@ -0,0 +1,533 @@
+/**
+ * \file concurrent_queue.test.cpp
+ *
+ * \brief This file contains unit tests for concurrent_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/concurrent_queue.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  template<typename T, typename Lock>
+  using queue_t = bit::platform::concurrent_queue<T,Lock>;
+
+  /// An allocator that counts the allocations made through it
+  template<typename T>
+  struct counting_allocator
+  {
+    using value_type = T;
+
+    explicit counting_allocator( std::size_t* count ) noexcept : count(count){}
+
+    template<typename U>
+    counting_allocator( const counting_allocator<U>& other ) noexcept : count(other.count){}
+
+    T* allocate( std::size_t n )
+    {
+      ++(*count);
+      return std::allocator<T>().allocate( n );
+    }
+
+    void deallocate( T* p, std::size_t n ) noexcept
+    {
+      std::allocator<T>().deallocate( p, n );
+    }
+
+    std::size_t* count;
+  };
+
+  template<typename T, typename U>
+  bool operator==( const counting_allocator<T>& lhs, const counting_allocator<U>& rhs ) noexcept
+  {
+    return lhs.count == rhs.count;
+  }
+
+  template<typename T, typename U>
+  bool operator!=( const counting_allocator<T>& lhs, const counting_allocator<U>& rhs ) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  //--------------------------------------------------------------------------
+
+  template<typename Lock>
+  void check_fifo()
+  {
+    queue_t<std::string,Lock> queue;
+    auto value = std::string();
+
+    REQUIRE( queue.empty() );
+    REQUIRE_FALSE( queue.try_pop( &value ) );
+
+    queue.push_back( "a" );
+    queue.emplace_back( 2u, 'b' );
+    REQUIRE( queue.try_push_back( "c" ) );
+    REQUIRE( queue.try_emplace_back( "d" ) );
+    REQUIRE( queue.size() == 4u );
+
+    for( auto expected : { "a", "bb", "c", "d" } ) {
+      REQUIRE( queue.try_pop( &value ) );
+      REQUIRE( value == expected );
+    }
+    REQUIRE( queue.empty() );
+  }
+
+  template<typename Lock>
+  void check_push_range()
+  {
+    queue_t<int,Lock> queue;
+    const auto values = std::vector<int>{ 1, 2, 3, 4, 5 };
+    auto value = 0;
+
+    queue.push_back( 0 );
+    queue.push_range( values.begin(), values.end() );
+
+    REQUIRE( queue.size() == 6u );
+    for( auto i = 0; i < 6; ++i ) {
+      REQUIRE( queue.try_pop( &value ) );
+      REQUIRE( value == i );
+    }
+  }
+
+  template<typename Lock>
+  void check_emplace_n()
+  {
+    queue_t<std::string,Lock> queue;
+    auto value = std::string();
+
+    queue.emplace_n( 3u, 2u, 'x' );
+
+    REQUIRE( queue.size() == 3u );
+    for( auto i = 0; i < 3; ++i ) {
+      REQUIRE( queue.try_pop( &value ) );
+      REQUIRE( value == "xx" );
+    }
+  }
+
+  template<typename Lock>
+  void check_try_pop_n()
+  {
+    queue_t<int,Lock> queue;
+    auto values = std::vector<int>{};
+
+    for( auto i = 0; i < 5; ++i ) {
+      queue.push_back( i );
+    }
+
+    REQUIRE( queue.try_pop_n( std::back_inserter(values), 3u ) == 3u );
+    REQUIRE( values == (std::vector<int>{ 0, 1, 2 }) );
+    REQUIRE( queue.try_pop_n( std::back_inserter(values), 3u ) == 2u );
+    REQUIRE( values == (std::vector<int>{ 0, 1, 2, 3, 4 }) );
+    REQUIRE( queue.try_pop_n( std::back_inserter(values), 3u ) == 0u );
+  }
+
+  template<typename Lock>
+  void check_pop_all()
+  {
+    queue_t<int,Lock> queue;
+    auto values = std::vector<int>{};
+
+    REQUIRE( queue.pop_all( std::back_inserter(values) ) == 0u );
+
+    // Repeated, so that the spare storage is swapped back in
+    for( auto round = 0; round < 3; ++round ) {
+      for( auto i = 0; i < 5; ++i ) {
+        queue.push_back( i );
+      }
+      values.clear();
+
+      REQUIRE( queue.pop_all( std::back_inserter(values) ) == 5u );
+      REQUIRE( values == (std::vector<int>{ 0, 1, 2, 3, 4 }) );
+      REQUIRE( queue.empty() );
+    }
+  }
+
+  template<typename Lock>
+  void check_clear()
+  {
+    queue_t<std::string,Lock> queue;
+    auto value = std::string();
+
+    queue.push_back( "a" );
+    queue.push_back( "b" );
+    queue.clear();
+
+    REQUIRE( queue.empty() );
+    REQUIRE_FALSE( queue.try_pop( &value ) );
+
+    queue.push_back( "c" );
+    REQUIRE( queue.try_pop( &value ) );
+    REQUIRE( value == "c" );
+  }
+
+  //--------------------------------------------------------------------------
+
+  /// Producers push batches with push_range while consumers drain with
+  /// try_pop_n, and each entry must be seen exactly once, with the entries
+  /// of each producer in the order they were pushed
+  template<typename Lock>
+  void check_bulk_producers_and_consumers()
+  {
+    static constexpr auto producers = 4;
+    static constexpr auto consumers = 4;
+    static constexpr auto count     = 10000;
+    static constexpr auto batch     = 8;
+
+    queue_t<int,Lock> queue;
+    auto seen = std::vector<std::atomic<int>>(producers * count);
+    std::atomic<int>  popped{0};
+    std::atomic<bool> ordered{true};
+
+    for( auto& s : seen ) s.store( 0 );
+
+    auto threads = std::vector<std::thread>{};
+    for( auto p = 0; p < producers; ++p ) {
+      threads.emplace_back([&queue,p]
+      {
+        auto values = std::vector<int>(batch);
+        for( auto i = 0; i < count; i += batch ) {
+          for( auto j = 0; j < batch; ++j ) {
+            values[j] = p * count + i + j;
+          }
+          queue.push_range( values.begin(), values.end() );
+        }
+      });
+    }
+    for( auto c = 0; c < consumers; ++c ) {
+      threads.emplace_back([&]
+      {
+        auto last   = std::vector<int>(producers, -1);
+        auto values = std::vector<int>{};
+
+        while( popped.load() < producers * count ) {
+          values.clear();
+          const auto n = queue.try_pop_n( std::back_inserter(values), batch );
+          if( n == 0u ) {
+            std::this_thread::yield();
+            continue;
+          }
+
+          for( auto value : values ) {
+            auto& previous = last[value / count];
+            if( value <= previous ) ordered = false;
+            previous = value;
+            seen[value].fetch_add( 1 );
+          }
+          popped.fetch_add( static_cast<int>(n) );
+        }
+      });
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    auto exactly_once = true;
+    for( auto& s : seen ) {
+      exactly_once = exactly_once && s.load() == 1;
+    }
+
+    REQUIRE( exactly_once );
+    REQUIRE( ordered.load() );
+    REQUIRE( queue.empty() );
+  }
+
+  /// A consumer that is parked in pop must be woken by a later push
+  template<typename Lock>
+  void check_pop_wakes()
+  {
+    queue_t<int,Lock> queue;
+    std::atomic<bool> popped{false};
+    auto value = 0;
+
+    auto consumer = std::thread([&]
+    {
+      queue.pop( &value );
+      popped = true;
+    });
+
+    // Give the consumer time to park
+    std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+    CHECK_FALSE( popped.load() );
+
+    queue.push_back( 42 );
+    consumer.join();
+
+    REQUIRE( popped.load() );
+    REQUIRE( value == 42 );
+  }
+
+  /// Producers push one entry at a time while consumers block in pop, and
+  /// each entry must be seen exactly once
+  template<typename Lock>
+  void check_blocking_producers_and_consumers()
+  {
+    static constexpr auto producers = 4;
+    static constexpr auto consumers = 4;
+    static constexpr auto count     = 10000;
+
+    queue_t<int,Lock> queue;
+    auto seen = std::vector<std::atomic<int>>(producers * count);
+
+    for( auto& s : seen ) s.store( 0 );
+
+    auto threads = std::vector<std::thread>{};
+    for( auto p = 0; p < producers; ++p ) {
+      threads.emplace_back([&queue,p]
+      {
+        for( auto i = 0; i < count; ++i ) {
+          queue.push_back( p * count + i );
+        }
+      });
+    }
+    for( auto c = 0; c < consumers; ++c ) {
+      threads.emplace_back([&]
+      {
+        auto value = 0;
+        for( auto i = 0; i < count; ++i ) {
+          queue.pop( &value );
+          seen[value].fetch_add( 1 );
+        }
+      });
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+
+    auto exactly_once = true;
+    for( auto& s : seen ) {
+      exactly_once = exactly_once && s.load() == 1;
+    }
+
+    REQUIRE( exactly_once );
+    REQUIRE( queue.empty() );
+  }
+
+  /// The lock-free queue links new segments as it grows, and must keep
+  /// its order across them
+  void check_segments()
+  {
+    queue_t<int,bit::platform::lock_free> queue;
+    const auto count = static_cast<int>(3u * queue.segment_size + 1u);
+    auto value = 0;
+
+    for( auto i = 0; i < count; ++i ) {
+      queue.push_back( i );
+    }
+    REQUIRE( queue.size() == static_cast<std::size_t>(count) );
+
+    auto ordered = true;
+    for( auto i = 0; i < count; ++i ) {
+      ordered = ordered && queue.try_pop( &value ) && value == i;
+    }
+
+    REQUIRE( ordered );
+    REQUIRE( queue.empty() );
+  }
+
+  /// A queue that oscillates between empty and a working size must stop
+  /// allocating once it has reached that size
+  template<typename Lock>
+  void check_steady_state()
+  {
+    auto count = std::size_t(0);
+    bit::platform::concurrent_queue<int,Lock,counting_allocator<int>> queue{
+      counting_allocator<int>(&count)
+    };
+    auto values = std::vector<int>{};
+    values.reserve( 1000u );
+
+    const auto oscillate = [&]
+    {
+      auto value = 0;
+      for( auto i = 0; i < 1000; ++i ) {
+        queue.push_back( i );
+      }
+      for( auto i = 0; i < 500; ++i ) {
+        queue.try_pop( &value );
+      }
+      values.clear();
+      queue.pop_all( std::back_inserter(values) );
+    };
+
+    for( auto round = 0; round < 3; ++round ) {
+      oscillate();
+    }
+    const auto warm = count;
+
+    for( auto round = 0; round < 10; ++round ) {
+      oscillate();
+    }
+
+    REQUIRE( count == warm );
+    REQUIRE( queue.empty() );
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Constructors / Assignment
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_queue::concurrent_queue( concurrent_queue&& )", "[ctor]")
+{
+  queue_t<std::string,bit::platform::spin_lock> queue;
+  auto value = std::string();
+
+  queue.push_back( "a" );
+  queue.push_back( "b" );
+
+  auto moved = queue_t<std::string,bit::platform::spin_lock>( std::move(queue) );
+
+  REQUIRE( moved.size() == 2u );
+  REQUIRE( moved.try_pop( &value ) );
+  REQUIRE( value == "a" );
+}
+
+TEST_CASE("concurrent_queue::operator=( concurrent_queue&& )", "[assignment]")
+{
+  queue_t<std::string,bit::platform::spin_lock> queue;
+  queue_t<std::string,bit::platform::spin_lock> other;
+  auto value = std::string();
+
+  queue.push_back( "a" );
+  other.push_back( "b" );
+  other = std::move(queue);
+
+  REQUIRE( other.size() == 1u );
+  REQUIRE( other.try_pop( &value ) );
+  REQUIRE( value == "a" );
+}
+
+//----------------------------------------------------------------------------
+// Capacity
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_queue::reserve( size_type )", "[capacity]")
+{
+  auto count = std::size_t(0);
+  bit::platform::concurrent_queue<int,bit::platform::spin_lock,counting_allocator<int>> queue{
+    counting_allocator<int>(&count)
+  };
+
+  queue.reserve( 100u );
+  const auto reserved = count;
+
+  for( auto i = 0; i < 100; ++i ) {
+    queue.push_back( i );
+  }
+
+  REQUIRE( count == reserved );
+  REQUIRE( queue.size() == 100u );
+}
+
+TEST_CASE("concurrent_queue stops allocating in a steady state", "[capacity]")
+{
+  SECTION("spin_lock")  { check_steady_state<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_steady_state<std::mutex>(); }
+  SECTION("lock_free")  { check_steady_state<bit::platform::lock_free>(); }
+}
+
+//----------------------------------------------------------------------------
+// Element Access / Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_queue pops entries in the order they were pushed", "[modifiers]")
+{
+  SECTION("spin_lock")  { check_fifo<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_fifo<std::mutex>(); }
+  SECTION("lock_free")  { check_fifo<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::push_range( InputIterator, InputIterator )", "[modifiers]")
+{
+  SECTION("spin_lock")  { check_push_range<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_push_range<std::mutex>(); }
+  SECTION("lock_free")  { check_push_range<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::emplace_n( size_type, const Args&... )", "[modifiers]")
+{
+  SECTION("spin_lock")  { check_emplace_n<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_emplace_n<std::mutex>(); }
+  SECTION("lock_free")  { check_emplace_n<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::try_pop_n( OutputIterator, size_type )", "[element access]")
+{
+  SECTION("spin_lock")  { check_try_pop_n<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_try_pop_n<std::mutex>(); }
+  SECTION("lock_free")  { check_try_pop_n<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::pop_all( OutputIterator )", "[element access]")
+{
+  SECTION("spin_lock")  { check_pop_all<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_pop_all<std::mutex>(); }
+  SECTION("lock_free")  { check_pop_all<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::swap( concurrent_queue& )", "[modifiers]")
+{
+  queue_t<int,bit::platform::spin_lock> queue;
+  queue_t<int,bit::platform::spin_lock> other;
+  auto value = 0;
+
+  queue.push_back( 1 );
+  other.push_back( 2 );
+  other.push_back( 3 );
+  queue.swap( other );
+
+  REQUIRE( queue.size() == 2u );
+  REQUIRE( other.size() == 1u );
+  REQUIRE( queue.try_pop( &value ) );
+  REQUIRE( value == 2 );
+}
+
+TEST_CASE("concurrent_queue::clear()", "[modifiers]")
+{
+  SECTION("spin_lock")  { check_clear<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_clear<std::mutex>(); }
+  SECTION("lock_free")  { check_clear<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue<T,lock_free> spans several segments", "[modifiers]")
+{
+  check_segments();
+}
+
+//----------------------------------------------------------------------------
+// Concurrency
+//----------------------------------------------------------------------------
+
+TEST_CASE("concurrent_queue with batching producers and consumers", "[concurrency]")
+{
+  SECTION("spin_lock")  { check_bulk_producers_and_consumers<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_bulk_producers_and_consumers<std::mutex>(); }
+  SECTION("lock_free")  { check_bulk_producers_and_consumers<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue::pop( T* ) waits for a push", "[concurrency]")
+{
+  SECTION("spin_lock")  { check_pop_wakes<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_pop_wakes<std::mutex>(); }
+  SECTION("lock_free")  { check_pop_wakes<bit::platform::lock_free>(); }
+}
+
+TEST_CASE("concurrent_queue with blocking producers and consumers", "[concurrency]")
+{
+  SECTION("spin_lock")  { check_blocking_producers_and_consumers<bit::platform::spin_lock>(); }
+  SECTION("std::mutex") { check_blocking_producers_and_consumers<std::mutex>(); }
+  SECTION("lock_free")  { check_blocking_producers_and_consumers<bit::platform::lock_free>(); }
+}
@@ -0,0 +1,192 @@
+/**
+ * \file dispatch_queue.test.cpp
+ *
+ * \brief This file contains unit tests for dispatch_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/dispatch_queue.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("dispatch_queue::stop()", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  bit::platform::dispatch_queue queue;
+  auto executed = 0;
+
+  queue.start();
+  for( auto i = 0; i < count; ++i ) {
+    queue.post([&]{ ++executed; });
+  }
+  queue.stop();
+
+  SECTION("Executes the remaining jobs before stopping")
+  {
+    REQUIRE( executed == count );
+  }
+}
+
+TEST_CASE("dispatch_queue::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  bit::platform::dispatch_queue queue;
+  queue.start();
+
+  SECTION("Executes jobs in the order they were posted")
+  {
+    auto order = std::vector<int>{};
+
+    for( auto i = 0; i < count; ++i ) {
+      queue.post([&]( int value ){ order.push_back( value ); }, i );
+    }
+    queue.stop();
+
+    auto expected = std::vector<int>(count);
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE( order == expected );
+  }
+
+  SECTION("Executes jobs posted from multiple threads, one at a time")
+  {
+    static constexpr auto producers = 4;
+
+    auto next = std::vector<int>(producers,0);
+    std::atomic<int>  running{0};
+    std::atomic<bool> overlapped{false};
+    std::atomic<bool> ordered{true};
+
+    auto threads = std::vector<std::thread>{};
+    for( auto p = 0; p < producers; ++p ) {
+      threads.emplace_back([&,p]
+      {
+        for( auto i = 0; i < count; ++i ) {
+          queue.post([&,p,i]
+          {
+            if( ++running != 1 ) overlapped = true;
+            if( next[p]++ != i ) ordered = false;
+            --running;
+          });
+        }
+      });
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+    queue.stop();
+
+    REQUIRE_FALSE( overlapped.load() );
+    REQUIRE( ordered.load() );
+    REQUIRE( std::accumulate( next.begin(), next.end(), 0 ) == producers * count );
+  }
+}
+
+TEST_CASE("dispatch_queue::post_and_wait( Fn&&, Args&&... )", "[modifiers]")
+{
+  bit::platform::dispatch_queue queue;
+  queue.start();
+
+  SECTION("Returns the result of the function")
+  {
+    REQUIRE( queue.post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 ) == 5 );
+  }
+
+  SECTION("Returns a reference to the result of the function")
+  {
+    auto value = 0;
+    auto& result = queue.post_and_wait([&]() -> int& { return value; });
+
+    REQUIRE( &result == &value );
+  }
+
+  SECTION("Executes on the queue's thread")
+  {
+    const auto id = queue.post_and_wait([]{ return std::this_thread::get_id(); });
+
+    REQUIRE( id != std::this_thread::get_id() );
+  }
+}
+
+TEST_CASE("dispatch_queue::wait( job_handle )", "[modifiers]")
+{
+  bit::platform::dispatch_queue queue;
+  queue.start();
+
+  SECTION("Returns once the job has completed")
+  {
+    std::atomic<bool> executed{false};
+    auto j = bit::platform::make_job([&]
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+      executed = true;
+    });
+    auto handle = bit::platform::job_handle(j);
+
+    queue.post_job( std::move(j) );
+    queue.wait( handle );
+
+    REQUIRE( executed.load() );
+    REQUIRE( handle.completed() );
+  }
+
+  SECTION("Returns once a child finished outside of the queue has completed")
+  {
+    std::atomic<bool> child_executed{false};
+    auto child_thread = std::thread{};
+
+    auto j = bit::platform::make_job([&]
+    {
+      auto child = bit::platform::make_job( *bit::platform::this_job(), [&]
+      {
+        std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+        child_executed = true;
+      });
+
+      // The child finishes on a thread that the queue knows nothing about
+      child_thread = std::thread([child = std::move(child)]
+      {
+        child.execute();
+      });
+    });
+    auto handle = bit::platform::job_handle(j);
+
+    queue.post_job( std::move(j) );
+    queue.wait( handle );
+
+    REQUIRE( child_executed.load() );
+    REQUIRE( handle.completed() );
+
+    child_thread.join();
+  }
+
+  SECTION("Keeps dispatching when called from a job in the queue")
+  {
+    const auto result = queue.post_and_wait([&]
+    {
+      auto value = 0;
+      auto j = bit::platform::make_job([&]{ value = 42; });
+      auto handle = bit::platform::job_handle(j);
+
+      bit::platform::this_dispatch_queue::post_job( std::move(j) );
+      bit::platform::this_dispatch_queue::wait( handle );
+
+      return value;
+    });
+
+    REQUIRE( result == 42 );
+  }
+}
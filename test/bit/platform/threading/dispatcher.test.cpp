@@ -0,0 +1,346 @@
+/**
+ * \file dispatcher.test.cpp
+ *
+ * \brief This file contains unit tests for the dispatcher
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/dispatcher.hpp>
+#include <bit/platform/threading/thread.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Timers
+//----------------------------------------------------------------------------
+
+TEST_CASE("dispatcher::post_after( const duration&, Fn&& )", "[timers]")
+{
+  using clock_type = std::chrono::steady_clock;
+
+  SECTION("Executes the job once the delay has elapsed")
+  {
+    bit::platform::dispatcher dispatcher(1);
+    std::atomic<bool> fired{false};
+    auto executed = clock_type::time_point{};
+
+    const auto start = clock_type::now();
+    dispatcher.post_after( std::chrono::milliseconds(20), [&]
+    {
+      executed = clock_type::now();
+      fired = true;
+    });
+    dispatcher.run([&]
+    {
+      if( fired.load() ) dispatcher.stop();
+    });
+
+    REQUIRE( executed - start >= std::chrono::milliseconds(20) );
+  }
+
+  SECTION("Forwards the arguments to the job")
+  {
+    bit::platform::dispatcher dispatcher(1);
+    std::atomic<int> sum{0};
+
+    dispatcher.post_after( std::chrono::milliseconds(1), [&]( int a, int b )
+    {
+      sum = a + b;
+    }, 2, 3 );
+    dispatcher.run([&]
+    {
+      if( sum.load() != 0 ) dispatcher.stop();
+    });
+
+    REQUIRE( sum.load() == 5 );
+  }
+
+  SECTION("Executes a burst of timers larger than the job storage of a worker")
+  {
+    // Every timer expires on the same tick, so a single poll sees all of them
+    static constexpr auto count = 10000;
+
+    bit::platform::dispatcher dispatcher(2);
+    std::atomic<int> fired{0};
+
+    for( auto i = 0; i < count; ++i ) {
+      dispatcher.post_after( std::chrono::milliseconds(50), [&]{ ++fired; } );
+    }
+    dispatcher.run([&]
+    {
+      if( fired.load() == count ) dispatcher.stop();
+    });
+
+    REQUIRE( fired.load() == count );
+  }
+}
+
+TEST_CASE("dispatcher::post_at( const time_point&, Fn&& )", "[timers]")
+{
+  using clock_type = std::chrono::steady_clock;
+
+  bit::platform::dispatcher dispatcher(1);
+  std::atomic<bool> fired{false};
+  auto executed = clock_type::time_point{};
+
+  const auto deadline = clock_type::now() + std::chrono::milliseconds(20);
+  dispatcher.post_at( deadline, [&]
+  {
+    executed = clock_type::now();
+    fired = true;
+  });
+  dispatcher.run([&]
+  {
+    if( fired.load() ) dispatcher.stop();
+  });
+
+  REQUIRE( executed >= deadline );
+}
+
+TEST_CASE("dispatcher::post_every( const duration&, Fn&& )", "[timers]")
+{
+  bit::platform::dispatcher dispatcher(1);
+  std::atomic<int> count{0};
+  auto cancelled = false;
+
+  const auto timer = dispatcher.post_every( std::chrono::milliseconds(2), [&]{ ++count; } );
+
+  // Runs until it has repeated a few times, then for a while after the
+  // timer is cancelled
+  std::atomic<bool> done{false};
+  auto last = 0;
+  dispatcher.run([&]
+  {
+    if( !cancelled && count.load() >= 3 ) {
+      cancelled = dispatcher.cancel( timer );
+      last      = count.load();
+      dispatcher.post_after( std::chrono::milliseconds(20), [&]{ done = true; } );
+    }
+    if( done.load() ) dispatcher.stop();
+  });
+
+  REQUIRE( cancelled );
+
+  // An execution that was already posted when it was cancelled still runs
+  REQUIRE( count.load() <= last + 1 );
+}
+
+TEST_CASE("dispatcher::cancel( timer_handle )", "[timers]")
+{
+  bit::platform::dispatcher dispatcher(1);
+  std::atomic<bool> cancelled_fired{false};
+  std::atomic<bool> done{false};
+
+  const auto timer = dispatcher.post_after( std::chrono::milliseconds(5), [&]{ cancelled_fired = true; } );
+  dispatcher.post_after( std::chrono::milliseconds(30), [&]{ done = true; } );
+
+  SECTION("Prevents a pending timer from executing")
+  {
+    REQUIRE( dispatcher.cancel( timer ) );
+
+    dispatcher.run([&]
+    {
+      if( done.load() ) dispatcher.stop();
+    });
+
+    REQUIRE_FALSE( cancelled_fired.load() );
+  }
+
+  SECTION("Does nothing once the timer has executed")
+  {
+    dispatcher.run([&]
+    {
+      if( done.load() ) dispatcher.stop();
+    });
+
+    REQUIRE( cancelled_fired.load() );
+    REQUIRE_FALSE( dispatcher.cancel( timer ) );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Worker Groups
+//----------------------------------------------------------------------------
+
+TEST_CASE("dispatcher::dispatcher( std::vector<worker_group> )", "[worker groups]")
+{
+  auto groups = std::vector<bit::platform::worker_group>{
+    { "main",  2, {}, {} },
+    { "batch", 3, {}, {} },
+  };
+  bit::platform::dispatcher dispatcher( groups );
+
+  SECTION("Creates each of the groups, in order")
+  {
+    REQUIRE( dispatcher.groups() == 2u );
+    REQUIRE( dispatcher.find_group( "main" ) == 0u );
+    REQUIRE( dispatcher.find_group( "batch" ) == 1u );
+  }
+
+  SECTION("Does not find a group that was not specified")
+  {
+    REQUIRE( dispatcher.find_group( "other" ) == bit::platform::dispatcher::no_group );
+  }
+
+  SECTION("Places the workers in their groups")
+  {
+    REQUIRE( dispatcher.group_size( 0 ) == 2u );
+    REQUIRE( dispatcher.group_size( 1 ) == 3u );
+  }
+
+  dispatcher.run([&]{ dispatcher.stop(); });
+}
+
+TEST_CASE("dispatcher::post_to( group_id, Fn&&, Args&&... )", "[worker groups]")
+{
+  static constexpr auto count = 1000;
+
+  auto groups = std::vector<bit::platform::worker_group>{
+    { "main",  1, {}, {} },
+    { "batch", 2, {}, {} },
+  };
+  bit::platform::dispatcher dispatcher( groups );
+
+  std::atomic<int>  executed{0};
+  std::atomic<bool> wrong_group{false};
+  auto started = false;
+
+  SECTION("Executes jobs only on the workers of the group")
+  {
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        for( auto i = 0; i < count; ++i ) {
+          dispatcher.post_to( 1, [&]
+          {
+            const auto worker = bit::platform::worker_thread_id();
+            if( dispatcher.group_of( worker ) != 1u ) wrong_group = true;
+            ++executed;
+          });
+        }
+      }
+      if( executed.load() == count ) dispatcher.stop();
+    });
+
+    REQUIRE( executed.load() == count );
+    REQUIRE_FALSE( wrong_group.load() );
+  }
+
+  SECTION("Executes jobs on an empty group once workers are moved into it")
+  {
+    dispatcher.move_workers( 1, 0, 2 );
+
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        dispatcher.post_to( 1, [&]{ ++executed; } );
+        dispatcher.move_workers( 0, 1, 1 );
+      }
+      if( executed.load() == 1 ) dispatcher.stop();
+    });
+
+    REQUIRE( executed.load() == 1 );
+  }
+}
+
+TEST_CASE("dispatcher::move_workers( group_id, group_id, std::size_t )", "[worker groups]")
+{
+  auto groups = std::vector<bit::platform::worker_group>{
+    { "main",  1, {}, {} },
+    { "batch", 3, {}, {} },
+  };
+  bit::platform::dispatcher dispatcher( groups );
+
+  SECTION("Moves up to the requested number of workers")
+  {
+    REQUIRE( dispatcher.move_workers( 1, 0, 2 ) == 2u );
+    REQUIRE( dispatcher.group_size( 0 ) == 3u );
+    REQUIRE( dispatcher.group_size( 1 ) == 1u );
+  }
+
+  SECTION("Moves only the workers that are in the group")
+  {
+    REQUIRE( dispatcher.move_workers( 1, 0, 10 ) == 3u );
+    REQUIRE( dispatcher.group_size( 1 ) == 0u );
+  }
+
+  SECTION("Never moves the thread running the dispatcher")
+  {
+    dispatcher.move_workers( 0, 1, 10 );
+
+    REQUIRE( dispatcher.group_of( 0 ) == 0u );
+  }
+
+  dispatcher.run([&]{ dispatcher.stop(); });
+}
+
+TEST_CASE("dispatcher::set_overflow( group_id, group_id, bool )", "[worker groups]")
+{
+  auto groups = std::vector<bit::platform::worker_group>{
+    { "main",  1, {}, {} },
+    { "batch", 0, {}, {} },
+  };
+  bit::platform::dispatcher dispatcher( groups );
+  std::atomic<bool> executed{false};
+  auto started = false;
+
+  dispatcher.set_overflow( 0, 1, true );
+
+  SECTION("Lets idle workers execute the jobs of another group")
+  {
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        dispatcher.post_to( 1, [&]{ executed = true; } );
+      }
+      if( executed.load() ) dispatcher.stop();
+    });
+
+    REQUIRE( executed.load() );
+  }
+}
+
+// Only Linux reports the core that a thread runs on
+#if defined(__linux__)
+TEST_CASE("worker_group::cores", "[worker groups]")
+{
+  auto groups = std::vector<bit::platform::worker_group>{
+    { "main",   1, {}, {} },
+    { "pinned", 2, { 0 }, {} },
+  };
+  bit::platform::dispatcher dispatcher( groups );
+
+  std::atomic<int>  executed{0};
+  std::atomic<bool> wrong_core{false};
+  auto started = false;
+
+  SECTION("Pins the workers of the group to its cores")
+  {
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        for( auto i = 0; i < 100; ++i ) {
+          dispatcher.post_to( 1, [&]
+          {
+            if( bit::platform::this_thread::active_core() != 0u ) wrong_core = true;
+            ++executed;
+          });
+        }
+      }
+      if( executed.load() == 100 ) dispatcher.stop();
+    });
+
+    REQUIRE_FALSE( wrong_core.load() );
+  }
+}
+#endif
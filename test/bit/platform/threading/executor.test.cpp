@@ -0,0 +1,160 @@
+/**
+ * \file executor.test.cpp
+ *
+ * \brief This file contains unit tests for any_executor
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/executor.hpp>
+
+#include <bit/platform/threading/dispatch_queue.hpp>
+#include <bit/platform/threading/dispatcher.hpp>
+#include <bit/platform/threading/serial_queue.hpp>
+#include <bit/platform/threading/thread_pool.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+//----------------------------------------------------------------------------
+// Type Traits
+//----------------------------------------------------------------------------
+
+TEST_CASE("detail::is_job_executor<Executor>", "[type traits]")
+{
+  SECTION("Is true for executors of jobs")
+  {
+    REQUIRE( bit::platform::detail::is_job_executor<bit::platform::dispatcher>::value );
+    REQUIRE( bit::platform::detail::is_job_executor<bit::platform::serial_queue>::value );
+    REQUIRE( bit::platform::detail::is_job_executor<bit::platform::dispatch_queue>::value );
+  }
+
+  SECTION("Is false for executors of tasks")
+  {
+    REQUIRE_FALSE( bit::platform::detail::is_job_executor<bit::platform::thread_pool>::value );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+TEST_CASE("any_executor::target()", "[observers]")
+{
+  bit::platform::thread_pool pool(1);
+  bit::platform::any_executor executor(pool);
+
+  SECTION("Returns the referenced executor if it is of the requested type")
+  {
+    REQUIRE( executor.target<bit::platform::thread_pool>() == &pool );
+  }
+
+  SECTION("Returns nullptr if it is not of the requested type")
+  {
+    REQUIRE( executor.target<bit::platform::dispatch_queue>() == nullptr );
+  }
+
+  SECTION("Refers to the same executor when copied")
+  {
+    const auto copy = executor;
+
+    REQUIRE( copy.target<bit::platform::thread_pool>() == &pool );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("any_executor::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  std::atomic<int> sum{0};
+
+  SECTION("Executes the function on an executor of tasks")
+  {
+    {
+      bit::platform::thread_pool pool(2);
+      bit::platform::any_executor executor(pool);
+
+      for( auto i = 0; i < count; ++i ) {
+        executor.post([&]( int value ){ sum += value; }, 1 );
+      }
+    }
+
+    REQUIRE( sum.load() == count );
+  }
+
+  SECTION("Executes the function on an executor of jobs")
+  {
+    bit::platform::dispatch_queue queue;
+    bit::platform::any_executor executor(queue);
+
+    queue.start();
+    for( auto i = 0; i < count; ++i ) {
+      executor.post([&]( int value ){ sum += value; }, 1 );
+    }
+    queue.stop();
+
+    REQUIRE( sum.load() == count );
+  }
+
+  SECTION("Moves move-only arguments into the function")
+  {
+    bit::platform::dispatch_queue queue;
+    bit::platform::any_executor executor(queue);
+
+    queue.start();
+    executor.post([&]( std::unique_ptr<int> p ){ sum = *p; }, std::make_unique<int>(5) );
+    queue.stop();
+
+    REQUIRE( sum.load() == 5 );
+  }
+}
+
+TEST_CASE("any_executor::post_and_wait( Fn&&, Args&&... )", "[modifiers]")
+{
+  SECTION("Returns the result of the function from an executor of tasks")
+  {
+    bit::platform::thread_pool pool(1);
+    bit::platform::any_executor executor(pool);
+
+    REQUIRE( executor.post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 ) == 5 );
+  }
+
+  SECTION("Returns the result of the function from an executor of jobs")
+  {
+    bit::platform::dispatch_queue queue;
+    bit::platform::any_executor executor(queue);
+
+    queue.start();
+    const auto result = executor.post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 );
+    queue.stop();
+
+    REQUIRE( result == 5 );
+  }
+
+  SECTION("Returns references to the caller")
+  {
+    bit::platform::thread_pool pool(1);
+    bit::platform::any_executor executor(pool);
+    auto value = 0;
+
+    auto& result = executor.post_and_wait([&]() -> int& { return value; } );
+
+    REQUIRE( &result == &value );
+  }
+
+  SECTION("Rethrows an exception thrown by the function")
+  {
+    bit::platform::thread_pool pool(1);
+    bit::platform::any_executor executor(pool);
+
+    REQUIRE_THROWS_AS( executor.post_and_wait([]{ throw std::runtime_error("error"); }),
+                       std::runtime_error );
+  }
+}
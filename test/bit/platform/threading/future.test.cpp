@@ -0,0 +1,400 @@
+/**
+ * \file future.test.cpp
+ *
+ * \brief This file contains unit tests for future and promise
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/future.hpp>
+#include <bit/platform/threading/thread_pool.hpp>
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// promise
+//----------------------------------------------------------------------------
+
+TEST_CASE("promise::set_value( Args&&... )", "[modifiers]")
+{
+  auto p = bit::platform::promise<std::string>{};
+  auto f = p.get_future();
+
+  REQUIRE( f.valid() );
+  REQUIRE_FALSE( f.ready() );
+
+  p.set_value( 3u, 'a' );
+
+  SECTION("Makes the future ready")
+  {
+    REQUIRE( f.ready() );
+  }
+
+  SECTION("Stores the value constructed from the arguments")
+  {
+    REQUIRE( f.get() == "aaa" );
+  }
+}
+
+TEST_CASE("promise::set_exception( std::exception_ptr )", "[modifiers]")
+{
+  auto p = bit::platform::promise<int>{};
+  auto f = p.get_future();
+
+  p.set_exception( std::make_exception_ptr( std::runtime_error("error") ) );
+
+  SECTION("Makes the future ready")
+  {
+    REQUIRE( f.ready() );
+  }
+
+  SECTION("Rethrows the exception from get")
+  {
+    REQUIRE_THROWS_AS( f.get(), std::runtime_error );
+  }
+}
+
+TEST_CASE("promise::~promise()", "[dtor]")
+{
+  auto f = bit::platform::future<int>{};
+  {
+    auto p = bit::platform::promise<int>{};
+    f = p.get_future();
+  }
+
+  SECTION("Breaks the promise if no result was stored")
+  {
+    REQUIRE( f.ready() );
+    REQUIRE_THROWS_AS( f.get(), std::future_error );
+  }
+}
+
+//----------------------------------------------------------------------------
+// future : Waiting
+//----------------------------------------------------------------------------
+
+TEST_CASE("future::wait()", "[waiting]")
+{
+  auto p = bit::platform::promise<int>{};
+  auto f = p.get_future();
+
+  auto thread = std::thread([&]
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+    p.set_value( 42 );
+  });
+  f.wait();
+
+  REQUIRE( f.ready() );
+  REQUIRE( f.get() == 42 );
+
+  thread.join();
+}
+
+TEST_CASE("future::wait_for( const duration& )", "[waiting]")
+{
+  auto p = bit::platform::promise<void>{};
+  auto f = p.get_future();
+
+  SECTION("Returns false if the timeout elapses first")
+  {
+    REQUIRE_FALSE( f.wait_for( std::chrono::milliseconds(5) ) );
+  }
+
+  SECTION("Returns true once the result is available")
+  {
+    p.set_value();
+
+    REQUIRE( f.wait_for( std::chrono::milliseconds(5) ) );
+  }
+}
+
+//----------------------------------------------------------------------------
+// future : Continuations
+//----------------------------------------------------------------------------
+
+TEST_CASE("future::then( Fn&& )", "[continuations]")
+{
+  using future_type = bit::platform::future<int>;
+
+  SECTION("Invokes the continuation once the result is stored")
+  {
+    auto p = bit::platform::promise<int>{};
+    auto f = p.get_future().then([]( future_type f ){ return f.get() * 2; });
+
+    REQUIRE_FALSE( f.ready() );
+
+    p.set_value( 21 );
+
+    REQUIRE( f.get() == 42 );
+  }
+
+  SECTION("Invokes the continuation immediately for a ready future")
+  {
+    auto f = bit::platform::make_ready_future( 21 ).then([]( future_type f ){ return f.get() * 2; });
+
+    REQUIRE( f.ready() );
+    REQUIRE( f.get() == 42 );
+  }
+
+  SECTION("Leaves the future without a shared state")
+  {
+    auto f = bit::platform::make_ready_future( 1 );
+    auto g = f.then([]( future_type f ){ return f.get(); });
+
+    REQUIRE_FALSE( f.valid() );
+  }
+
+  SECTION("Chains continuations")
+  {
+    auto p = bit::platform::promise<int>{};
+    auto f = p.get_future()
+      .then([]( future_type f ){ return f.get() + 1; })
+      .then([]( future_type f ){ return std::to_string( f.get() ); });
+
+    p.set_value( 41 );
+
+    REQUIRE( f.get() == "42" );
+  }
+
+  SECTION("Propagates an exception from the antecedent through get")
+  {
+    auto p = bit::platform::promise<int>{};
+    auto f = p.get_future()
+      .then([]( future_type f ){ return f.get() + 1; })
+      .then([]( future_type f ){ return f.get() + 1; });
+
+    p.set_exception( std::make_exception_ptr( std::runtime_error("error") ) );
+
+    REQUIRE_THROWS_AS( f.get(), std::runtime_error );
+  }
+
+  SECTION("Stores an exception thrown by the continuation")
+  {
+    auto f = bit::platform::make_ready_future( 1 ).then([]( future_type ) -> int
+    {
+      throw std::logic_error("error");
+    });
+
+    REQUIRE_THROWS_AS( f.get(), std::logic_error );
+  }
+
+  SECTION("Invokes the continuation when the result is stored on another thread")
+  {
+    auto p = bit::platform::promise<int>{};
+    auto f = p.get_future().then([]( future_type f ){ return f.get() * 2; });
+
+    auto thread = std::thread([&]{ p.set_value( 21 ); });
+
+    REQUIRE( f.get() == 42 );
+
+    thread.join();
+  }
+}
+
+TEST_CASE("future::then( Executor&, Fn&& )", "[continuations]")
+{
+  using future_type = bit::platform::future<int>;
+
+  bit::platform::thread_pool pool(1);
+  const auto worker = pool.post_and_wait([]{ return std::this_thread::get_id(); });
+
+  auto p = bit::platform::promise<int>{};
+  auto f = p.get_future().then( pool, []( future_type f )
+  {
+    return std::make_pair( f.get(), std::this_thread::get_id() );
+  });
+  p.set_value( 42 );
+
+  const auto result = f.get();
+
+  SECTION("Runs the continuation on the executor")
+  {
+    REQUIRE( result.first == 42 );
+    REQUIRE( result.second == worker );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Factories
+//----------------------------------------------------------------------------
+
+TEST_CASE("make_ready_future( T&& )", "[factories]")
+{
+  auto f = bit::platform::make_ready_future( std::string("value") );
+
+  REQUIRE( f.ready() );
+  REQUIRE( f.get() == "value" );
+}
+
+TEST_CASE("make_exceptional_future( std::exception_ptr )", "[factories]")
+{
+  auto f = bit::platform::make_exceptional_future<int>( std::make_exception_ptr( std::runtime_error("error") ) );
+
+  REQUIRE( f.ready() );
+  REQUIRE_THROWS_AS( f.get(), std::runtime_error );
+}
+
+//----------------------------------------------------------------------------
+// Combinators
+//----------------------------------------------------------------------------
+
+TEST_CASE("when_all( Futures&&... )", "[combinators]")
+{
+  auto p1 = bit::platform::promise<int>{};
+  auto p2 = bit::platform::promise<std::string>{};
+
+  auto all = bit::platform::when_all( p1.get_future(), p2.get_future() );
+
+  SECTION("Becomes ready only once every future is ready")
+  {
+    p1.set_value( 1 );
+
+    REQUIRE_FALSE( all.ready() );
+
+    p2.set_value( "2" );
+    auto result = all.get();
+
+    REQUIRE( std::get<0>(result).get() == 1 );
+    REQUIRE( std::get<1>(result).get() == "2" );
+  }
+
+  SECTION("Holds a future that failed, rather than failing itself")
+  {
+    p1.set_exception( std::make_exception_ptr( std::runtime_error("error") ) );
+    p2.set_value( "2" );
+    auto result = all.get();
+
+    REQUIRE_THROWS_AS( std::get<0>(result).get(), std::runtime_error );
+    REQUIRE( std::get<1>(result).get() == "2" );
+  }
+}
+
+TEST_CASE("when_all( InputIt, InputIt )", "[combinators]")
+{
+  static constexpr auto count = 100;
+
+  SECTION("Holds every future, in order, once all are ready")
+  {
+    auto promises = std::vector<bit::platform::promise<int>>(count);
+    auto futures  = std::vector<bit::platform::future<int>>{};
+    for( auto& p : promises ) {
+      futures.push_back( p.get_future() );
+    }
+
+    auto all = bit::platform::when_all( futures.begin(), futures.end() );
+
+    // Fulfilled in reverse, from another thread
+    auto thread = std::thread([&]
+    {
+      for( auto i = count; i > 0; --i ) {
+        promises[i-1].set_value( i - 1 );
+      }
+    });
+    auto result = all.get();
+    thread.join();
+
+    REQUIRE( result.size() == std::size_t{count} );
+    for( auto i = 0; i < count; ++i ) {
+      REQUIRE( result[i].get() == i );
+    }
+  }
+
+  SECTION("Is ready immediately for an empty range")
+  {
+    auto futures = std::vector<bit::platform::future<int>>{};
+    auto all = bit::platform::when_all( futures.begin(), futures.end() );
+
+    REQUIRE( all.ready() );
+    REQUIRE( all.get().empty() );
+  }
+}
+
+TEST_CASE("when_any( InputIt, InputIt )", "[combinators]")
+{
+  SECTION("Holds the first future to become ready, and its index")
+  {
+    auto promises = std::vector<bit::platform::promise<int>>(3);
+    auto futures  = std::vector<bit::platform::future<int>>{};
+    for( auto& p : promises ) {
+      futures.push_back( p.get_future() );
+    }
+
+    auto any = bit::platform::when_any( futures.begin(), futures.end() );
+
+    REQUIRE_FALSE( any.ready() );
+
+    promises[1].set_value( 42 );
+    promises[0].set_value( 0 );
+    auto result = any.get();
+
+    REQUIRE( result.index == 1u );
+    REQUIRE( result.result.get() == 42 );
+  }
+
+  SECTION("Holds an invalid future for an empty range")
+  {
+    auto futures = std::vector<bit::platform::future<int>>{};
+    auto result  = bit::platform::when_any( futures.begin(), futures.end() ).get();
+
+    REQUIRE( result.index == static_cast<std::size_t>(-1) );
+    REQUIRE_FALSE( result.result.valid() );
+  }
+}
+
+TEST_CASE("when_any( future<T>&&, Futures&&... )", "[combinators]")
+{
+  auto p1 = bit::platform::promise<int>{};
+  auto p2 = bit::platform::promise<int>{};
+
+  auto any = bit::platform::when_any( p1.get_future(), p2.get_future() );
+  p2.set_exception( std::make_exception_ptr( std::runtime_error("error") ) );
+  auto result = any.get();
+
+  SECTION("Holds the first future to become ready, even if it failed")
+  {
+    REQUIRE( result.index == 1u );
+    REQUIRE_THROWS_AS( result.result.get(), std::runtime_error );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Execution
+//----------------------------------------------------------------------------
+
+TEST_CASE("post_async( Executor&, Fn&&, Args&&... )", "[execution]")
+{
+  bit::platform::thread_pool pool(2);
+
+  SECTION("Holds the result of the function")
+  {
+    auto f = bit::platform::post_async( pool, []( int a, int b ){ return a + b; }, 2, 3 );
+
+    REQUIRE( f.get() == 5 );
+  }
+
+  SECTION("Holds the exception thrown by the function")
+  {
+    auto f = bit::platform::post_async( pool, []() -> int { throw std::runtime_error("error"); } );
+
+    REQUIRE_THROWS_AS( f.get(), std::runtime_error );
+  }
+
+  SECTION("Copies the arguments")
+  {
+    auto value = std::make_shared<int>(42);
+    auto f = bit::platform::post_async( pool, []( std::shared_ptr<int> p ){ return *p; }, value );
+
+    REQUIRE( f.get() == 42 );
+  }
+}
@@ -0,0 +1,283 @@
+/**
+ * \file job.test.cpp
+ *
+ * \brief This file contains unit tests for job
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/job.hpp>
+
+#include <catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+TEST_CASE("job::job()", "[ctor]")
+{
+  auto j = bit::platform::job{};
+
+  SECTION("Is null")
+  {
+    REQUIRE_FALSE( static_cast<bool>(j) );
+    REQUIRE( j == nullptr );
+  }
+}
+
+TEST_CASE("job::job( Fn&&, Args&&... )", "[ctor]")
+{
+  SECTION("Is not null")
+  {
+    auto j = bit::platform::make_job([]{});
+
+    REQUIRE( static_cast<bool>(j) );
+    REQUIRE( j != nullptr );
+    REQUIRE( j.available() );
+    REQUIRE_FALSE( j.completed() );
+  }
+
+  SECTION("Destroys the stored arguments with the job")
+  {
+    auto value = std::make_shared<int>(0);
+    {
+      auto j = bit::platform::make_job([]( const std::shared_ptr<int>& ){}, value );
+
+      REQUIRE( value.use_count() == 2 );
+    }
+    REQUIRE( value.use_count() == 1 );
+  }
+
+  SECTION("Destroys arguments that are too large to store inline")
+  {
+    auto value = std::make_shared<int>(0);
+    auto large = std::array<char,256>{};
+    {
+      auto j = bit::platform::make_job([]( const std::shared_ptr<int>&, const std::array<char,256>& ){}, value, large );
+
+      REQUIRE( value.use_count() == 2 );
+    }
+    REQUIRE( value.use_count() == 1 );
+  }
+}
+
+TEST_CASE("job::job( const job&, Fn&&, Args&&... )", "[ctor]")
+{
+  auto parent = bit::platform::make_job([]{});
+  auto handle = bit::platform::job_handle(parent);
+
+  SECTION("Makes the parent unavailable until the child is finished")
+  {
+    {
+      auto child = bit::platform::make_job( parent, []{} );
+
+      REQUIRE_FALSE( parent.available() );
+      child.execute();
+    }
+    REQUIRE( parent.available() );
+  }
+
+  SECTION("Completes the parent once both it and the child are finished")
+  {
+    auto child = bit::platform::make_job( parent, []{} );
+    parent = bit::platform::job{};
+
+    REQUIRE_FALSE( handle.completed() );
+
+    child = bit::platform::job{};
+
+    REQUIRE( handle.completed() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Execution
+//----------------------------------------------------------------------------
+
+TEST_CASE("job::execute()", "[execution]")
+{
+  SECTION("Invokes the function with the stored arguments")
+  {
+    auto sum = 0;
+    auto j = bit::platform::make_job([&]( int a, int b ){ sum = a + b; }, 2, 3 );
+    j.execute();
+
+    REQUIRE( sum == 5 );
+  }
+
+  SECTION("Invokes a std::function stored in the job")
+  {
+    auto called = false;
+    auto fn = std::function<void()>([&]{ called = true; });
+    auto j  = bit::platform::make_job( std::move(fn) );
+    j.execute();
+
+    REQUIRE( called );
+  }
+
+  SECTION("Invokes a function with arguments that are too large to store inline")
+  {
+    auto large = std::array<int,64>{};
+    large.back() = 42;
+
+    auto result = 0;
+    auto j = bit::platform::make_job([&]( const std::array<int,64>& a ){ result = a.back(); }, large );
+    j.execute();
+
+    REQUIRE( result == 42 );
+  }
+
+  SECTION("Sets the active job while executing")
+  {
+    auto active = static_cast<const bit::platform::job*>(nullptr);
+    auto j = bit::platform::make_job([&]{ active = bit::platform::this_job(); });
+    j.execute();
+
+    REQUIRE( active == &j );
+    REQUIRE( bit::platform::this_job() == nullptr );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Waiting
+//----------------------------------------------------------------------------
+
+TEST_CASE("job_handle::wait()", "[waiting]")
+{
+  SECTION("Returns immediately for a completed job")
+  {
+    auto handle = bit::platform::job_handle{};
+    {
+      auto j = bit::platform::make_job([]{});
+      handle = bit::platform::job_handle(j);
+    }
+    handle.wait();
+
+    REQUIRE( handle.completed() );
+  }
+
+  SECTION("Returns once the job and its children are finished on other threads")
+  {
+    auto parent = bit::platform::make_job([]{});
+    auto child  = bit::platform::make_job( parent, []{} );
+    auto handle = bit::platform::job_handle(parent);
+
+    auto parent_thread = std::thread([j = std::move(parent)]{ j.execute(); });
+    auto child_thread  = std::thread([j = std::move(child)]
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+      j.execute();
+    });
+    handle.wait();
+
+    REQUIRE( handle.completed() );
+
+    parent_thread.join();
+    child_thread.join();
+  }
+}
+
+//----------------------------------------------------------------------------
+// Intrusive Queueing
+//----------------------------------------------------------------------------
+
+TEST_CASE("detail::release_job( job&& )", "[intrusive]")
+{
+  bit::platform::detail::mpsc_queue queue;
+  auto order = std::vector<int>{};
+
+  SECTION("Pops nothing from an empty queue")
+  {
+    REQUIRE( queue.empty() );
+    REQUIRE( queue.pop() == nullptr );
+  }
+
+  SECTION("Leaves the released job null")
+  {
+    auto j = bit::platform::make_job([]{});
+    queue.push( bit::platform::detail::release_job( std::move(j) ) );
+
+    REQUIRE( j == nullptr );
+    REQUIRE_FALSE( queue.empty() );
+
+    bit::platform::detail::acquire_job( queue.pop() );
+  }
+
+  SECTION("Pops jobs in the order they were pushed")
+  {
+    for( auto i = 0; i < 3; ++i ) {
+      auto j = bit::platform::make_job([&order]( int value ){ order.push_back( value ); }, i );
+      queue.push( bit::platform::detail::release_job( std::move(j) ) );
+    }
+    while( auto* node = queue.pop() ) {
+      bit::platform::detail::acquire_job( node ).execute();
+    }
+
+    REQUIRE( order == (std::vector<int>{ 0, 1, 2 }) );
+    REQUIRE( queue.empty() );
+  }
+
+  SECTION("Completes the job once it is acquired and destroyed")
+  {
+    auto j = bit::platform::make_job([]{});
+    auto handle = bit::platform::job_handle(j);
+
+    queue.push( bit::platform::detail::release_job( std::move(j) ) );
+
+    REQUIRE_FALSE( handle.completed() );
+
+    bit::platform::detail::acquire_job( queue.pop() );
+
+    REQUIRE( handle.completed() );
+  }
+}
+
+TEST_CASE("detail::mpsc_queue with multiple producers", "[intrusive]")
+{
+  static constexpr auto producers = 4;
+  static constexpr auto count     = 1000;
+
+  bit::platform::detail::mpsc_queue queue;
+  auto next = std::vector<int>(producers,0);
+  auto ordered  = true;
+  auto executed = 0;
+
+  auto threads = std::vector<std::thread>{};
+  for( auto p = 0; p < producers; ++p ) {
+    threads.emplace_back([&,p]
+    {
+      for( auto i = 0; i < count; ++i ) {
+        auto j = bit::platform::make_job([&,p,i]
+        {
+          if( next[p]++ != i ) ordered = false;
+        });
+        queue.push( bit::platform::detail::release_job( std::move(j) ) );
+      }
+    });
+  }
+
+  // A push in progress may pop nothing while the queue is not empty
+  while( executed != producers * count ) {
+    if( auto* node = queue.pop() ) {
+      bit::platform::detail::acquire_job( node ).execute();
+      ++executed;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for( auto& thread : threads ) {
+    thread.join();
+  }
+
+  REQUIRE( ordered );
+  REQUIRE( queue.empty() );
+}
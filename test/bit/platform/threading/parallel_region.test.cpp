@@ -0,0 +1,318 @@
+/**
+ * \file parallel_region.test.cpp
+ *
+ * \brief This file contains unit tests for parallel_region
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/parallel_region.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// Runs a parallel_region of up to \p team_size members on a dispatcher
+  /// with \p threads workers, invoking \p fn on each member
+  template<typename Fn>
+  void run_region( std::size_t threads, std::size_t team_size, Fn&& fn )
+  {
+    bit::platform::dispatcher dispatcher(threads);
+
+    dispatcher.run([&]
+    {
+      bit::platform::parallel_region( dispatcher, team_size, fn );
+      dispatcher.stop();
+    });
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Free Functions
+//----------------------------------------------------------------------------
+
+TEST_CASE("parallel_region( dispatcher&, std::size_t, Fn&& )", "[free]")
+{
+  static constexpr auto team_size = 4u;
+
+  SECTION("Forms a team of at most the requested size")
+  {
+    std::atomic<std::size_t> members{0};
+    std::atomic<std::size_t> size{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      ++members;
+      size = team.size();
+    });
+
+    REQUIRE( size.load() >= 1u );
+    REQUIRE( size.load() <= team_size );
+    REQUIRE( members.load() == size.load() );
+  }
+
+  SECTION("Gives each member a unique index")
+  {
+    auto seen = std::vector<std::atomic<int>>(team_size);
+    std::atomic<std::size_t> size{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      ++seen[team.index()];
+      size = team.size();
+    });
+
+    for( auto i = std::size_t{0}; i < team_size; ++i ) {
+      REQUIRE( seen[i].load() == (i < size.load() ? 1 : 0) );
+    }
+  }
+
+  SECTION("Runs the calling thread as the member at index 0")
+  {
+    const auto caller = std::this_thread::get_id();
+    std::atomic<bool> matched{false};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      if( team.index() == 0u ) matched = (std::this_thread::get_id() == caller);
+    });
+
+    REQUIRE( matched.load() );
+  }
+
+  SECTION("Runs on the calling thread alone with a team size of 1")
+  {
+    std::atomic<std::size_t> members{0};
+    std::atomic<std::size_t> size{0};
+
+    run_region( 3u, 1u, [&]( bit::platform::team& team )
+    {
+      ++members;
+      size = team.size();
+    });
+
+    REQUIRE( members.load() == 1u );
+    REQUIRE( size.load() == 1u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Synchronization
+//----------------------------------------------------------------------------
+
+TEST_CASE("team::barrier()", "[synchronization]")
+{
+  static constexpr auto team_size  = 4u;
+  static constexpr auto iterations = 200;
+
+  SECTION("Waits for every member to arrive before any continues")
+  {
+    auto phases = std::vector<std::atomic<int>>(team_size);
+    std::atomic<bool> early{false};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      for( auto i = 1; i <= iterations; ++i ) {
+        phases[team.index()].store( i );
+        team.barrier();
+
+        for( auto m = std::size_t{0}; m < team.size(); ++m ) {
+          if( phases[m].load() < i ) early = true;
+        }
+        team.barrier();
+      }
+    });
+
+    REQUIRE_FALSE( early.load() );
+  }
+}
+
+TEST_CASE("team::single( Fn&& )", "[synchronization]")
+{
+  static constexpr auto team_size  = 4u;
+  static constexpr auto iterations = 200;
+
+  SECTION("Invokes the function on exactly one member")
+  {
+    std::atomic<int> calls{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      for( auto i = 0; i < iterations; ++i ) {
+        team.single([&]{ ++calls; });
+      }
+    });
+
+    REQUIRE( calls.load() == iterations );
+  }
+
+  SECTION("Makes the result visible to every member once it returns")
+  {
+    auto value = 0;
+    std::atomic<bool> stale{false};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      for( auto i = 1; i <= iterations; ++i ) {
+        team.single([&]{ value = i; });
+
+        if( value != i ) stale = true;
+        team.barrier();
+      }
+    });
+
+    REQUIRE_FALSE( stale.load() );
+    REQUIRE( value == iterations );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Work Sharing
+//----------------------------------------------------------------------------
+
+TEST_CASE("team::for_static( Integer, Integer, Fn&& )", "[work sharing]")
+{
+  static constexpr auto team_size = 4u;
+  static constexpr auto count     = 1001;
+
+  SECTION("Invokes the function with every index exactly once")
+  {
+    auto visits = std::vector<std::atomic<int>>(count);
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      team.for_static( 0, count, [&]( int i ){ ++visits[i]; } );
+    });
+
+    auto once = true;
+    for( auto& v : visits ) {
+      once = once && (v.load() == 1);
+    }
+    REQUIRE( once );
+  }
+
+  SECTION("Divides the range into one contiguous block per member")
+  {
+    auto owners = std::vector<std::atomic<std::size_t>>(count);
+    std::atomic<std::size_t> size{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      size = team.size();
+      team.for_static( 0, count, [&]( int i ){ owners[i] = team.index(); } );
+    });
+
+    auto ordered = true;
+    for( auto i = 1; i < count; ++i ) {
+      ordered = ordered && (owners[i - 1].load() <= owners[i].load());
+    }
+    REQUIRE( ordered );
+    REQUIRE( owners[count - 1].load() < size.load() );
+  }
+
+  SECTION("Offsets the indices by the first index")
+  {
+    std::atomic<long> sum{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      team.for_static( 10, 20, [&]( int i ){ sum += i; } );
+    });
+
+    REQUIRE( sum.load() == 145 );
+  }
+
+  SECTION("Invokes nothing for an empty range")
+  {
+    std::atomic<int> calls{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      team.for_static( 5, 5, [&]( int ){ ++calls; } );
+      team.for_static( 5, 0, [&]( int ){ ++calls; } );
+    });
+
+    REQUIRE( calls.load() == 0 );
+  }
+
+  SECTION("Completes every index before any member continues")
+  {
+    static constexpr auto iterations = 50;
+
+    auto values = std::vector<std::atomic<int>>(count);
+    std::atomic<bool> early{false};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      for( auto n = 1; n <= iterations; ++n ) {
+        team.for_static( 0, count, [&]( int i ){ values[i].store( n ); } );
+
+        team.for_static( 0, count, [&]( int i )
+        {
+          if( values[(i + 1) % count].load() < n ) early = true;
+        });
+      }
+    });
+
+    REQUIRE_FALSE( early.load() );
+  }
+}
+
+TEST_CASE("team::for_static( Integer, Integer, Integer, Fn&& )", "[work sharing]")
+{
+  static constexpr auto team_size = 4u;
+  static constexpr auto count     = 1001;
+  static constexpr auto chunk     = 16;
+
+  SECTION("Invokes the function with every index exactly once")
+  {
+    auto visits = std::vector<std::atomic<int>>(count);
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      team.for_static( 0, count, chunk, [&]( int i ){ ++visits[i]; } );
+    });
+
+    auto once = true;
+    for( auto& v : visits ) {
+      once = once && (v.load() == 1);
+    }
+    REQUIRE( once );
+  }
+
+  SECTION("Deals the chunks to the members in a round-robin")
+  {
+    auto owners = std::vector<std::atomic<std::size_t>>(count);
+    std::atomic<std::size_t> size{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      size = team.size();
+      team.for_static( 0, count, chunk, [&]( int i ){ owners[i] = team.index(); } );
+    });
+
+    auto dealt = true;
+    for( auto i = 0; i < count; ++i ) {
+      dealt = dealt && (owners[i].load() == (static_cast<std::size_t>(i / chunk) % size.load()));
+    }
+    REQUIRE( dealt );
+  }
+
+  SECTION("Handles a chunk larger than the range")
+  {
+    std::atomic<int> calls{0};
+
+    run_region( 3u, team_size, [&]( bit::platform::team& team )
+    {
+      team.for_static( 0, 10, 100, [&]( int ){ ++calls; } );
+    });
+
+    REQUIRE( calls.load() == 10 );
+  }
+}
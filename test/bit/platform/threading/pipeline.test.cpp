@@ -0,0 +1,234 @@
+/**
+ * \file pipeline.test.cpp
+ *
+ * \brief This file contains unit tests for pipeline
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/pipeline.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using stage_mode = bit::platform::stage_mode;
+
+  /// A source that produces the integers [0,count)
+  struct counter_source
+  {
+    int* next;
+    int  count;
+
+    int operator()( bit::platform::flow_control& control )
+    {
+      if( *next == count ) control.stop();
+      return (*next)++;
+    }
+  };
+
+  /// A file that reads from a string, a few bytes at a time
+  struct string_file
+  {
+    std::string contents;
+    std::size_t offset;
+
+    bit::stl::span<char> read( bit::stl::span<char> buffer )
+    {
+      const auto size = std::min( static_cast<std::size_t>(buffer.size()),
+                                  contents.size() - offset );
+
+      std::memcpy( buffer.data(), contents.data() + offset, size );
+      offset += size;
+
+      return bit::stl::span<char>( buffer.data(), static_cast<std::ptrdiff_t>(size) );
+    }
+  };
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("pipeline::run()", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  bit::platform::dispatcher dispatcher(4);
+  auto next = 0;
+
+  SECTION("Passes every token through every stage")
+  {
+    std::atomic<int> sum{0};
+
+    dispatcher.run([&]
+    {
+      bit::platform::make_pipeline( dispatcher, 8, counter_source{ &next, count } )
+        .then( stage_mode::parallel, []( int value ){ return value * 2; } )
+        .then( stage_mode::parallel, [&]( int value ){ sum += value; } )
+        .run();
+      dispatcher.stop();
+    });
+
+    REQUIRE( sum.load() == count * (count - 1) );
+  }
+
+  SECTION("Executes serial in-order stages in the order tokens were produced")
+  {
+    auto order = std::vector<int>{};
+
+    dispatcher.run([&]
+    {
+      bit::platform::make_pipeline( dispatcher, 8, counter_source{ &next, count } )
+        .then( stage_mode::parallel, []( int value ){ return value; } )
+        .then( stage_mode::serial_in_order, [&]( int value ){ order.push_back( value ); } )
+        .run();
+      dispatcher.stop();
+    });
+
+    auto expected = std::vector<int>(count);
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE( order == expected );
+  }
+
+  SECTION("Executes serial out-of-order stages one token at a time")
+  {
+    std::atomic<int>  running{0};
+    std::atomic<bool> overlapped{false};
+    auto values = std::vector<int>{};
+
+    dispatcher.run([&]
+    {
+      bit::platform::make_pipeline( dispatcher, 8, counter_source{ &next, count } )
+        .then( stage_mode::serial_out_of_order, [&]( int value )
+        {
+          if( ++running != 1 ) overlapped = true;
+          values.push_back( value );
+          --running;
+        })
+        .run();
+      dispatcher.stop();
+    });
+
+    std::sort( values.begin(), values.end() );
+
+    auto expected = std::vector<int>(count);
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE_FALSE( overlapped.load() );
+    REQUIRE( values == expected );
+  }
+
+  SECTION("Never has more than max_tokens tokens in flight")
+  {
+    static constexpr auto max_tokens = 4;
+
+    std::atomic<int> in_flight{0};
+    std::atomic<int> peak{0};
+
+    dispatcher.run([&]
+    {
+      bit::platform::make_pipeline( dispatcher, max_tokens, [&]( bit::platform::flow_control& control )
+      {
+        if( next == count ) control.stop();
+
+        const auto current = ++in_flight;
+        auto previous = peak.load();
+        while( previous < current && !peak.compare_exchange_weak( previous, current ) ) {
+          // retry with the updated peak
+        }
+        return next++;
+      })
+        .then( stage_mode::parallel, []( int value ){ return value; } )
+        .then( stage_mode::serial_in_order, [&]( int ){ --in_flight; } )
+        .run();
+      dispatcher.stop();
+    });
+
+    // The value produced alongside stop is discarded without leaving the
+    // last stage, so it is the only token still counted
+    REQUIRE( in_flight.load() == 1 );
+    REQUIRE( peak.load() <= max_tokens );
+  }
+
+  SECTION("Rethrows the first exception once every token has left")
+  {
+    auto caught = false;
+    std::atomic<int> completed{0};
+
+    dispatcher.run([&]
+    {
+      try {
+        bit::platform::make_pipeline( dispatcher, 8, counter_source{ &next, count } )
+          .then( stage_mode::parallel, []( int value )
+          {
+            if( value == 10 ) throw std::runtime_error("error");
+            return value;
+          })
+          .then( stage_mode::serial_in_order, [&]( int ){ ++completed; } )
+          .run();
+      } catch( const std::runtime_error& ) {
+        caught = true;
+      }
+      dispatcher.stop();
+    });
+
+    REQUIRE( caught );
+    REQUIRE( completed.load() < count );
+  }
+
+  SECTION("Can be run more than once")
+  {
+    std::atomic<int> total{0};
+
+    dispatcher.run([&]
+    {
+      auto pipeline = bit::platform::make_pipeline( dispatcher, 8, counter_source{ &next, count } )
+        .then( stage_mode::parallel, [&]( int ){ ++total; } );
+
+      pipeline.run();
+      next = 0;
+      pipeline.run();
+      dispatcher.stop();
+    });
+
+    REQUIRE( total.load() == 2 * count );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Sources
+//----------------------------------------------------------------------------
+
+TEST_CASE("read_from( File& )", "[sources]")
+{
+  bit::platform::dispatcher dispatcher(2);
+  auto file   = string_file{ "the quick brown fox jumps over the lazy dog", 0u };
+  auto result = std::string{};
+  auto largest = std::ptrdiff_t{0};
+
+  dispatcher.run([&]
+  {
+    bit::platform::make_pipeline( dispatcher, 4, bit::platform::read_from( file ), 5 )
+      .then( stage_mode::serial_in_order, [&]( bit::stl::span<char> chunk )
+      {
+        largest = std::max( largest, static_cast<std::ptrdiff_t>(chunk.size()) );
+        result.append( chunk.data(), static_cast<std::size_t>(chunk.size()) );
+      })
+      .run();
+    dispatcher.stop();
+  });
+
+  REQUIRE( result == file.contents );
+  REQUIRE( largest == 5 );
+}
@@ -0,0 +1,177 @@
+/**
+ * \file serial_queue.test.cpp
+ *
+ * \brief This file contains unit tests for serial_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/serial_queue.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("serial_queue::serial_queue( dispatcher&, size_type )", "[ctor]")
+{
+  bit::platform::dispatcher dispatcher(1);
+
+  SECTION("Uses the specified batch size")
+  {
+    bit::platform::serial_queue queue(dispatcher,8);
+
+    REQUIRE( queue.batch_size() == 8u );
+    REQUIRE( &queue.get_dispatcher() == &dispatcher );
+  }
+
+  SECTION("Uses a batch size of at least 1")
+  {
+    bit::platform::serial_queue queue(dispatcher,0);
+
+    REQUIRE( queue.batch_size() == 1u );
+  }
+
+  // A dispatcher can only be destroyed on the thread that ran it
+  dispatcher.run([&]{ dispatcher.stop(); });
+}
+
+TEST_CASE("serial_queue::~serial_queue()", "[dtor]")
+{
+  static constexpr auto count = 100;
+
+  bit::platform::dispatcher dispatcher(2);
+  std::atomic<int>  executed{0};
+  std::atomic<bool> destroyed{false};
+  auto started = false;
+
+  dispatcher.run([&]
+  {
+    if( !started ) {
+      started = true;
+      dispatcher.post([&]
+      {
+        {
+          bit::platform::serial_queue queue(dispatcher,4);
+          for( auto i = 0; i < count; ++i ) {
+            queue.post([&]{ ++executed; });
+          }
+        }
+        destroyed = true;
+      });
+    }
+    if( destroyed.load() ) dispatcher.stop();
+  });
+
+  SECTION("Executes every outstanding job before returning")
+  {
+    REQUIRE( executed.load() == count );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("serial_queue::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  static constexpr auto count = 1000;
+
+  bit::platform::dispatcher dispatcher(2);
+
+  SECTION("Executes jobs in the order they were posted")
+  {
+    // A small batch, so that the drain defers itself many times
+    bit::platform::serial_queue queue(dispatcher,8);
+    auto order = std::vector<int>{};
+    std::atomic<int> executed{0};
+    auto started = false;
+
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        for( auto i = 0; i < count; ++i ) {
+          queue.post([&]( int value )
+          {
+            order.push_back( value );
+            ++executed;
+          }, i );
+        }
+      }
+      if( executed.load() == count ) dispatcher.stop();
+    });
+
+    auto expected = std::vector<int>(count);
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE( order == expected );
+  }
+
+  SECTION("Executes one job at a time, in order per producer")
+  {
+    static constexpr auto producers = 4;
+
+    bit::platform::serial_queue queue(dispatcher);
+    auto next = std::vector<int>(producers,0);
+    std::atomic<int>  running{0};
+    std::atomic<int>  executed{0};
+    std::atomic<bool> overlapped{false};
+    std::atomic<bool> ordered{true};
+    auto started = false;
+
+    dispatcher.run([&]
+    {
+      if( !started ) {
+        started = true;
+        for( auto p = 0; p < producers; ++p ) {
+          dispatcher.post([&,p]
+          {
+            for( auto i = 0; i < count; ++i ) {
+              queue.post([&,p,i]
+              {
+                if( ++running != 1 ) overlapped = true;
+                if( next[p]++ != i ) ordered = false;
+                --running;
+                ++executed;
+              });
+            }
+          });
+        }
+      }
+      if( executed.load() == producers * count ) dispatcher.stop();
+    });
+
+    REQUIRE_FALSE( overlapped.load() );
+    REQUIRE( ordered.load() );
+  }
+}
+
+TEST_CASE("serial_queue::wait( job_handle )", "[modifiers]")
+{
+  bit::platform::dispatcher dispatcher(1);
+  bit::platform::serial_queue queue(dispatcher);
+  std::atomic<bool> completed{false};
+  auto started = false;
+
+  dispatcher.run([&]
+  {
+    if( !started ) {
+      started = true;
+      auto j = bit::platform::make_job([]{});
+      auto handle = bit::platform::job_handle(j);
+
+      queue.post_job( std::move(j) );
+      queue.wait( handle );
+      completed = handle.completed();
+    }
+    if( completed.load() ) dispatcher.stop();
+  });
+
+  REQUIRE( completed.load() );
+}
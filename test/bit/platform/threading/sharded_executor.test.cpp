@@ -0,0 +1,284 @@
+/**
+ * \file sharded_executor.test.cpp
+ *
+ * \brief This file contains unit tests for sharded_executor
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/sharded_executor.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Constructors / Destructor
+//----------------------------------------------------------------------------
+
+TEST_CASE("sharded_executor::sharded_executor( std::size_t, std::size_t )", "[ctor]")
+{
+  bit::platform::sharded_executor executor(3);
+
+  SECTION("Creates the specified number of shards")
+  {
+    REQUIRE( executor.size() == 3u );
+  }
+
+  SECTION("Numbers each shard by its index")
+  {
+    for( auto i = std::size_t{0}; i < executor.size(); ++i ) {
+      REQUIRE( executor[i].index() == i );
+      REQUIRE( &executor[i].get_executor() == &executor );
+    }
+  }
+}
+
+TEST_CASE("sharded_executor::~sharded_executor()", "[dtor]")
+{
+  static constexpr auto count = 1000;
+
+  std::atomic<int> executed{0};
+
+  {
+    bit::platform::sharded_executor executor(2);
+
+    for( auto i = 0; i < count; ++i ) {
+      executor[i % 2].post([&]{ ++executed; });
+    }
+  }
+
+  SECTION("Runs every task that was posted before it was destroyed")
+  {
+    REQUIRE( executed.load() == count );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Observers
+//----------------------------------------------------------------------------
+
+TEST_CASE("sharded_executor::this_shard()", "[observers]")
+{
+  bit::platform::sharded_executor executor(2);
+
+  SECTION("Returns nullptr outside of a shard")
+  {
+    REQUIRE( bit::platform::sharded_executor::this_shard() == nullptr );
+  }
+
+  SECTION("Returns the shard whose thread is calling")
+  {
+    const auto* shard = executor[1].post_and_wait([]
+    {
+      return bit::platform::sharded_executor::this_shard();
+    });
+
+    REQUIRE( shard == &executor[1] );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Execution
+//----------------------------------------------------------------------------
+
+TEST_CASE("executor_shard::post( Fn&&, Args&&... )", "[execution]")
+{
+  static constexpr auto count = 10000;
+
+  SECTION("Executes tasks from another thread in the order they were posted")
+  {
+    auto order = std::vector<int>{};
+
+    {
+      bit::platform::sharded_executor executor(2);
+
+      for( auto i = 0; i < count; ++i ) {
+        executor[0].post([&]( int value ){ order.push_back( value ); }, i );
+      }
+    }
+
+    auto ordered = true;
+    for( auto i = 0; i < count; ++i ) {
+      if( order[i] != i ) ordered = false;
+    }
+    REQUIRE( order.size() == static_cast<std::size_t>(count) );
+    REQUIRE( ordered );
+  }
+
+  SECTION("Executes tasks forwarded between shards, beyond the ring capacity")
+  {
+    std::atomic<int> executed{0};
+    std::atomic<bool> wrong_shard{false};
+
+    {
+      bit::platform::sharded_executor executor(2, 16);
+
+      executor[0].post([&]
+      {
+        for( auto i = 0; i < count; ++i ) {
+          executor[1].post([&]
+          {
+            if( bit::platform::sharded_executor::this_shard() != &executor[1] ) wrong_shard = true;
+            ++executed;
+          });
+        }
+      });
+    }
+
+    REQUIRE( executed.load() == count );
+    REQUIRE_FALSE( wrong_shard.load() );
+  }
+
+  SECTION("Discards exceptions thrown by the task")
+  {
+    std::atomic<int> executed{0};
+
+    {
+      bit::platform::sharded_executor executor(2);
+
+      executor[0].post([]{ throw std::runtime_error("error"); });
+      executor[0].post([&]{ ++executed; });
+      executor[1].post([&]
+      {
+        executor[0].post([]{ throw std::runtime_error("error"); });
+        executor[0].post([&]{ ++executed; });
+      });
+    }
+
+    REQUIRE( executed.load() == 2 );
+  }
+}
+
+TEST_CASE("executor_shard::post_and_wait( Fn&&, Args&&... )", "[execution]")
+{
+  bit::platform::sharded_executor executor(2);
+
+  SECTION("Returns the result of the function")
+  {
+    REQUIRE( executor[0].post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 ) == 5 );
+  }
+
+  SECTION("Invokes the function immediately from the same shard")
+  {
+    const auto result = executor[0].post_and_wait([&]
+    {
+      return executor[0].post_and_wait([]{ return 5; });
+    });
+
+    REQUIRE( result == 5 );
+  }
+
+  SECTION("Waits on another shard without blocking it")
+  {
+    const auto result = executor[0].post_and_wait([&]
+    {
+      return executor[1].post_and_wait([&]
+      {
+        return bit::platform::sharded_executor::this_shard()->index();
+      });
+    });
+
+    REQUIRE( result == 1u );
+  }
+}
+
+TEST_CASE("sharded_executor::submit_to( std::size_t, Fn&&, Args&&... )", "[execution]")
+{
+  bit::platform::sharded_executor executor(2);
+
+  SECTION("Returns a future to the result of the function")
+  {
+    auto f = executor.submit_to( 1, []( int a, int b ){ return a * b; }, 3, 4 );
+
+    REQUIRE( f.get() == 12 );
+  }
+
+  SECTION("Propagates an exception through the future")
+  {
+    auto f = executor.submit_to( 0, []() -> int { throw std::runtime_error("error"); } );
+
+    REQUIRE_THROWS_AS( f.get(), std::runtime_error );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Timers
+//----------------------------------------------------------------------------
+
+TEST_CASE("executor_shard::schedule_timer( time_point, callback_type )", "[timers]")
+{
+  using clock_type = std::chrono::steady_clock;
+
+  bit::platform::sharded_executor executor(1);
+  std::atomic<bool> fired{false};
+  std::atomic<bool> on_shard{false};
+
+  const auto deadline = clock_type::now() + std::chrono::milliseconds(10);
+  executor[0].post([&]
+  {
+    executor[0].schedule_timer( deadline, [&]
+    {
+      on_shard = bit::platform::sharded_executor::this_shard() == &executor[0];
+      fired    = true;
+    });
+  });
+
+  while( !fired.load() ) {
+    std::this_thread::yield();
+  }
+
+  REQUIRE( clock_type::now() >= deadline );
+  REQUIRE( on_shard.load() );
+}
+
+TEST_CASE("executor_shard::cancel_timer( timer_handle )", "[timers]")
+{
+  bit::platform::sharded_executor executor(1);
+  std::atomic<bool> fired{false};
+
+  const auto cancelled = executor[0].post_and_wait([&]
+  {
+    const auto handle = executor[0].schedule_timer(
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(5),
+      [&]{ fired = true; }
+    );
+    return executor[0].cancel_timer( handle );
+  });
+  std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+
+  REQUIRE( cancelled );
+  REQUIRE_FALSE( fired.load() );
+}
+
+//----------------------------------------------------------------------------
+// Arena
+//----------------------------------------------------------------------------
+
+TEST_CASE("shard_arena::allocate( std::size_t, std::size_t )", "[arena]")
+{
+  bit::platform::shard_arena arena(256);
+
+  SECTION("Returns memory aligned to the requested alignment")
+  {
+    arena.allocate( 1, 1 );
+    auto* p = arena.allocate( 8, 64 );
+
+    REQUIRE( reinterpret_cast<std::uintptr_t>(p) % 64 == 0u );
+  }
+
+  SECTION("Allocates new chunks once the first is exhausted")
+  {
+    auto* first  = static_cast<char*>(arena.allocate( 200 ));
+    auto* second = static_cast<char*>(arena.allocate( 200 ));
+
+    REQUIRE( first != nullptr );
+    REQUIRE( second != nullptr );
+    REQUIRE( (second >= first + 200 || second + 200 <= first) );
+  }
+}
@@ -0,0 +1,243 @@
+/**
+ * \file spsc_queue.test.cpp
+ *
+ * \brief This file contains unit tests for spsc_queue and
+ *        unbounded_spsc_queue
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/spsc_queue.hpp>
+
+#include <catch.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+//============================================================================
+// spsc_queue
+//============================================================================
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("spsc_queue::spsc_queue( size_type )", "[ctor]")
+{
+  bit::platform::spsc_queue<int> queue(3);
+
+  SECTION("Rounds the capacity up to a power of two")
+  {
+    REQUIRE( queue.capacity() == 4u );
+  }
+
+  SECTION("Starts empty")
+  {
+    REQUIRE( queue.empty() );
+    REQUIRE( queue.size() == 0u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Element Access
+//----------------------------------------------------------------------------
+
+TEST_CASE("spsc_queue::try_pop( T* )", "[element access]")
+{
+  bit::platform::spsc_queue<std::string> queue(4);
+  auto value = std::string();
+
+  SECTION("Fails on an empty queue")
+  {
+    REQUIRE_FALSE( queue.try_pop( &value ) );
+  }
+
+  SECTION("Pops entries in the order they were pushed")
+  {
+    queue.try_push_back( "a" );
+    queue.try_emplace_back( 2u, 'b' );
+
+    REQUIRE( queue.try_pop( &value ) );
+    REQUIRE( value == "a" );
+    REQUIRE( queue.try_pop( &value ) );
+    REQUIRE( value == "bb" );
+    REQUIRE( queue.empty() );
+  }
+}
+
+TEST_CASE("spsc_queue::pop_n( span<T> )", "[element access]")
+{
+  bit::platform::spsc_queue<int> queue(8);
+  auto values = std::vector<int>(8);
+
+  for( auto i = 0; i < 5; ++i ) {
+    queue.try_push_back( i );
+  }
+
+  SECTION("Pops no more than are available")
+  {
+    const auto count = queue.pop_n( bit::stl::span<int>( values.data(), 8u ) );
+
+    REQUIRE( count == 5u );
+    for( auto i = 0; i < 5; ++i ) {
+      REQUIRE( values[i] == i );
+    }
+  }
+
+  SECTION("Pops no more than requested")
+  {
+    const auto count = queue.pop_n( bit::stl::span<int>( values.data(), 2u ) );
+
+    REQUIRE( count == 2u );
+    REQUIRE( queue.size() == 3u );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("spsc_queue::try_push_back( const T& )", "[modifiers]")
+{
+  bit::platform::spsc_queue<int> queue(4);
+
+  for( auto i = 0; i < 4; ++i ) {
+    REQUIRE( queue.try_push_back( i ) );
+  }
+
+  SECTION("Fails on a full queue")
+  {
+    REQUIRE_FALSE( queue.try_push_back( 4 ) );
+  }
+
+  SECTION("Succeeds again once an entry is popped")
+  {
+    auto value = 0;
+    queue.try_pop( &value );
+
+    REQUIRE( queue.try_push_back( 4 ) );
+  }
+}
+
+TEST_CASE("spsc_queue::push_n( span<const T> )", "[modifiers]")
+{
+  bit::platform::spsc_queue<int> queue(4);
+  const auto values = std::vector<int>{ 1, 2, 3, 4, 5, 6 };
+
+  const auto count = queue.push_n( bit::stl::span<const int>( values.data(), values.size() ) );
+
+  REQUIRE( count == 4u );
+  REQUIRE( queue.size() == 4u );
+}
+
+//----------------------------------------------------------------------------
+// Concurrency
+//----------------------------------------------------------------------------
+
+TEST_CASE("spsc_queue with a producer and a consumer", "[concurrency]")
+{
+  static constexpr auto count = 100000;
+
+  bit::platform::spsc_queue<int> queue(64);
+  auto ordered = true;
+
+  auto consumer = std::thread([&]
+  {
+    auto values = std::vector<int>(16);
+
+    for( auto expected = 0; expected < count; ) {
+      const auto popped = queue.pop_n( bit::stl::span<int>( values.data(), values.size() ) );
+
+      for( auto i = 0u; i < popped; ++i ) {
+        ordered = ordered && values[i] == expected++;
+      }
+      if( popped == 0u ) std::this_thread::yield();
+    }
+  });
+
+  for( auto i = 0; i < count; ) {
+    if( queue.try_push_back( i ) ) {
+      ++i;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+
+  REQUIRE( ordered );
+  REQUIRE( queue.empty() );
+}
+
+//============================================================================
+// unbounded_spsc_queue
+//============================================================================
+
+TEST_CASE("unbounded_spsc_queue::push_back( const T& )", "[modifiers]")
+{
+  bit::platform::unbounded_spsc_queue<int> queue;
+  const auto count = static_cast<int>(3u * queue.segment_size);
+
+  // Spans several segments
+  for( auto i = 0; i < count; ++i ) {
+    queue.push_back( i );
+  }
+
+  auto value   = 0;
+  auto ordered = true;
+  for( auto i = 0; i < count; ++i ) {
+    ordered = ordered && queue.try_pop( &value ) && value == i;
+  }
+
+  REQUIRE( ordered );
+  REQUIRE( queue.empty() );
+  REQUIRE_FALSE( queue.try_pop( &value ) );
+}
+
+TEST_CASE("unbounded_spsc_queue::push_n( span<const T> )", "[modifiers]")
+{
+  bit::platform::unbounded_spsc_queue<std::string> queue;
+  auto values = std::vector<std::string>(1000);
+
+  for( auto i = 0u; i < values.size(); ++i ) {
+    values[i] = std::to_string(i);
+  }
+  queue.push_n( bit::stl::span<const std::string>( values.data(), values.size() ) );
+
+  auto popped = std::vector<std::string>(2000);
+  const auto count = queue.pop_n( bit::stl::span<std::string>( popped.data(), popped.size() ) );
+
+  REQUIRE( count == 1000u );
+  REQUIRE( popped[0] == "0" );
+  REQUIRE( popped[999] == "999" );
+  REQUIRE( queue.empty() );
+}
+
+TEST_CASE("unbounded_spsc_queue with a producer and a consumer", "[concurrency]")
+{
+  static constexpr auto count = 100000;
+
+  bit::platform::unbounded_spsc_queue<int> queue;
+  auto ordered = true;
+
+  auto consumer = std::thread([&]
+  {
+    auto value = 0;
+
+    for( auto expected = 0; expected < count; ) {
+      if( queue.try_pop( &value ) ) {
+        ordered = ordered && value == expected++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for( auto i = 0; i < count; ++i ) {
+    queue.push_back( i );
+  }
+  consumer.join();
+
+  REQUIRE( ordered );
+  REQUIRE( queue.empty() );
+}
@@ -0,0 +1,363 @@
+/**
+ * \file thread_pool.test.cpp
+ *
+ * \brief This file contains unit tests for the thread pools
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/thread_pool.hpp>
+
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /// Recursively posts a binary tree of tasks of the given \p depth to
+  /// \p pool, counting each in \p executed
+  template<typename ThreadPool>
+  void post_tree( ThreadPool& pool, int depth, std::atomic<int>& executed )
+  {
+    ++executed;
+    if( depth == 0 ) return;
+
+    pool.post([&pool,depth,&executed]{ post_tree( pool, depth - 1, executed ); });
+    pool.post([&pool,depth,&executed]{ post_tree( pool, depth - 1, executed ); });
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// basic_thread_pool : Constructors / Destructor
+//----------------------------------------------------------------------------
+
+TEST_CASE("basic_thread_pool::basic_thread_pool( size_type )", "[ctor]")
+{
+  SECTION("Uses the specified capacity")
+  {
+    bit::platform::thread_pool pool(3);
+
+    REQUIRE( pool.capacity() == 3u );
+  }
+
+  SECTION("Uses at least one thread")
+  {
+    bit::platform::thread_pool pool(0);
+
+    REQUIRE( pool.capacity() == 1u );
+  }
+}
+
+TEST_CASE("basic_thread_pool::basic_thread_pool( std::allocator_arg_t, const Allocator&, size_type )", "[ctor]")
+{
+  bit::platform::basic_thread_pool<std::allocator<int>> pool(std::allocator_arg,std::allocator<int>{},2);
+
+  SECTION("Uses the specified capacity")
+  {
+    REQUIRE( pool.capacity() == 2u );
+  }
+
+  SECTION("Executes tasks")
+  {
+    REQUIRE( pool.post_and_wait([]{ return 42; }) == 42 );
+  }
+}
+
+TEST_CASE("basic_thread_pool::~basic_thread_pool()", "[dtor]")
+{
+  static constexpr auto count = 10000;
+
+  std::atomic<int> executed{0};
+  {
+    bit::platform::thread_pool pool(2);
+    for( auto i = 0; i < count; ++i ) {
+      pool.post([&]{ ++executed; });
+    }
+  }
+
+  SECTION("Executes every remaining task before returning")
+  {
+    REQUIRE( executed.load() == count );
+  }
+}
+
+//----------------------------------------------------------------------------
+// basic_thread_pool : Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("basic_thread_pool::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  SECTION("Forwards the arguments to the function")
+  {
+    std::atomic<int> sum{0};
+    {
+      bit::platform::thread_pool pool(2);
+      pool.post([&]( int a, int b ){ sum = a + b; }, 2, 3 );
+    }
+
+    REQUIRE( sum.load() == 5 );
+  }
+
+  SECTION("Stores a copy of the arguments")
+  {
+    auto value = std::make_shared<int>(1);
+    std::atomic<long> use_count{0};
+    {
+      bit::platform::thread_pool pool(1);
+      pool.post([&]( const std::shared_ptr<int>& p ){ use_count = p.use_count(); }, value );
+    }
+
+    REQUIRE( use_count.load() == 2 );
+    REQUIRE( value.use_count() == 1 );
+  }
+
+  SECTION("Executes tasks that are posted recursively from the workers")
+  {
+    // 2^13 - 1 tasks, all but the first posted to the local queue of a
+    // worker, and stolen by the others
+    static constexpr auto depth = 12;
+
+    std::atomic<int> executed{0};
+    {
+      bit::platform::thread_pool pool(4);
+      pool.post([&]{ post_tree( pool, depth, executed ); });
+    }
+
+    REQUIRE( executed.load() == (1 << (depth + 1)) - 1 );
+  }
+
+  SECTION("Executes tasks that are posted from multiple external threads")
+  {
+    static constexpr auto producers = 4;
+    static constexpr auto count     = 2500;
+
+    std::atomic<int> executed{0};
+    {
+      bit::platform::thread_pool pool(2);
+
+      auto threads = std::vector<std::thread>{};
+      for( auto p = 0; p < producers; ++p ) {
+        threads.emplace_back([&]
+        {
+          for( auto i = 0; i < count; ++i ) {
+            pool.post([&]{ ++executed; });
+          }
+        });
+      }
+      for( auto& thread : threads ) {
+        thread.join();
+      }
+    }
+
+    REQUIRE( executed.load() == producers * count );
+  }
+}
+
+TEST_CASE("basic_thread_pool::post( unique_task )", "[modifiers]")
+{
+  std::atomic<bool> executed{false};
+  {
+    bit::platform::thread_pool pool(1);
+    pool.post( bit::platform::unique_task([&]{ executed = true; }) );
+  }
+
+  REQUIRE( executed.load() );
+}
+
+TEST_CASE("basic_thread_pool::post_and_wait( Fn&&, Args&&... )", "[modifiers]")
+{
+  bit::platform::thread_pool pool(2);
+
+  SECTION("Returns the result of the function")
+  {
+    REQUIRE( pool.post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 ) == 5 );
+  }
+
+  SECTION("Returns a reference to the result of the function")
+  {
+    auto value = 0;
+    auto& result = pool.post_and_wait([&]() -> int& { return value; });
+
+    REQUIRE( &result == &value );
+  }
+
+  SECTION("Executes on a worker of the pool")
+  {
+    const auto id = pool.post_and_wait([]{ return std::this_thread::get_id(); });
+
+    REQUIRE( id != std::this_thread::get_id() );
+  }
+
+  SECTION("Helps execute tasks when called from every worker at once")
+  {
+    // Every worker waits on a nested task, so they can only finish by
+    // executing each other's
+    std::atomic<int> executed{0};
+    std::atomic<int> waiting{0};
+    bit::platform::completion_flag done;
+
+    for( auto i = 0u; i < pool.capacity(); ++i ) {
+      pool.post([&]
+      {
+        executed += pool.post_and_wait([]{ return 1; });
+        if( ++waiting == static_cast<int>(pool.capacity()) ) done.signal();
+      });
+    }
+    done.wait();
+
+    REQUIRE( executed.load() == static_cast<int>(pool.capacity()) );
+  }
+}
+
+TEST_CASE("basic_thread_pool with tasks that throw", "[exceptions]")
+{
+  bit::platform::thread_pool pool(1);
+
+  SECTION("post discards the exception, and the worker keeps running")
+  {
+    pool.post([]{ throw std::runtime_error("posted"); });
+
+    REQUIRE( pool.post_and_wait([]{ return 42; }) == 42 );
+  }
+
+  SECTION("post_and_wait rethrows the exception on the waiting thread")
+  {
+    REQUIRE_THROWS_AS( pool.post_and_wait([]() -> int { throw std::runtime_error("waited"); }), std::runtime_error );
+  }
+}
+
+//----------------------------------------------------------------------------
+// cached_thread_pool
+//----------------------------------------------------------------------------
+
+TEST_CASE("cached_thread_pool::cached_thread_pool( duration )", "[ctor]")
+{
+  bit::platform::cached_thread_pool pool(std::chrono::milliseconds(5));
+
+  SECTION("Uses the specified idle timeout")
+  {
+    REQUIRE( pool.idle_timeout() == std::chrono::milliseconds(5) );
+  }
+
+  SECTION("Starts with no threads")
+  {
+    REQUIRE( pool.size() == 0u );
+    REQUIRE( pool.idle() == 0u );
+    REQUIRE( pool.peak_size() == 0u );
+  }
+}
+
+TEST_CASE("cached_thread_pool::~cached_thread_pool()", "[dtor]")
+{
+  std::atomic<bool> finished{false};
+  {
+    bit::platform::cached_thread_pool pool;
+    pool.post([&]
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+      finished = true;
+    });
+  }
+
+  SECTION("Waits for running tasks to complete")
+  {
+    REQUIRE( finished.load() );
+  }
+}
+
+TEST_CASE("cached_thread_pool::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  SECTION("Runs every task concurrently")
+  {
+    // Each task waits for all of the others, which only completes if no
+    // task waits behind another for a thread
+    static constexpr auto count = 8;
+
+    bit::platform::cached_thread_pool pool;
+    std::atomic<int> arrived{0};
+    bit::platform::completion_flag done;
+
+    for( auto i = 0; i < count; ++i ) {
+      pool.post([&]
+      {
+        if( ++arrived == count ) done.signal();
+        done.wait();
+      });
+    }
+    done.wait();
+
+    REQUIRE( pool.peak_size() == std::size_t{count} );
+  }
+
+  SECTION("Reuses an idle thread rather than creating a new one")
+  {
+    bit::platform::cached_thread_pool pool;
+
+    const auto first  = pool.post_and_wait([]{ return std::this_thread::get_id(); });
+    while( pool.idle() == 0u ) std::this_thread::yield();
+    const auto second = pool.post_and_wait([]{ return std::this_thread::get_id(); });
+
+    REQUIRE( first == second );
+    REQUIRE( pool.peak_size() == 1u );
+  }
+
+  SECTION("Retires threads that are idle for longer than the timeout")
+  {
+    bit::platform::cached_thread_pool pool(std::chrono::milliseconds(1));
+
+    pool.post_and_wait([]{});
+    while( pool.size() != 0u ) std::this_thread::yield();
+
+    REQUIRE( pool.idle() == 0u );
+    REQUIRE( pool.post_and_wait([]{ return 42; }) == 42 );
+  }
+
+  SECTION("Discards exceptions, and keeps the thread for reuse")
+  {
+    bit::platform::cached_thread_pool pool;
+
+    pool.post([]{ throw std::runtime_error("posted"); });
+    while( pool.idle() == 0u ) std::this_thread::yield();
+
+    REQUIRE( pool.post_and_wait([]{ return 42; }) == 42 );
+    REQUIRE( pool.peak_size() == 1u );
+  }
+}
+
+TEST_CASE("cached_thread_pool::post_and_wait( Fn&&, Args&&... )", "[modifiers]")
+{
+  bit::platform::cached_thread_pool pool;
+
+  SECTION("Returns the result of the function")
+  {
+    REQUIRE( pool.post_and_wait([]( int a, int b ){ return a + b; }, 2, 3 ) == 5 );
+  }
+
+  SECTION("Rethrows the exception on the waiting thread")
+  {
+    REQUIRE_THROWS_AS( pool.post_and_wait([]() -> int { throw std::runtime_error("waited"); }), std::runtime_error );
+  }
+}
+
+//----------------------------------------------------------------------------
+// sequential_thread_pool
+//----------------------------------------------------------------------------
+
+TEST_CASE("sequential_thread_pool::post( Fn&&, Args&&... )", "[modifiers]")
+{
+  bit::platform::sequential_thread_pool pool;
+  auto id = std::thread::id{};
+
+  pool.post([&]{ id = std::this_thread::get_id(); });
+
+  SECTION("Executes on the calling thread before returning")
+  {
+    REQUIRE( id == std::this_thread::get_id() );
+  }
+}
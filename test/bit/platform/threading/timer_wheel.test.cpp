@@ -0,0 +1,221 @@
+/**
+ * \file timer_wheel.test.cpp
+ *
+ * \brief This file contains unit tests for timer_wheel
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/timer_wheel.hpp>
+
+#include <catch.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace {
+
+  using clock_type    = bit::platform::timer_wheel::clock_type;
+  using callback_type = bit::platform::timer_wheel::callback_type;
+  using milliseconds  = std::chrono::milliseconds;
+
+  /// Invokes every callback in \p expired, then clears it
+  void invoke_all( std::vector<callback_type>& expired )
+  {
+    for( auto& callback : expired ) {
+      callback();
+    }
+    expired.clear();
+  }
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+TEST_CASE("timer_wheel::timer_wheel( duration )", "[ctor]")
+{
+  bit::platform::timer_wheel wheel(milliseconds(2));
+
+  SECTION("Starts empty")
+  {
+    REQUIRE( wheel.empty() );
+    REQUIRE( wheel.size() == 0u );
+  }
+
+  SECTION("Uses the specified resolution")
+  {
+    REQUIRE( wheel.resolution() == milliseconds(2) );
+  }
+
+  SECTION("Has no next expiry")
+  {
+    REQUIRE( wheel.next_expiry() == clock_type::time_point::max() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("timer_wheel::schedule( time_point, callback_type )", "[modifiers]")
+{
+  bit::platform::timer_wheel wheel;
+  const auto start = clock_type::now();
+  auto expired = std::vector<callback_type>{};
+  auto order   = std::vector<int>{};
+
+  SECTION("Returns a handle to the timer")
+  {
+    const auto handle = wheel.schedule( start + milliseconds(5), []{} );
+
+    REQUIRE( static_cast<bool>(handle) );
+    REQUIRE( wheel.size() == 1u );
+    REQUIRE( wheel.next_expiry() <= start + milliseconds(6) );
+  }
+
+  SECTION("Does not expire a timer before its deadline")
+  {
+    wheel.schedule( start + milliseconds(5), []{} );
+
+    REQUIRE( wheel.advance( start + milliseconds(3), expired ) == 0u );
+    REQUIRE( expired.empty() );
+    REQUIRE( wheel.size() == 1u );
+  }
+
+  SECTION("Expires timers in the order of their deadlines")
+  {
+    wheel.schedule( start + milliseconds(5), [&]{ order.push_back( 5 ); } );
+    wheel.schedule( start + milliseconds(1), [&]{ order.push_back( 1 ); } );
+    wheel.schedule( start + milliseconds(3), [&]{ order.push_back( 3 ); } );
+
+    REQUIRE( wheel.advance( start + milliseconds(10), expired ) == 3u );
+    invoke_all( expired );
+
+    REQUIRE( order == (std::vector<int>{ 1, 3, 5 }) );
+    REQUIRE( wheel.empty() );
+  }
+
+  SECTION("Expires timers that cascade from the upper levels")
+  {
+    // Past the range of the first two levels
+    wheel.schedule( start + milliseconds(10000), [&]{ order.push_back( 1 ); } );
+
+    REQUIRE( wheel.advance( start + milliseconds(9999), expired ) == 0u );
+    REQUIRE( wheel.advance( start + milliseconds(10001), expired ) == 1u );
+    invoke_all( expired );
+
+    REQUIRE( order == (std::vector<int>{ 1 }) );
+  }
+
+  SECTION("Expires timers beyond the range of the wheel")
+  {
+    const auto deadline = start + std::chrono::hours(10);
+
+    wheel.schedule( deadline, []{} );
+
+    REQUIRE( wheel.advance( deadline - std::chrono::hours(1), expired ) == 0u );
+    REQUIRE( wheel.advance( deadline + milliseconds(1), expired ) == 1u );
+  }
+
+  SECTION("Expires a burst of timers with the same deadline at once")
+  {
+    for( auto i = 0; i < 10000; ++i ) {
+      wheel.schedule( start + milliseconds(5), []{} );
+    }
+
+    REQUIRE( wheel.advance( start + milliseconds(6), expired ) == 10000u );
+    REQUIRE( wheel.empty() );
+  }
+}
+
+TEST_CASE("timer_wheel::schedule( time_point, duration, callback_type )", "[modifiers]")
+{
+  bit::platform::timer_wheel wheel;
+  const auto start = clock_type::now();
+  auto expired = std::vector<callback_type>{};
+  auto count   = 0;
+
+  wheel.schedule( start + milliseconds(1), milliseconds(2), [&]{ ++count; } );
+
+  // Deadlines are rounded up to the next tick of the wheel, so each advance
+  // is a tick later than the deadline it is meant to reach
+  SECTION("Expires again every period")
+  {
+    wheel.advance( start + milliseconds(2), expired );
+    wheel.advance( start + milliseconds(4), expired );
+    wheel.advance( start + milliseconds(6), expired );
+    invoke_all( expired );
+
+    REQUIRE( count == 3 );
+    REQUIRE( wheel.size() == 1u );
+  }
+
+  SECTION("Skips missed periods rather than expiring in a burst")
+  {
+    wheel.advance( start + milliseconds(2), expired );
+    wheel.advance( start + milliseconds(22), expired );
+    invoke_all( expired );
+
+    REQUIRE( count == 2 );
+  }
+}
+
+TEST_CASE("timer_wheel::cancel( timer_handle )", "[modifiers]")
+{
+  bit::platform::timer_wheel wheel;
+  const auto start = clock_type::now();
+  auto expired = std::vector<callback_type>{};
+
+  const auto handle = wheel.schedule( start + milliseconds(5), []{} );
+
+  SECTION("Cancels a pending timer")
+  {
+    REQUIRE( wheel.cancel( handle ) );
+    REQUIRE( wheel.empty() );
+    REQUIRE( wheel.advance( start + milliseconds(10), expired ) == 0u );
+  }
+
+  SECTION("Does nothing for a cancelled timer")
+  {
+    wheel.cancel( handle );
+
+    REQUIRE_FALSE( wheel.cancel( handle ) );
+  }
+
+  SECTION("Does nothing for an expired timer")
+  {
+    wheel.advance( start + milliseconds(10), expired );
+
+    REQUIRE_FALSE( wheel.cancel( handle ) );
+  }
+
+  SECTION("Does nothing for a handle whose node was reused")
+  {
+    wheel.cancel( handle );
+    wheel.schedule( start + milliseconds(5), []{} );
+
+    REQUIRE_FALSE( wheel.cancel( handle ) );
+    REQUIRE( wheel.size() == 1u );
+  }
+
+  SECTION("Does nothing for an empty handle")
+  {
+    REQUIRE_FALSE( wheel.cancel( bit::platform::timer_handle{} ) );
+  }
+}
+
+TEST_CASE("timer_wheel::clear()", "[modifiers]")
+{
+  bit::platform::timer_wheel wheel;
+  const auto start = clock_type::now();
+  auto expired = std::vector<callback_type>{};
+
+  wheel.schedule( start + milliseconds(5), []{} );
+  wheel.schedule( start + milliseconds(5000), milliseconds(1), []{} );
+  wheel.clear();
+
+  REQUIRE( wheel.empty() );
+  REQUIRE( wheel.advance( start + milliseconds(10000), expired ) == 0u );
+}
@@ -0,0 +1,224 @@
+/**
+ * \file unique_task.test.cpp
+ *
+ * \brief This file contains unit tests for unique_task
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#include <bit/platform/threading/unique_task.hpp>
+
+#include <catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+  /// A callable that is too large to be stored inline
+  struct large_callable
+  {
+    std::array<char,128> data;
+    int*                 result;
+
+    void operator()(){ *result = data.back(); }
+  };
+
+  /// A callable whose move constructor may throw
+  struct throwing_move_callable
+  {
+    throwing_move_callable() = default;
+    throwing_move_callable( throwing_move_callable&& ){}
+
+    void operator()(){}
+  };
+
+  /// An allocator that counts the allocations made through it
+  template<typename T>
+  struct counting_allocator
+  {
+    using value_type = T;
+
+    std::size_t* count;
+
+    explicit counting_allocator( std::size_t* count ) : count(count){}
+
+    template<typename U>
+    counting_allocator( const counting_allocator<U>& other ) : count(other.count){}
+
+    T* allocate( std::size_t n )
+    {
+      ++(*count);
+      return std::allocator<T>{}.allocate( n );
+    }
+
+    void deallocate( T* p, std::size_t n )
+    {
+      std::allocator<T>{}.deallocate( p, n );
+    }
+
+    template<typename U>
+    bool operator==( const counting_allocator<U>& other ) const{ return count == other.count; }
+    template<typename U>
+    bool operator!=( const counting_allocator<U>& other ) const{ return count != other.count; }
+  };
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Static Members
+//----------------------------------------------------------------------------
+
+TEST_CASE("unique_task::is_stored_inline<Fn>()", "[static]")
+{
+  using unique_task = bit::platform::unique_task;
+
+  SECTION("Is true for small, nothrow-movable callables")
+  {
+    auto fn = [p = static_cast<void*>(nullptr)]{ (void) p; };
+
+    REQUIRE( unique_task::is_stored_inline<decltype(fn)>() );
+  }
+
+  SECTION("Is false for callables larger than the buffer")
+  {
+    REQUIRE_FALSE( unique_task::is_stored_inline<large_callable>() );
+  }
+
+  SECTION("Is false for callables that may throw on move")
+  {
+    REQUIRE_FALSE( unique_task::is_stored_inline<throwing_move_callable>() );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Constructors / Assignment
+//----------------------------------------------------------------------------
+
+TEST_CASE("unique_task::unique_task()", "[ctor]")
+{
+  auto task = bit::platform::unique_task{};
+
+  SECTION("Is empty")
+  {
+    REQUIRE_FALSE( static_cast<bool>(task) );
+  }
+}
+
+TEST_CASE("unique_task::unique_task( Fn&& )", "[ctor]")
+{
+  SECTION("Invokes the stored callable")
+  {
+    auto called = false;
+    auto task = bit::platform::unique_task([&]{ called = true; });
+    task();
+
+    REQUIRE( static_cast<bool>(task) );
+    REQUIRE( called );
+  }
+
+  SECTION("Invokes a callable that is too large to be stored inline")
+  {
+    auto result = 0;
+    auto fn = large_callable{ {}, &result };
+    fn.data.back() = 42;
+
+    auto task = bit::platform::unique_task( fn );
+    task();
+
+    REQUIRE( result == 42 );
+  }
+
+  SECTION("Destroys the stored callable with the task")
+  {
+    auto value = std::make_shared<int>(0);
+    {
+      auto task = bit::platform::unique_task([value]{});
+
+      REQUIRE( value.use_count() == 2 );
+    }
+    REQUIRE( value.use_count() == 1 );
+  }
+}
+
+TEST_CASE("unique_task::unique_task( std::allocator_arg_t, const Allocator&, Fn&& )", "[ctor]")
+{
+  auto count = std::size_t{0};
+  const auto allocator = counting_allocator<char>(&count);
+
+  SECTION("Does not allocate for callables stored inline")
+  {
+    auto task = bit::platform::unique_task( std::allocator_arg, allocator, []{} );
+
+    REQUIRE( count == 0u );
+  }
+
+  SECTION("Allocates with the allocator for callables that are not stored inline")
+  {
+    auto result = 0;
+    auto task = bit::platform::unique_task( std::allocator_arg, allocator, large_callable{ {}, &result } );
+
+    REQUIRE( count == 1u );
+  }
+}
+
+TEST_CASE("unique_task::unique_task( unique_task&& )", "[ctor]")
+{
+  auto value = std::make_shared<int>(0);
+
+  SECTION("Moves a callable stored inline, leaving the source empty")
+  {
+    auto task  = bit::platform::unique_task([value]{});
+    auto moved = std::move(task);
+
+    REQUIRE_FALSE( static_cast<bool>(task) );
+    REQUIRE( static_cast<bool>(moved) );
+    REQUIRE( value.use_count() == 2 );
+  }
+
+  SECTION("Moves an allocated callable, leaving the source empty")
+  {
+    auto task  = bit::platform::unique_task([value, data = std::array<char,128>{}]{ (void) data; });
+    auto moved = std::move(task);
+
+    REQUIRE_FALSE( static_cast<bool>(task) );
+    REQUIRE( static_cast<bool>(moved) );
+    REQUIRE( value.use_count() == 2 );
+  }
+}
+
+TEST_CASE("unique_task::operator=( std::nullptr_t )", "[assignment]")
+{
+  auto value = std::make_shared<int>(0);
+  auto task  = bit::platform::unique_task([value]{});
+
+  task = nullptr;
+
+  SECTION("Destroys the stored callable")
+  {
+    REQUIRE_FALSE( static_cast<bool>(task) );
+    REQUIRE( value.use_count() == 1 );
+  }
+}
+
+//----------------------------------------------------------------------------
+// Modifiers
+//----------------------------------------------------------------------------
+
+TEST_CASE("unique_task::swap( unique_task& )", "[modifiers]")
+{
+  auto first  = 0;
+  auto second = 0;
+  auto a = bit::platform::unique_task([&]{ first = 1; });
+  auto b = bit::platform::unique_task([&]{ second = 2; });
+
+  swap( a, b );
+  a();
+
+  SECTION("Swaps the callables")
+  {
+    REQUIRE( first == 0 );
+    REQUIRE( second == 2 );
+  }
+}
@@ -0,0 +1,10 @@
+/**
+ * \file main.test.cpp
+ *
+ * \brief This file contains the entry point of the unit tests
+ *
+ * \author Matthew Rodusek (matthew.rodusek@gmail.com)
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>